@@ -0,0 +1,291 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "arena.h"
+#include "common.h"
+
+/* Arena memory comes in chunks of ARENA_CHUNK_SIZE bytes, aligned on their
+ * size (requests that do not fit in one chunk get a block of several). Then
+ * the chunk that holds any address is found by masking it, and arena_free() can
+ * tell arena memory from malloc()ed memory by looking up that chunk in the set
+ * of live chunks. That set is shared by all arenas, hence by all threads, and
+ * is locked (lookups only take a read lock, and none is needed while no arena
+ * has chunks); an arena itself, and the current arena, belong to one thread.
+ * Nodes record whether they come from an arena (see rnode.h), so freeing them
+ * needs no lookup. */
+
+#define ARENA_CHUNK_SIZE 8192
+#define ARENA_ALIGN 16
+#define MIN_CHUNK_SET_SIZE 64
+
+/* Header of a chunk, or of a block of chunks. */
+
+struct arena_chunk {
+	struct arena_chunk *next;
+	size_t size;
+};
+
+#define CHUNK_HEADER_SIZE \
+	((sizeof(struct arena_chunk) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+struct arena {
+	struct arena_chunk *chunks;
+	char *next;	/* next free byte in the current chunk */
+	char *end;	/* end of the current chunk */
+};
+
+static THREAD_LOCAL struct arena *current = NULL;
+
+/* The set of live chunks (by address), an open-addressing table. 0 marks an
+ * empty slot: no chunk starts at address 0. */
+
+static pthread_rwlock_t chunk_set_lock = PTHREAD_RWLOCK_INITIALIZER;
+static uintptr_t *chunk_set = NULL;
+static size_t chunk_set_size = 0;	/* a power of 2 */
+static size_t chunk_set_count = 0;
+/* chunk_set_count, but read without the lock (chunk_set_count itself drops to
+ * 0 while the set grows) */
+static size_t live_chunks = 0;
+
+static size_t chunk_slot(uintptr_t chunk)
+{
+	/* chunk addresses have their low bits cleared */
+	uint64_t h = (uint64_t) chunk / ARENA_CHUNK_SIZE;
+	h *= 0x9E3779B97F4A7C15ULL;
+	return (size_t) (h >> 32) & (chunk_set_size - 1);
+}
+
+static int chunk_set_add(uintptr_t chunk);
+
+static int grow_chunk_set()
+{
+	uintptr_t *old_set = chunk_set;
+	size_t old_size = chunk_set_size;
+	size_t i;
+
+	chunk_set_size = 0 == old_size ? MIN_CHUNK_SET_SIZE : 2 * old_size;
+	chunk_set = calloc(chunk_set_size, sizeof(uintptr_t));
+	if (NULL == chunk_set) {
+		chunk_set = old_set;
+		chunk_set_size = old_size;
+		return FAILURE;
+	}
+	chunk_set_count = 0;
+	for (i = 0; i < old_size; i++)
+		if (0 != old_set[i]) chunk_set_add(old_set[i]);
+	free(old_set);
+	return SUCCESS;
+}
+
+static int chunk_set_add(uintptr_t chunk)
+{
+	size_t i;
+
+	if (2 * (chunk_set_count + 1) > chunk_set_size && ! grow_chunk_set())
+		return FAILURE;
+	for (i = chunk_slot(chunk); 0 != chunk_set[i];
+			i = (i + 1) & (chunk_set_size - 1))
+		;
+	chunk_set[i] = chunk;
+	chunk_set_count++;
+	return SUCCESS;
+}
+
+static int chunk_set_has(uintptr_t chunk)
+{
+	size_t i;
+
+	if (0 == chunk_set_count) return FALSE;
+	for (i = chunk_slot(chunk); 0 != chunk_set[i];
+			i = (i + 1) & (chunk_set_size - 1))
+		if (chunk == chunk_set[i]) return TRUE;
+	return FALSE;
+}
+
+/* Removes a chunk, shifting back the following slots of its probe sequence
+ * so that no lookup is cut short. */
+
+static void chunk_set_remove(uintptr_t chunk)
+{
+	size_t mask = chunk_set_size - 1;
+	size_t i, j;
+
+	for (i = chunk_slot(chunk); chunk != chunk_set[i]; i = (i + 1) & mask)
+		if (0 == chunk_set[i]) return;
+	chunk_set[i] = 0;
+	chunk_set_count--;
+	for (j = (i + 1) & mask; 0 != chunk_set[j]; j = (j + 1) & mask) {
+		size_t home = chunk_slot(chunk_set[j]);
+		/* move entry j to the hole at i unless its home slot lies
+		 * (cyclically) in (i, j] */
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			chunk_set[i] = chunk_set[j];
+			chunk_set[j] = 0;
+			i = j;
+		}
+	}
+}
+
+/* Allocates a block of 'size' bytes (a multiple of ARENA_CHUNK_SIZE) and
+ * links it into the arena. */
+
+static struct arena_chunk *add_chunk(struct arena *arena, size_t size)
+{
+	struct arena_chunk *chunk;
+	size_t offset;
+
+	if (0 != posix_memalign((void **) &chunk, ARENA_CHUNK_SIZE, size))
+		return NULL;
+	pthread_rwlock_wrlock(&chunk_set_lock);
+	for (offset = 0; offset < size; offset += ARENA_CHUNK_SIZE) {
+		if (! chunk_set_add((uintptr_t) chunk + offset)) {
+			size_t added;
+			for (added = 0; added < offset;
+					added += ARENA_CHUNK_SIZE)
+				chunk_set_remove((uintptr_t) chunk + added);
+			pthread_rwlock_unlock(&chunk_set_lock);
+			free(chunk);
+			return NULL;
+		}
+	}
+	__atomic_store_n(&live_chunks, chunk_set_count, __ATOMIC_RELEASE);
+	pthread_rwlock_unlock(&chunk_set_lock);
+	chunk->size = size;
+	chunk->next = arena->chunks;
+	arena->chunks = chunk;
+	return chunk;
+}
+
+struct arena *create_arena()
+{
+	struct arena *arena = malloc(sizeof(struct arena));
+	if (NULL == arena) return NULL;
+	arena->chunks = NULL;
+	arena->next = arena->end = NULL;
+	return arena;
+}
+
+void *arena_alloc(struct arena *arena, size_t size)
+{
+	void *result;
+
+	size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+	if (size > (size_t) (arena->end - arena->next)) {
+		struct arena_chunk *chunk;
+		if (size > ARENA_CHUNK_SIZE - CHUNK_HEADER_SIZE) {
+			/* a block of its own; the current chunk stays */
+			size_t block_size = (CHUNK_HEADER_SIZE + size
+				+ ARENA_CHUNK_SIZE - 1) &
+				~((size_t) ARENA_CHUNK_SIZE - 1);
+			chunk = add_chunk(arena, block_size);
+			if (NULL == chunk) return NULL;
+			return (char *) chunk + CHUNK_HEADER_SIZE;
+		}
+		chunk = add_chunk(arena, ARENA_CHUNK_SIZE);
+		if (NULL == chunk) return NULL;
+		arena->next = (char *) chunk + CHUNK_HEADER_SIZE;
+		arena->end = (char *) chunk + ARENA_CHUNK_SIZE;
+	}
+	result = arena->next;
+	arena->next += size;
+	return result;
+}
+
+void destroy_arena(struct arena *arena)
+{
+	struct arena_chunk *chunk = arena->chunks;
+
+	while (NULL != chunk) {
+		struct arena_chunk *next = chunk->next;
+		size_t offset;
+		pthread_rwlock_wrlock(&chunk_set_lock);
+		for (offset = 0; offset < chunk->size;
+				offset += ARENA_CHUNK_SIZE)
+			chunk_set_remove((uintptr_t) chunk + offset);
+		__atomic_store_n(&live_chunks, chunk_set_count,
+				__ATOMIC_RELEASE);
+		pthread_rwlock_unlock(&chunk_set_lock);
+		free(chunk);
+		chunk = next;
+	}
+	if (current == arena) current = NULL;
+	free(arena);
+}
+
+struct arena *set_current_arena(struct arena *arena)
+{
+	struct arena *previous = current;
+	current = arena;
+	return previous;
+}
+
+struct arena *current_arena()
+{
+	return current;
+}
+
+void *arena_malloc(size_t size)
+{
+	if (NULL == current) return malloc(size);
+	return arena_alloc(current, size);
+}
+
+char *arena_strdup(const char *s)
+{
+	size_t length = strlen(s);
+	char *copy = arena_malloc(length + 1);
+	if (NULL == copy) return NULL;
+	memcpy(copy, s, length + 1);
+	return copy;
+}
+
+void arena_free(void *ptr)
+{
+	uintptr_t chunk;
+	int in_arena;
+
+	if (NULL == ptr) return;
+	/* Memory of a live arena reached us after its chunk was added, so if
+	 * there are no chunks, 'ptr' is malloc()ed. */
+	if (0 == __atomic_load_n(&live_chunks, __ATOMIC_ACQUIRE)) {
+		free(ptr);
+		return;
+	}
+	chunk = (uintptr_t) ptr & ~((uintptr_t) ARENA_CHUNK_SIZE - 1);
+	pthread_rwlock_rdlock(&chunk_set_lock);
+	in_arena = chunk_set_has(chunk);
+	pthread_rwlock_unlock(&chunk_set_lock);
+	if (in_arena) return;
+	free(ptr);
+}
@@ -0,0 +1,86 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Arenas: bump allocators that are freed in a single call. A tree parsed into
+ * an arena (see parse_tree_in_arena()) has all its nodes, lists and edge
+ * lengths allocated from it, and the destroy_tree*() functions release it as a
+ * whole. */
+
+/* The library allocates nodes and lists with arena_malloc(), and frees lists
+ * and edge lengths with arena_free(). The latter does nothing for memory that
+ * belongs to a live arena, so the usual tree functions (unlink_rnode(),
+ * destroy_rnode(), etc.) work on arena trees too. Nodes record whether they
+ * come from an arena, and are freed accordingly. Memory allocated outside
+ * parsing still comes from malloc(), even if it ends up in an arena tree. */
+
+/* NOTE: each thread has its own current arena. An arena may only be used by
+ * one thread at a time, but arenas can be created, used and destroyed on
+ * several threads at once. */
+
+#include <stddef.h>
+
+struct arena;
+
+/* Creates an empty arena. Returns NULL in case of error (malloc()) */
+
+struct arena *create_arena();
+
+/* Returns 'size' bytes from the arena, suitably aligned for any type. */
+/* Returns NULL in case of error (malloc()) */
+
+void *arena_alloc(struct arena *arena, size_t size);
+
+/* Frees all memory allocated from the arena, and the arena itself. */
+
+void destroy_arena(struct arena *arena);
+
+/* Sets the arena that arena_malloc() allocates from (on the calling thread);
+ * NULL means malloc(). Returns the previous one. */
+
+struct arena *set_current_arena(struct arena *arena);
+
+/* Returns the calling thread's current arena (NULL if none). */
+
+struct arena *current_arena();
+
+/* Allocates from the current arena, if any, otherwise calls malloc(). */
+/* Returns NULL in case of error (malloc()) */
+
+void *arena_malloc(size_t size);
+
+/* Like strdup(), but allocates with arena_malloc() */
+
+char *arena_strdup(const char *s);
+
+/* Frees 'ptr' unless it belongs to a live arena (in which case it is freed
+ * along with the arena). Like free(), does nothing if 'ptr' is NULL. While
+ * arenas are live, this takes a (shared) lock: code that knows where its memory
+ * comes from should not call it (see rnode->in_arena). */
+
+void arena_free(void *ptr);
@@ -0,0 +1,384 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "cluster_set.h"
+#include "tree.h"
+#include "rnode.h"
+#include "list.h"
+#include "label_table.h"
+#include "flat_tree.h"
+#include "common.h"
+
+#define WORD_BITS (CHAR_BIT * sizeof(cluster_word))
+
+/* Sorting key of a restricted cluster: 'key' orders clusters by smallest
+ * taxon, then size; 'src' is the cluster's position in the unsorted buffer. */
+
+struct cluster_key {
+	long key;
+	int src;
+};
+
+/* Makes room in index->id2num for every label interned so far. */
+
+static int grow_taxon_index(struct taxon_index *index)
+{
+	int new_size = label_table_size();
+	int i;
+	int *id2num;
+
+	if (new_size <= index->size) return SUCCESS;
+	id2num = realloc(index->id2num, new_size * sizeof(int));
+	if (NULL == id2num) return FAILURE;
+	for (i = index->size; i < new_size; i++) id2num[i] = -1;
+	index->id2num = id2num;
+	index->size = new_size;
+	return SUCCESS;
+}
+
+struct taxon_index *create_taxon_index(int size)
+{
+	struct taxon_index *index = malloc(sizeof(struct taxon_index));
+	int i;
+	if (NULL == index) return NULL;
+	if (size < 1) size = 1;
+	index->id2num = malloc(size * sizeof(int));
+	if (NULL == index->id2num) { free(index); return NULL; }
+	for (i = 0; i < size; i++) index->id2num[i] = -1;
+	index->size = size;
+	index->count = 0;
+	return index;
+}
+
+int taxon_index_add_tree(struct taxon_index *index, struct rooted_tree *tree)
+{
+	struct list_elem *el;
+
+	if (! grow_taxon_index(index)) return FAILURE;
+	for (el = tree->nodes_in_order->head; NULL != el; el = el->next) {
+		struct rnode *current = (struct rnode *) el->data;
+		if (! is_leaf(current)) continue;
+		if (EMPTY_LABEL_ID == current->label_id) continue;
+		if (-1 != index->id2num[current->label_id]) continue;
+		index->id2num[current->label_id] = index->count;
+		index->count++;
+	}
+
+	return SUCCESS;
+}
+
+/* Like taxon_number(), but by label id */
+
+static int taxon_number_by_id(struct taxon_index *index, int id)
+{
+	if (id < 0 || id >= index->size) return -1;
+	return index->id2num[id];
+}
+
+int taxon_number(struct taxon_index *index, const char *label)
+{
+	return taxon_number_by_id(index, find_label(label));
+}
+
+int taxon_set_words(struct taxon_index *index)
+{
+	int num_words = (index->count + WORD_BITS - 1) / WORD_BITS;
+	if (0 == num_words) num_words = 1;
+	return num_words;
+}
+
+void destroy_taxon_index(struct taxon_index *index)
+{
+	free(index->id2num);
+	free(index);
+}
+
+cluster_word *create_taxon_set(int num_words)
+{
+	return calloc(num_words, sizeof(cluster_word));
+}
+
+void taxon_set_add(cluster_word *set, int taxon)
+{
+	assert(taxon >= 0);
+	set[taxon / WORD_BITS] |= (cluster_word) 1 << (taxon % WORD_BITS);
+}
+
+void taxon_set_union(cluster_word *result, const cluster_word *set1,
+		const cluster_word *set2, int num_words)
+{
+	int i;
+	for (i = 0; i < num_words; i++)
+		result[i] = set1[i] | set2[i];
+}
+
+static int word_count(cluster_word word)
+{
+#ifdef __GNUC__
+	return __builtin_popcountl(word);
+#else
+	int count = 0;
+	for (; 0 != word; word &= word - 1) count++;
+	return count;
+#endif
+}
+
+static int word_lowest(cluster_word word)
+{
+#ifdef __GNUC__
+	return __builtin_ctzl(word);
+#else
+	int bit = 0;
+	for (; 0 == (word & 1); word >>= 1) bit++;
+	return bit;
+#endif
+}
+
+int taxon_set_count(const cluster_word *set, int num_words)
+{
+	int i, count = 0;
+	for (i = 0; i < num_words; i++)
+		count += word_count(set[i]);
+	return count;
+}
+
+int taxon_set_common_count(const cluster_word *set1, const cluster_word *set2,
+		int num_words)
+{
+	int i, count = 0;
+	for (i = 0; i < num_words; i++)
+		count += word_count(set1[i] & set2[i]);
+	return count;
+}
+
+/* The nodes are visited children first (see get_nodes_in_order()), so each
+ * inner node's cluster is the union of its children's, which are already
+ * known. node->data points to the node's cluster. */
+
+struct tree_clusters *create_tree_clusters(struct rooted_tree *tree,
+		struct taxon_index *index)
+{
+	struct tree_clusters *tc;
+	struct list_elem *el;
+	int num_words = taxon_set_words(index);
+	int n = 0;
+
+	tc = malloc(sizeof(struct tree_clusters));
+	if (NULL == tc) return NULL;
+	tc->num_words = num_words;
+	tc->num_clusters = tree->nodes_in_order->count;
+	tc->sets = calloc(tc->num_clusters * num_words, sizeof(cluster_word));
+	tc->leaves = create_taxon_set(num_words);
+	if (NULL == tc->sets || NULL == tc->leaves) {
+		destroy_tree_clusters(tc);
+		return NULL;
+	}
+
+	for (el = tree->nodes_in_order->head; NULL != el; el = el->next, n++) {
+		struct rnode *current = (struct rnode *) el->data;
+		cluster_word *set = tc->sets + n * num_words;
+		current->data = set;
+		if (is_leaf(current)) {
+			int taxon;
+			if (EMPTY_LABEL_ID == current->label_id) continue;
+			taxon = taxon_number_by_id(index, current->label_id);
+			if (taxon < 0) {
+				destroy_tree_clusters(tc);
+				return NULL;
+			}
+			taxon_set_add(set, taxon);
+			taxon_set_add(tc->leaves, taxon);
+		} else {
+			struct list_elem *c;
+			for (c = current->children->head; NULL != c; c = c->next) {
+				struct rnode *child = c->data;
+				taxon_set_union(set, set, child->data, num_words);
+			}
+		}
+	}
+
+	return tc;
+}
+
+struct tree_clusters *create_flat_tree_clusters(struct flat_tree *flat,
+		struct taxon_index *index)
+{
+	struct tree_clusters *tc;
+	int num_words = taxon_set_words(index);
+	int n;
+
+	tc = malloc(sizeof(struct tree_clusters));
+	if (NULL == tc) return NULL;
+	tc->num_words = num_words;
+	tc->num_clusters = flat->num_nodes;
+	tc->sets = calloc(tc->num_clusters * num_words, sizeof(cluster_word));
+	tc->leaves = create_taxon_set(num_words);
+	if (NULL == tc->sets || NULL == tc->leaves) {
+		destroy_tree_clusters(tc);
+		return NULL;
+	}
+
+	/* in reverse preorder, children come before their parent */
+	for (n = flat->num_nodes - 1; n >= 0; n--) {
+		cluster_word *set = tc->sets + n * num_words;
+		if (flat_tree_is_leaf(flat, n)) {
+			const char *label = flat_tree_label(flat, n);
+			int taxon;
+			if ('\0' == *label) continue;
+			taxon = taxon_number(index, label);
+			if (taxon < 0) {
+				destroy_tree_clusters(tc);
+				return NULL;
+			}
+			taxon_set_add(set, taxon);
+			taxon_set_add(tc->leaves, taxon);
+		}
+		if (FLAT_NONE != flat->parent[n]) {
+			cluster_word *parent_set = tc->sets +
+				flat->parent[n] * num_words;
+			taxon_set_union(parent_set, parent_set, set, num_words);
+		}
+	}
+
+	return tc;
+}
+
+void destroy_tree_clusters(struct tree_clusters *tc)
+{
+	free(tc->sets);
+	free(tc->leaves);
+	free(tc);
+}
+
+struct cluster_restriction *create_cluster_restriction(int num_clusters,
+		int num_words)
+{
+	struct cluster_restriction *r;
+
+	r = malloc(sizeof(struct cluster_restriction));
+	if (NULL == r) return NULL;
+	r->num_words = num_words;
+	r->capacity = num_clusters;
+	r->count = 0;
+	r->covers = FALSE;
+	r->keys = malloc((num_clusters + 1) * sizeof(struct cluster_key));
+	r->sets = malloc((num_clusters + 1) * num_words * sizeof(cluster_word));
+	r->raw = malloc((num_clusters + 1) * num_words * sizeof(cluster_word));
+	if (NULL == r->keys || NULL == r->sets || NULL == r->raw) {
+		destroy_cluster_restriction(r);
+		return NULL;
+	}
+	return r;
+}
+
+static int key_comparator(const void *a, const void *b)
+{
+	const struct cluster_key *ka = a;
+	const struct cluster_key *kb = b;
+	if (ka->key < kb->key) return -1;
+	if (ka->key > kb->key) return 1;
+	return 0;
+}
+
+void restrict_clusters(struct tree_clusters *tree, const cluster_word *taxa,
+		struct cluster_restriction *r)
+{
+	int num_words = tree->num_words;
+	int num_taxa = taxon_set_count(taxa, num_words);
+	long max_size = (long) num_words * WORD_BITS + 1;
+	int i, w, n = 0;
+
+	assert(r->num_words == num_words);
+	assert(r->capacity >= tree->num_clusters);
+
+	r->covers = TRUE;
+	for (w = 0; w < num_words; w++)
+		if ((taxa[w] & tree->leaves[w]) != taxa[w])
+			r->covers = FALSE;
+	r->count = 0;
+	if (! r->covers) return;
+
+	for (i = 0; i < tree->num_clusters; i++) {
+		const cluster_word *cluster = tree->sets + i * num_words;
+		cluster_word *restricted = r->raw + n * num_words;
+		int size = 0, smallest = -1;
+		for (w = 0; w < num_words; w++) {
+			restricted[w] = cluster[w] & taxa[w];
+			if (0 == restricted[w]) continue;
+			if (smallest < 0)
+				smallest = w * WORD_BITS +
+					word_lowest(restricted[w]);
+			size += word_count(restricted[w]);
+		}
+		if (size < 2 || size >= num_taxa) continue;
+		r->keys[n].key = smallest * max_size + size;
+		r->keys[n].src = n;
+		n++;
+	}
+
+	qsort(r->keys, n, sizeof(struct cluster_key), key_comparator);
+
+	/* gather the clusters in key order, skipping duplicates (an inner node
+	 * with a single child in the restriction has its child's cluster). */
+	for (i = 0; i < n; i++) {
+		if (r->count > 0 && r->keys[i].key == r->keys[r->count - 1].key)
+			continue;
+		r->keys[r->count] = r->keys[i];
+		memcpy(r->sets + r->count * num_words,
+			r->raw + r->keys[i].src * num_words,
+			num_words * sizeof(cluster_word));
+		r->count++;
+	}
+}
+
+int cluster_restrictions_equal(struct cluster_restriction *r1,
+		struct cluster_restriction *r2)
+{
+	int i;
+
+	if (! r1->covers || ! r2->covers) return FALSE;
+	if (r1->count != r2->count) return FALSE;
+	for (i = 0; i < r1->count; i++)
+		if (r1->keys[i].key != r2->keys[i].key) return FALSE;
+	return 0 == memcmp(r1->sets, r2->sets,
+			r1->count * r1->num_words * sizeof(cluster_word));
+}
+
+void destroy_cluster_restriction(struct cluster_restriction *r)
+{
+	free(r->keys);
+	free(r->sets);
+	free(r->raw);
+	free(r);
+}
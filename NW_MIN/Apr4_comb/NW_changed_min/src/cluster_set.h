@@ -0,0 +1,152 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Cluster bit sets: each node of a tree defines a cluster, namely the set of
+ * leaves below it. Two trees agree on a set of taxa (i.e., they are identical
+ * once pruned to these taxa) IFF their clusters, restricted to the taxa, are
+ * the same. This is the same idea as node_set.c, but the sets are made of
+ * machine words so that they can be combined a word at a time, and the taxa
+ * are numbered once for all trees of a run. */
+
+struct rooted_tree;
+struct flat_tree;
+struct cluster_key;
+
+typedef unsigned long cluster_word;
+
+/* Maps leaf labels to taxon numbers (0, 1, ...), shared by all trees. */
+
+struct taxon_index {
+	int *id2num;	/* by label id (see label_table.h), -1 if not a taxon */
+	int size;	/* number of entries in id2num */
+	int count;	/* number of taxa */
+};
+
+/* The clusters of a tree. Cluster i starts at sets + i * num_words. */
+
+struct tree_clusters {
+	int num_words;
+	int num_clusters;
+	cluster_word *sets;
+	cluster_word *leaves;	/* the tree's leaf set */
+};
+
+/* A tree's clusters restricted to a set of taxa. Only clusters with at least
+ * two, and fewer than all, taxa are kept (the others are present in any tree
+ * on these taxa). Clusters are stored without duplicates, sorted by smallest
+ * taxon and size - within one tree, these two numbers determine the cluster,
+ * since any two clusters are either disjoint or nested. */
+
+struct cluster_restriction {
+	int num_words;
+	int capacity;	/* max number of clusters */
+	int count;	/* actual number of clusters */
+	int covers;	/* true IFF all taxa are leaves of the tree */
+	struct cluster_key *keys;
+	cluster_word *sets;
+	cluster_word *raw;	/* unsorted clusters, before removing duplicates */
+};
+
+/* Creates an empty taxon index; 'size' is a hint of the number of labels.
+ * Returns NULL in case of malloc() error. */
+
+struct taxon_index *create_taxon_index(int size);
+
+/* Numbers the (nonempty) leaf labels of 'tree' that are not yet in the index.
+ * Returns FAILURE in case of malloc() error. */
+
+int taxon_index_add_tree(struct taxon_index *, struct rooted_tree *tree);
+
+/* Returns the number of 'label', or -1 if it is not in the index. */
+
+int taxon_number(struct taxon_index *, const char *label);
+
+/* Number of words needed for a set of all the taxa in the index. Trees and sets
+ * should only be created once all taxa are in the index. */
+
+int taxon_set_words(struct taxon_index *);
+
+void destroy_taxon_index(struct taxon_index *);
+
+/* Creates an empty set of taxa. Returns NULL in case of malloc() error. */
+
+cluster_word *create_taxon_set(int num_words);
+
+void taxon_set_add(cluster_word *set, int taxon);
+
+/* Sets 'result' to the union of 'set1' and 'set2' ('result' may be one of
+ * them). */
+
+void taxon_set_union(cluster_word *result, const cluster_word *set1,
+		const cluster_word *set2, int num_words);
+
+/* Returns the number of taxa in 'set' */
+
+int taxon_set_count(const cluster_word *set, int num_words);
+
+/* Returns the number of taxa in both 'set1' and 'set2' */
+
+int taxon_set_common_count(const cluster_word *set1, const cluster_word *set2,
+		int num_words);
+
+/* Computes the clusters of 'tree', whose leaf labels must all be in the
+ * index (empty leaf labels are ignored). NOTE: Clobbers node->data. */
+/* Returns NULL in case of malloc() error, or if a label is not found. */
+
+struct tree_clusters *create_tree_clusters(struct rooted_tree *tree,
+		struct taxon_index *);
+
+/* Like create_tree_clusters(), but for a flat tree (see flat_tree.h), whose
+ * clusters are in preorder. Does not change the tree. */
+
+struct tree_clusters *create_flat_tree_clusters(struct flat_tree *,
+		struct taxon_index *);
+
+void destroy_tree_clusters(struct tree_clusters *);
+
+/* Creates a restriction buffer large enough for any tree of 'num_clusters'
+ * clusters or less. Returns NULL in case of malloc() error. */
+
+struct cluster_restriction *create_cluster_restriction(int num_clusters,
+		int num_words);
+
+/* Restricts the clusters of 'tree' to 'taxa', storing the result in
+ * 'restriction', which must be large enough. */
+
+void restrict_clusters(struct tree_clusters *tree, const cluster_word *taxa,
+		struct cluster_restriction *restriction);
+
+/* Returns true IFF both trees contain all the taxa, and have the same
+ * topology once pruned to them. Both arguments must have been restricted to
+ * the same taxa. */
+
+int cluster_restrictions_equal(struct cluster_restriction *,
+		struct cluster_restriction *);
+
+void destroy_cluster_restriction(struct cluster_restriction *);
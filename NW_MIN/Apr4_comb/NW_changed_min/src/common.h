@@ -35,3 +35,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define HERE {printf ("**** up to %s, %d ****\n", __FILE__, __LINE__); fflush(stdin);}
 #define FAILURE 0
 #define SUCCESS 1
+
+/* Storage class of the library's few per-call results and scratch buffers, so
+ * that each thread has its own (like errno). */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define THREAD_LOCAL _Thread_local
+#else
+#define THREAD_LOCAL __thread
+#endif
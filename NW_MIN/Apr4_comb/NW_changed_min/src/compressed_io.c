@@ -0,0 +1,502 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+#define WITH_GZIP
+#include <zlib.h>
+#endif
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+#define WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "compressed_io.h"
+#include "common.h"
+
+#define IO_BUFFER_SIZE 131072
+#define MAGIC_LENGTH 4
+#define GZIP_LEVEL 6
+#define ZSTD_LEVEL 3
+
+static const unsigned char gzip_magic[] = { 0x1f, 0x8b };
+static const unsigned char zstd_magic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+/* A stream's state (its fopencookie() cookie). 'buffer' holds compressed
+ * data: read from 'file' but not yet decompressed (from 'buffer_pos' to
+ * 'buffer_length'), or compressed but not yet written. Input starts with the
+ * bytes that were read to detect its compression ('head'). */
+
+struct compressed_stream {
+	FILE *file;
+	int close_file;
+	enum compression compression;
+	int writing;
+	unsigned char head[MAGIC_LENGTH];
+	size_t head_length;
+	unsigned char *buffer;
+	size_t buffer_length;
+	size_t buffer_pos;
+	int error;		/* reading 'file' failed */
+	int ended;		/* the last gzip member or zstd frame is complete */
+#ifdef WITH_GZIP
+	z_stream gzip;
+#endif
+#ifdef WITH_ZSTD
+	ZSTD_DStream *zstd_in;
+	ZSTD_CStream *zstd_out;
+#endif
+};
+
+enum compression compression_of_data(const unsigned char *bytes,
+		size_t length)
+{
+	if (length >= sizeof(gzip_magic)
+		&& 0 == memcmp(bytes, gzip_magic, sizeof(gzip_magic)))
+		return COMPRESSION_GZIP;
+	if (length >= sizeof(zstd_magic)
+		&& 0 == memcmp(bytes, zstd_magic, sizeof(zstd_magic)))
+		return COMPRESSION_ZSTD;
+	return COMPRESSION_NONE;
+}
+
+/* Returns TRUE iff 'string' ends with 'suffix' */
+
+static int ends_with(const char *string, const char *suffix)
+{
+	size_t length = strlen(string), suffix_length = strlen(suffix);
+	return length > suffix_length
+		&& 0 == strcmp(string + length - suffix_length, suffix);
+}
+
+enum compression compression_of_filename(const char *filename)
+{
+	if (ends_with(filename, ".gz")) return COMPRESSION_GZIP;
+	if (ends_with(filename, ".zst")) return COMPRESSION_ZSTD;
+	return COMPRESSION_NONE;
+}
+
+/* Reads up to 'size' bytes of the stream's input, head first. */
+
+static size_t read_input(struct compressed_stream *stream,
+		unsigned char *dest, size_t size)
+{
+	size_t num_read = 0;
+
+	if (stream->head_length > 0) {
+		num_read = stream->head_length < size ?
+			stream->head_length : size;
+		memcpy(dest, stream->head, num_read);
+		memmove(stream->head, stream->head + num_read,
+				stream->head_length - num_read);
+		stream->head_length -= num_read;
+	}
+	if (num_read < size)
+		num_read += fread(dest + num_read, 1, size - num_read,
+				stream->file);
+	if (ferror(stream->file)) stream->error = TRUE;
+	return num_read;
+}
+
+/* Refills the buffer if it is empty. Returns the number of bytes in it (0 at
+ * the end of input, or in case of error). */
+
+static size_t buffered_input(struct compressed_stream *stream)
+{
+	if (stream->buffer_pos == stream->buffer_length) {
+		stream->buffer_length = read_input(stream, stream->buffer,
+				IO_BUFFER_SIZE);
+		stream->buffer_pos = 0;
+	}
+	return stream->buffer_length - stream->buffer_pos;
+}
+
+/* The read functions below return the number of bytes decompressed into
+ * 'dest', 0 at the end of input, or -1 in case of error (including truncated
+ * input). Concatenated gzip members or zstd frames are read as one. */
+
+#ifdef WITH_GZIP
+static ssize_t read_gzip(struct compressed_stream *stream, char *dest,
+		size_t size)
+{
+	z_stream *gzip = &stream->gzip;
+	size_t available;
+	int result;
+
+	gzip->next_out = (Bytef *) dest;
+	gzip->avail_out = size;
+	while (gzip->avail_out == size) {
+		available = buffered_input(stream);
+		if (0 == available && stream->error) return -1;
+		if (0 == available && stream->ended) return 0;
+		if (stream->ended) {
+			/* another member follows */
+			if (Z_OK != inflateReset(gzip)) return -1;
+			stream->ended = FALSE;
+		}
+		gzip->next_in = stream->buffer + stream->buffer_pos;
+		gzip->avail_in = available;
+		result = inflate(gzip, Z_NO_FLUSH);
+		stream->buffer_pos = stream->buffer_length - gzip->avail_in;
+		if (Z_STREAM_END == result)
+			stream->ended = TRUE;
+		else if (Z_OK != result && Z_BUF_ERROR != result)
+			return -1;
+		if (0 == available && gzip->avail_out == size
+				&& ! stream->ended)
+			return -1;
+	}
+	return size - gzip->avail_out;
+}
+#endif
+
+#ifdef WITH_ZSTD
+static ssize_t read_zstd(struct compressed_stream *stream, char *dest,
+		size_t size)
+{
+	ZSTD_outBuffer out = { dest, size, 0 };
+	size_t available, result;
+
+	while (0 == out.pos) {
+		available = buffered_input(stream);
+		if (0 == available && stream->error) return -1;
+		if (0 == available && stream->ended) return 0;
+		ZSTD_inBuffer in = { stream->buffer + stream->buffer_pos,
+			available, 0 };
+		result = ZSTD_decompressStream(stream->zstd_in, &out, &in);
+		stream->buffer_pos += in.pos;
+		if (ZSTD_isError(result)) return -1;
+		/* the next call starts a new frame, if any */
+		stream->ended = 0 == result;
+		if (0 == available && 0 == out.pos && ! stream->ended)
+			return -1;
+	}
+	return out.pos;
+}
+#endif
+
+static ssize_t read_stream(void *cookie, char *dest, size_t size)
+{
+	struct compressed_stream *stream = cookie;
+
+	switch (stream->compression) {
+#ifdef WITH_GZIP
+	case COMPRESSION_GZIP:
+		return read_gzip(stream, dest, size);
+#endif
+#ifdef WITH_ZSTD
+	case COMPRESSION_ZSTD:
+		return read_zstd(stream, dest, size);
+#endif
+	default:
+		size = read_input(stream, (unsigned char *) dest, size);
+		if (0 == size && stream->error) return -1;
+		return size;
+	}
+}
+
+/* Writes the compressed data that the buffer holds. Returns FAILURE in case
+ * of error (I/O). */
+
+static int write_buffer(struct compressed_stream *stream, size_t length)
+{
+	if (0 == length) return SUCCESS;
+	return length == fwrite(stream->buffer, 1, length, stream->file);
+}
+
+#ifdef WITH_GZIP
+/* Compresses the gzip stream's pending input, and with 'flush' Z_FINISH, ends
+ * the compressed data. Returns FAILURE in case of error. */
+
+static int deflate_gzip(struct compressed_stream *stream, int flush)
+{
+	z_stream *gzip = &stream->gzip;
+	int result;
+
+	do {
+		gzip->next_out = stream->buffer;
+		gzip->avail_out = IO_BUFFER_SIZE;
+		result = deflate(gzip, flush);
+		if (Z_STREAM_ERROR == result) return FAILURE;
+		if (! write_buffer(stream, IO_BUFFER_SIZE - gzip->avail_out))
+			return FAILURE;
+	} while (0 == gzip->avail_out
+			|| (Z_FINISH == flush && Z_STREAM_END != result));
+	return SUCCESS;
+}
+#endif
+
+/* Returns the number of bytes written, i.e. 'size', or 0 in case of error */
+
+static ssize_t write_stream(void *cookie, const char *source, size_t size)
+{
+	struct compressed_stream *stream = cookie;
+
+	switch (stream->compression) {
+#ifdef WITH_GZIP
+	case COMPRESSION_GZIP:
+		stream->gzip.next_in = (Bytef *) source;
+		stream->gzip.avail_in = size;
+		return deflate_gzip(stream, Z_NO_FLUSH) ? size : 0;
+#endif
+#ifdef WITH_ZSTD
+	case COMPRESSION_ZSTD: {
+		ZSTD_inBuffer in = { source, size, 0 };
+		while (in.pos < in.size) {
+			ZSTD_outBuffer out = { stream->buffer, IO_BUFFER_SIZE,
+				0 };
+			if (ZSTD_isError(ZSTD_compressStream(stream->zstd_out,
+						&out, &in)))
+				return 0;
+			if (! write_buffer(stream, out.pos)) return 0;
+		}
+		return size;
+	}
+#endif
+	default:
+		return size == fwrite(source, 1, size, stream->file) ?
+			size : 0;
+	}
+}
+
+/* Ends the compressed output (if writing). Returns FAILURE in case of error. */
+
+static int finish_output(struct compressed_stream *stream)
+{
+	if (! stream->writing) return SUCCESS;
+	switch (stream->compression) {
+#ifdef WITH_GZIP
+	case COMPRESSION_GZIP:
+		stream->gzip.next_in = NULL;
+		stream->gzip.avail_in = 0;
+		return deflate_gzip(stream, Z_FINISH);
+#endif
+#ifdef WITH_ZSTD
+	case COMPRESSION_ZSTD: {
+		size_t remaining;
+		do {
+			ZSTD_outBuffer out = { stream->buffer, IO_BUFFER_SIZE,
+				0 };
+			remaining = ZSTD_endStream(stream->zstd_out, &out);
+			if (ZSTD_isError(remaining)) return FAILURE;
+			if (! write_buffer(stream, out.pos)) return FAILURE;
+		} while (remaining > 0);
+		return SUCCESS;
+	}
+#endif
+	default:
+		return SUCCESS;
+	}
+}
+
+/* Frees the stream, and its (de)compressor */
+
+static void destroy_stream(struct compressed_stream *stream)
+{
+#ifdef WITH_GZIP
+	if (COMPRESSION_GZIP == stream->compression) {
+		if (stream->writing)
+			deflateEnd(&stream->gzip);
+		else
+			inflateEnd(&stream->gzip);
+	}
+#endif
+#ifdef WITH_ZSTD
+	if (NULL != stream->zstd_in) ZSTD_freeDStream(stream->zstd_in);
+	if (NULL != stream->zstd_out) ZSTD_freeCStream(stream->zstd_out);
+#endif
+	free(stream->buffer);
+	free(stream);
+}
+
+static int close_stream(void *cookie)
+{
+	struct compressed_stream *stream = cookie;
+	int ok = finish_output(stream);
+
+	if (stream->close_file) {
+		if (0 != fclose(stream->file)) ok = FALSE;
+	} else if (stream->writing) {
+		if (0 != fflush(stream->file)) ok = FALSE;
+	}
+	destroy_stream(stream);
+	return ok ? 0 : EOF;
+}
+
+/* Creates a stream's state, and its (de)compressor. Returns NULL in case of
+ * error (malloc(), or compression not supported). */
+
+static struct compressed_stream *create_stream(FILE *file, int close_file,
+		enum compression compression, int writing)
+{
+	struct compressed_stream *stream;
+	int ok = TRUE;
+
+	stream = malloc(sizeof(struct compressed_stream));
+	if (NULL == stream) return NULL;
+	stream->file = file;
+	stream->close_file = close_file;
+	stream->compression = compression;
+	stream->writing = writing;
+	stream->head_length = 0;
+	stream->buffer = NULL;
+	stream->buffer_length = stream->buffer_pos = 0;
+	stream->error = FALSE;
+	stream->ended = FALSE;
+#ifdef WITH_ZSTD
+	stream->zstd_in = NULL;
+	stream->zstd_out = NULL;
+#endif
+	if (COMPRESSION_NONE != compression) {
+		stream->buffer = malloc(IO_BUFFER_SIZE);
+		if (NULL == stream->buffer) {
+			free(stream);
+			return NULL;
+		}
+	}
+
+	switch (compression) {
+	case COMPRESSION_NONE:
+		break;
+	case COMPRESSION_GZIP:
+#ifdef WITH_GZIP
+		memset(&stream->gzip, 0, sizeof(z_stream));
+		/* 15 + 16: gzip format; 15 + 32: gzip or zlib */
+		if (writing)
+			ok = Z_OK == deflateInit2(&stream->gzip, GZIP_LEVEL,
+				Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		else
+			ok = Z_OK == inflateInit2(&stream->gzip, 15 + 32);
+		if (! ok) stream->compression = COMPRESSION_NONE;
+#else
+		ok = FALSE;
+#endif
+		break;
+	case COMPRESSION_ZSTD:
+#ifdef WITH_ZSTD
+		if (writing) {
+			stream->zstd_out = ZSTD_createCStream();
+			ok = NULL != stream->zstd_out && ! ZSTD_isError(
+				ZSTD_initCStream(stream->zstd_out, ZSTD_LEVEL));
+		} else {
+			stream->zstd_in = ZSTD_createDStream();
+			ok = NULL != stream->zstd_in && ! ZSTD_isError(
+				ZSTD_initDStream(stream->zstd_in));
+		}
+#else
+		ok = FALSE;
+#endif
+		break;
+	}
+	if (! ok) {
+		destroy_stream(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+/* Makes a FILE of a stream. Returns NULL in case of error. */
+
+static FILE *open_stream(struct compressed_stream *stream)
+{
+	cookie_io_functions_t functions = { read_stream, write_stream, NULL,
+		close_stream };
+	FILE *file = fopencookie(stream, stream->writing ? "w" : "r",
+			functions);
+
+	if (NULL == file) {
+		destroy_stream(stream);
+		return NULL;
+	}
+	/* fewer, larger calls to read_stream() and write_stream() */
+	setvbuf(file, NULL, _IOFBF, IO_BUFFER_SIZE);
+	return file;
+}
+
+FILE *open_decompressed(FILE *input, int close_input)
+{
+	unsigned char head[MAGIC_LENGTH];
+	size_t length = fread(head, 1, MAGIC_LENGTH, input);
+	enum compression compression;
+	struct compressed_stream *stream;
+
+	if (ferror(input)) return NULL;
+	compression = compression_of_data(head, length);
+	if (COMPRESSION_NONE == compression
+			&& 0 == fseeko(input, -(off_t) length, SEEK_CUR))
+		return input;
+
+	stream = create_stream(input, close_input, compression, FALSE);
+	if (NULL == stream) return NULL;
+	memcpy(stream->head, head, length);
+	stream->head_length = length;
+	return open_stream(stream);
+}
+
+FILE *open_input_file(const char *filename)
+{
+	FILE *file = fopen(filename, "r");
+	FILE *input;
+
+	if (NULL == file) return NULL;
+	input = open_decompressed(file, TRUE);
+	if (NULL == input) fclose(file);
+	return input;
+}
+
+FILE *open_compressed(FILE *output, enum compression compression,
+		int close_output)
+{
+	struct compressed_stream *stream;
+
+	if (COMPRESSION_NONE == compression) return output;
+	stream = create_stream(output, close_output, compression, TRUE);
+	if (NULL == stream) return NULL;
+	return open_stream(stream);
+}
+
+FILE *open_output_file(const char *filename)
+{
+	FILE *file = fopen(filename, "w");
+	FILE *output;
+
+	if (NULL == file) return NULL;
+	output = open_compressed(file, compression_of_filename(filename), TRUE);
+	if (NULL == output) fclose(file);
+	return output;
+}
@@ -0,0 +1,83 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Compressed input and output. Files compressed with gzip or zstd are read
+ * through a stream that decompresses them on the fly, so that the parser (and
+ * anything else that reads a FILE) sees plain text; compression is recognized
+ * by the data's first bytes, not by the file's name. Output files whose name
+ * ends in ".gz" or ".zst" are compressed likewise. */
+
+/* NOTE: gzip support needs zlib, and zstd support needs libzstd, at build
+ * time. Without them, such data can't be opened (see below). The streams are
+ * made with fopencookie(), and have no file descriptor: they can't be mapped,
+ * so the mmap and parallel parsers (see parser.h) don't use them. */
+
+#include <stdio.h>
+
+enum compression { COMPRESSION_NONE, COMPRESSION_GZIP, COMPRESSION_ZSTD };
+
+/* Returns the compression of data that starts with the 'length' bytes at
+ * 'bytes' (4 are enough to tell). */
+
+enum compression compression_of_data(const unsigned char *bytes,
+		size_t length);
+
+/* Returns the compression implied by a file's name ("x.gz", "x.zst") */
+
+enum compression compression_of_filename(const char *filename);
+
+/* Returns a stream that reads 'input' decompressed, from its current position.
+ * If 'input' is not compressed, this is 'input' itself when it can be
+ * repositioned (so that the parser can still map it), or else a stream that
+ * passes it through. Closing any other stream than 'input' closes the latter
+ * iff 'close_input' is TRUE. */
+/* Returns NULL in case of error (I/O, malloc(), or compression not supported
+ * by this build) */
+
+FILE *open_decompressed(FILE *input, int close_input);
+
+/* Opens file 'filename' for reading, decompressed (see above). */
+/* Returns NULL in case of error (fopen(), etc.) */
+
+FILE *open_input_file(const char *filename);
+
+/* Returns a stream that writes to 'output' compressed with 'compression'
+ * ('output' itself for COMPRESSION_NONE). Closing it finishes the compressed
+ * data, and closes 'output' iff 'close_output' is TRUE. */
+/* Returns NULL in case of error (malloc(), or compression not supported by
+ * this build) */
+
+FILE *open_compressed(FILE *output, enum compression compression,
+		int close_output);
+
+/* Opens file 'filename' for writing, compressed according to its name (see
+ * compression_of_filename()). */
+/* Returns NULL in case of error (fopen(), etc.) */
+
+FILE *open_output_file(const char *filename);
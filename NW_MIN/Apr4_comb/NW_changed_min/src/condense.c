@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "parser.h"
 #include "to_newick.h"
 #include "stdbool.h"
+#include "output.h"
 
 enum actions { PURE_CLADES, STAIR_NODES }; /* not sure we'll keep stair nodes */
 
@@ -112,12 +113,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-h] <filename|->\n",
@@ -134,6 +134,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	while (true) {
 		tree = parse_tree();
@@ -142,7 +143,7 @@ int main(int argc, char *argv[])
 			dump_newick(tree->root);
 			destroy_tree(tree, DONT_FREE_NODE_DATA);
 		}
-		else switch (newick_parser_status) {
+		else switch (newick_parser_status()) {
 			case PARSER_STATUS_EMPTY:	/* EOF, etc. */
 				/* goto is ok to break "twice" */
 				goto end;
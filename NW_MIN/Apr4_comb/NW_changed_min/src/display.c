@@ -44,6 +44,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "graph_common.h"
 #include "svg_graph_common.h"
 #include "error.h"
+#include "output.h"
 
 // TODO: switch the logical ints to bools (stdbool.h)
 
@@ -347,12 +348,11 @@ struct parameters get_params(int argc, char *argv[])
 	if (1 == (argc - optind)) {
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-aAbchilsuUvw] <filename|->\n",
@@ -424,6 +424,7 @@ int main(int argc, char *argv[])
 	void (*node_destroyer)(struct rnode *) = NULL;
 
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	if (params.svg) {
 		set_svg_parameters(params);
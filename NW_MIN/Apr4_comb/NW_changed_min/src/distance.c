@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "simple_node_pos.h"
 #include "rnode.h"
 #include "node_pos_alloc.h"
+#include "output.h"
 #include "common.h"
 
 enum {FROM_ROOT, FROM_LCA, MATRIX, FROM_PARENT};
@@ -236,12 +237,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) >= 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 		struct llist *lbl_list = create_llist();
 		if (NULL == lbl_list) { perror(NULL); exit(EXIT_FAILURE); }
@@ -375,8 +375,12 @@ void print_distance_list (struct rnode *origin,
 		for (el = selected_nodes->head; NULL != el; el = el->next) {
 			node = el->data;
 			distance = distance_to_descendant(origin, node);
-			if (header) { printf("%s\t", node->label); }
-			printf( "%g\n", distance);
+			if (header) {
+				out_string(stdout, node->label);
+				putchar('\t');
+			}
+			out_double(stdout, distance);
+			putchar('\n');
 		}
 	} else if (HORIZONTAL == orientation) {
 		if (header) {
@@ -384,7 +388,7 @@ void print_distance_list (struct rnode *origin,
 				node = el->data;
 				if (el != selected_nodes->head)
 					putchar ('\t');
-				printf( "%s", node->label);
+				out_string(stdout, node->label);
 			}
 			putchar('\n');
 		}
@@ -392,7 +396,7 @@ void print_distance_list (struct rnode *origin,
 			node = el->data;
 			distance = distance_to_descendant(origin, node);
 			if (el != selected_nodes->head) { putchar ('\t'); }
-			printf( "%g", distance);
+			out_double(stdout, distance);
 		}
 		putchar('\n');
 	} else {
@@ -486,21 +490,25 @@ void print_square_distance_matrix (struct rooted_tree *tree,
 	int i, j;
 	
 	if (show_headers) { /* Header line */
-		for (h_el = selected_nodes->head; NULL != h_el; h_el = h_el->next)
-			printf ("\t%s", ((struct rnode *) h_el->data)->label);
+		for (h_el = selected_nodes->head; NULL != h_el; h_el = h_el->next) {
+			putchar('\t');
+			out_string(stdout, ((struct rnode *) h_el->data)->label);
+		}
 		putchar('\n');
 	}
 			
 	for (j = 0, v_el = selected_nodes->head; NULL != v_el;
 		v_el = v_el->next, j++) {
 
-		if (show_headers) printf ("%s\t",
-			((struct rnode *) v_el->data)->label);
+		if (show_headers) {
+			out_string(stdout, ((struct rnode *) v_el->data)->label);
+			putchar('\t');
+		}
 
 		for (i = 0, h_el = selected_nodes->head; NULL != h_el;
 			h_el = h_el->next , i++) {
 
-			printf("%g", matrix[j][i]);
+			out_double(stdout, matrix[j][i]);
 			if (h_el == selected_nodes->tail) 
 				putchar('\n');
 			else
@@ -526,8 +534,10 @@ void print_triangular_distance_matrix (struct rooted_tree *tree,
 	for (j = 0, v_el = selected_nodes->head; NULL != v_el;
 		v_el = v_el->next, j++) {
 
-		if (show_headers)
-			printf ("%s\t", ((struct rnode *) v_el->data)->label);
+		if (show_headers) {
+			out_string(stdout, ((struct rnode *) v_el->data)->label);
+			putchar('\t');
+		}
 
 		/* Shows the diagonal when we print headers */
 		int limit = (show_headers ? j+1 : j);
@@ -535,7 +545,7 @@ void print_triangular_distance_matrix (struct rooted_tree *tree,
 		for (i = 0, h_el = selected_nodes->head; i < limit;
 			h_el = h_el->next , i++) {
 
-			printf("%g", matrix[j][i]);
+			out_double(stdout, matrix[j][i]);
 			if (i == limit-1)
 				putchar('\n');
 			else
@@ -588,6 +598,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	struct h_data depths;	
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	/* TODO: could take the switch out of the loop, since the distance type
 	 * is fixed for the program's lifetime. OTOH the code is easier to
@@ -40,6 +40,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "tree.h"
 #include "rnode.h"
 #include "masprintf.h"
+#include "output.h"
+#include "arena.h"
 
 void help(char *argv[])
 {
@@ -111,12 +113,11 @@ void get_params(int argc, char *argv[])
 	if ((argc - optind) == 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-bhIL] <filename|->\n", argv[0]);
@@ -132,7 +133,7 @@ void process_tree(struct rooted_tree *tree)
 		struct rnode *current = (struct rnode *) el->data;
 		if (is_root(current)) {
 			/* set to none */
-			free(current->edge_length_as_string);
+			arena_free(current->edge_length_as_string);
 			current->edge_length_as_string = strdup("");
 		}
 		else {
@@ -148,7 +149,7 @@ void process_tree(struct rooted_tree *tree)
 			double parent_age = atof(current->parent->
 				edge_length_as_string);
 			double edge_length = parent_age - age;
-			free(current->edge_length_as_string);
+			arena_free(current->edge_length_as_string);
 			current->edge_length_as_string = masprintf("%g",
 					edge_length);
 		}
@@ -160,6 +161,7 @@ int main (int argc, char* argv[])
 	struct rooted_tree *tree;
 
 	get_params(argc, argv);
+	buffer_stdout();
 
 	while ((tree = parse_tree()) != NULL) {
 		process_tree(tree);
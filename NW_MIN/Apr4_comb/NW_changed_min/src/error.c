@@ -29,8 +29,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* error.c - code for handling errors */
 
 #include "error.h"
+#include "common.h"
 
-static enum error_codes last_error_code = ERR_UNSET;
+static THREAD_LOCAL enum error_codes last_error_code = ERR_UNSET;
 
 static char *error_messages[] = {
 	"(Error code not set)",
@@ -0,0 +1,279 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "flat_tree.h"
+#include "tree.h"
+#include "rnode.h"
+#include "list.h"
+#include "hash.h"
+#include "link.h"
+#include "rnode_iterator.h"
+#include "common.h"
+
+/* A node whose children are being numbered: 'next' is the next child to
+ * visit, 'last' the number of the last child visited so far. */
+
+struct preorder_frame {
+	int num;
+	int last;
+	struct list_elem *next;
+};
+
+struct flat_tree *alloc_flat_tree(int num_nodes)
+{
+	struct flat_tree *flat = malloc(sizeof(struct flat_tree));
+	if (NULL == flat) return NULL;
+	flat->num_nodes = num_nodes;
+	flat->num_strings = 0;
+	flat->parent = malloc(num_nodes * sizeof(int));
+	flat->first_child = malloc(num_nodes * sizeof(int));
+	flat->next_sibling = malloc(num_nodes * sizeof(int));
+	flat->subtree_size = malloc(num_nodes * sizeof(int));
+	flat->label_id = malloc(num_nodes * sizeof(int));
+	flat->length_id = malloc(num_nodes * sizeof(int));
+	flat->edge_length = malloc(num_nodes * sizeof(double));
+	/* each node brings at most two new strings */
+	flat->strings = malloc((2 * num_nodes + 1) * sizeof(char *));
+	if (NULL == flat->parent || NULL == flat->first_child
+		|| NULL == flat->next_sibling || NULL == flat->subtree_size
+		|| NULL == flat->label_id || NULL == flat->length_id
+		|| NULL == flat->edge_length || NULL == flat->strings) {
+		destroy_flat_tree(flat);
+		return NULL;
+	}
+	return flat;
+}
+
+/* Returns the id of 'string' in the flat tree's string table, adding it if
+ * needed. 'ids' maps strings to (pointers to) their ids. Returns -1 in case
+ * of error. */
+
+static int string_id(struct flat_tree *flat, struct hash *ids, int *id_store,
+		const char *string)
+{
+	int *id = hash_get(ids, string);
+	if (NULL != id) return *id;
+
+	char *copy = strdup(string);
+	if (NULL == copy) return -1;
+	id = id_store + flat->num_strings;
+	*id = flat->num_strings;
+	if (! hash_set(ids, string, id)) { free(copy); return -1; }
+	flat->strings[flat->num_strings++] = copy;
+	return *id;
+}
+
+/* Stores 'node''s properties as number 'num' */
+
+static int set_flat_node(struct flat_tree *flat, struct hash *ids,
+		int *id_store, int num, struct rnode *node)
+{
+	flat->first_child[num] = FLAT_NONE;
+	flat->next_sibling[num] = FLAT_NONE;
+	flat->subtree_size[num] = 1;
+	flat->edge_length[num] = node->edge_length;
+	flat->label_id[num] = string_id(flat, ids, id_store, node->label);
+	flat->length_id[num] = string_id(flat, ids, id_store,
+			node->edge_length_as_string);
+	return -1 != flat->label_id[num] && -1 != flat->length_id[num];
+}
+
+/* Counts the nodes below (and including) 'root', and sets 'depth' to the
+ * number of nodes on the longest path from 'root' to a leaf. Does not rely on
+ * nodes_in_order, which may be stale after the tree has been edited. Returns
+ * -1 in case of error. */
+
+static int count_nodes(struct rnode *root, int *depth)
+{
+	int capacity = 64, top = 0, count = 1;
+	struct list_elem **stack = malloc(capacity * sizeof(struct list_elem *));
+	if (NULL == stack) return -1;
+
+	*depth = 1;
+	stack[0] = root->children->head;
+	while (top >= 0) {
+		if (NULL == stack[top]) {
+			top--;
+			continue;
+		}
+		struct rnode *child = stack[top]->data;
+		stack[top] = stack[top]->next;
+		count++;
+		if (++top == capacity) {
+			struct list_elem **bigger;
+			capacity *= 2;
+			bigger = realloc(stack,
+				capacity * sizeof(struct list_elem *));
+			if (NULL == bigger) { free(stack); return -1; }
+			stack = bigger;
+		}
+		stack[top] = child->children->head;
+		if (top + 1 > *depth) *depth = top + 1;
+	}
+
+	free(stack);
+	return count;
+}
+
+struct flat_tree *create_flat_tree(struct rooted_tree *tree)
+{
+	int depth;
+	int num_nodes = count_nodes(tree->root, &depth);
+	if (-1 == num_nodes) return NULL;
+	struct flat_tree *flat = alloc_flat_tree(num_nodes);
+	if (NULL == flat) return NULL;
+	struct hash *ids = create_hash(num_nodes);
+	int *id_store = malloc((2 * num_nodes + 1) * sizeof(int));
+	struct preorder_frame *stack = malloc(depth *
+			sizeof(struct preorder_frame));
+	int top, count, n, ok = TRUE;
+
+	if (NULL == ids || NULL == id_store || NULL == stack) {
+		ok = FALSE;
+		goto done;
+	}
+	if (-1 == string_id(flat, ids, id_store, "")) {
+		ok = FALSE;
+		goto done;
+	}
+
+	/* Depth-first, with an explicit stack (and without using the nodes'
+	 * iterator fields): a node is numbered when it is first reached. */
+	count = 0;
+	top = 0;
+	flat->parent[0] = FLAT_NONE;
+	ok = set_flat_node(flat, ids, id_store, count, tree->root);
+	stack[0].num = count++;
+	stack[0].last = FLAT_NONE;
+	stack[0].next = tree->root->children->head;
+	while (ok && top >= 0) {
+		struct preorder_frame *frame = stack + top;
+		if (NULL == frame->next) {
+			top--;
+			continue;
+		}
+		struct rnode *child = frame->next->data;
+		frame->next = frame->next->next;
+		n = count++;
+		ok = set_flat_node(flat, ids, id_store, n, child);
+		flat->parent[n] = frame->num;
+		if (FLAT_NONE == frame->last)
+			flat->first_child[frame->num] = n;
+		else
+			flat->next_sibling[frame->last] = n;
+		frame->last = n;
+		top++;
+		stack[top].num = n;
+		stack[top].last = FLAT_NONE;
+		stack[top].next = child->children->head;
+	}
+
+	/* children come after their parent */
+	for (n = num_nodes - 1; ok && n > 0; n--)
+		flat->subtree_size[flat->parent[n]] += flat->subtree_size[n];
+
+done:
+	if (NULL != ids) destroy_hash(ids);
+	free(id_store);
+	free(stack);
+	if (! ok) {
+		destroy_flat_tree(flat);
+		return NULL;
+	}
+	return flat;
+}
+
+struct rooted_tree *flat_tree_to_rooted_tree(struct flat_tree *flat)
+{
+	struct rnode **nodes = calloc(flat->num_nodes, sizeof(struct rnode *));
+	struct rooted_tree *tree = malloc(sizeof(struct rooted_tree));
+	int n = 0;
+
+	if (NULL == nodes || NULL == tree) goto error;
+
+	/* parents are created before their children, and siblings in order */
+	for (n = 0; n < flat->num_nodes; n++) {
+		nodes[n] = create_rnode(flat->strings[flat->label_id[n]],
+				flat->strings[flat->length_id[n]]);
+		if (NULL == nodes[n]) goto error;
+		nodes[n]->edge_length = flat->edge_length[n];
+		if (FLAT_NONE != flat->parent[n])
+			if (! add_child(nodes[flat->parent[n]], nodes[n])) {
+				n++;
+				goto error;
+			}
+	}
+
+	tree->root = nodes[0];
+	tree->type = TREE_TYPE_UNKNOWN;
+	tree->arena = NULL;
+	tree->orders = NULL;
+	tree->nodes_in_order = get_nodes_in_order(tree->root);
+	if (NULL == tree->nodes_in_order) goto error;
+	use_nodes_in_order_as_postorder(tree);
+	free(nodes);
+	return tree;
+
+error:
+	if (NULL != nodes)
+		while (n-- > 0) destroy_rnode(nodes[n], NULL);
+	free(nodes);
+	free(tree);
+	return NULL;
+}
+
+char *flat_tree_label(struct flat_tree *flat, int node)
+{
+	return flat->strings[flat->label_id[node]];
+}
+
+int flat_tree_is_leaf(struct flat_tree *flat, int node)
+{
+	return FLAT_NONE == flat->first_child[node];
+}
+
+void destroy_flat_tree(struct flat_tree *flat)
+{
+	int i;
+	if (NULL != flat->strings)
+		for (i = 0; i < flat->num_strings; i++)
+			free(flat->strings[i]);
+	free(flat->strings);
+	free(flat->parent);
+	free(flat->first_child);
+	free(flat->next_sibling);
+	free(flat->subtree_size);
+	free(flat->label_id);
+	free(flat->length_id);
+	free(flat->edge_length);
+	free(flat);
+}
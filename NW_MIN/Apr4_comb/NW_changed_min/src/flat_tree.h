@@ -0,0 +1,86 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* A compact, read-only representation of a rooted tree. Nodes are numbered in
+ * preorder (the root is 0), and each node property is stored in an array
+ * indexed by node number, so that a traversal reads memory sequentially
+ * instead of following rnode and list_elem pointers. The subtree of node 'n'
+ * consists of nodes n to n + subtree_size[n] - 1. Labels and edge lengths are
+ * kept in a string table, in which each distinct string is stored once. */
+
+struct rooted_tree;
+
+/* Marks a missing parent, child or sibling */
+
+#define FLAT_NONE (-1)
+
+struct flat_tree {
+	int num_nodes;
+	int *parent;		/* FLAT_NONE for the root */
+	int *first_child;	/* FLAT_NONE for leaves */
+	int *next_sibling;	/* FLAT_NONE for last children (and the root) */
+	int *subtree_size;	/* includes the node itself */
+	int *label_id;		/* index into 'strings' */
+	int *length_id;		/* index into 'strings'; "" if no length */
+	double *edge_length;	/* -1 if no length, as in struct rnode */
+	char **strings;		/* strings[0] is always "" */
+	int num_strings;
+};
+
+/* Creates a flat tree from 'tree', in O(n) time. Children keep their order.
+ * Unlike many functions on trees, this does not use node->data, and follows
+ * the children lists rather than nodes_in_order. */
+/* Returns NULL in case of error (malloc()) */
+
+struct flat_tree *create_flat_tree(struct rooted_tree *tree);
+
+/* Allocates a flat tree of 'num_nodes' nodes, with room for 2 * num_nodes + 1
+ * strings (none used yet), for parsers that build flat trees directly. The
+ * caller fills in the arrays; strings must be malloc()ed. */
+/* Returns NULL in case of error (malloc()) */
+
+struct flat_tree *alloc_flat_tree(int num_nodes);
+
+/* Creates a struct rooted_tree with the same topology, labels and edge lengths
+ * as 'flat', in O(n) time. */
+/* Returns NULL in case of error (malloc()) */
+
+struct rooted_tree *flat_tree_to_rooted_tree(struct flat_tree *flat);
+
+/* Returns the node's label */
+
+char *flat_tree_label(struct flat_tree *flat, int node);
+
+/* Returns true IFF 'node' is a leaf */
+
+int flat_tree_is_leaf(struct flat_tree *flat, int node);
+
+/* Releases all storage used by 'flat' */
+
+void destroy_flat_tree(struct flat_tree *flat);
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 
 #include "tree_models.h"
+#include "output.h"
 
 const double	DEFAULT_MEAN_BRANCH_LENGTH = 1.0;
 const double	DEFAULT_DURATION = 3;
@@ -44,6 +45,7 @@ struct parameters {
 	int seed;
 	double duration;
 	double mean_branch_length;
+	int caterpillar_leaves;
 };
 
 void help(char *argv[])
@@ -54,7 +56,7 @@ void help(char *argv[])
 "Synopsis\n"
 "--------\n"
 "\n"
-"%s [-cdhsx]\n"
+"%s [-cdhls]\n"
 "\n"
 "Input\n"
 "-----\n"
@@ -67,10 +69,14 @@ void help(char *argv[])
 "The generated tree. Branches are \"grown\" using exponentially distributed\n"
 "lengths. If the length exceeds the time limit, growth stops; otherwise the\n"
 "lineage splits in two, and the process is repeated on the children.\n"
+"With -c, the tree is a caterpillar (ladder) instead: each inner node has one\n"
+"leaf and one inner node as children, so the tree is as deep as it has leaves.\n"
+"This is mostly useful for testing programs on very deep trees.\n"
 "\n"
 "Options\n"
 "-------\n"
 "\n"
+"    -c <int>: generate a caterpillar tree with <int> leaves (at least 2)\n"
 "    -d <float>: sets the maximum depth (time limit). Default: 3.0\n"
 "    -h: print this message and exit\n"
 "    -l <float>: sets the average branch length (default: 1.0)\n"
@@ -82,7 +88,12 @@ void help(char *argv[])
 "\n"
 "# Generate a random tree\n"
 "\n"
-"$ %s\n",
+"$ %s\n"
+"\n"
+"# Generate a caterpillar with a million leaves\n"
+"\n"
+"$ %s -c 1000000\n",
+	argv[0],
 	argv[0],
 	argv[0]
 	);
@@ -95,10 +106,18 @@ struct parameters get_params(int argc, char *argv[])
 	params.seed = time(NULL);
 	params.duration = DEFAULT_DURATION;
 	params.mean_branch_length = DEFAULT_MEAN_BRANCH_LENGTH;
+	params.caterpillar_leaves = 0;
 
 	int opt_char;
-	while ((opt_char = getopt(argc, argv, "d:hl:s:")) != -1) {
+	while ((opt_char = getopt(argc, argv, "c:d:hl:s:")) != -1) {
 		switch (opt_char) {
+		case 'c':
+			params.caterpillar_leaves = atoi(optarg);
+			if (params.caterpillar_leaves < 2) {
+				fprintf(stderr, "-c needs at least 2 leaves.\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
 		case 'd':
 			params.duration = atof(optarg);	
 			break;
@@ -116,7 +135,7 @@ struct parameters get_params(int argc, char *argv[])
 
 	/* check arguments */
 	if ((argc - optind) != 0)	{
-		fprintf(stderr, "Usage: %s [-hs]\n",
+		fprintf(stderr, "Usage: %s [-cdhls]\n",
 				argv[0]);
 		exit(EXIT_FAILURE);
 	}
@@ -127,16 +146,22 @@ struct parameters get_params(int argc, char *argv[])
 int main(int argc, char *argv[])
 {
 	struct parameters params = get_params(argc, argv);
+	buffer_stdout();
 	srand(params.seed);
 
 	// TODO: offer geometric trees as well, and don't forget to check the
 	// return value of geometric_tree().
 	/* geometric_tree(params.prob_node_has_children); */
 
-	// The 1st parameter is the exponential distribution's rate parameter,
-	// which is the inverse of the mean.
-	int result = time_limited_tree(1.0 / params.mean_branch_length,
-			params.duration);
+	// The exponential distribution's rate parameter is the inverse of the
+	// mean.
+	int result;
+	if (params.caterpillar_leaves > 0)
+		result = caterpillar_tree(params.caterpillar_leaves,
+				1.0 / params.mean_branch_length);
+	else
+		result = time_limited_tree(1.0 / params.mean_branch_length,
+				params.duration);
 	if (! result) { perror(NULL); exit(EXIT_FAILURE); }
 
 	exit(EXIT_SUCCESS);
@@ -70,8 +70,13 @@ void prettify_labels (struct rooted_tree *tree)
 	struct list_elem *el;
 	for (el = tree->nodes_in_order->head; NULL != el; el = el->next) {
 		struct rnode *current = el->data;
-		underscores2spaces(current->label);
-		remove_quotes(current->label);
+		/* labels are shared, so we work on a copy */
+		char *label = strdup(current->label);
+		if (NULL == label) return;
+		underscores2spaces(label);
+		remove_quotes(label);
+		set_rnode_label(current, label);
+		free(label);
 	}
 }
 
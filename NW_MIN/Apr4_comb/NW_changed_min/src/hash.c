@@ -29,76 +29,157 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 /* A simple hash table implementation. */
 
-/* Values are arbitrary objects (void *), keys are char*. Hash size is fixed at creation. */
+/* Values are arbitrary objects (void *), keys are char*. Open addressing with
+ * linear probing: all slots are in one array, which doubles in size when it
+ * gets 3/4 full. Since elements are never removed, there is no need for
+ * tombstones. */
 
 #define _GNU_SOURCE
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "hash.h"
 #include "list.h"
 #include "masprintf.h"
 #include "common.h"
 
+#define MIN_HASH_SIZE 8
+
 struct hash *create_hash(int n)
 {
 	struct hash *h;
-	int i;
+	int size = MIN_HASH_SIZE;
 
 	/* allocate storage for struct hash */
 	h = (struct hash *) malloc (sizeof(struct hash));
 	if (NULL == h) return NULL;
 
-	h->size = n;
-	/* allocate storage for n pointers to llist */
-	h->bins = (struct llist **) malloc (n * sizeof(struct llist *));
-	if (NULL == h->bins) return NULL;
-	/* create a llist at each position */
-	for (i = 0; i < n; i++) {
-		(h->bins)[i] = create_llist();
-		if (NULL == (h->bins)[i]) return NULL;
-	}
+	/* room for n elements without growing */
+	while (size / 4 * 3 < n) size *= 2;
+	h->size = size;
+	/* all slots are empty (code 0) */
+	h->slots = calloc(size, sizeof(struct hash_slot));
+	if (NULL == h->slots) { free(h); return NULL; }
 	h->count = 0; 	/* no key-value paits yet */
 	return h;
 }
 
-/* Bernstein's hash function. See e.g.
- * http://www.eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx */
+static uint64_t rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
 
-unsigned int hash_func (const char *key)
+/* MurmurHash3's finalizer: every input bit affects every output bit */
+
+static uint64_t fmix64(uint64_t x)
 {
-	int h=0;
-	while(*key) h=33*h + *key++;
-	return h;
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+}
+
+/* A 64-bit string hash, which reads the key 8 bytes at a time (in the manner
+ * of MurmurHash3). Never returns 0, which marks empty slots. */
+
+static uint64_t hash_func(const char *key, size_t len)
+{
+	const uint64_t c1 = 0x87c37b91114253d5ULL;
+	const uint64_t c2 = 0x4cf5ad432745937fULL;
+	uint64_t h = 0x9e3779b97f4a7c15ULL ^ len;
+	uint64_t word;
+
+	for (; len >= 8; key += 8, len -= 8) {
+		memcpy(&word, key, 8);
+		h ^= rotl64(word * c1, 31) * c2;
+		h = rotl64(h, 27) * 5 + 0x52dce729;
+	}
+	word = 0;
+	memcpy(&word, key, len);
+	h ^= rotl64(word * c1, 31) * c2;
+	h = fmix64(h);
+
+	return 0 == h ? 1 : h;
+}
+
+static const char *slot_key(const struct hash_slot *slot)
+{
+	return NULL == slot->long_key ? slot->inline_key : slot->long_key;
+}
+
+/* Returns the slot that holds 'key', or the empty slot where it would go. */
+
+static struct hash_slot *find_slot(struct hash *h, const char *key,
+		uint64_t code)
+{
+	unsigned int mask = h->size - 1;
+	unsigned int i = (unsigned int) code & mask;
+
+	for (;; i = (i + 1) & mask) {
+		struct hash_slot *slot = h->slots + i;
+		if (0 == slot->code) return slot;
+		if (code == slot->code && 0 == strcmp(key, slot_key(slot)))
+			return slot;
+	}
+}
+
+/* Doubles the number of slots. Keys are not rehashed: their code is kept in
+ * the slot. */
+
+static int grow_hash(struct hash *h)
+{
+	int new_size = 2 * h->size;
+	unsigned int mask = new_size - 1;
+	struct hash_slot *new_slots = calloc(new_size, sizeof(struct hash_slot));
+	int i;
+
+	if (NULL == new_slots) return FAILURE;
+	for (i = 0; i < h->size; i++) {
+		struct hash_slot *slot = h->slots + i;
+		unsigned int j;
+		if (0 == slot->code) continue;
+		for (j = (unsigned int) slot->code & mask; 0 != new_slots[j].code;
+				j = (j + 1) & mask)
+			;
+		new_slots[j] = *slot;
+	}
+	free(h->slots);
+	h->slots = new_slots;
+	h->size = new_size;
+
+	return SUCCESS;
 }
 
 int hash_set(struct hash *h, const char *key, void *value)
 {
-	int hash_code = hash_func(key) % h->size;
-	struct llist *bin;
-	struct key_val_pair *kvp;
-
-	bin = (h->bins)[hash_code];
-
-	/* First, see if key is already in bin. If so, just replace value. */
-	struct list_elem *le;
-	for (le = bin->head; NULL != le; le = le->next) {
-		kvp = (struct key_val_pair *) le->data;
-		if (0 == strcmp(key, kvp->key)) {
-			kvp->value = value;
-			return SUCCESS;
-		}
+	size_t len = strlen(key);
+	uint64_t code = hash_func(key, len);
+	struct hash_slot *slot = find_slot(h, key, code);
+
+	/* First, see if key is already there. If so, just replace value. */
+	if (0 != slot->code) {
+		slot->value = value;
+		return SUCCESS;
+	}
+	/* Key not found - keep the load below 3/4, and fill an empty slot */
+	if ((h->count + 1) * 4 > h->size * 3) {
+		if (! grow_hash(h)) return FAILURE;
+		slot = find_slot(h, key, code);
 	}
-	/* Key not found - create new key_val_pair, fill it with key and val,
-	 * and append to bin. */
-	kvp = (struct key_val_pair *) malloc (sizeof (struct key_val_pair));
-	if (NULL == kvp) return FAILURE;
-	kvp->key = strdup(key);
-	kvp->value = value;
-
-	if (! append_element(bin, kvp)) return FAILURE;
+	if (len < HASH_INLINE_KEY) {
+		memcpy(slot->inline_key, key, len + 1);
+		slot->long_key = NULL;
+	} else {
+		slot->long_key = strdup(key);
+		if (NULL == slot->long_key) return FAILURE;
+	}
+	slot->code = code;
+	slot->value = value;
 	h->count++;
 
 	return SUCCESS;
@@ -106,37 +187,25 @@ int hash_set(struct hash *h, const char *key, void *value)
 
 void *hash_get(struct hash *h, const char *key)
 {
-	int hash_code = hash_func(key) % h->size;
-	struct llist *bin;
-	struct key_val_pair *kvp;
-
-	bin = (h->bins)[hash_code];
-	struct list_elem *le;
-	for (le = bin->head; NULL != le; le = le->next) {
-		kvp = (struct key_val_pair *) le->data;
-		if (0 == strcmp(key, kvp->key)) {
-			return kvp->value;
-		}
-	}
-	return NULL; /* not found */
+	struct hash_slot *slot = find_slot(h, key,
+			hash_func(key, strlen(key)));
+	if (0 == slot->code) return NULL; /* not found */
+	return slot->value;
 }
 
 void dump_hash(struct hash *h, void (*dump_func)())
 {
 	int i;
 
-	printf ("Dump of hash at %p: (%d bins, %d pairs):\n", h, h->size,
+	printf ("Dump of hash at %p: (%d slots, %d pairs):\n", h, h->size,
 			h->count);
 	for (i = 0; i < h->size; i++) {
-		struct list_elem *el = h->bins[i]->head;
-		if (NULL == el) continue;
-		printf ("Hash code: %d (%d pairs)\n", i, h->bins[i]->count);
-		for (; NULL != el; el = el->next) {
-			struct key_val_pair *kp;
-			kp = (struct key_val_pair *) el->data;
-			printf("key: %s\n", kp->key);
-			if (NULL != dump_func) dump_func(kp->value);
-		}
+		struct hash_slot *slot = h->slots + i;
+		if (0 == slot->code) continue;
+		printf ("Slot %d (hash code %016llx)\n", i,
+				(unsigned long long) slot->code);
+		printf("key: %s\n", slot_key(slot));
+		if (NULL != dump_func) dump_func(slot->value);
 	}	
 
 	printf ("Dump done.\n");
@@ -149,13 +218,10 @@ struct llist *hash_keys(struct hash *h)
 	int i;
 
 	for (i = 0; i < h->size; i++) {
-	       struct llist *bin = h->bins[i];	
-	       struct list_elem *el;
-	       for (el = bin->head; NULL != el; el = el->next) {
-		       struct key_val_pair *kvp = el->data;
-		       if (! append_element(list, kvp->key))
-			       return NULL;
-	       }
+		struct hash_slot *slot = h->slots + i;
+		if (0 == slot->code) continue;
+		if (! append_element(list, (char *) slot_key(slot)))
+			return NULL;
 	}
 
 	return list;
@@ -165,21 +231,11 @@ void destroy_hash(struct hash *h)
 {
 	int i;
 
-	/* free internal structure */
-	for (i = 0; i < h->size; i++) {
-		/* free list, including key-val pairs */
-		struct llist *list;
-		struct list_elem *el;
-		list = (h->bins)[i];
-		for (el = list->head; NULL != el; el = el -> next) {
-			struct key_val_pair *kvp = (struct key_val_pair *) el->data;
-			char * key = kvp->key;
-			free(key); /* key is a strdup()licate: free() it */
-			free(kvp); /* we do NOT free value */
-		}
-		destroy_llist(list);
-	}
-	free(h->bins);
+	/* free long keys (they are strdup()licates); we do NOT free values */
+	for (i = 0; i < h->size; i++)
+		if (0 != h->slots[i].code)
+			free(h->slots[i].long_key);
+	free(h->slots);
 	/* free self */
 	free(h);
 }
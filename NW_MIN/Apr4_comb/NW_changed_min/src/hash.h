@@ -27,7 +27,8 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
-/* Simple hash table. Arbitrary data, keyed by strings. Fixed number of bins, does not grow. */
+/* Simple hash table. Arbitrary data, keyed by strings. Open addressing (linear
+ * probing) in a single array of slots, which grows as needed. */
 
 /* NOTE: All functions except the most simple ones can fail, in which case the
  * return value indicates failure or success. Functions that return pointers
@@ -37,26 +38,35 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * insufficient memory in a called function. 
  */
 
+#include <stdint.h>
+
 struct llist;
 
-struct hash {
-	struct llist **bins;
-	int size;	/* the number of bins */
-	int count;	/* the number of data elements - initially 0 */
-};
+/* Keys shorter than this are stored in the slot itself, others are strdup()ed */
+
+#define HASH_INLINE_KEY 16
 
-// TODO: does this need to be public?
-struct key_val_pair {
-	char *key;
+struct hash_slot {
+	uint64_t code;		/* the key's hash code, 0 if the slot is empty */
 	void *value;
+	char *long_key;		/* NULL if the key is in 'inline_key' */
+	char inline_key[HASH_INLINE_KEY];
+};
+
+struct hash {
+	struct hash_slot *slots;
+	int size;	/* the number of slots - a power of 2 */
+	int count;	/* the number of data elements - initially 0 */
 };
 
-/* Creates a hash with n bins. If memory allocation fails, returns NULL . */
+/* Creates a hash for about n elements (it grows if more are added, so n is
+ * just a hint). If memory allocation fails, returns NULL . */
 
 struct hash * create_hash(int n);
 
 /* Inserts a (key, value) pair into a hash. Increments count. The 'key' will be
- * duplicated. */
+ * duplicated. May grow the hash, which invalidates keys previously returned by
+ * hash_keys(). */
 
 int hash_set(struct hash *, const char *key, void *value);
 
@@ -69,7 +79,9 @@ void *hash_get(struct hash *, const char *key);
 
 void dump_hash(struct hash *, void (*dump_func)());
 
-/* Returns a struct llist* with all hash keys. Order is not specified. */
+/* Returns a struct llist* with all hash keys. Order is not specified. The keys
+ * belong to the hash: they are valid until the hash is destroyed, or grows
+ * (see hash_set()). */
 
 struct llist *hash_keys(struct hash *);
 
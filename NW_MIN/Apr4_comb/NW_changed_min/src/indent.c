@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 
 #include "common.h"
+#include "output.h"
 
 extern char *indent_string;
 extern char *eol;
@@ -137,6 +138,7 @@ void get_params(int argc, char* argv[])
 int main(int argc, char* argv[])
 {
 	get_params(argc, argv);
+	buffer_stdout();
 
 	yylex();
 
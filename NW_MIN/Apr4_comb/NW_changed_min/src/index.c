@@ -0,0 +1,247 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* nw_index: index a multi-tree Newick file, and extract trees by number */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <string.h>
+#include <time.h>
+
+#include "tree_index.h"
+#include "common.h"
+#include "output.h"
+
+enum selection { SELECT_NONE, SELECT_RANGE, SELECT_RANDOM, SELECT_PART };
+
+struct parameters {
+	char *filename;
+	enum selection selection;
+	long first;		/* -t, counting from 1 */
+	long last;
+	long sample_size;	/* -r */
+	int seed;
+	int part;		/* -p, counting from 1 */
+	int num_parts;
+};
+
+void help(char *argv[])
+{
+	printf (
+"Indexes a file of Newick trees, and extracts trees from it by number\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s [-h] [-p <part>/<parts> | -r <int> [-s <int>] | -t <range>] <newick trees filename>\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"Argument is the name of a file that contains Newick trees (not '-': the file\n"
+"must be seekable).\n"
+"\n"
+"The first time, the file is scanned for the ';' that end its trees (which\n"
+"is much faster than parsing them), and the trees' positions are saved to an\n"
+"index next to it, with suffix '.nwi'. Later runs use the index, as long as\n"
+"the file is unchanged.\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"By default, prints the number of trees. With one of the options below,\n"
+"prints the selected trees as they are in the file, one per line.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"    -p <part>/<parts>: divide the file into <parts> parts of about the same\n"
+"       size, and print the trees of part <part> (from 1)\n"
+"    -r <int>: print <int> trees picked at random (without replacement)\n"
+"    -s <int>: sets the pseudorandom number generator's seed (with -r)\n"
+"    -t <int>[-<int>]: print tree number <int> (from 1), or a range of trees\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# count the trees\n"
+"$ %s data/HRV_20reps.nw\n"
+"\n"
+"# print the 10th tree\n"
+"$ %s -t 10 data/HRV_20reps.nw\n"
+"\n"
+"# pick 5 trees at random\n"
+"$ %s -r 5 data/HRV_20reps.nw\n"
+"\n"
+"# process a file in 4 parts, at the same time\n"
+"$ for i in 1 2 3 4; do %s -p $i/4 big.nw | nw_topology - > part$i.nw & done\n",
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0]
+	);
+}
+
+struct parameters get_params(int argc, char *argv[])
+{
+	struct parameters params;
+	char *dash;
+
+	params.selection = SELECT_NONE;
+	params.seed = time(NULL);
+
+	int opt_char;
+	while ((opt_char = getopt(argc, argv, "hp:r:s:t:")) != -1) {
+		switch (opt_char) {
+		case 'h':
+			help(argv);
+			exit(EXIT_SUCCESS);
+		case 'p':
+			params.selection = SELECT_PART;
+			if (2 != sscanf(optarg, "%d/%d", &params.part,
+					&params.num_parts)
+				|| params.part < 1
+				|| params.part > params.num_parts) {
+				fprintf (stderr, "-p needs <part>/<parts>, "
+					"with 1 <= <part> <= <parts>.\n");
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'r':
+			params.selection = SELECT_RANDOM;
+			params.sample_size = atol(optarg);
+			break;
+		case 's':
+			params.seed = atoi(optarg);
+			break;
+		case 't':
+			params.selection = SELECT_RANGE;
+			params.first = atol(optarg);
+			dash = strchr(optarg, '-');
+			params.last = NULL == dash ? params.first :
+				atol(dash + 1);
+			if (params.first < 1 || params.last < params.first) {
+				fprintf (stderr, "Invalid range '%s'.\n",
+						optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			fprintf (stderr, "Unknown option '-%c'\n", opt_char);
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	/* check arguments */
+	if ((argc - optind) == 1)	{
+		params.filename = argv[optind];
+	} else {
+		fprintf(stderr, "Usage: %s [-hprst] <filename>\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	return params;
+}
+
+void print_tree(FILE *file, struct tree_index *index, long n)
+{
+	char *newick = read_tree_text(file, index, n);
+	if (NULL == newick) { perror(NULL); exit(EXIT_FAILURE); }
+	printf ("%s\n", newick);
+	free(newick);
+}
+
+/* Prints 'sample_size' distinct trees, picked by a partial Fisher-Yates
+ * shuffle of the tree numbers. */
+
+void print_random_trees(FILE *file, struct tree_index *index,
+		long sample_size)
+{
+	long *numbers = malloc(index->num_trees * sizeof(long));
+	long n;
+
+	if (NULL == numbers) { perror(NULL); exit(EXIT_FAILURE); }
+	for (n = 0; n < index->num_trees; n++) numbers[n] = n;
+	if (sample_size > index->num_trees) sample_size = index->num_trees;
+	for (n = 0; n < sample_size; n++) {
+		long pick = n + (long) ((double) rand() / ((double) RAND_MAX
+				+ 1) * (index->num_trees - n));
+		long tmp = numbers[pick];
+		numbers[pick] = numbers[n];
+		numbers[n] = tmp;
+		print_tree(file, index, numbers[n]);
+	}
+	free(numbers);
+}
+
+int main(int argc, char *argv[])
+{
+	struct parameters params = get_params(argc, argv);
+	struct tree_index *index = get_tree_index(params.filename);
+	FILE *file;
+	long n, end;
+
+	buffer_stdout();
+
+	if (NULL == index) { perror(params.filename); exit(EXIT_FAILURE); }
+	file = fopen(params.filename, "r");
+	if (NULL == file) { perror(params.filename); exit(EXIT_FAILURE); }
+
+	switch (params.selection) {
+	case SELECT_NONE:
+		printf ("%ld\n", index->num_trees);
+		break;
+	case SELECT_RANGE:
+		if (params.last > index->num_trees) {
+			fprintf (stderr, "There are only %ld trees.\n",
+					index->num_trees);
+			exit(EXIT_FAILURE);
+		}
+		for (n = params.first - 1; n < params.last; n++)
+			print_tree(file, index, n);
+		break;
+	case SELECT_RANDOM:
+		srand(params.seed);
+		print_random_trees(file, index, params.sample_size);
+		break;
+	case SELECT_PART:
+		tree_index_part(index, params.part - 1, params.num_parts,
+				&n, &end);
+		for (; n < end; n++)
+			print_tree(file, index, n);
+		break;
+	}
+
+	fclose(file);
+	destroy_tree_index(index);
+	return 0;
+}
@@ -0,0 +1,245 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "label_table.h"
+#include "hash.h"
+#include "common.h"
+
+#define INIT_LABEL_TABLE_SIZE 1024
+
+/* Entries are kept in pages that never move, so that a label's string can be
+ * looked up without locking while other threads add labels. */
+
+#define LABEL_PAGE_SIZE 1024
+#define MAX_LABEL_PAGES 65536
+
+/* A label and its id, in a single block. */
+
+struct label_entry {
+	int id;
+	char string[];
+};
+
+/* The table is shared by all threads: changes, and hash lookups, are done
+ * under 'lock'. */
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static struct hash *label2entry = NULL;
+static struct label_entry **pages[MAX_LABEL_PAGES];	/* indexed by id */
+static int num_labels = 0;
+static int generation = 0;	/* bumped by destroy_label_table() */
+
+/* label_ranks()'s cache, of which each thread has its own */
+
+static THREAD_LOCAL int *ranks = NULL;		/* indexed by id */
+static THREAD_LOCAL int num_ranked = 0;
+static THREAD_LOCAL int ranked_generation = 0;
+
+/* use_label_cache()'s cache: label -> entry, valid for one generation */
+
+static THREAD_LOCAL struct hash *cache = NULL;
+static THREAD_LOCAL int cache_generation = 0;
+
+static struct label_entry *entry_of(int id)
+{
+	return pages[id / LABEL_PAGE_SIZE][id % LABEL_PAGE_SIZE];
+}
+
+static int add_label(const char *label);
+
+/* These two are called with the lock held */
+
+static int init_label_table()
+{
+	label2entry = create_hash(INIT_LABEL_TABLE_SIZE);
+	if (NULL == label2entry) return FAILURE;
+	num_labels = 0;
+	/* the empty label gets id 0 */
+	return EMPTY_LABEL_ID == add_label("");
+}
+
+static int add_label(const char *label)
+{
+	struct label_entry *entry;
+	size_t length;
+	int page = num_labels / LABEL_PAGE_SIZE;
+
+	if (NULL == label2entry && ! init_label_table()) return -1;
+
+	entry = hash_get(label2entry, label);
+	if (NULL != entry) return entry->id;
+
+	if (page == MAX_LABEL_PAGES) return -1;
+	if (NULL == pages[page]) {
+		pages[page] = malloc(LABEL_PAGE_SIZE *
+				sizeof(struct label_entry *));
+		if (NULL == pages[page]) return -1;
+	}
+	length = strlen(label);
+	entry = malloc(sizeof(struct label_entry) + length + 1);
+	if (NULL == entry) return -1;
+	entry->id = num_labels;
+	memcpy(entry->string, label, length + 1);
+	if (! hash_set(label2entry, label, entry)) {
+		free(entry);
+		return -1;
+	}
+	pages[page][num_labels % LABEL_PAGE_SIZE] = entry;
+	num_labels++;
+
+	return entry->id;
+}
+
+int intern_label(const char *label)
+{
+	struct label_entry *entry;
+	int id;
+
+	/* 'generation' only changes in destroy_label_table(), which may not
+	 * run concurrently */
+	if (NULL != cache) {
+		if (cache_generation != generation) {
+			destroy_hash(cache);
+			cache = create_hash(INIT_LABEL_TABLE_SIZE);
+			cache_generation = generation;
+			if (NULL == cache) return -1;
+		}
+		entry = hash_get(cache, label);
+		if (NULL != entry) return entry->id;
+	}
+
+	pthread_mutex_lock(&lock);
+	id = add_label(label);
+	pthread_mutex_unlock(&lock);
+
+	if (NULL != cache && -1 != id)
+		if (! hash_set(cache, label, entry_of(id))) return -1;
+	return id;
+}
+
+int use_label_cache()
+{
+	if (NULL != cache) return SUCCESS;
+	cache = create_hash(INIT_LABEL_TABLE_SIZE);
+	cache_generation = generation;
+	return NULL != cache;
+}
+
+void free_label_cache()
+{
+	if (NULL == cache) return;
+	destroy_hash(cache);
+	cache = NULL;
+}
+
+int find_label(const char *label)
+{
+	struct label_entry *entry = NULL;
+
+	pthread_mutex_lock(&lock);
+	if (NULL != label2entry) entry = hash_get(label2entry, label);
+	pthread_mutex_unlock(&lock);
+	return NULL == entry ? -1 : entry->id;
+}
+
+char *label_string(int id)
+{
+	return entry_of(id)->string;
+}
+
+int label_table_size()
+{
+	int size;
+
+	pthread_mutex_lock(&lock);
+	size = num_labels;
+	pthread_mutex_unlock(&lock);
+	return size;
+}
+
+static int label_id_comparator(const void *a, const void *b)
+{
+	return strcmp(entry_of(*(const int *) a)->string,
+			entry_of(*(const int *) b)->string);
+}
+
+const int *label_ranks()
+{
+	int *ids;
+	int i, size, current_generation;
+
+	pthread_mutex_lock(&lock);
+	size = num_labels;
+	current_generation = generation;
+	pthread_mutex_unlock(&lock);
+
+	if (NULL != ranks && num_ranked == size &&
+			ranked_generation == current_generation)
+		return ranks;
+
+	int *bigger = realloc(ranks, size * sizeof(int));
+	if (NULL == bigger) return NULL;
+	ranks = bigger;
+	ids = malloc(size * sizeof(int));
+	if (NULL == ids) return NULL;
+	for (i = 0; i < size; i++) ids[i] = i;
+	qsort(ids, size, sizeof(int), label_id_comparator);
+	/* labels are distinct, so are their ranks */
+	for (i = 0; i < size; i++) ranks[ids[i]] = i;
+	free(ids);
+	num_ranked = size;
+	ranked_generation = current_generation;
+
+	return ranks;
+}
+
+void destroy_label_table()
+{
+	int i;
+
+	pthread_mutex_lock(&lock);
+	for (i = 0; i < num_labels; i++)
+		free(entry_of(i));
+	for (i = 0; i < MAX_LABEL_PAGES && NULL != pages[i]; i++) {
+		free(pages[i]);
+		pages[i] = NULL;
+	}
+	if (NULL != label2entry) destroy_hash(label2entry);
+	label2entry = NULL;
+	num_labels = 0;
+	generation++;
+	pthread_mutex_unlock(&lock);
+	free(ranks);
+	ranks = NULL;
+	num_ranked = 0;
+}
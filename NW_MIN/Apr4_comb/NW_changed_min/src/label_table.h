@@ -0,0 +1,82 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* The label table: a program-wide symbol table of node labels. Each distinct
+ * label is stored once, and gets an id: a small, non-negative integer.
+ * Nodes point to the interned string (see struct rnode), so labels can be
+ * compared by id instead of strcmp(), and used as array indices instead of
+ * hash keys. */
+
+/* NOTE: interned strings are shared: they must not be modified or free()d. They
+ * stay valid until destroy_label_table(). The table may be used from several
+ * threads at once (destroy_label_table() excepted). */
+
+/* The empty label's id */
+
+#define EMPTY_LABEL_ID 0
+
+/* Returns the id of 'label', adding it to the table if it is not there yet. */
+/* Returns -1 in case of error (malloc()) */
+
+int intern_label(const char *label);
+
+/* A thread that interns many labels (such as the workers of
+ * parallel_parser.h) can have intern_label() look them up in a private cache
+ * first, so that it only takes the table's lock for labels it has not seen
+ * yet. The thread must free its cache before exiting. Returns FAILURE in case
+ * of error (malloc()). */
+
+int use_label_cache();
+void free_label_cache();
+
+/* Returns the id of 'label', or -1 if it has not been interned */
+
+int find_label(const char *label);
+
+/* Returns the interned string of label 'id', which must be valid. */
+
+char *label_string(int id);
+
+/* Returns the number of labels in the table - ids are below this. */
+
+int label_table_size();
+
+/* Returns an array giving, for each label id, the label's rank in strcmp()
+ * order: comparing ranks is the same as comparing labels. The ranking is only
+ * recomputed when labels have been added since the last call, so it is cheap
+ * to use for many trees over the same labels. The array belongs to the table
+ * (each thread has its own), and is valid until the thread's next call. */
+/* Returns NULL in case of error (malloc()) */
+
+const int *label_ranks();
+
+/* Frees the table and all interned strings (no node may use them anymore).
+ * The table can be used again afterwards. */
+
+void destroy_label_table();
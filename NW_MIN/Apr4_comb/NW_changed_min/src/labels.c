@@ -39,6 +39,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "rnode.h"
 #include "list.h"
 #include "common.h"
+#include "output.h"
 
 struct parameters {
 	int show_inner_labels;
@@ -125,12 +126,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-hILt] <filename|->\n", argv[0]);
@@ -179,6 +179,7 @@ int main (int argc, char* argv[])
 	struct parameters params;
 
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	while ((tree = parse_tree()) != NULL) {
 		process_tree(tree, params);
@@ -37,8 +37,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "hash.h"
 #include "nodemap.h"
 
-struct rooted_tree *lca2w_tree;
-
 /* NOTE: these two functions are obsolete, but I keep them in case the new
  * implementation turns out to be faulty. */
 
@@ -56,55 +54,39 @@ void mark_unseen(struct rooted_tree *tree)
 }
 */
 
-/* Start from descendant A and climbs to the root, marking each node as 'seen'
- * along the way. Then starts again from descendant B, returning the first
- * 'seen' node. */
+/* Returns the number of edges between 'node' and the root */
+
+static int depth(struct rnode *node)
+{
+	int d = 0;
+	for (; ! is_root(node); node = node->parent) d++;
+	return d;
+}
+
+/* Climbs from the deeper of descendants A and B until both are at the same
+ * depth, then from both at once until they meet. This needs neither memory
+ * nor node->data, so it can be called O(n^2) times, e.g. for distance
+ * matrices. 'tree' is not used: it is kept for API compatibility. */
 
 struct rnode *lca2(struct rooted_tree *tree, struct rnode *desc_A,
 		struct rnode *desc_B)
 {
-	char *SEEN = "seen";
-	char *key;
-
-	/* This hash will remember which nodes have been visited. It need be at
-	 * most as large as the number of nodes in the tree. */
-	struct hash *seen_nodes = create_hash(tree->nodes_in_order->count);
-	if (NULL == seen_nodes) return NULL;
-
-	/* Climb to root, marking nodes as 'seen' */
-	while (! is_root(desc_A)) {
-		key = make_hash_key(desc_A);
-		if(! hash_set(seen_nodes, key, SEEN)) return NULL;
-		free(key);
+	int depth_A = depth(desc_A);
+	int depth_B = depth(desc_B);
+
+	(void) tree;
+
+	for (; depth_A > depth_B; depth_A--) desc_A = desc_A->parent;
+	for (; depth_B > depth_A; depth_B--) desc_B = desc_B->parent;
+	while (desc_A != desc_B) {
+		if (is_root(desc_A)) return NULL;	/* different trees */
 		desc_A = desc_A->parent;
-	}
-	key = make_hash_key(desc_A);
-	if (! hash_set(seen_nodes, key, SEEN)) return NULL;
-	free(key);
-
-	while (1) {
-		key = make_hash_key(desc_B);
-		if (NULL != hash_get(seen_nodes, key)) { /* seen */
-			free(key);
-			break;
-		}
-		free(key);
 		desc_B = desc_B->parent;
 	}
 
-	destroy_hash(seen_nodes);
-
 	return desc_B;
 }
 
-/* A wrapper around lca2() so it can be passed to reduce() */
-
-void * lca2w(void *a, void *b)
-{
-	return lca2(lca2w_tree, (struct rnode*) a,
-			(struct rnode *) b);
-}
-
 /* Returns the LCA of any number of nodes, by applying lca2 to a list of
  * descendants. THIS USES UP THE LIST! Use lca_from_nodes() to keep the
  * argument list intact. */
@@ -112,12 +94,16 @@ void * lca2w(void *a, void *b)
 struct rnode *lca (struct rooted_tree *tree,
 		struct llist *descendants)
 {
-	void * result;
+	struct rnode *result;
 
-	/* lca2w() has only 2 args (by definition of reduce() in
-	 * list.h), but lca() needs *tree */
-	lca2w_tree = tree; 
-	result = reduce(descendants, lca2w);
+	/* a left fold of lca2() over the list, which needs no state besides
+	 * 'tree' (hence no reduce(), whose function takes only 2 args) */
+	if (0 == descendants->count) return NULL;
+	result = shift(descendants);
+	while (descendants->count > 0) {
+		result = lca2(tree, result, shift(descendants));
+		if (NULL == result) return NULL;
+	}
 
 	return result;
 }
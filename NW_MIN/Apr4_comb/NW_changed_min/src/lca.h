@@ -31,19 +31,16 @@ struct rooted_tree;
 struct rnode;
 struct llist;
 
-/* Given a tree and two nodes, returns their last common ancestor.
- * NOTE: Both nodes are assumed to belong to the tree; if this is
- * not the case, then the function will return the tree's root or
- * may hang.  NOTE: Clobbers node->data. */
-/* Returns NULL in case of malloc() error. */
+/* Given a tree and two nodes, returns their last common ancestor. Takes time
+ * proportional to the nodes' depth, and allocates no memory. */
+/* Returns NULL if the nodes are not in the same tree. */
 
 struct rnode *lca2(struct rooted_tree *, struct rnode *,
 		struct rnode *);
 
 /* Given a tree and a list of (pointers to) nodes, returns the last
  * common ancestor of the nodes. NOTE: All nodes in the list are
- * assumed to belong to the tree, otherwise behaviour is unspecified
- * and can hang. NOTE: Clobbers node->data. */
+ * assumed to belong to the tree, otherwise returns NULL. */
 
 /* TODO: this function changes its argument. Make it static, and use
  * lca_from_nodes() instead. */
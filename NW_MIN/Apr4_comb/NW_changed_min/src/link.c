@@ -39,15 +39,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include "list.h"
+#include "arena.h"
 #include "link.h"
 #include "masprintf.h"
 #include "common.h"
 
-struct rnode *unlink_rnode_root_child;
+THREAD_LOCAL struct rnode *unlink_rnode_root_child;
+THREAD_LOCAL unsigned long link_changes = 0;
 
 int add_child(struct rnode *parent, struct rnode *child)
 {
 	struct llist *children_list;
+	link_changes++;
 	child->parent = parent;
 
 	children_list = parent->children;
@@ -93,7 +96,7 @@ int insert_node_above(struct rnode *this, char *label)
 	if (NULL == new) return FAILURE;
 	/* link new node to this node */
 	if (! add_child(new, this)) return FAILURE;
-	free(this->edge_length_as_string);
+	arena_free(this->edge_length_as_string);
 	this->edge_length_as_string = strdup(new_edge_length);
 	replace_child(parent, this, new);
 
@@ -106,6 +109,7 @@ void replace_child (struct rnode *node, struct rnode *old, struct rnode *new)
 {
 	struct list_elem *el;
 
+	link_changes++;
 	for (el = node->children->head; NULL != el; el = el->next) { 
 		if (el->data == old) {
 			el->data = new;
@@ -145,6 +149,7 @@ int splice_out_rnode(struct rnode *this)
 	struct rnode *parent = this->parent;
 	struct list_elem *elem;
 
+	link_changes++;
 	/* change the children's parent edges: they must now point to their
 	 * 'grandparent', and the length from their parent to their grandparent
 	 * must be added. */
@@ -154,7 +159,7 @@ int splice_out_rnode(struct rnode *this)
 			this->edge_length_as_string,
 			child->edge_length_as_string);
 		if (NULL == new_edge_len_s) return FAILURE;
-		free(child->edge_length_as_string);
+		arena_free(child->edge_length_as_string);
 		child->edge_length_as_string = new_edge_len_s;
 		child->parent = parent;  /* instead of this node */
 	}
@@ -171,7 +176,7 @@ int splice_out_rnode(struct rnode *this)
 
 	/* insert list of modified edges in parent's children list */
 	insert_after(parent->children, i-1, kids_copy);
-	free(kids_copy);
+	arena_free(kids_copy);
 
 	return SUCCESS;
 }
@@ -179,6 +184,7 @@ int splice_out_rnode(struct rnode *this)
 int remove_child(struct rnode *child)
 {
 	if (is_root(child)) return RM_CHILD_IS_ROOT;;
+	link_changes++;
 
 	struct rnode *parent = child->parent;
 	struct llist *kids = parent->children;
@@ -196,6 +202,7 @@ int remove_child(struct rnode *child)
 int insert_child(struct rnode *parent, struct rnode *child, int index)
 {
 	struct llist *kids = parent->children;
+	link_changes++;
 	struct llist *insert = create_llist();
 	if (NULL == insert) return FAILURE;
 	if (! append_element(insert, child)) return FAILURE;
@@ -216,9 +223,9 @@ int swap_nodes(struct rnode *node)
 	if(remove_child(node) < 0) return FAILURE;
 	if (! add_child(node, parent)) return FAILURE;
 
-	free(node->edge_length_as_string);
+	arena_free(node->edge_length_as_string);
 	node->edge_length_as_string = strdup("");
-	free(parent->edge_length_as_string);
+	arena_free(parent->edge_length_as_string);
 	parent->edge_length_as_string = length;
 
 	return SUCCESS;
@@ -229,6 +236,7 @@ int unlink_rnode(struct rnode *node)
 	struct rnode *parent = node->parent;
 	struct llist *siblings = parent->children; 	/* includes 'node'! */
 	int index = llist_index_of(siblings, node);
+	link_changes++;
 	/* This removes this node from its parent's list of children.  We get
 	 * the resulting list only so we can free it. */
 	struct llist *del = delete_after(siblings, index-1, 1);
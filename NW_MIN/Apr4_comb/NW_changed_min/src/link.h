@@ -42,9 +42,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 enum unlink_rnode_status { UNLINK_RNODE_DONE, UNLINK_RNODE_ROOT_CHILD,
 	UNLINK_RNODE_ERROR };
 
+#include "common.h"
+
 struct rnode;
 
-extern struct rnode * unlink_rnode_root_child;
+/* Set by unlink_rnode() (see below); each thread has its own */
+extern THREAD_LOCAL struct rnode * unlink_rnode_root_child;
+
+/* Counts the changes to tree structure made by the functions below, on the
+ * calling thread. A tree's cached traversals (see tree_postorder()) are only
+ * used while this has not changed. */
+extern THREAD_LOCAL unsigned long link_changes;
 
 /* Adds 'child' to 'parent''s list of children nodes */
 /* Returns FAILURE iff there was a problem (malloc(), most probably) */
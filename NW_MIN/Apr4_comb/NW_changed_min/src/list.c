@@ -33,12 +33,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "common.h"
 #include "list.h"
+#include "arena.h"
 
 
 struct llist *create_llist()
 {
 	struct llist *llist_p;
-	llist_p = malloc(sizeof(struct llist));
+	llist_p = arena_malloc(sizeof(struct llist));
 	if (NULL == llist_p) return NULL;
 	llist_p->head = llist_p->tail = NULL;
 	llist_p->count = 0;
@@ -49,7 +50,7 @@ int prepend_element(struct llist *list, void *data)
 {
 	struct list_elem *el_p;
 
-	el_p = malloc(sizeof(struct list_elem));
+	el_p = arena_malloc(sizeof(struct list_elem));
 	if (NULL == el_p) return FAILURE;
 	el_p->data = data;
 	el_p->next = NULL;
@@ -70,7 +71,7 @@ int append_element(struct llist *list, void *data)
 {
 	struct list_elem *el_p;
 
-	el_p = malloc(sizeof(struct list_elem));
+	el_p = arena_malloc(sizeof(struct list_elem));
 	if (NULL == el_p) return FAILURE;
 	el_p->data = data;
 	el_p->next = NULL;
@@ -128,7 +129,7 @@ void *shift(struct llist *list)
 	list->count -= 1;
 	
 	void *data = result->data;
-	free(result);
+	arena_free(result);
 
 	return data;
 }
@@ -310,7 +311,7 @@ int llist_index_of_f(struct llist *list, int (*func)(void*,void*), void * tgt)
 void destroy_llist(struct llist *l) 
 {
 	clear_llist(l);
-	free(l);
+	arena_free(l);
 }
 
 void ** llist_to_array (struct llist *l)
@@ -347,7 +348,7 @@ void clear_llist(struct llist *l)
 	e = l->head;
 	while (NULL != e) {
 		f = e->next;
-		free(e);
+		arena_free(e);
 		e = f;
 	}
 	l->head = l->tail = NULL;
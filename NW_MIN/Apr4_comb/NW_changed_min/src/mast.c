@@ -0,0 +1,218 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* mast.c - exact maximum agreement subtree of a set of trees */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree.h"
+#include "parser.h"
+#include "to_newick.h"
+#include "list.h"
+#include "rnode.h"
+#include "order_tree.h"
+#include "mast_tree.h"
+#include "common.h"
+#include "output.h"
+
+struct parameters {
+	int size_only;
+};
+
+void help (char *argv[])
+{
+	printf (
+"Computes the exact maximum agreement subtree (MAST) of a set of trees\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s [-hs] <newick trees filename|->\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"Argument is the name of a file that contains Newick trees, or '-' (in\n"
+"which case trees are read from standard input).\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"Prints the MAST of all the input trees on standard output, as a Newick\n"
+"tree ordered by label (see nw_order). The MAST is a largest set of\n"
+"leaves on which all trees have the same topology, once pruned to these\n"
+"leaves. Only leaves whose labels are found in every tree are considered,\n"
+"and branch lengths and inner labels are ignored. If the trees have no\n"
+"label in common, nothing is printed.\n"
+"\n"
+"With one or two trees, polytomies of up to %d children are allowed.\n"
+"With more trees, all trees must be binary, and the running time grows\n"
+"as the cube of the number of leaves: this is meant as a reference for\n"
+"small inputs, e.g. to measure how close nw_match's greedy heuristic gets\n"
+"to the optimum.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"    -s: print the number of leaves in the MAST instead of the MAST\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# MAST of two trees\n"
+"$ %s data/falconiformes_2_trees\n"
+"\n"
+"# How large is the MAST of a set of gene trees?\n"
+"$ %s -s gene_trees.nw\n",
+	argv[0],
+	MAST_MAX_DEGREE,
+	argv[0],
+	argv[0]
+	       );
+}
+
+struct parameters get_params(int argc, char *argv[])
+{
+
+	struct parameters params;
+	params.size_only = FALSE;
+
+	int opt_char;
+	while ((opt_char = getopt(argc, argv, "hs")) != -1) {
+		switch (opt_char) {
+		case 'h':
+			help(argv);
+			exit(EXIT_SUCCESS);
+		case 's':
+			params.size_only = TRUE;
+			break;
+		default:
+			fprintf (stderr, "Unknown option '-%c'\n", opt_char);
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	/* check arguments */
+	if ((argc - optind) == 1)	{
+		if (0 != strcmp("-", argv[optind])) {
+			FILE *fin = fopen(argv[optind], "r");
+			if (NULL == fin) {
+				perror(NULL);
+				exit(EXIT_FAILURE);
+			}
+			set_parser_input(fin);
+		}
+	} else {
+		fprintf(stderr, "Usage: %s [-hs] <filename|->\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	return params;
+}
+
+int main(int argc, char *argv[])
+{
+	struct rooted_tree *tree;	
+	struct rooted_tree *mast = NULL;
+	struct parameters params = get_params(argc, argv);
+	struct llist *trees = create_llist();
+	struct rooted_tree **tree_array;
+	struct list_elem *el;
+	enum mast_return result;
+	int i;
+
+	buffer_stdout();
+
+	if (NULL == trees) { perror(NULL); exit(EXIT_FAILURE); }
+	while (NULL != (tree = parse_tree())) {
+		if (! append_element(trees, tree)) {
+			perror(NULL);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (0 == trees->count) {
+		fprintf(stderr, "No tree found in input.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	tree_array = malloc(trees->count * sizeof(struct rooted_tree *));
+	if (NULL == tree_array) { perror(NULL); exit(EXIT_FAILURE); }
+	for (i = 0, el = trees->head; NULL != el; el = el->next, i++)
+		tree_array[i] = el->data;
+
+	/* The two-tree algorithm is faster, and handles polytomies. */
+	switch (trees->count) {
+	case 1:
+		result = mast_two_trees(tree_array[0], tree_array[0], &mast);
+		break;
+	case 2:
+		result = mast_two_trees(tree_array[0], tree_array[1], &mast);
+		break;
+	default:
+		result = mast_trees(tree_array, trees->count, &mast);
+	}
+
+	switch (result) {
+	case MAST_OK:
+		break;
+	case MAST_DUP_LABEL:
+		fprintf(stderr, "Labels must be unique in each tree.\n");
+		exit(EXIT_FAILURE);
+	case MAST_DEGREE:
+		fprintf(stderr, "Nodes may have at most %d children.\n",
+				MAST_MAX_DEGREE);
+		exit(EXIT_FAILURE);
+	case MAST_NOT_BINARY:
+		fprintf(stderr, "With more than two trees, all trees must "
+				"be binary.\n");
+		exit(EXIT_FAILURE);
+	default:
+		perror(NULL);
+		exit(EXIT_FAILURE);
+	}
+
+	if (params.size_only) {
+		printf("%d\n", NULL == mast ? 0 : leaf_count(mast));
+	} else if (NULL != mast) {
+		if (! order_tree_lbl(mast)) { perror(NULL); exit(EXIT_FAILURE); }
+		dump_newick(mast->root);
+	}
+
+	if (NULL != mast) destroy_tree_cb(mast, NULL);
+	for (i = 0; i < trees->count; i++)
+		destroy_tree(tree_array[i], FALSE);
+	free(tree_array);
+	destroy_llist(trees);
+
+	return 0;
+}
@@ -0,0 +1,684 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "mast_tree.h"
+#include "tree.h"
+#include "rnode.h"
+#include "list.h"
+#include "link.h"
+#include "hash.h"
+#include "rnode_iterator.h"
+#include "common.h"
+
+/* The input trees are first converted to arrays, in postorder. Since the
+ * children are visited in order, the subtree of node i is made of nodes
+ * low[i] to i, so that ancestry is a pair of comparisons. Leaves get the
+ * number of their taxon, if it is common to all trees. */
+
+struct mast_input {
+	int num_nodes;
+	int max_degree;
+	int *taxon;	/* -1 for inner nodes and for leaves not in all trees */
+	int *first;	/* children of i are child[first[i]] .. child[first[i+1]-1] */
+	int *child;
+	int *low;
+	int *depth;
+};
+
+/* Labels found in all trees, numbered in order of the first tree's leaves. */
+
+struct common_taxa {
+	struct hash *lbl2entry;
+	int count;
+	char **labels;	/* point to the first tree's labels */
+};
+
+struct taxon_entry {
+	int seen;	/* number of trees that have this label */
+	int number;
+};
+
+static void destroy_common_taxa(struct common_taxa *taxa)
+{
+	struct llist *keys;
+
+	if (NULL == taxa->lbl2entry) return;
+	keys = hash_keys(taxa->lbl2entry);
+	if (NULL != keys) {
+		struct list_elem *el;
+		for (el = keys->head; NULL != el; el = el->next)
+			free(hash_get(taxa->lbl2entry, el->data));
+		destroy_llist(keys);
+	}
+	destroy_hash(taxa->lbl2entry);
+	free(taxa->labels);
+}
+
+static enum mast_return find_common_taxa(struct rooted_tree **trees, int count,
+		struct common_taxa *taxa)
+{
+	struct list_elem *el;
+	int t;
+
+	taxa->count = 0;
+	taxa->labels = NULL;
+	taxa->lbl2entry = create_hash(trees[0]->nodes_in_order->count);
+	if (NULL == taxa->lbl2entry) return MAST_MEM_ERROR;
+
+	for (t = 0; t < count; t++) {
+		for (el = trees[t]->nodes_in_order->head; NULL != el;
+				el = el->next) {
+			struct rnode *current = el->data;
+			struct taxon_entry *entry;
+			if (! is_leaf(current)) continue;
+			if (0 == strcmp("", current->label)) continue;
+			entry = hash_get(taxa->lbl2entry, current->label);
+			if (NULL == entry) {
+				if (t > 0) continue;
+				entry = malloc(sizeof(struct taxon_entry));
+				if (NULL == entry) return MAST_MEM_ERROR;
+				entry->seen = 0;
+				entry->number = -1;
+				if (! hash_set(taxa->lbl2entry, current->label,
+							entry))
+					return MAST_MEM_ERROR;
+			}
+			if (entry->seen > t) return MAST_DUP_LABEL;
+			if (entry->seen == t) entry->seen++;
+		}
+	}
+
+	taxa->labels = malloc(trees[0]->nodes_in_order->count * sizeof(char *));
+	if (NULL == taxa->labels) return MAST_MEM_ERROR;
+	for (el = trees[0]->nodes_in_order->head; NULL != el; el = el->next) {
+		struct rnode *current = el->data;
+		struct taxon_entry *entry;
+		if (! is_leaf(current)) continue;
+		entry = hash_get(taxa->lbl2entry, current->label);
+		if (NULL == entry || entry->seen < count) continue;
+		entry->number = taxa->count;
+		taxa->labels[taxa->count++] = current->label;
+	}
+
+	return MAST_OK;
+}
+
+static void destroy_input(struct mast_input *in)
+{
+	free(in->taxon);
+	free(in->first);
+	free(in->child);
+	free(in->low);
+	free(in->depth);
+}
+
+/* NOTE: node->data is set to point into 'in->low' while the nodes get their
+ * numbers (low[] is filled afterwards). */
+
+static enum mast_return build_input(struct rooted_tree *tree,
+		struct common_taxa *taxa, struct mast_input *in)
+{
+	int n = tree->nodes_in_order->count;
+	struct rnode **stack = malloc(n * sizeof(struct rnode *));
+	struct rnode **preorder = malloc(n * sizeof(struct rnode *));
+	int top = 0, k = 0, i;
+
+	in->num_nodes = n;
+	in->max_degree = 0;
+	in->taxon = malloc(n * sizeof(int));
+	in->first = malloc((n + 1) * sizeof(int));
+	in->child = malloc(n * sizeof(int));
+	in->low = malloc(n * sizeof(int));
+	in->depth = malloc(n * sizeof(int));
+	if (NULL == stack || NULL == preorder || NULL == in->taxon ||
+			NULL == in->first || NULL == in->child ||
+			NULL == in->low || NULL == in->depth) {
+		free(stack);
+		free(preorder);
+		destroy_input(in);
+		return MAST_MEM_ERROR;
+	}
+
+	/* Visiting children right to left in preorder, then reversing,
+	 * yields a left-to-right postorder. */
+	stack[top++] = tree->root;
+	while (top > 0) {
+		struct rnode *current = stack[--top];
+		struct list_elem *el;
+		preorder[k++] = current;
+		for (el = current->children->head; NULL != el; el = el->next)
+			stack[top++] = el->data;
+	}
+	assert(k == n);
+	for (i = 0; i < n; i++) {
+		in->low[n - 1 - i] = n - 1 - i;
+		preorder[i]->data = in->low + (n - 1 - i);
+	}
+
+	k = 0;
+	for (i = 0; i < n; i++) {
+		struct rnode *current = preorder[n - 1 - i];
+		struct list_elem *el;
+		int degree = 0;
+		in->first[i] = k;
+		in->taxon[i] = -1;
+		if (is_leaf(current)) {
+			struct taxon_entry *entry = hash_get(taxa->lbl2entry,
+					current->label);
+			if (NULL != entry) in->taxon[i] = entry->number;
+		}
+		for (el = current->children->head; NULL != el; el = el->next) {
+			struct rnode *kid = el->data;
+			in->child[k++] = *((int *) kid->data);
+			degree++;
+		}
+		if (degree > in->max_degree) in->max_degree = degree;
+	}
+	in->first[n] = k;
+
+	/* low[] still holds the node numbers, which we no longer need */
+	for (i = 0; i < n; i++)
+		if (in->first[i] != in->first[i+1])
+			in->low[i] = in->low[in->child[in->first[i]]];
+	/* preorder: parents before children */
+	in->depth[n - 1] = 0;
+	for (i = n - 1; i >= 0; i--) {
+		int c;
+		for (c = in->first[i]; c < in->first[i+1]; c++)
+			in->depth[in->child[c]] = in->depth[i] + 1;
+	}
+
+	free(stack);
+	free(preorder);
+	return MAST_OK;
+}
+
+static struct rnode *create_mast_leaf(struct common_taxa *taxa, int taxon)
+{
+	return create_rnode(taxa->labels[taxon], NULL);
+}
+
+static struct rooted_tree *create_mast_tree(struct rnode *root)
+{
+	struct rooted_tree *mast;
+
+	if (NULL == root) return NULL;
+	mast = malloc(sizeof(struct rooted_tree));
+	if (NULL == mast) return NULL;
+	mast->root = root;
+	mast->nodes_in_order = get_nodes_in_order(root);
+	if (NULL == mast->nodes_in_order) { free(mast); return NULL; }
+	mast->type = TREE_TYPE_UNKNOWN;
+	mast->arena = NULL;
+	mast->orders = NULL;
+	use_nodes_in_order_as_postorder(mast);
+	return mast;
+}
+
+/* Two trees */
+
+struct two_tree_dp {
+	struct mast_input *in1;
+	struct mast_input *in2;
+	int *leaf2;	/* node number of each taxon's leaf in tree 2 */
+	int *mast;	/* mast[u * n2 + v]: MAST size of subtrees u and v */
+	int *layers;	/* scratch for matching children */
+	struct common_taxa *taxa;
+	int error;
+};
+
+#define DP(dp, u, v) ((dp)->mast[(u) * (dp)->in2->num_nodes + (v)])
+
+/* Max weight matching between the children of u and v, where the weight of
+ * (u_i, v_j) is their MAST size. Layer i holds the best matching of u's first
+ * i children, for each subset of v's children. */
+
+static int match_children(struct two_tree_dp *dp, int u, int v)
+{
+	struct mast_input *in1 = dp->in1, *in2 = dp->in2;
+	int du = in1->first[u+1] - in1->first[u];
+	int dv = in2->first[v+1] - in2->first[v];
+	int num_masks = 1 << dv;
+	int i, j, mask;
+
+	for (mask = 0; mask < num_masks; mask++) dp->layers[mask] = 0;
+	for (i = 1; i <= du; i++) {
+		int *prev = dp->layers + (i - 1) * num_masks;
+		int *cur = dp->layers + i * num_masks;
+		int ui = in1->child[in1->first[u] + i - 1];
+		for (mask = 0; mask < num_masks; mask++) {
+			int best = prev[mask];
+			for (j = 0; j < dv; j++) {
+				int vj, w;
+				if (! (mask & (1 << j))) continue;
+				vj = in2->child[in2->first[v] + j];
+				w = prev[mask ^ (1 << j)] + DP(dp, ui, vj);
+				if (w > best) best = w;
+			}
+			cur[mask] = best;
+		}
+	}
+	return dp->layers[du * num_masks + num_masks - 1];
+}
+
+static void fill_two_tree_dp(struct two_tree_dp *dp)
+{
+	struct mast_input *in1 = dp->in1, *in2 = dp->in2;
+	int u, v, c;
+
+	for (u = 0; u < in1->num_nodes; u++) {
+		for (v = 0; v < in2->num_nodes; v++) {
+			int best = 0;
+			if (in1->first[u] == in1->first[u+1]) {
+				int t = in1->taxon[u];
+				if (t >= 0 && in2->low[v] <= dp->leaf2[t] &&
+						dp->leaf2[t] <= v)
+					best = 1;
+			} else if (in2->first[v] == in2->first[v+1]) {
+				int t = in2->taxon[v];
+				/* t's leaf in tree 1 is below u IFF some
+				 * child's MAST with v is 1 */
+				if (t >= 0)
+					for (c = in1->first[u];
+						c < in1->first[u+1]; c++)
+						if (DP(dp, in1->child[c], v))
+							best = 1;
+			} else {
+				int m;
+				for (c = in1->first[u]; c < in1->first[u+1];
+						c++)
+					if (DP(dp, in1->child[c], v) > best)
+						best = DP(dp, in1->child[c], v);
+				for (c = in2->first[v]; c < in2->first[v+1];
+						c++)
+					if (DP(dp, u, in2->child[c]) > best)
+						best = DP(dp, u, in2->child[c]);
+				m = match_children(dp, u, v);
+				if (m > best) best = m;
+			}
+			DP(dp, u, v) = best;
+		}
+	}
+}
+
+/* Builds the agreement subtree whose size is DP(u, v), following the same
+ * choices as fill_two_tree_dp(). */
+
+static struct rnode *build_two_tree_mast(struct two_tree_dp *dp, int u, int v)
+{
+	struct mast_input *in1 = dp->in1, *in2 = dp->in2;
+	int size = DP(dp, u, v);
+	int du, dv, num_masks, i, j, mask;
+	struct rnode *node;
+
+	if (0 == size || dp->error) return NULL;
+	if (in1->first[u] == in1->first[u+1])
+		return create_mast_leaf(dp->taxa, in1->taxon[u]);
+	if (in2->first[v] == in2->first[v+1])
+		return create_mast_leaf(dp->taxa, in2->taxon[v]);
+	for (i = in1->first[u]; i < in1->first[u+1]; i++)
+		if (DP(dp, in1->child[i], v) == size)
+			return build_two_tree_mast(dp, in1->child[i], v);
+	for (j = in2->first[v]; j < in2->first[v+1]; j++)
+		if (DP(dp, u, in2->child[j]) == size)
+			return build_two_tree_mast(dp, u, in2->child[j]);
+
+	node = create_rnode(NULL, NULL);
+	if (NULL == node) { dp->error = TRUE; return NULL; }
+	match_children(dp, u, v);
+	du = in1->first[u+1] - in1->first[u];
+	dv = in2->first[v+1] - in2->first[v];
+	num_masks = 1 << dv;
+	mask = num_masks - 1;
+	/* walk the layers back; children end up in reverse order, which does
+	 * not matter for a tree. */
+	for (i = du; i > 0; i--) {
+		int *prev = dp->layers + (i - 1) * num_masks;
+		int *cur = dp->layers + i * num_masks;
+		int ui = in1->child[in1->first[u] + i - 1];
+		if (cur[mask] == prev[mask]) continue;
+		for (j = 0; j < dv; j++) {
+			int vj = in2->child[in2->first[v] + j];
+			if (! (mask & (1 << j))) continue;
+			if (prev[mask ^ (1 << j)] + DP(dp, ui, vj) == cur[mask])
+				break;
+		}
+		assert(j < dv);
+		mask ^= 1 << j;
+		{
+			int vj = in2->child[in2->first[v] + j];
+			struct rnode *kid = build_two_tree_mast(dp, ui, vj);
+			if (NULL == kid || ! add_child(node, kid)) {
+				dp->error = TRUE;
+				return node;
+			}
+		}
+		/* the recursive calls overwrote the layers */
+		match_children(dp, u, v);
+	}
+	return node;
+}
+
+enum mast_return mast_two_trees(struct rooted_tree *tree1,
+		struct rooted_tree *tree2, struct rooted_tree **mast_ptr)
+{
+	struct rooted_tree *trees[2];
+	struct common_taxa taxa;
+	struct mast_input in1, in2;
+	struct two_tree_dp dp;
+	struct rnode *root;
+	enum mast_return result;
+	int v;
+
+	trees[0] = tree1;
+	trees[1] = tree2;
+	result = find_common_taxa(trees, 2, &taxa);
+	if (MAST_OK != result) { destroy_common_taxa(&taxa); return result; }
+	if (0 == taxa.count) {
+		destroy_common_taxa(&taxa);
+		*mast_ptr = NULL;
+		return MAST_OK;
+	}
+	result = build_input(tree1, &taxa, &in1);
+	if (MAST_OK != result) { destroy_common_taxa(&taxa); return result; }
+	result = build_input(tree2, &taxa, &in2);
+	if (MAST_OK != result) {
+		destroy_input(&in1);
+		destroy_common_taxa(&taxa);
+		return result;
+	}
+	if (in1.max_degree > MAST_MAX_DEGREE ||
+			in2.max_degree > MAST_MAX_DEGREE) {
+		destroy_input(&in1);
+		destroy_input(&in2);
+		destroy_common_taxa(&taxa);
+		return MAST_DEGREE;
+	}
+
+	dp.in1 = &in1;
+	dp.in2 = &in2;
+	dp.taxa = &taxa;
+	dp.error = FALSE;
+	dp.leaf2 = malloc(taxa.count * sizeof(int));
+	dp.mast = malloc((size_t) in1.num_nodes * in2.num_nodes * sizeof(int));
+	dp.layers = malloc((in1.max_degree + 1) * (1 << in2.max_degree) *
+			sizeof(int));
+	result = MAST_MEM_ERROR;
+	if (NULL != dp.leaf2 && NULL != dp.mast && NULL != dp.layers) {
+		for (v = 0; v < in2.num_nodes; v++)
+			if (in2.taxon[v] >= 0) dp.leaf2[in2.taxon[v]] = v;
+		fill_two_tree_dp(&dp);
+		root = build_two_tree_mast(&dp, in1.num_nodes - 1,
+				in2.num_nodes - 1);
+		if (! dp.error) {
+			*mast_ptr = create_mast_tree(root);
+			if (NULL != *mast_ptr) result = MAST_OK;
+		}
+		if (MAST_OK != result && NULL != root)
+			free_descendants(root);
+	}
+
+	free(dp.leaf2);
+	free(dp.mast);
+	free(dp.layers);
+	destroy_input(&in1);
+	destroy_input(&in2);
+	destroy_common_taxa(&taxa);
+	return result;
+}
+
+/* k binary trees. Leaves a, b and c agree on triplet ac|b IFF lca(a,c) is
+ * strictly below lca(a,b) in every tree. An agreement subtree rooted at the
+ * LCA of a and b, with a on the left and b on the right, has a left subtree
+ * whose leaves c all satisfy ac|b, and likewise on the right. So, with
+ * mast(a,b) the size of the largest such agreement subtree:
+ *
+ * 	mast(a,a) = 1
+ * 	mast(a,b) = max mast(a,c) + max mast(b,d)
+ *
+ * over c = a or ac|b, and d = b or bd|a. Pairs are visited by increasing
+ * size of their LCA's clade in the first tree, so the terms on the right are
+ * known. */
+
+struct k_tree_dp {
+	int n;
+	int count;
+	int *lca_depth;	/* count * n * n: depth of lca(a,b) in each tree */
+	int *mast;	/* n * n */
+	int *choice;	/* choice[a * n + b]: best c on a's side of (a,b) */
+	struct common_taxa *taxa;
+	int error;
+};
+
+static int agree_on_triplet(struct k_tree_dp *dp, int a, int c, int b)
+{
+	int n = dp->n, t;
+	for (t = 0; t < dp->count; t++) {
+		int *depth = dp->lca_depth + (size_t) t * n * n;
+		if (depth[a * n + c] <= depth[a * n + b]) return FALSE;
+	}
+	return TRUE;
+}
+
+/* Fills tree t's LCA depths, and (for the first tree) the number of common
+ * taxa in each pair's LCA clade. */
+
+static void fill_lca_depths(struct k_tree_dp *dp, struct mast_input *in,
+		int t, int *clade_size)
+{
+	int n = dp->n;
+	int *depth = dp->lca_depth + (size_t) t * n * n;
+	int *taxa_below = NULL;
+	int x, c1, c2, l1, l2;
+
+	if (NULL != clade_size) {
+		taxa_below = calloc(in->num_nodes, sizeof(int));
+		if (NULL == taxa_below) { dp->error = TRUE; return; }
+	}
+	for (x = 0; x < in->num_nodes; x++) {
+		if (NULL != taxa_below) {
+			if (in->taxon[x] >= 0) taxa_below[x] = 1;
+			for (c1 = in->first[x]; c1 < in->first[x+1]; c1++)
+				taxa_below[x] += taxa_below[in->child[c1]];
+		}
+		for (c1 = in->first[x]; c1 < in->first[x+1]; c1++) {
+			int k1 = in->child[c1];
+			for (c2 = c1 + 1; c2 < in->first[x+1]; c2++) {
+				int k2 = in->child[c2];
+				for (l1 = in->low[k1]; l1 <= k1; l1++) {
+					int a = in->taxon[l1];
+					if (a < 0) continue;
+					for (l2 = in->low[k2]; l2 <= k2; l2++) {
+						int b = in->taxon[l2];
+						if (b < 0) continue;
+						depth[a * n + b] = in->depth[x];
+						depth[b * n + a] = in->depth[x];
+						if (NULL == clade_size) continue;
+						clade_size[a * n + b] =
+							taxa_below[x];
+						clade_size[b * n + a] =
+							taxa_below[x];
+					}
+				}
+			}
+		}
+	}
+	free(taxa_below);
+}
+
+static void fill_k_tree_dp(struct k_tree_dp *dp, int *clade_size)
+{
+	int n = dp->n;
+	int *pairs = malloc(n * n * sizeof(int));
+	int *start = calloc(n + 2, sizeof(int));
+	int a, b, c, p, s;
+
+	if (NULL == pairs || NULL == start) {
+		free(pairs);
+		free(start);
+		dp->error = TRUE;
+		return;
+	}
+	/* counting sort of the pairs a < b by clade size (2..n) */
+	for (a = 0; a < n; a++)
+		for (b = a + 1; b < n; b++)
+			start[clade_size[a * n + b] + 1]++;
+	for (s = 1; s <= n + 1; s++) start[s] += start[s-1];
+	for (a = 0; a < n; a++)
+		for (b = a + 1; b < n; b++)
+			pairs[start[clade_size[a * n + b]]++] = a * n + b;
+
+	for (a = 0; a < n; a++) {
+		dp->mast[a * n + a] = 1;
+		dp->choice[a * n + a] = a;
+	}
+	for (p = 0; p < n * (n - 1) / 2; p++) {
+		int left, right, best_c, best_d;
+		a = pairs[p] / n;
+		b = pairs[p] % n;
+		left = 1; best_c = a;
+		right = 1; best_d = b;
+		for (c = 0; c < n; c++) {
+			if (c == a || c == b) continue;
+			if (dp->mast[a * n + c] > left &&
+					agree_on_triplet(dp, a, c, b)) {
+				left = dp->mast[a * n + c];
+				best_c = c;
+			}
+			if (dp->mast[b * n + c] > right &&
+					agree_on_triplet(dp, b, c, a)) {
+				right = dp->mast[b * n + c];
+				best_d = c;
+			}
+		}
+		dp->mast[a * n + b] = dp->mast[b * n + a] = left + right;
+		dp->choice[a * n + b] = best_c;
+		dp->choice[b * n + a] = best_d;
+	}
+
+	free(pairs);
+	free(start);
+}
+
+static struct rnode *build_k_tree_mast(struct k_tree_dp *dp, int a, int b)
+{
+	int n = dp->n;
+	struct rnode *node, *left, *right;
+
+	if (dp->error) return NULL;
+	if (a == b) {
+		node = create_mast_leaf(dp->taxa, a);
+		if (NULL == node) dp->error = TRUE;
+		return node;
+	}
+	node = create_rnode(NULL, NULL);
+	if (NULL == node) { dp->error = TRUE; return NULL; }
+	left = build_k_tree_mast(dp, a, dp->choice[a * n + b]);
+	right = build_k_tree_mast(dp, b, dp->choice[b * n + a]);
+	if (NULL == left || ! add_child(node, left)) dp->error = TRUE;
+	else if (NULL == right || ! add_child(node, right)) dp->error = TRUE;
+	return node;
+}
+
+enum mast_return mast_trees(struct rooted_tree **trees, int count,
+		struct rooted_tree **mast_ptr)
+{
+	struct common_taxa taxa;
+	struct k_tree_dp dp;
+	struct rnode *root;
+	int *clade_size;
+	enum mast_return result;
+	int n, t, a, b, best_a = 0, best_b = 0;
+
+	assert(count > 0);
+	result = find_common_taxa(trees, count, &taxa);
+	if (MAST_OK != result) { destroy_common_taxa(&taxa); return result; }
+	n = taxa.count;
+	if (0 == n) {
+		destroy_common_taxa(&taxa);
+		*mast_ptr = NULL;
+		return MAST_OK;
+	}
+
+	dp.n = n;
+	dp.count = count;
+	dp.taxa = &taxa;
+	dp.error = FALSE;
+	dp.lca_depth = malloc((size_t) count * n * n * sizeof(int));
+	dp.mast = calloc(n * n, sizeof(int));	/* 0: not computed yet */
+	dp.choice = malloc(n * n * sizeof(int));
+	clade_size = malloc(n * n * sizeof(int));
+	if (NULL == dp.lca_depth || NULL == dp.mast || NULL == dp.choice ||
+			NULL == clade_size)
+		dp.error = TRUE;
+
+	for (t = 0; t < count && ! dp.error; t++) {
+		struct mast_input in;
+		result = build_input(trees[t], &taxa, &in);
+		if (MAST_OK != result) break;
+		if (in.max_degree > 2) {
+			destroy_input(&in);
+			result = MAST_NOT_BINARY;
+			break;
+		}
+		fill_lca_depths(&dp, &in, t, 0 == t ? clade_size : NULL);
+		destroy_input(&in);
+	}
+	if (MAST_OK == result && ! dp.error)
+		fill_k_tree_dp(&dp, clade_size);
+
+	if (MAST_OK == result && ! dp.error) {
+		for (a = 0; a < n; a++)
+			for (b = a + 1; b < n; b++)
+				if (dp.mast[a * n + b] >
+					dp.mast[best_a * n + best_b]) {
+					best_a = a;
+					best_b = b;
+				}
+		root = build_k_tree_mast(&dp, best_a, best_b);
+		if (! dp.error) {
+			*mast_ptr = create_mast_tree(root);
+			if (NULL == *mast_ptr) dp.error = TRUE;
+		} else if (NULL != root) {
+			free_descendants(root);
+		}
+	}
+	if (MAST_OK == result && dp.error) result = MAST_MEM_ERROR;
+
+	free(dp.lca_depth);
+	free(dp.mast);
+	free(dp.choice);
+	free(clade_size);
+	destroy_common_taxa(&taxa);
+	return result;
+}
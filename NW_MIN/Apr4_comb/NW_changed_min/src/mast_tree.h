@@ -0,0 +1,63 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Exact maximum agreement subtree (MAST) of rooted trees. The MAST of a set of
+ * trees is a largest set of leaves on which all the trees have the same
+ * topology (once pruned to these leaves), together with that topology. Only
+ * leaves whose labels are found in every tree are considered. */
+
+struct rooted_tree;
+
+/* Error codes */
+
+enum mast_return {MAST_OK, MAST_DUP_LABEL, MAST_MEM_ERROR, MAST_DEGREE,
+	MAST_NOT_BINARY};
+
+/* Nodes with more children than this are not supported by mast_two_trees() */
+
+#define MAST_MAX_DEGREE 16
+
+/* Computes a MAST of 'tree1' and 'tree2', and stores it (as a new tree) in
+ * 'mast_ptr' - or NULL if the trees have no labels in common. The trees may
+ * have polytomies, of up to MAST_MAX_DEGREE children. This is the dynamic
+ * program of Steel and Warnow: O(n1 * n2) node pairs, each of which needs a
+ * matching between children. NOTE: clobbers node->data. */
+/* Returns MAST_OK, or an error code (in which case 'mast_ptr' is not set). */
+
+enum mast_return mast_two_trees(struct rooted_tree *tree1,
+		struct rooted_tree *tree2, struct rooted_tree **mast_ptr);
+
+/* Same as above, but for 'count' binary trees. This uses the triplets common
+ * to all the trees (Bryant's method), in O(count * n^3) time and O(count *
+ * n^2) space, where n is the number of common labels, so it is meant for small
+ * trees. NOTE: clobbers node->data. */
+/* Returns MAST_NOT_BINARY if a tree has a node with more than two children. */
+
+enum mast_return mast_trees(struct rooted_tree **trees, int count,
+		struct rooted_tree **mast_ptr);
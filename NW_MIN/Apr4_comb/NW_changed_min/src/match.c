@@ -1,6 +1,6 @@
 
 //Modified by Avinash Ramu, University of FLorida.
-//  Usage = ./nw_match seed_file tree_file freq
+//  Usage = ./nw_match [-oz] [-t seconds [-f seconds]] seed_file tree_file freq
 /* 
 
    Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
@@ -39,6 +39,9 @@
 #include <ctype.h>
 #include <assert.h>
 #include <time.h>
+#include <signal.h>
+#include <limits.h>
+#include <pthread.h>
 
 /*
   #include <assert.h>
@@ -54,19 +57,21 @@
 #include "list.h"
 #include "rnode.h"
 #include "link.h"
-#include "nodemap.h"
 #include "common.h"
 #include "rnode_iterator.h"
 #include "masprintf.h"
+#include "cluster_set.h"
+#include "label_table.h"
+#include "arena.h"
+#include "tree_index.h"
+#include "compressed_io.h"
+#include "parallel_parser.h"
+#include "output.h"
 
 #define LABEL_LENGTH 200
-#define TREE_COUNT 400
 #define MAST_LENGTH 20000
 #define SEED_COUNT 5000
 
-void newick_scanner_set_string_input(char *);
-void newick_scanner_clear_string_input();
-void newick_scanner_set_file_input(FILE *);
 
 struct parameters {
   char *pattern;
@@ -187,14 +192,16 @@ void show_node_children_numbers(struct rooted_tree *tree)
 struct rooted_tree *get_ordered_pattern_tree(char *pattern)
 {
   struct rooted_tree *pattern_tree;
-  newick_scanner_set_string_input(pattern);
-  pattern_tree = parse_tree();
+  struct newick_parser *parser = create_newick_string_parser(pattern);
+  if (NULL == parser) { perror(NULL); exit(EXIT_FAILURE); }
+  /* pattern trees are many, small and short-lived */
+  pattern_tree = parser_parse_tree_in_arena(parser);
   if (NULL == pattern_tree) {
     fprintf (stderr, "Could not parse pattern tree '%s'\n", pattern);
     printf("\nError4");
     exit(EXIT_FAILURE);
   }
-  newick_scanner_clear_string_input();
+  destroy_newick_parser(parser);
 
   if (!order_tree_lbl(pattern_tree)) { perror(NULL); exit(EXIT_FAILURE); }
 
@@ -204,20 +211,33 @@ struct rooted_tree *get_ordered_pattern_tree(char *pattern)
 struct rooted_tree *get_ordered_pattern_tree2(char *pattern)
 {
   struct rooted_tree *pattern_tree;
-  newick_scanner_set_string_input(pattern);
-  pattern_tree = parse_tree();
+  struct newick_parser *parser = create_newick_string_parser(pattern);
+  if (NULL == parser) { perror(NULL); exit(EXIT_FAILURE); }
+  /* pattern trees are many, small and short-lived */
+  pattern_tree = parser_parse_tree_in_arena(parser);
   if (NULL == pattern_tree) {
     fprintf (stderr, "Could not parse pattern tree '%s'\n", pattern);
     printf("\nError4");
     exit(EXIT_FAILURE);
   }
-  newick_scanner_clear_string_input();
+  destroy_newick_parser(parser);
 
   //if (!order_tree_lbl(pattern_tree)) { perror(NULL); exit(EXIT_FAILURE); }
 
   return pattern_tree;
 }
 
+/* Returns a zeroed array of label flags, one per interned label */
+char *create_label_flags()
+{
+  char *flags = calloc(label_table_size(), sizeof(char));
+  if (NULL == flags) {
+    fprintf(stderr, "Memory error -exiting.\n");
+    exit(EXIT_FAILURE);
+  }
+  return flags;
+}
+
 /* We only consider leaf labels. This might change if keeping internal labels
  * proves useful. */
 
@@ -228,26 +248,22 @@ void remove_inner_node_labels(struct rooted_tree *target_tree)
     {
       struct rnode *current = el->data;
       if (is_leaf(current)) continue;
-      free(current->label);
-      // We need to allocate dynamically, since this will later be
-      // passed to free().
-      current->label = strdup("");
+      set_rnode_label(current, "");
     }
 }
 
-/* Removes all nodes in target tree whose labels are not found in the 'kept'
- * hash */
+/* Removes all nodes in target tree whose labels are not flagged in 'kept'
+ * (indexed by label id) */
 
-void prune_extra_labels(struct rooted_tree *target_tree, struct hash *kept)
+void prune_extra_labels(struct rooted_tree *target_tree, const char *kept)
 {
   struct list_elem *el;
 
   for (el=target_tree->nodes_in_order->head; NULL != el; el=el->next) {
     struct rnode *current = el->data;
-    char *label = current->label;
-    if (0 == strcmp("", label)) continue;
+    if (EMPTY_LABEL_ID == current->label_id) continue;
     if (is_root(current)) continue;
-    if (NULL == hash_get(kept, current->label)) {
+    if (! kept[current->label_id]) {
       /* not in 'kept': remove */
       enum unlink_rnode_status result = unlink_rnode(current);
       switch(result) {
@@ -268,16 +284,15 @@ void prune_extra_labels(struct rooted_tree *target_tree, struct hash *kept)
       }
     }
   }
-
-  destroy_llist(target_tree->nodes_in_order);
-  target_tree->nodes_in_order = get_nodes_in_order(target_tree->root);
-  reset_current_child_elem(target_tree);
 }
 
 void prune_empty_labels(struct rooted_tree *target_tree)
 {
+  /* tree may have been modified: use its current post-order */
+  struct llist *nodes = tree_postorder(target_tree);
+  if (NULL == nodes) { perror(NULL); exit(EXIT_FAILURE); }
   struct list_elem *el;
-  for (el=target_tree->nodes_in_order->head; NULL != el; el=el->next) {
+  for (el = nodes->head; NULL != el; el = el->next) {
     struct rnode *current = el->data;
     char *label = current->label;
     if (is_leaf(current)) {
@@ -307,12 +322,14 @@ void prune_empty_labels(struct rooted_tree *target_tree)
 
 void remove_branch_lengths(struct rooted_tree *target_tree)
 {
+  struct llist *nodes = tree_postorder(target_tree);
+  if (NULL == nodes) { perror(NULL); exit(EXIT_FAILURE); }
   struct list_elem *el;
 
-  for (el = target_tree->nodes_in_order->head; NULL != el; el = el->next) {
+  for (el = nodes->head; NULL != el; el = el->next) {
     struct rnode *current = el->data;
     if (strcmp("", current->edge_length_as_string) != 0) {
-      free(current->edge_length_as_string);
+      arena_free(current->edge_length_as_string);
       // We need to allocate dynamically, since this will
       // later be passed to free():
       // WRONG! cur_edge->length_as_string = ""
@@ -323,12 +340,11 @@ void remove_branch_lengths(struct rooted_tree *target_tree)
 
 void remove_knee_nodes(struct rooted_tree *tree)
 {
-  /* tree was modified -> can't use its ordered node list */
-  struct llist *nodes_in_order = get_nodes_in_order(tree->root);
-  if (NULL == nodes_in_order) { perror(NULL); exit(EXIT_FAILURE); }
+  struct llist *nodes = tree_postorder(tree);
+  if (NULL == nodes) { perror(NULL); exit(EXIT_FAILURE); }
   struct list_elem *el;
 
-  for (el = nodes_in_order->head; NULL != el; el = el->next) {
+  for (el = nodes->head; NULL != el; el = el->next) {
     struct rnode *current = el->data;
     if (is_inner_node(current))
       if (1 == children_count(current))
@@ -337,7 +353,6 @@ void remove_knee_nodes(struct rooted_tree *tree)
 	  exit(EXIT_FAILURE);
 	}
   }
-  destroy_llist(nodes_in_order);
 
   /* If the root has only one child, make that child the new root */
   if (1 == children_count(tree->root)) {
@@ -346,14 +361,13 @@ void remove_knee_nodes(struct rooted_tree *tree)
   }
 }
 
-int process_tree(struct rooted_tree *tree, struct hash *pattern_labels,
+int process_tree(struct rooted_tree *tree, const char *pattern_labels,
 		 char *pattern_newick)
 {
-  /* NOTE: whenever I alter the tree structure, I rebuild nodes_in_order
-   * as soon as possible. Then I no longer need to guard against this
-   * list being invalid. WARNING: I did this just enough to make all
-   * tests pass, NOT systemytically after each tree-function call. It may
-   * be necessary to do it more thoroughly later on. */
+  /* NOTE: nodes_in_order keeps all the parsed nodes (they are free()d
+   * through it), but once the tree is pruned it no longer reflects the
+   * structure. Steps that need the current nodes use tree_postorder(),
+   * which is recomputed only after the structure has changed. */
   char *original_newick = to_newick(tree->root);
   //printf ("%s = original newick\n", original_newick);
   remove_inner_node_labels(tree);
@@ -379,125 +393,96 @@ int match_pattern(char* target, char* pattern)
   struct rooted_tree *pattern_tree;	
   struct rooted_tree *tree;	
   char   *pattern_newick;
-  struct hash *pattern_labels;
+  char *pattern_labels;
+  struct list_elem *el;
   pattern_tree = get_ordered_pattern_tree(pattern);
   pattern_newick = to_newick(pattern_tree->root);
-  pattern_labels = create_label2node_map(pattern_tree->nodes_in_order);
   tree = get_ordered_pattern_tree2(target);
-  struct llist *original_nodes_in_order = shallow_copy(tree->nodes_in_order);
-  /* No nodes are free()d in here... */
-  int match = process_tree(tree, pattern_labels, pattern_newick);
-  /* Now we free the original nodes */
-  struct list_elem *el = original_nodes_in_order->head;
-  for (; NULL != el; el = el->next) {
+  /* after parsing the target, so that all its labels have ids */
+  pattern_labels = create_label_flags();
+  for (el = pattern_tree->nodes_in_order->head; NULL != el; el = el->next) {
     struct rnode *current = el->data;
-    destroy_rnode(current, NULL);
+    pattern_labels[current->label_id] = TRUE;
   }
-  destroy_llist(original_nodes_in_order);
-  destroy_llist(tree->nodes_in_order);
-  free(tree);
-  destroy_hash(pattern_labels);
+  pattern_labels[EMPTY_LABEL_ID] = FALSE;
+  /* No nodes are free()d in here, and nodes_in_order is left alone */
+  int match = process_tree(tree, pattern_labels, pattern_newick);
+  destroy_tree_cb_2(tree, NULL);
+  free(pattern_labels);
   free(pattern_newick);
   destroy_tree_cb_2(pattern_tree, NULL);
   return match;
 }
 
 
-int parse_labels(struct rooted_tree *tree, char label_list[1000][200])
+/* Flags (by label id) the labels of the tree's leaves. 'flags' must have
+ * room for label_table_size() entries. Returns the number of labeled
+ * leaves. */
+int flag_leaf_labels(struct rooted_tree *tree, char *flags)
 {
-	
   struct list_elem *elem;
-  int first_line = 1;
   int i = 0;
   for (elem = tree->nodes_in_order->head; NULL != elem; elem = elem->next) 
     {
       struct rnode *current = (struct rnode *) elem->data;
-      char *label = current->label;
-      if (strcmp("", label) == 0)
+      if (EMPTY_LABEL_ID == current->label_id)
 	continue;
       if (is_leaf(current)) 
 	{
-	  //printf("\nHello!!");
-	  //if (! first_line) putchar(' ');
-	  //printf ("%s", label);
-	  strcpy(label_list[i++],label);			
-	  //if (first_line) first_line = 0;			
+	  flags[current->label_id] = TRUE;
+	  i++;
 	} 
-		
     }
   return i;
-  //putchar('\n');
-	
 }
 
-
-struct llist *reverse_labels(struct rooted_tree *tree, struct llist *labels)
+/* Produces a new list with all labels in the tree that are NOT flagged. */
+struct llist *reverse_labels(struct rooted_tree *tree, const char *flags)
 {
   struct llist *rev_labels = create_llist();
-  /* We use a hash for looking up labels, instead of going over the list
-   * of labels every time (see below) */
-  struct hash *labels_h = create_hash(labels->count);
-  if (NULL == labels_h) {
+  if (NULL == rev_labels) {
     fprintf(stderr, "Memory error -exiting.\n");
     exit(EXIT_FAILURE);
   }
 
   struct list_elem *elem;
 
-  /* fill label hash with the labels */
-  char *PRESENT = "present";
-  for (elem = labels->head; NULL != elem; elem = elem->next) {
-    char *label = elem->data;
-    if (! hash_set(labels_h, label, PRESENT)) {
-      fprintf(stderr, "Memory error -exiting.\n");
-      exit(EXIT_FAILURE);
-    }
-  }
-
-  /* Now iterate over all nodes in the tree and see if their labels are
-   * found in the labels hash. If not, add them to the 'rev_labels' list.
-   * */
   for (elem=tree->nodes_in_order->head; NULL!=elem; elem=elem->next) {
-    char *label = ((struct rnode*) elem->data)->label;
-    if (0 == strcmp("", label)) continue;
-    if (NULL == hash_get(labels_h, label)) {
-      if (! append_element(rev_labels, label)) {
+    struct rnode *current = elem->data;
+    if (EMPTY_LABEL_ID == current->label_id) continue;
+    if (! flags[current->label_id]) {
+      if (! append_element(rev_labels, current->label)) {
 	fprintf(stderr, "Memory error -exiting.\n");
 	exit(EXIT_FAILURE);
       }
     }
   }
-  destroy_hash(labels_h);
 
   return rev_labels;
 }
 
-/* Create a linked list of labels from an array of char pointers */
-struct llist* create_label_list(char argv[1000][200], int label_count)
-{               
-  struct llist *lbl_list = create_llist();
-  if (NULL == lbl_list) { perror(NULL); exit(EXIT_FAILURE); }
-  int i;
-  for (i =0; i< label_count; i++) 
-    {
-      if (! append_element(lbl_list, argv[i])) 
-	{
-	  perror(NULL);
-	  exit(EXIT_FAILURE);
-	}
-    }
-  return lbl_list;
-}
-
 /* prune a patternparams from a tree, pass the pattern as a linked list of labels */
 char* prune_tree(struct rooted_tree *tree, struct llist *labels)
 {
-  struct hash *lbl2node_map = create_label2node_map(tree->nodes_in_order);
+  /* label id -> node; the last node wins if a label occurs more than once */
+  struct rnode **lbl2node_map = calloc(label_table_size(),
+				       sizeof(struct rnode *));
   struct list_elem *elem;
 
+  if (NULL == lbl2node_map) {
+    fprintf (stderr, "Memory error - exiting.\n");
+    exit(EXIT_FAILURE);
+  }
+  for (elem = tree->nodes_in_order->head; NULL != elem; elem = elem->next) {
+    struct rnode *current = elem->data;
+    if (EMPTY_LABEL_ID != current->label_id)
+      lbl2node_map[current->label_id] = current;
+  }
+
   for (elem = labels->head; NULL != elem; elem = elem->next) {
     char *label = elem->data;
-    struct rnode *goner = hash_get(lbl2node_map, label);
+    int id = find_label(label);
+    struct rnode *goner = id < 0 ? NULL : lbl2node_map[id];
     if (NULL == goner) {
       fprintf (stderr, "WARNING: label '%s' not found.\n",
 	       label);
@@ -522,7 +507,7 @@ char* prune_tree(struct rooted_tree *tree, struct llist *labels)
     }
   }
 
-  destroy_hash(lbl2node_map);
+  free(lbl2node_map);
   char* pruned_tree = to_newick(tree->root);
   return pruned_tree;
 }
@@ -530,87 +515,462 @@ char* prune_tree(struct rooted_tree *tree, struct llist *labels)
 /* Overlap b/w 2 label sets */
 int overlap_labels(char*  seed1, char* seed2)
 {
-  int i, j, overlap= 0;
-	
-  /*char** label_set1;
-    label_set1 = (char**) malloc(sizeof(char*) * 1000);
-    for(i=0; i<1000; i++)
-    {
-    label_set1[i] = (char*) malloc(sizeof(char) * LABEL_LENGTH);	    
-    }
-	
-    char** label_set2;
-    label_set2 = (char**) malloc(sizeof(char*) * 1000);
-    for(i=0; i<1000; i++)
-    {
-    label_set2[i] = (char*) malloc(sizeof(char) * LABEL_LENGTH);	    
-    }*/
-	  
-  char label_set1[1000][200];
-  char label_set2[1000][200];
-  int lc1, lc2;
-	
-		
   struct rooted_tree *seed1_tree = get_ordered_pattern_tree(seed1);
   struct rooted_tree *seed2_tree = get_ordered_pattern_tree(seed2);
-	
-	
-  lc1 = parse_labels(seed1_tree, label_set1);
-  lc2 = parse_labels(seed2_tree, label_set2);
-		
-  //printf("\nlc1 = %d lc2 = %d",lc1, lc2);
-  for(i=0; i<lc1; i++)
-    {
-      for(j=0; j<lc2; j++)
-	{
-	  //printf("\n%s",label_set2[j]);
-	  if(strcmp(label_set1[i], label_set2[j]) == 0)
-	    {
-	      overlap++;
-	      break;	            
-	    }
-	}
-    }
-  /*for(i=0; i<1000; i++)
+  char *in_seed2 = create_label_flags();
+  struct list_elem *elem;
+  int overlap = 0;
+
+  flag_leaf_labels(seed2_tree, in_seed2);
+  for (elem = seed1_tree->nodes_in_order->head; NULL != elem;
+       elem = elem->next)
     {
-    free(label_set1[i]);
-    free(label_set2[i]);
+      struct rnode *current = elem->data;
+      if (EMPTY_LABEL_ID == current->label_id || ! is_leaf(current))
+	continue;
+      if (in_seed2[current->label_id])
+	overlap++;
     }
-    free(label_set1);
-    free(label_set2);*/
+  free(in_seed2);
   destroy_tree_cb_2(seed1_tree, NULL);
   destroy_tree_cb_2(seed2_tree, NULL);
-  //free(seed1_tree);
-  //free(seed2_tree);
   return overlap;
 }
 
 char* prune(char* tree, char* MAST, char* seed)
 {
-  int MAST_lc, seed_lc;
-  char labels[1000][200];
-  char combined_labels[1000][200];
-  int mast_lcnt, seed_lcnt, combined_lc =0;
   struct rooted_tree *current_tree = get_ordered_pattern_tree(tree);
   struct rooted_tree *MAST_tree = get_ordered_pattern_tree(MAST);              
-  MAST_lc = parse_labels(MAST_tree, labels);  		      
-  for(mast_lcnt=0; mast_lcnt<MAST_lc; mast_lcnt++)
-    strcpy(combined_labels[combined_lc++], labels[mast_lcnt]); 		      
   struct rooted_tree *seed_tree = get_ordered_pattern_tree(seed);    		                
-  seed_lc = parse_labels(seed_tree, labels);   
-  for(seed_lcnt=0; seed_lcnt<seed_lc; seed_lcnt++)
-    strcpy(combined_labels[combined_lc++], labels[seed_lcnt]);
-  struct llist* combined_ll = create_label_list(combined_labels, combined_lc); 
-  struct llist* rev_combined_labels = reverse_labels(current_tree,combined_ll);
+  /* parsed last, so that all three trees' labels have ids */
+  char *combined_labels = create_label_flags();
+  flag_leaf_labels(MAST_tree, combined_labels);
+  flag_leaf_labels(seed_tree, combined_labels);
+  struct llist* rev_combined_labels = reverse_labels(current_tree,
+						     combined_labels);
   char* new_MAST = prune_tree(current_tree, rev_combined_labels);
   destroy_tree_cb_2(current_tree, NULL);
   destroy_tree_cb_2(MAST_tree, NULL);
   destroy_tree_cb_2(seed_tree, NULL);
-  destroy_llist(combined_ll);
+  free(combined_labels);
   destroy_llist(rev_combined_labels);
   return new_MAST;
 }
 
+/* Cluster-based presence test (see cluster_set.h). A seed or MAST is present
+ * in a tree IFF the tree, pruned to the seed's taxa, has the same clusters as
+ * the seed. This is what match_pattern() checks, without parsing and pruning
+ * the tree again for each test. It only holds for plain topologies, though:
+ * match_pattern() never matches patterns with inner labels, branch lengths or
+ * knees, so for such input we stick to match_pattern(). */
+
+int plain_topology(struct rooted_tree *tree)
+{
+  struct list_elem *el;
+  for (el = tree->nodes_in_order->head; NULL != el; el = el->next) {
+    struct rnode *current = el->data;
+    if (0 != strcmp("", current->edge_length_as_string)) return FALSE;
+    if (is_leaf(current)) {
+      if (0 == strcmp("", current->label)) return FALSE;
+    } else {
+      if (0 != strcmp("", current->label)) return FALSE;
+      if (1 == children_count(current)) return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/* Computes the clusters of the trees, then of the seeds, in a single array
+ * (trees first). Returns NULL if any of them is not a plain topology, or has
+ * duplicate labels. */
+
+struct tree_clusters **input_clusters(char **trees_array, int treecount,
+				      char **seeds_array, int seedcount)
+{
+  int count = treecount + seedcount;
+  struct rooted_tree **parsed = malloc(count * sizeof(struct rooted_tree *));
+  struct tree_clusters **clusters = malloc(count * sizeof(struct tree_clusters *));
+  struct taxon_index *taxa = create_taxon_index(SEED_COUNT);
+  if (NULL == parsed || NULL == clusters || NULL == taxa)
+    { perror(NULL); exit(EXIT_FAILURE); }
+  int n, plain = TRUE;
+
+  /* all taxa must be numbered before we can build any taxon set */
+  for (n = 0; n < count; n++) {
+    char *newick = n < treecount ? trees_array[n] : seeds_array[n - treecount];
+    parsed[n] = get_ordered_pattern_tree2(newick);
+    if (! plain_topology(parsed[n])) plain = FALSE;
+    if (! taxon_index_add_tree(taxa, parsed[n]))
+      { perror(NULL); exit(EXIT_FAILURE); }
+  }
+  for (n = 0; n < count; n++) {
+    clusters[n] = NULL;
+    if (plain) {
+      clusters[n] = create_tree_clusters(parsed[n], taxa);
+      if (NULL == clusters[n]) { perror(NULL); exit(EXIT_FAILURE); }
+      if (taxon_set_count(clusters[n]->leaves, clusters[n]->num_words)
+	  != leaf_count(parsed[n]))
+	plain = FALSE;
+    }
+    destroy_tree(parsed[n], FALSE);
+  }
+  free(parsed);
+  destroy_taxon_index(taxa);
+
+  if (! plain) {
+    for (n = 0; n < count; n++)
+      if (NULL != clusters[n]) destroy_tree_clusters(clusters[n]);
+    free(clusters);
+    return NULL;
+  }
+  return clusters;
+}
+
+/* Returns tree 'tree_id' restricted to 'taxa'. Restrictions are cached in
+ * 'restrictions' until 'stamp' changes, i.e. until the candidate taxa do. */
+
+struct cluster_restriction *restricted_tree(struct tree_clusters **clusters,
+					    struct cluster_restriction **restrictions,
+					    int *stamps, int stamp, int tree_id,
+					    cluster_word *taxa)
+{
+  if (stamps[tree_id] != stamp) {
+    restrict_clusters(clusters[tree_id], taxa, restrictions[tree_id]);
+    stamps[tree_id] = stamp;
+  }
+  return restrictions[tree_id];
+}
+
+/* State memoization for the greedy MAST search. The greedy loop for an outer
+ * seed is fully determined by the current MAST (up to child order) and the
+ * index of the next candidate seed, since the set of trees where the MAST is
+ * present is just the set of trees that display it. Different outer seeds
+ * often converge on the same intermediate MAST, so we remember the final MAST
+ * reached from each expanded state and reuse it. */
+
+/* Returns the MAST's Newick with children ordered by label, so that MASTs
+ * that differ only by child order get the same string. Allocates storage. */
+
+char *canonical_mast(char *mast)
+{
+  struct rooted_tree *mast_tree = get_ordered_pattern_tree(mast);
+  char *canonical = to_newick(mast_tree->root);
+  if (NULL == canonical) { perror(NULL); exit(EXIT_FAILURE); }
+  destroy_tree_cb_2(mast_tree, NULL);
+  return canonical;
+}
+
+/* Returns the memo key for the state (MAST, next candidate seed index).
+ * Allocates storage. */
+
+char *mast_state_key(char *mast, int next_seed)
+{
+  char *canonical = canonical_mast(mast);
+  char *key = masprintf("%d %s", next_seed, canonical);
+  if (NULL == key) { perror(NULL); exit(EXIT_FAILURE); }
+  free(canonical);
+  return key;
+}
+
+/* Looks up the state in the memo table. On a hit, copies the final MAST
+ * into 'mast' and returns TRUE. On a miss, records the state's key in
+ * 'pending' (so that it can be resolved once the outer seed is done) and
+ * returns FALSE. */
+
+int mast_state_lookup(struct hash *memo, struct llist *pending, char *mast,
+		      int next_seed)
+{
+  char *key = mast_state_key(mast, next_seed);
+  char *final_mast = hash_get(memo, key);
+  if (NULL != final_mast) {
+    strcpy(mast, final_mast);
+    free(key);
+    return TRUE;
+  }
+  if (! append_element(pending, key)) { perror(NULL); exit(EXIT_FAILURE); }
+  return FALSE;
+}
+
+/* Maps all states expanded for the current outer seed to its final MAST, and
+ * empties the 'pending' list. */
+
+void mast_state_resolve(struct hash *memo, struct llist *pending,
+			char *final_mast)
+{
+  struct list_elem *el;
+  for (el = pending->head; NULL != el; el = el->next) {
+    char *key = el->data;
+    char *copy = strdup(final_mast);
+    if (NULL == copy) { perror(NULL); exit(EXIT_FAILURE); }
+    if (! hash_set(memo, key, copy)) { perror(NULL); exit(EXIT_FAILURE); }
+    free(key);
+  }
+  clear_llist(pending);
+}
+
+void destroy_mast_memo(struct hash *memo)
+{
+  struct llist *keys = hash_keys(memo);
+  if (NULL == keys) { perror(NULL); exit(EXIT_FAILURE); }
+  struct list_elem *el;
+  for (el = keys->head; NULL != el; el = el->next)
+    free(hash_get(memo, el->data));
+  destroy_llist(keys);
+  destroy_hash(memo);
+}
+
+/* Deadline ("anytime") mode. Outer seeds are visited by decreasing frequency,
+ * the largest MAST found so far is kept, and it is periodically written out
+ * together with progress counters, so that a run that is stopped by the
+ * deadline (or killed by the scheduler) still leaves a usable answer. */
+
+static volatile sig_atomic_t stop_requested = FALSE;
+
+void request_stop(int signum)
+{
+  signum = signum;	/* suppresses warning about unused signum */
+  stop_requested = TRUE;
+}
+
+/* Returns true IFF the search should stop, i.e. the deadline has passed or
+ * we were asked to stop. A deadline of 0 means no deadline. */
+
+int out_of_time(time_t deadline)
+{
+  if (stop_requested) return TRUE;
+  return (0 != deadline && time(NULL) >= deadline);
+}
+
+/* Fills 'order' with the seed indexes, by decreasing frequency (ties are
+ * broken by seed index). Seeds without a frequency count as 0. */
+
+void seeds_by_frequency(int *order, int seedcount, int *freq_array,
+			int freqcount)
+{
+  int i, j;
+  for (i = 0; i < seedcount; i++) {
+    int freq_i = i < freqcount ? freq_array[i] : 0;
+    /* insertion sort: there are at most SEED_COUNT seeds, and it is done
+     * only once */
+    for (j = i; j > 0; j--) {
+      int prev = order[j-1];
+      int freq_prev = prev < freqcount ? freq_array[prev] : 0;
+      if (freq_prev >= freq_i) break;
+      order[j] = prev;
+    }
+    order[j] = i;
+  }
+}
+
+/* Seed co-occurrence: entry (i, k) is the number of trees that contain both
+ * seeds i and k. A MAST is only present in trees that contain all of its seeds,
+ * so the trees where the MAST and seed k are both present are at most the
+ * smallest entry (s, k) over the MAST's seeds s - if that is not above the
+ * cutoff, seed k need not be tried. The presence matrix's rows are packed as
+ * bit sets. Only ordering candidates needs the whole matrix (SEED_COUNT^2
+ * ints): its product is computed by blocks of SEED_BLOCK rows, which are
+ * shared out among one thread per processor. Otherwise, the rows of the outer
+ * and added seeds are computed as they are needed. */
+
+#define SEED_BLOCK 64
+
+struct seed_cooccurrence {
+  cluster_word *rows;		/* the seeds' trees, as bit sets */
+  int num_words;
+  int seedcount;
+  int *matrix;			/* NULL unless computed in full */
+};
+
+struct cooccurrence_job {
+  struct seed_cooccurrence *co;
+  int next_block;		/* the first row of the next block to do */
+  pthread_mutex_t lock;
+};
+
+/* Computes each (a, b) with a in the block starting at row 'block', and b >= a;
+ * and fills in (b, a) as well. */
+
+static void cooccurrence_block(struct seed_cooccurrence *co, int block)
+{
+  int seedcount = co->seedcount, num_words = co->num_words;
+  int bj, a, b;
+  int a_end = block + SEED_BLOCK < seedcount ? block + SEED_BLOCK : seedcount;
+  for (bj = block; bj < seedcount; bj += SEED_BLOCK) {
+    int b_end = bj + SEED_BLOCK < seedcount ? bj + SEED_BLOCK : seedcount;
+    for (a = block; a < a_end; a++)
+      for (b = a > bj ? a : bj; b < b_end; b++) {
+	int common = taxon_set_common_count(co->rows + (size_t) a * num_words,
+					    co->rows + (size_t) b * num_words,
+					    num_words);
+	co->matrix[a * seedcount + b] = common;
+	co->matrix[b * seedcount + a] = common;
+      }
+  }
+}
+
+/* Does blocks until there are none left. The first blocks are the largest
+ * (they go to the end of the matrix), so handing them out in order keeps the
+ * threads busy until about the same time. */
+
+static void *cooccurrence_worker(void *arg)
+{
+  struct cooccurrence_job *job = arg;
+  for (;;) {
+    int block;
+    pthread_mutex_lock(&job->lock);
+    block = job->next_block;
+    job->next_block += SEED_BLOCK;
+    pthread_mutex_unlock(&job->lock);
+    if (block >= job->co->seedcount) break;
+    cooccurrence_block(job->co, block);
+  }
+  return NULL;
+}
+
+static void cooccurrence_matrix(struct seed_cooccurrence *co)
+{
+  struct cooccurrence_job job;
+  int num_blocks = (co->seedcount + SEED_BLOCK - 1) / SEED_BLOCK;
+  int num_threads = num_processors();
+  pthread_t *threads;
+  int i, started = 0;
+
+  co->matrix = malloc(sizeof(int) * co->seedcount * co->seedcount);
+  if (num_threads > num_blocks) num_threads = num_blocks;
+  threads = malloc(sizeof(pthread_t) * (num_threads + 1));
+  if (NULL == co->matrix || NULL == threads)
+    { perror(NULL); exit(EXIT_FAILURE); }
+  job.co = co;
+  job.next_block = 0;
+  pthread_mutex_init(&job.lock, NULL);
+
+  /* this thread is one of the workers; if a thread cannot be started, the
+   * others do its share */
+  for (i = 1; i < num_threads; i++)
+    if (0 == pthread_create(threads + started, NULL, cooccurrence_worker,
+			    &job))
+      started++;
+  cooccurrence_worker(&job);
+  for (i = 0; i < started; i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_mutex_destroy(&job.lock);
+  free(threads);
+}
+
+/* Packs the seeds' presence in the trees; with 'full', also computes the whole
+ * matrix */
+
+struct seed_cooccurrence *create_seed_cooccurrence(int **seeds_trees,
+						   int seedcount,
+						   int treecount, int full)
+{
+  struct seed_cooccurrence *co = malloc(sizeof(struct seed_cooccurrence));
+  int i, j;
+
+  if (NULL == co) { perror(NULL); exit(EXIT_FAILURE); }
+  co->num_words = (treecount + CHAR_BIT * sizeof(cluster_word) - 1)
+    / (CHAR_BIT * sizeof(cluster_word));
+  co->rows = calloc((size_t) seedcount * co->num_words + 1,
+		    sizeof(cluster_word));
+  co->seedcount = seedcount;
+  co->matrix = NULL;
+  if (NULL == co->rows) { perror(NULL); exit(EXIT_FAILURE); }
+
+  for (i = 0; i < seedcount; i++)
+    for (j = 0; j < treecount; j++)
+      if (seeds_trees[i][j])
+	taxon_set_add(co->rows + (size_t) i * co->num_words, j);
+
+  if (full) cooccurrence_matrix(co);
+  return co;
+}
+
+/* Fills 'row' with row 's' of the matrix, computing it if need be */
+
+void seed_cooccurrence_row(struct seed_cooccurrence *co, int s, int *row)
+{
+  const cluster_word *row_s = co->rows + (size_t) s * co->num_words;
+  int k;
+
+  if (NULL != co->matrix) {
+    memcpy(row, co->matrix + s * co->seedcount, sizeof(int) * co->seedcount);
+    return;
+  }
+  for (k = 0; k < co->seedcount; k++)
+    row[k] = taxon_set_common_count(row_s,
+				    co->rows + (size_t) k * co->num_words,
+				    co->num_words);
+}
+
+void destroy_seed_cooccurrence(struct seed_cooccurrence *co)
+{
+  free(co->matrix);
+  free(co->rows);
+  free(co);
+}
+
+struct candidate {
+  int cooccurrence;
+  int seed;
+};
+
+static int candidate_comparator(const void *a, const void *b)
+{
+  const struct candidate *ca = a, *cb = b;
+  if (ca->cooccurrence != cb->cooccurrence)
+    return cb->cooccurrence - ca->cooccurrence;
+  return ca->seed - cb->seed;
+}
+
+/* Fills 'order' with all seeds, by decreasing co-occurrence with seed 'outer'
+ * (ties in file order). */
+
+void candidates_by_cooccurrence(int *order, int outer, int *cooccurrence,
+				int seedcount)
+{
+  struct candidate *candidates = malloc(sizeof(struct candidate) * seedcount);
+  int k;
+  if (NULL == candidates) { perror(NULL); exit(EXIT_FAILURE); }
+  for (k = 0; k < seedcount; k++) {
+    candidates[k].cooccurrence = cooccurrence[outer * seedcount + k];
+    candidates[k].seed = k;
+  }
+  qsort(candidates, seedcount, sizeof(struct candidate), candidate_comparator);
+  for (k = 0; k < seedcount; k++)
+    order[k] = candidates[k].seed;
+  free(candidates);
+}
+
+int mast_leaf_count(char *mast)
+{
+  struct rooted_tree *mast_tree = get_ordered_pattern_tree2(mast);
+  int count = leaf_count(mast_tree);
+  destroy_tree_cb_2(mast_tree, NULL);
+  return count;
+}
+
+/* Writes the best MAST so far and progress counters to 'best_file'. The file
+ * is written under a temporary name and then renamed, so that it is always
+ * complete even if we are killed while writing. */
+
+void flush_best_mast(char *best_file, char *best_mast, int best_leaves,
+		     int best_seed, int covered, int seedcount, time_t start)
+{
+  char *tmp_file = masprintf("%s.tmp", best_file);
+  if (NULL == tmp_file) { perror(NULL); exit(EXIT_FAILURE); }
+  FILE *out = fopen(tmp_file, "w");
+  if (NULL == out) { perror(tmp_file); exit(EXIT_FAILURE); }
+  fprintf(out, "# outer seeds covered: %d of %d\n", covered, seedcount);
+  fprintf(out, "# elapsed: %ld s\n", (long) (time(NULL) - start));
+  fprintf(out, "# best MAST: %d leaves (outer seed %d)\n", best_leaves,
+	  best_seed);
+  fprintf(out, "%.*s\n", (int) strcspn(best_mast, "\n"), best_mast);
+  fclose(out);
+  if (0 != rename(tmp_file, best_file)) { perror(best_file); exit(EXIT_FAILURE); }
+  free(tmp_file);
+}
+
 
 
 int old_main(int argc, char *argv[])
@@ -635,26 +995,120 @@ int old_main(int argc, char *argv[])
   //prune code.
   /*struct rooted_tree *tree = get_ordered_pattern_tree(tree2);
   struct rooted_tree *subtree = get_ordered_pattern_tree(subtree2);
-  char subtree_labels[1000][200];
-  char tree_labels[1000][100];
-  int label_count1, label_count2;
-  label_count2 = parse_labels(subtree, subtree_labels);
-  struct llist* subtree_ll = create_label_list(subtree_labels, label_count2);
-  struct llist *rev_labels = reverse_labels(tree,subtree_ll);
+  char *subtree_labels = create_label_flags();
+  flag_leaf_labels(subtree, subtree_labels);
+  struct llist *rev_labels = reverse_labels(tree,subtree_labels);
   char* pruned_tree = prune_tree(tree, rev_labels);
   printf("\nPruned Tree = %s",pruned_tree);
   free(pruned_tree);
   printf("\n");
   destroy_tree_cb_2(tree, NULL);
   destroy_tree_cb_2(subtree, NULL);
-  destroy_llist(subtree_ll);
+  free(subtree_labels);
   destroy_llist(rev_labels);*/	
   return 0;
 }
 
 
+/* Reads all of 'input'. Returns NULL in case of error (I/O, malloc()). */
+
+static char *read_whole_stream(FILE *input, size_t *length)
+{
+  size_t capacity = 1 << 16;
+  size_t num_read;
+  char *text = malloc(capacity);
+  *length = 0;
+  if (NULL == text) return NULL;
+  while (0 < (num_read = fread(text + *length, 1, capacity - *length, input)))
+    {
+      *length += num_read;
+      if (*length == capacity)
+	{
+	  char *larger = realloc(text, 2 * capacity);
+	  if (NULL == larger) { free(text); return NULL; }
+	  text = larger;
+	  capacity *= 2;
+	}
+    }
+  if (ferror(input)) { free(text); return NULL; }
+  return text;
+}
+
+/* Reads the trees of file 'tree_file', opened as 'input' (see
+   open_input_file()), into an array of strings, and sets 'treecount'. A plain
+   file is read through its index (saved as <tree file>.nwi, so later runs on
+   the same file skip the scan); a compressed one is decompressed whole and
+   indexed in memory. Returns NULL in case of error. */
+
+static char **read_trees(FILE *input, const char *tree_file, int *treecount)
+{
+  struct tree_index *tree_index;
+  char *text = NULL;
+  size_t text_length;
+  char **trees_array;
+  int n;
+
+  if (-1 != fileno(input))	/* not decompressing */
+    tree_index = get_tree_index(tree_file);
+  else
+    {
+      text = read_whole_stream(input, &text_length);
+      if (NULL == text) return NULL;
+      tree_index = index_tree_text(text, text_length);
+    }
+  if (NULL == tree_index) { free(text); return NULL; }
+  trees_array = malloc(tree_index->num_trees * sizeof (char *));
+  if (NULL == trees_array) { perror(NULL); exit(EXIT_FAILURE); }
+  for (n = 0; n < tree_index->num_trees; n++)
+    {
+      if (NULL == text)
+	trees_array[n] = read_tree_text(input, tree_index, n);
+      else
+	trees_array[n] = strndup(text + tree_index->offset[n],
+				 tree_index->length[n]);
+      if (NULL == trees_array[n]) { perror(NULL); exit(EXIT_FAILURE); }
+    }
+  *treecount = tree_index->num_trees;
+  destroy_tree_index(tree_index);
+  free(text);
+  return trees_array;
+}
+
 int main(int argc, char* argv[])
 {
+  int opt_char;
+  time_t time_limit = 0;	/* seconds, 0 = no deadline */
+  time_t flush_interval = 60;	/* seconds between writes of the best MAST */
+  int order_candidates = FALSE;	/* by co-occurrence, instead of file order */
+  int compress_output = FALSE;	/* gzip the MAST file, as <name>_OP.gz */
+  buffer_stdout();
+  while ((opt_char = getopt(argc, argv, "f:ot:z")) != -1) {
+    switch (opt_char) {
+    case 'f':
+      flush_interval = atoi(optarg);
+      break;
+    case 'o':
+      order_candidates = TRUE;
+      break;
+    case 't':
+      time_limit = atoi(optarg);
+      break;
+    case 'z':
+      compress_output = TRUE;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-oz] [-t seconds [-f seconds]] <seed file> "
+	      "<tree file> <frequency>\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if(argc - optind != 3)
+    {
+      printf("Insufficient Arguments ! Exiting! \n");
+      exit(1);
+    }	 
+  argv += optind - 1;
+  argc -= optind - 1;
   char  *seed_file = argv[1];
   char *tree_file = argv[2];
   char opfile[100];
@@ -666,7 +1120,7 @@ int main(int argc, char* argv[])
   int frequency = atoi(argv[3]);
   printf("\nThe frequency entered is %d", frequency);
   char** seeds_array = malloc(SEED_COUNT * sizeof (char *));
-  char** trees_array = malloc(TREE_COUNT * sizeof (char *));
+  char** trees_array = NULL;
   int freq_array[SEED_COUNT];
   int cutoff;
   int k;
@@ -676,20 +1130,13 @@ int main(int argc, char* argv[])
     // seeds_array[k] = (char*) malloc(sizeof (char) * 10000);
   }
   char* seed = (char*) malloc(30000);
-  char* tree = (char*) malloc(50000);
   int seedcount =0;
   int treecount =0;
   int freqcount = 0;  
-  
-  if(argc!= 4)
-    {
-      printf("Insufficient Arguments ! Exiting! \n");
-      exit(1);
-    }	 
     
   FILE *fp;  
   printf("\nSeed file is %s",seed_file);
-  fp=fopen(seed_file, "r");  
+  fp=open_input_file(seed_file);  
   if(fp == NULL )
     {perror("\nError opening seed file\n");exit(1);}
   else
@@ -714,19 +1161,15 @@ int main(int argc, char* argv[])
   //}     
    
   printf("\nTree file is %s",tree_file);
-  fp=fopen(tree_file, "r");  
-  if(fp == NULL )
+  /* Trees are located through the file's index (saved as <tree file>.nwi, so
+     later runs on the same file skip the scan), which also sizes trees_array
+     and allows trees longer than a line. A compressed tree file is read whole
+     and indexed in memory instead. */
+  fp=open_input_file(tree_file);  
+  if (fp != NULL)
+    trees_array = read_trees(fp, tree_file, &treecount);
+  if(fp == NULL || NULL == trees_array)
     {perror("\nError opening tree file\n");exit(1);}
-  else
-    {     
-      while(fgets(tree, 50000, fp)!= NULL)
-	{
-	  //printf("\n%s",tree); 
-	  trees_array[treecount] = (char*) malloc(sizeof (char) * 50000);        
-	  strcpy(trees_array[treecount++], tree);
-	}       
-    } 
-  fflush(fp); 
   fclose(fp);
   printf("\nThe number of trees is %d", treecount);
   cutoff = (frequency * treecount) / 100;
@@ -737,7 +1180,7 @@ int main(int argc, char* argv[])
   strcat(freq_file, "_frequencies");
   
   printf("\nFrequency file is %s ",freq_file);
-  fp=fopen(freq_file, "r");  
+  fp=open_input_file(freq_file);  
   if(fp == NULL )
     {perror("\nError opening freq file\n");exit(1);}
   else
@@ -760,13 +1203,60 @@ int main(int argc, char* argv[])
     {
       seeds_trees[i] = (int*) malloc(sizeof(int) * treecount);
     }
+  struct tree_clusters **clusters = input_clusters(trees_array, treecount,
+						    seeds_array, seedcount);
+  struct cluster_restriction **restrictions = NULL;
+  struct cluster_restriction *seed_restriction = NULL;
+  int *restriction_stamps = NULL;
+  int restriction_stamp = 0;
+  cluster_word *MAST_taxa = NULL, *candidate_taxa = NULL;
+  int num_words = 0;
+  if (NULL == clusters)
+    printf("\nInput is not plain topologies, matching trees one by one");
+  else
+    {
+      int max_clusters = 0;
+      num_words = clusters[0]->num_words;
+      for(i=0; i<treecount+seedcount; i++)
+	if (clusters[i]->num_clusters > max_clusters)
+	  max_clusters = clusters[i]->num_clusters;
+      restrictions = malloc(sizeof(struct cluster_restriction *) * treecount);
+      restriction_stamps = malloc(sizeof(int) * treecount);
+      seed_restriction = create_cluster_restriction(max_clusters, num_words);
+      MAST_taxa = create_taxon_set(num_words);
+      candidate_taxa = create_taxon_set(num_words);
+      if (NULL == restrictions || NULL == restriction_stamps
+	  || NULL == seed_restriction || NULL == MAST_taxa
+	  || NULL == candidate_taxa)
+	{ perror(NULL); exit(EXIT_FAILURE); }
+      for(j=0; j<treecount; j++)
+	{
+	  restrictions[j] = create_cluster_restriction(max_clusters, num_words);
+	  if (NULL == restrictions[j]) { perror(NULL); exit(EXIT_FAILURE); }
+	  restriction_stamps[j] = -1;
+	}
+    }
   for(i =0; i<seedcount; i++)
     {       
       //int present_seed =0;  
+      if (NULL != clusters)
+	{
+	  struct tree_clusters *seed_clusters = clusters[treecount + i];
+	  restriction_stamp++;
+	  restrict_clusters(seed_clusters, seed_clusters->leaves,
+			    seed_restriction);
+	}
       for(j=0; j<treecount; j++)
 	{ 
 	        
-	  int present = match_pattern(trees_array[j], seeds_array[i]);
+	  int present;
+	  if (NULL == clusters)
+	    present = match_pattern(trees_array[j], seeds_array[i]);
+	  else
+	    present = cluster_restrictions_equal(seed_restriction,
+	        restricted_tree(clusters, restrictions, restriction_stamps,
+				restriction_stamp, j,
+				clusters[treecount + i]->leaves));
 	  if(present == 1)
 	    {
 	      //printf("\npresent");
@@ -783,14 +1273,72 @@ int main(int argc, char* argv[])
       //printf("\n");
     }
   FILE *op;
-  op=fopen(opfile, "w");
+  char *op_name = compress_output ? masprintf("%s.gz", opfile) : opfile;
+  if (NULL == op_name) { perror(NULL); exit(EXIT_FAILURE); }
+  op=open_output_file(op_name);
+  if (NULL == op) { perror(op_name); exit(EXIT_FAILURE); }
   int* MAST_seed_present = (int*) malloc(sizeof(int) * treecount); /* trees where MAST and the current seed are present */  
+  /* tree_checked[t] == check_stamp iff tree t was already tested against the
+   * current candidate: the stamp changes with each candidate, so the array is
+   * never cleared */
+  int *tree_checked = calloc(treecount, sizeof(int));
+  int check_stamp = 0;
+  if (NULL == MAST_seed_present || NULL == tree_checked)
+    { perror(NULL); exit(EXIT_FAILURE); }
   char* MAST_temp = (char*) malloc(sizeof(char) * MAST_LENGTH); 
+  /* (canonical MAST, next seed) -> final MAST, and the states expanded so
+   * far for the current outer seed */
+  struct hash *mast_memo = create_hash(SEED_COUNT);
+  struct llist *expanded_states = create_llist();
+  if (NULL == mast_memo || NULL == expanded_states)
+    { perror(NULL); exit(EXIT_FAILURE); }
+  int memo_hits = 0;
+  /* candidate_bound[k] bounds the trees where the MAST and seed k are both
+   * present */
+  struct seed_cooccurrence *cooccurrence =
+    create_seed_cooccurrence(seeds_trees, seedcount, treecount,
+			     order_candidates);
+  int *candidate_order = malloc(sizeof(int) * seedcount);
+  int *candidate_bound = malloc(sizeof(int) * seedcount);
+  int *added_cooccurrence = malloc(sizeof(int) * seedcount);
+  if (NULL == candidate_order || NULL == candidate_bound
+      || NULL == added_cooccurrence)
+    { perror(NULL); exit(EXIT_FAILURE); }
+  int pruned = 0;
   time_t start, end;
   start = clock();
-  
+
+  /* Outer seeds are visited in file order, or by decreasing frequency in
+   * deadline mode. */
+  int *seed_order = malloc(sizeof(int) * seedcount);
+  if (NULL == seed_order) { perror(NULL); exit(EXIT_FAILURE); }
   for(i = 0; i<seedcount; i++)
+    seed_order[i] = i;
+  time_t wall_start = time(NULL);
+  time_t deadline = 0, next_flush = 0;
+  char *best_file = NULL;
+  char *best_MAST = NULL;
+  int best_leaves = 0, best_seed = -1;
+  int covered = 0, interrupted = FALSE;
+  if (0 != time_limit) {
+    seeds_by_frequency(seed_order, seedcount, freq_array, freqcount);
+    deadline = wall_start + time_limit;
+    next_flush = wall_start + flush_interval;
+    best_file = masprintf("%s_best", opfile);
+    best_MAST = malloc(sizeof(char) * MAST_LENGTH);
+    if (NULL == best_file || NULL == best_MAST)
+      { perror(NULL); exit(EXIT_FAILURE); }
+    best_MAST[0] = '\0';
+    signal(SIGTERM, request_stop);
+    signal(SIGINT, request_stop);
+    signal(SIGUSR1, request_stop);
+    signal(SIGXCPU, request_stop);
+  }
+  
+  int seed_rank;
+  for(seed_rank = 0; seed_rank<seedcount && !interrupted; seed_rank++)
     {      
+      i = seed_order[seed_rank];
       int* MAST_present = (int*) malloc(sizeof(int) * treecount);   /* trees where the MAST is present */       
       //printf("\n-3");
       int l, MAST_presentno =0;
@@ -801,8 +1349,38 @@ int main(int argc, char* argv[])
 	    MAST_present[MAST_presentno++] = l;// the trees where seed 'i' is present.
 	}
       strcpy(MAST_temp, seeds_array[i]);
-      for(k =0; k<seedcount; k++)
+      if (NULL != clusters)
+	memcpy(MAST_taxa, clusters[treecount + i]->leaves,
+	       num_words * sizeof(cluster_word));
+      seed_cooccurrence_row(cooccurrence, i, candidate_bound);
+      for(k = 0; k<seedcount; k++)
+	candidate_order[k] = k;
+      /* memo states refer to positions in the candidate order, which
+       * depends on the outer seed when ordering by co-occurrence */
+      int memo_hit = FALSE;
+      if (order_candidates)
+	candidates_by_cooccurrence(candidate_order, i, cooccurrence->matrix,
+				   seedcount);
+      else
+	memo_hit = mast_state_lookup(mast_memo, expanded_states, MAST_temp, 0);
+      int k_rank;
+      for(k_rank = 0; k_rank<seedcount && !memo_hit; k_rank++)
 	{
+	  k = candidate_order[k_rank];
+	  if (out_of_time(deadline))
+	    {
+	      interrupted = TRUE;
+	      break;
+	    }
+	  /* the remaining candidates co-occur even less with the outer seed */
+	  if (order_candidates
+	      && cooccurrence->matrix[i * seedcount + k] <= cutoff)
+	    break;
+	  if(k!=i && candidate_bound[k] <= cutoff)
+	    {
+	      pruned++;
+	      continue;
+	    }
 	  if(k!=i)
              {
 		  //printf("\nConsidering seed number %d",k);
@@ -822,19 +1400,32 @@ int main(int argc, char* argv[])
 		  //printf("\n Both present is %d", both_present);
 		  if(both_present>cutoff)
 		    {
-		      int tree_checked[400];
-		      int tc;
-		      for(tc =0; tc<treecount; tc++)
-		        tree_checked[tc] = 0;
+		      check_stamp++;
+		      if (NULL != clusters)
+			{
+			  /* candidate MAST taxa; the trees' restrictions to
+			   * them are computed as needed */
+			  taxon_set_union(candidate_taxa, MAST_taxa,
+					  clusters[treecount + seed_addno]->leaves,
+					  num_words);
+			  restriction_stamp++;
+			}
 		      //printf("\n1");  
 		      int false_freq = 0;
 		      for(l =0; l<both_present; l++)
 			{		  
 			  int tree_id = MAST_seed_present[l];              
-			  if(tree_checked[tree_id] == 0)
+			  if(tree_checked[tree_id] != check_stamp)
 			    {
 			      char* tree_current = trees_array[tree_id];		      
-			      char* new_MAST = prune(tree_current, MAST_temp, add_seed);
+			      char* new_MAST = NULL;
+			      struct cluster_restriction *current_restriction = NULL;
+			      if (NULL == clusters)
+				new_MAST = prune(tree_current, MAST_temp, add_seed);
+			      else
+				current_restriction = restricted_tree(clusters,
+				    restrictions, restriction_stamps,
+				    restriction_stamp, tree_id, candidate_taxa);
 			      int newmast_present_count = 0, p;
 			      //printf("both present is %d",both_present);
 			      int* new_MAST_present = (int*) malloc(sizeof(int) * treecount); 
@@ -842,14 +1433,23 @@ int main(int argc, char* argv[])
 				{
 				  int tree_id = MAST_seed_present[p];
 				  //printf("tree id is %d",tree_id);		          
-				  if(tree_checked[tree_id] == 0)
+				  if(tree_checked[tree_id] != check_stamp)
 				    { 		              
-				      int present = match_pattern(trees_array[tree_id], new_MAST);
+				      int present;
+				      if (NULL == clusters)
+					present = match_pattern(trees_array[tree_id], new_MAST);
+				      else
+					present = cluster_restrictions_equal(
+					    current_restriction,
+					    restricted_tree(clusters,
+						restrictions, restriction_stamps,
+						restriction_stamp, tree_id,
+						candidate_taxa));
 				      if(present == 1)
 					{
 					  new_MAST_present[newmast_present_count++] = tree_id;			
 					  //printf("\n\n PRESENT tree id is %d",tree_id);
-					  tree_checked[tree_id] = 1;
+					  tree_checked[tree_id] = check_stamp;
 					}
 				    }
 				}//for p
@@ -859,12 +1459,30 @@ int main(int argc, char* argv[])
 				{
 				  printf("\n%d", seed_addno);
 				  //printf("\nAdded seed %d frequency = %d", seed_addno, newmast_present_count);
+				  if (NULL == new_MAST)
+				    {
+				      new_MAST = prune(tree_current, MAST_temp, add_seed);
+				      memcpy(MAST_taxa, candidate_taxa,
+					     num_words * sizeof(cluster_word));
+				    }
 				  strcpy(MAST_temp, new_MAST);
 				  MAST_presentno = newmast_present_count;
 				  free(MAST_present); 
 				  MAST_present = new_MAST_present;
 				  //printf("\nMAST_temp = %s MAST_presentno = %d", MAST_temp, MAST_presentno);
 				  free(new_MAST);	
+				  int m;
+				  seed_cooccurrence_row(cooccurrence,
+					seed_addno, added_cooccurrence);
+				  for(m = 0; m<seedcount; m++)
+				    if (added_cooccurrence[m]
+					< candidate_bound[m])
+				      candidate_bound[m] =
+					added_cooccurrence[m];
+				  /* new state: stop if already expanded */
+				  if (! order_candidates)
+				    memo_hit = mast_state_lookup(mast_memo,
+					expanded_states, MAST_temp, k_rank+1);
 				  break;
 				}
 			      else 
@@ -886,15 +1504,77 @@ int main(int argc, char* argv[])
 		  //else{printf("\tboth present failed.");}   
 		}
 	}//for inner seed   
+      if (memo_hit) memo_hits++;
+      if (0 != time_limit) {
+	/* even an interrupted search yields a valid MAST */
+	int leaves = mast_leaf_count(MAST_temp);
+	if (leaves > best_leaves) {
+	  strcpy(best_MAST, MAST_temp);
+	  best_leaves = leaves;
+	  best_seed = i;
+	}
+      }
+      free(MAST_present);     
+      if (interrupted) {
+	/* the expanded states did not reach their final MAST */
+	struct list_elem *el;
+	for (el = expanded_states->head; NULL != el; el = el->next)
+	  free(el->data);
+	clear_llist(expanded_states);
+	break;
+      }
+      mast_state_resolve(mast_memo, expanded_states, MAST_temp);
+      covered++;
       fputs(MAST_temp, op);
       //printf("\nMAST_temp = %s MAST_presentno = %d", MAST_temp, MAST_presentno);
       fputs("\n", op);   
-      free(MAST_present);     
+      if (0 != time_limit) {
+	if (time(NULL) >= next_flush) {
+	  flush_best_mast(best_file, best_MAST, best_leaves, best_seed,
+			  covered, seedcount, wall_start);
+	  fflush(op);
+	  next_flush = time(NULL) + flush_interval;
+	}
+	if (out_of_time(deadline)) interrupted = TRUE;
+      }
     }// for outer seed
+  if (0 != time_limit) {
+    flush_best_mast(best_file, best_MAST, best_leaves, best_seed,
+		    covered, seedcount, wall_start);
+    printf("\nOuter seeds covered: %d of %d%s", covered, seedcount,
+	   interrupted ? " (stopped at deadline)" : "");
+    printf("\nBest MAST (%d leaves, outer seed %d): %.*s", best_leaves,
+	   best_seed, (int) strcspn(best_MAST, "\n"), best_MAST);
+    free(best_file);
+    free(best_MAST);
+  }
+  free(seed_order);
   //printf("\n");
  
+    printf("\nMemoized outer seeds: %d", memo_hits);
+    printf("\nCandidates pruned by co-occurrence: %d", pruned);
+    destroy_mast_memo(mast_memo);
+    destroy_seed_cooccurrence(cooccurrence);
+    free(candidate_order);
+    free(candidate_bound);
+    free(added_cooccurrence);
+    if (NULL != clusters)
+      {
+	for(i=0; i<treecount+seedcount; i++)
+	  destroy_tree_clusters(clusters[i]);
+	free(clusters);
+	for(j=0; j<treecount; j++)
+	  destroy_cluster_restriction(restrictions[j]);
+	free(restrictions);
+	free(restriction_stamps);
+	destroy_cluster_restriction(seed_restriction);
+	free(MAST_taxa);
+	free(candidate_taxa);
+      }
+    destroy_llist(expanded_states);
     free(MAST_temp);      
     free(MAST_seed_present);    
+    free(tree_checked);
     fflush(op);
     fclose(op);
 	 
@@ -915,7 +1595,6 @@ int main(int argc, char* argv[])
       }
     free(seeds_trees); 
     free(seed);
-    free(tree);
     
     end = clock();
     double t_end = (double) (end-start)/(CLOCKS_PER_SEC*60);
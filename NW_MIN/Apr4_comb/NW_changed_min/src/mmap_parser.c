@@ -0,0 +1,597 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif
+
+#include "parser.h"
+#include "mmap_parser.h"
+#include "tree.h"
+#include "rnode.h"
+#include "list.h"
+#include "link.h"
+#include "arena.h"
+#include "flat_tree.h"
+#include "common.h"
+
+#define INIT_CAPACITY 256
+
+/* A piece of the input. 'spaces' is set for labels that contain spaces, which
+ * become underscores (as with the Bison parser). */
+
+struct text_slice {
+	size_t offset;
+	int length;
+	int spaces;
+};
+
+/* A node as parsed: nodes are numbered in preorder, so a node's parent comes
+ * before it, and siblings come in order. */
+
+struct parsed_node {
+	int parent;		/* -1 for the root */
+	struct text_slice label;
+	struct text_slice length;
+};
+
+enum token {
+	TOKEN_END,
+	TOKEN_O_PAREN,
+	TOKEN_C_PAREN,
+	TOKEN_COMMA,
+	TOKEN_COLON,
+	TOKEN_SEMICOLON,
+	TOKEN_LABEL
+};
+
+/* Characters of unquoted labels, as in newick_scanner.l */
+
+static int is_label_char(unsigned char c)
+{
+	return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')
+		|| ('0' <= c && c <= '9') || '_' == c || '.' == c
+		|| '+' == c || '-' == c;
+}
+
+/* Scans the next token, setting 'start' to where it starts (for error
+ * messages) and 'slice' to the label, if it is one. This follows the rules of
+ * newick_scanner.l, except that characters Flex would echo (no rule matches
+ * them) are skipped silently, and so is '\r'. */
+
+static enum token next_token(struct mmap_parser *parser,
+		struct text_slice *slice, size_t *start)
+{
+	const char *text = parser->text;
+	size_t size = parser->size;
+	size_t pos = parser->pos;
+	const char *end;
+
+	for (;;) {
+		*start = pos;
+		if (pos >= size) {
+			parser->pos = pos;
+			return TOKEN_END;
+		}
+		parser->pos = pos + 1;
+		switch (text[pos]) {
+		case '(': return TOKEN_O_PAREN;
+		case ')': return TOKEN_C_PAREN;
+		case ',': return TOKEN_COMMA;
+		case ':': return TOKEN_COLON;
+		case ';': return TOKEN_SEMICOLON;
+		case '\n':
+			parser->lineno++;
+			/* fall through */
+		case ' ':
+		case '\t':
+		case '\r':
+			pos++;
+			continue;
+		case '[':	/* comment */
+			end = memchr(text + pos + 1, ']', size - pos - 1);
+			pos = NULL == end ? pos + 1 : (size_t) (end - text) + 1;
+			continue;
+		case '\'':	/* quoted label, quotes included */
+			end = memchr(text + pos + 1, '\'', size - pos - 1);
+			if (NULL == end) {
+				pos++;
+				continue;
+			}
+			slice->offset = pos;
+			slice->length = end - text + 1 - pos;
+			slice->spaces = FALSE;
+			parser->pos = end - text + 1;
+			return TOKEN_LABEL;
+		default:
+			break;
+		}
+		if (! is_label_char(text[pos])) {
+			pos++;
+			continue;
+		}
+		slice->offset = pos;
+		slice->spaces = FALSE;
+		while (pos < size && is_label_char(text[pos])) pos++;
+		/* words separated by single spaces make one label */
+		while (pos + 1 < size && ' ' == text[pos]
+				&& is_label_char(text[pos + 1])) {
+			slice->spaces = TRUE;
+			for (pos++; pos < size && is_label_char(text[pos]); pos++)
+				;
+		}
+		slice->length = pos - slice->offset;
+		parser->pos = pos;
+		if (slice->spaces)
+			fprintf (stderr, "WARNING: spaces found in label '%.*s'"
+				" - converting to underscores.\n",
+				slice->length, text + slice->offset);
+		return TOKEN_LABEL;
+	}
+}
+
+struct mmap_parser *create_mmap_parser(FILE *input)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	struct mmap_parser *parser;
+	struct stat st;
+	off_t start = ftello(input);
+	void *map = NULL;
+
+	if (0 != fstat(fileno(input), &st) || ! S_ISREG(st.st_mode)
+			|| start < 0)
+		return NULL;
+	/* an empty file can't be mapped, but it is just an empty input */
+	if (st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+				fileno(input), 0);
+		if (MAP_FAILED == map) return NULL;
+#ifdef MADV_SEQUENTIAL
+		madvise(map, st.st_size, MADV_SEQUENTIAL);
+#endif
+	}
+
+	parser = create_mmap_text_parser(map, st.st_size);
+	if (NULL == parser) {
+		if (NULL != map) munmap(map, st.st_size);
+		return NULL;
+	}
+	parser->mapped = TRUE;
+	parser->pos = start < st.st_size ? start : st.st_size;
+
+	return parser;
+#else
+	input = input;	/* suppresses warning about unused input */
+	return NULL;
+#endif
+}
+
+struct mmap_parser *create_mmap_text_parser(const char *text, size_t size)
+{
+	struct mmap_parser *parser = malloc(sizeof(struct mmap_parser));
+	if (NULL == parser) return NULL;
+
+	parser->text = text;
+	parser->size = size;
+	parser->mapped = FALSE;
+	parser->pos = 0;
+	parser->status = PARSER_STATUS_OK;
+	parser->lineno = 0;
+	parser->nodes = NULL;
+	parser->postorder = NULL;
+	parser->rnodes = NULL;
+	parser->num_nodes = 0;
+	parser->capacity = 0;
+	parser->open = NULL;
+	parser->open_capacity = 0;
+	parser->scratch = NULL;
+	parser->scratch_size = 0;
+
+	return parser;
+}
+
+void reset_mmap_text_parser(struct mmap_parser *parser, const char *text,
+		size_t size, int lineno)
+{
+	parser->text = text;
+	parser->size = size;
+	parser->pos = 0;
+	parser->status = PARSER_STATUS_OK;
+	parser->lineno = lineno;
+}
+
+void destroy_mmap_parser(struct mmap_parser *parser)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	if (parser->mapped && NULL != parser->text)
+		munmap((void *) parser->text, parser->size);
+#endif
+	free(parser->nodes);
+	free(parser->postorder);
+	free(parser->rnodes);
+	free(parser->open);
+	free(parser->scratch);
+	free(parser);
+}
+
+/* Adds a node below 'parent'. Returns its number, or -1 in case of error
+ * (malloc()). */
+
+static int new_node(struct mmap_parser *parser, int parent)
+{
+	struct parsed_node *node;
+
+	if (parser->num_nodes == parser->capacity) {
+		int capacity = parser->capacity ? 2 * parser->capacity
+			: INIT_CAPACITY;
+		struct parsed_node *nodes = realloc(parser->nodes,
+				capacity * sizeof(struct parsed_node));
+		if (NULL == nodes) return -1;
+		parser->nodes = nodes;
+		int *postorder = realloc(parser->postorder,
+				capacity * sizeof(int));
+		if (NULL == postorder) return -1;
+		parser->postorder = postorder;
+		struct rnode **rnodes = realloc(parser->rnodes,
+				capacity * sizeof(struct rnode *));
+		if (NULL == rnodes) return -1;
+		parser->rnodes = rnodes;
+		parser->capacity = capacity;
+	}
+	node = parser->nodes + parser->num_nodes;
+	node->parent = parent;
+	node->label.offset = node->length.offset = 0;
+	node->label.length = 0;
+	node->length.length = 0;
+	return parser->num_nodes++;
+}
+
+/* Pushes inner node 'n' on the stack of open nodes. Returns FAILURE in case
+ * of error (malloc()). */
+
+static int open_node(struct mmap_parser *parser, int *top, int n)
+{
+	if (*top + 1 == parser->open_capacity) {
+		int capacity = parser->open_capacity ?
+			2 * parser->open_capacity : INIT_CAPACITY;
+		int *open = realloc(parser->open, capacity * sizeof(int));
+		if (NULL == open) return FAILURE;
+		parser->open = open;
+		parser->open_capacity = capacity;
+	}
+	parser->open[++(*top)] = n;
+	return SUCCESS;
+}
+
+/* Parses the next tree into the parser's node arrays, following the grammar of
+ * newick_parser.y: a node is an optional parenthesized list of nodes, an
+ * optional label, and an optional ':' and length. Returns FAILURE at the end
+ * of input or in case of error, and sets 'status' accordingly. */
+
+static int parse_nodes(struct mmap_parser *parser)
+{
+	struct text_slice slice;
+	enum token token;
+	size_t start;
+	int top = -1, done = 0, n;
+
+	parser->num_nodes = 0;
+	parser->status = PARSER_STATUS_OK;
+	token = next_token(parser, &slice, &start);
+	if (TOKEN_END == token) {
+		parser->status = PARSER_STATUS_EMPTY;
+		return FAILURE;
+	}
+
+	for (;;) {
+		/* opens inner nodes down to a leaf... */
+		for (;;) {
+			n = new_node(parser, top < 0 ? -1 : parser->open[top]);
+			if (-1 == n) goto malloc_error;
+			if (TOKEN_O_PAREN != token) break;
+			if (! open_node(parser, &top, n)) goto malloc_error;
+			token = next_token(parser, &slice, &start);
+		}
+		/* ...then completes it, and the inner nodes it closes */
+		for (;;) {
+			struct parsed_node *node = parser->nodes + n;
+			if (TOKEN_LABEL == token) {
+				node->label = slice;
+				token = next_token(parser, &slice, &start);
+			}
+			if (TOKEN_COLON == token) {
+				token = next_token(parser, &slice, &start);
+				if (TOKEN_LABEL != token) goto syntax_error;
+				node->length = slice;
+				token = next_token(parser, &slice, &start);
+			}
+			parser->postorder[done++] = n;
+			if (top < 0 || TOKEN_C_PAREN != token) break;
+			n = parser->open[top--];
+			token = next_token(parser, &slice, &start);
+		}
+		if (top < 0) break;
+		if (TOKEN_COMMA != token) {
+			if (TOKEN_END != token) goto syntax_error;
+			fprintf (stderr, "ERROR: missing ')' at line %d near "
+				"'%.*s'\n", parser->lineno,
+				(int) (parser->pos - start),
+				parser->text + start);
+			parser->status = PARSER_STATUS_PARSE_ERROR;
+			return FAILURE;
+		}
+		token = next_token(parser, &slice, &start);
+	}
+
+	if (TOKEN_SEMICOLON == token) return SUCCESS;
+	if (TOKEN_END != token) goto syntax_error;
+	fprintf (stderr, "ERROR: missing ';' at end of tree, line %d near "
+		"''\n", parser->lineno);
+	parser->status = PARSER_STATUS_PARSE_ERROR;
+	return FAILURE;
+
+syntax_error:
+	printf ("ERROR: Syntax error at line %d near '%.*s'\n",
+		parser->lineno, (int) (parser->pos - start),
+		parser->text + start);
+	parser->status = PARSER_STATUS_PARSE_ERROR;
+	return FAILURE;
+
+malloc_error:
+	parser->status = PARSER_STATUS_MALLOC_ERROR;
+	return FAILURE;
+}
+
+/* Copies a slice into 'dest' as a string, with underscores for spaces.
+ * Returns 'dest'. */
+
+static char *slice_string(struct mmap_parser *parser, struct text_slice *slice,
+		char *dest)
+{
+	int i;
+	memcpy(dest, parser->text + slice->offset, slice->length);
+	dest[slice->length] = '\0';
+	if (slice->spaces)
+		for (i = 0; i < slice->length; i++)
+			if (' ' == dest[i]) dest[i] = '_';
+	return dest;
+}
+
+/* Makes sure the scratch buffer holds at least 'size' bytes. Returns FAILURE
+ * in case of error (malloc()). */
+
+static int reserve_scratch(struct mmap_parser *parser, size_t size)
+{
+	char *scratch;
+	if (size <= parser->scratch_size) return SUCCESS;
+	scratch = realloc(parser->scratch, size);
+	if (NULL == scratch) return FAILURE;
+	parser->scratch = scratch;
+	parser->scratch_size = size;
+	return SUCCESS;
+}
+
+/* Builds a tree from the parsed nodes, allocating from 'arena' (if not NULL).
+ * The nodes are created in preorder, so that each is added to its parent
+ * after its elder siblings, and listed in the order they were completed, as
+ * the Bison parser does. */
+
+static struct rooted_tree *build_rooted_tree(struct mmap_parser *parser,
+		struct arena *arena)
+{
+	struct rooted_tree *tree = malloc(sizeof(struct rooted_tree));
+	struct arena *previous = set_current_arena(arena);
+	struct llist *nodes_in_order = create_llist();
+	int n = 0, i;
+
+	if (NULL == tree || NULL == nodes_in_order) goto error;
+	for (n = 0; n < parser->num_nodes; n++) {
+		struct parsed_node *node = parser->nodes + n;
+		char *label, *length;
+		if (! reserve_scratch(parser,
+				node->label.length + node->length.length + 2))
+			goto error;
+		label = slice_string(parser, &(node->label), parser->scratch);
+		length = slice_string(parser, &(node->length),
+				parser->scratch + node->label.length + 1);
+		parser->rnodes[n] = create_rnode(label, length);
+		if (NULL == parser->rnodes[n]) goto error;
+		if (-1 != node->parent)
+			if (! add_child(parser->rnodes[node->parent],
+						parser->rnodes[n])) {
+				n++;
+				goto error;
+			}
+	}
+	for (i = 0; i < parser->num_nodes; i++)
+		if (! append_element(nodes_in_order,
+				parser->rnodes[parser->postorder[i]]))
+			goto error;
+	set_current_arena(previous);
+
+	tree->root = parser->rnodes[0];
+	tree->nodes_in_order = nodes_in_order;
+	tree->type = TREE_TYPE_UNKNOWN;
+	tree->arena = arena;
+	tree->orders = NULL;
+	use_nodes_in_order_as_postorder(tree);
+	return tree;
+
+error:
+	while (n-- > 0) destroy_rnode(parser->rnodes[n], NULL);
+	if (NULL != nodes_in_order) destroy_llist(nodes_in_order);
+	set_current_arena(previous);
+	free(tree);
+	parser->status = PARSER_STATUS_MALLOC_ERROR;
+	return NULL;
+}
+
+struct rooted_tree *mmap_parse_tree(struct mmap_parser *parser)
+{
+	if (! parse_nodes(parser)) return NULL;
+	return build_rooted_tree(parser, NULL);
+}
+
+struct rooted_tree *mmap_parse_tree_in_arena(struct mmap_parser *parser)
+{
+	struct rooted_tree *tree;
+	struct arena *arena;
+
+	if (! parse_nodes(parser)) return NULL;
+	arena = create_arena();
+	if (NULL == arena) {
+		parser->status = PARSER_STATUS_MALLOC_ERROR;
+		return NULL;
+	}
+	tree = build_rooted_tree(parser, arena);
+	if (NULL == tree) destroy_arena(arena);
+	return tree;
+}
+
+/* A flat tree's string table, as an open-addressing hash of string ids */
+
+struct string_ids {
+	int *ids;		/* -1 for free slots */
+	unsigned mask;		/* the number of slots, minus 1 */
+};
+
+/* Returns the id of string 's' (of length 'length') in the flat tree's string
+ * table, adding a copy of it if needed. Returns -1 in case of error. */
+
+static int string_id(struct flat_tree *flat, struct string_ids *table,
+		const char *s, int length)
+{
+	unsigned hash = 2166136261u;	/* FNV-1a */
+	int i;
+
+	for (i = 0; i < length; i++)
+		hash = (hash ^ (unsigned char) s[i]) * 16777619u;
+	for (i = hash & table->mask; -1 != table->ids[i];
+			i = (i + 1) & table->mask) {
+		char *string = flat->strings[table->ids[i]];
+		if (0 == strncmp(string, s, length) && '\0' == string[length])
+			return table->ids[i];
+	}
+
+	char *copy = malloc(length + 1);
+	if (NULL == copy) return -1;
+	memcpy(copy, s, length);
+	copy[length] = '\0';
+	flat->strings[flat->num_strings] = copy;
+	table->ids[i] = flat->num_strings;
+	return flat->num_strings++;
+}
+
+/* Returns the id of a slice's string, like string_id() */
+
+static int slice_id(struct mmap_parser *parser, struct flat_tree *flat,
+		struct string_ids *table, struct text_slice *slice)
+{
+	/* labels with spaces differ from the input, so they are compared
+	 * after conversion */
+	if (slice->spaces) {
+		if (! reserve_scratch(parser, slice->length + 1)) return -1;
+		return string_id(flat, table,
+			slice_string(parser, slice, parser->scratch),
+			slice->length);
+	}
+	return string_id(flat, table, parser->text + slice->offset,
+			slice->length);
+}
+
+/* Builds a flat tree from the parsed nodes, which are already in preorder:
+ * subtree sizes are summed up from the last node, and then a node's first
+ * child is the next node (if it is a child), and its next sibling is the node
+ * after its subtree (if it has the same parent). */
+
+static struct flat_tree *build_flat_tree(struct mmap_parser *parser)
+{
+	int num_nodes = parser->num_nodes;
+	struct flat_tree *flat = alloc_flat_tree(num_nodes);
+	struct string_ids table;
+	unsigned slots = 4, min_slots = 2 * (2 * (unsigned) num_nodes + 1);
+	int n, next;
+
+	table.ids = NULL;
+	if (NULL == flat) goto error;
+	while (slots < min_slots) slots *= 2;
+	table.ids = malloc(slots * sizeof(int));
+	if (NULL == table.ids) goto error;
+	memset(table.ids, -1, slots * sizeof(int));
+	table.mask = slots - 1;
+	if (-1 == string_id(flat, &table, "", 0)) goto error;
+
+	for (n = 0; n < num_nodes; n++) {
+		struct parsed_node *node = parser->nodes + n;
+		flat->parent[n] = -1 == node->parent ? FLAT_NONE : node->parent;
+		flat->subtree_size[n] = 1;
+		flat->edge_length[n] = -1;
+		flat->label_id[n] = slice_id(parser, flat, &table,
+				&(node->label));
+		flat->length_id[n] = slice_id(parser, flat, &table,
+				&(node->length));
+		if (-1 == flat->label_id[n] || -1 == flat->length_id[n])
+			goto error;
+	}
+	for (n = num_nodes - 1; n > 0; n--)
+		flat->subtree_size[flat->parent[n]] += flat->subtree_size[n];
+	for (n = 0; n < num_nodes; n++) {
+		next = n + 1;
+		flat->first_child[n] = next < num_nodes
+			&& n == flat->parent[next] ? next : FLAT_NONE;
+		next = n + flat->subtree_size[n];
+		flat->next_sibling[n] = n > 0 && next < num_nodes
+			&& flat->parent[n] == flat->parent[next] ?
+			next : FLAT_NONE;
+	}
+
+	free(table.ids);
+	return flat;
+
+error:
+	free(table.ids);
+	if (NULL != flat) destroy_flat_tree(flat);
+	parser->status = PARSER_STATUS_MALLOC_ERROR;
+	return NULL;
+}
+
+struct flat_tree *mmap_parse_flat_tree(struct mmap_parser *parser)
+{
+	if (! parse_nodes(parser)) return NULL;
+	return build_flat_tree(parser);
+}
@@ -0,0 +1,109 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* A hand-written Newick parser over memory-mapped input. It accepts the same
+ * language as the Bison parser (see newick_parser.y), but it scans the mapping
+ * in place: labels and edge lengths are kept as (offset, length) slices into
+ * it, rather than strdup()ed token by token. The nodes of a tree are first
+ * laid out in parser-owned arrays (reused from one tree to the next), from
+ * which the tree - flat or not - is built in one pass. */
+
+/* NOTE: only regular files can be mapped; create_mmap_parser() returns NULL
+ * for pipes, terminals, etc, and callers should then use the Bison parser (as
+ * parse_tree() does). Like struct newick_parser, a parser may only be used by
+ * one thread at a time, but parsers are independent of each other. */
+
+/* NOTE: include parser.h first (for enum parser_status_type) */
+
+#include <stdio.h>
+#include <stddef.h>
+
+struct rooted_tree;
+struct flat_tree;
+struct rnode;
+struct parsed_node;
+
+struct mmap_parser {
+	const char *text;	/* the mapped file */
+	size_t size;
+	int mapped;		/* FALSE if 'text' belongs to the caller */
+	size_t pos;		/* where the next tree starts */
+	enum parser_status_type status;
+	int lineno;
+	/* the last tree's nodes, in preorder, and their order of completion
+	 * (postorder) */
+	struct parsed_node *nodes;
+	int *postorder;
+	int num_nodes;
+	int capacity;
+	int *open;		/* the inner nodes being parsed */
+	int open_capacity;
+	struct rnode **rnodes;	/* by node number, see mmap_parse_tree() */
+	char *scratch;		/* a label, NUL-terminated */
+	size_t scratch_size;
+};
+
+/* Creates a parser over the rest of 'input' (from its current position), which
+ * must be a regular file. The file can be closed afterwards. */
+/* Returns NULL if the file cannot be mapped, or in case of error (malloc()) */
+
+struct mmap_parser *create_mmap_parser(FILE *input);
+
+/* Creates a parser over 'size' bytes of text at 'text', e.g. part of another
+ * parser's mapping. The text is not copied, and must stay valid while the
+ * parser is in use. */
+/* Returns NULL in case of error (malloc()) */
+
+struct mmap_parser *create_mmap_text_parser(const char *text, size_t size);
+
+/* Makes a text parser (see above) parse 'size' bytes at 'text' from now on,
+ * keeping the arrays it has grown so far. Line numbers (for error messages)
+ * start at 'lineno'. */
+
+void reset_mmap_text_parser(struct mmap_parser *parser, const char *text,
+		size_t size, int lineno);
+
+/* Parses the next tree, like parse_tree(). Sets the parser's 'status'. */
+
+struct rooted_tree *mmap_parse_tree(struct mmap_parser *parser);
+
+/* Like mmap_parse_tree(), but in an arena, like parse_tree_in_arena() */
+
+struct rooted_tree *mmap_parse_tree_in_arena(struct mmap_parser *parser);
+
+/* Parses the next tree straight into a flat tree (see flat_tree.h), without
+ * creating any rnode. Each distinct label and edge length is copied once; edge
+ * lengths are -1, like those of the nodes parse_tree() returns. */
+/* Returns NULL at the end of input, or in case of error (see 'status') */
+
+struct flat_tree *mmap_parse_flat_tree(struct mmap_parser *parser);
+
+/* Unmaps the input and frees the parser */
+
+void destroy_mmap_parser(struct mmap_parser *parser);
@@ -0,0 +1,401 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* nw: all the programs in a single binary, busybox-style */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "common.h"
+
+#define BATCH_BUFFER_SIZE 65536
+
+/* Each program's main(), renamed when its objects are combined into one, in
+ * which main() is the only global symbol left (see Makefile.am). */
+
+int nw_clade_main(int argc, char *argv[]);
+int nw_condense_main(int argc, char *argv[]);
+int nw_display_main(int argc, char *argv[]);
+int nw_distance_main(int argc, char *argv[]);
+int nw_duration_main(int argc, char *argv[]);
+int nw_ed_main(int argc, char *argv[]);
+int nw_gen_main(int argc, char *argv[]);
+int nw_index_main(int argc, char *argv[]);
+int nw_labels_main(int argc, char *argv[]);
+int nw_mast_main(int argc, char *argv[]);
+int nw_match_main(int argc, char *argv[]);
+int nw_order_main(int argc, char *argv[]);
+int nw_pack_main(int argc, char *argv[]);
+int nw_prune_main(int argc, char *argv[]);
+int nw_query_main(int argc, char *argv[]);
+int nw_rename_main(int argc, char *argv[]);
+int nw_reroot_main(int argc, char *argv[]);
+int nw_serve_main(int argc, char *argv[]);
+int nw_stats_main(int argc, char *argv[]);
+int nw_support_main(int argc, char *argv[]);
+int nw_topology_main(int argc, char *argv[]);
+int nw_trim_main(int argc, char *argv[]);
+int nw_unpack_main(int argc, char *argv[]);
+
+struct applet {
+	char *name;
+	int (*main)(int argc, char *argv[]);
+};
+
+static struct applet applets[] = {
+	{ "nw_clade", nw_clade_main },
+	{ "nw_condense", nw_condense_main },
+	{ "nw_display", nw_display_main },
+	{ "nw_distance", nw_distance_main },
+	{ "nw_duration", nw_duration_main },
+	{ "nw_ed", nw_ed_main },
+	{ "nw_gen", nw_gen_main },
+	{ "nw_index", nw_index_main },
+	{ "nw_labels", nw_labels_main },
+	{ "nw_mast", nw_mast_main },
+	{ "nw_match", nw_match_main },
+	{ "nw_order", nw_order_main },
+	{ "nw_pack", nw_pack_main },
+	{ "nw_prune", nw_prune_main },
+	{ "nw_query", nw_query_main },
+	{ "nw_rename", nw_rename_main },
+	{ "nw_reroot", nw_reroot_main },
+	{ "nw_serve", nw_serve_main },
+	{ "nw_stats", nw_stats_main },
+	{ "nw_support", nw_support_main },
+	{ "nw_topology", nw_topology_main },
+	{ "nw_trim", nw_trim_main },
+	{ "nw_unpack", nw_unpack_main }
+};
+
+#define NUM_APPLETS (sizeof(applets) / sizeof(struct applet))
+
+void help(char *argv[])
+{
+	printf (
+"Runs any of the Newick Utilities, from a single binary\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s <program> [options] [arguments]\n"
+"nw_<program> [options] [arguments]	(through a link to %s)\n"
+"%s --batch\n"
+"%s [-hl]\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"The program's name, with or without the 'nw_' prefix, and its own options\n"
+"and arguments. If %s is called through a link (or copy) named after a\n"
+"program, e.g. 'nw_labels', it runs that program.\n"
+"\n"
+"With --batch, reads commands from standard input, one per line, each made\n"
+"of a program name and its arguments, and runs them in turn. Arguments may\n"
+"be quoted with '' or \"\", as in the shell, and \\ escapes the next\n"
+"character; there are no redirections, pipes or variables. Blank lines and\n"
+"lines starting with '#' are skipped.\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"Whatever the program outputs. In batch mode, the outputs of all commands\n"
+"follow each other on standard output, in order; each command runs in a\n"
+"process of its own, forked from %s (which costs much less than starting a\n"
+"program), with no standard input. The exit status is nonzero if any\n"
+"command failed.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"    -l: list the programs and exit\n"
+"    --batch: run the commands read from standard input\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# the same as nw_labels -I data/catarrhini\n"
+"$ %s labels -I data/catarrhini\n"
+"\n"
+"# count the leaves of many trees, in a single process\n"
+"$ for f in trees/*.nw ; do echo \"labels -I $f\" ; done | %s --batch\n",
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0],
+	argv[0]
+	);
+}
+
+/* Returns the applet called 'name' (possibly a path, and with or without the
+ * 'nw_' prefix), or NULL if there is none. */
+
+static struct applet *find_applet(const char *name)
+{
+	const char *base = strrchr(name, '/');
+	size_t i;
+
+	base = NULL == base ? name : base + 1;
+	for (i = 0; i < NUM_APPLETS; i++)
+		if (0 == strcmp(base, applets[i].name)
+			|| 0 == strcmp(base, applets[i].name + 3))
+			return &applets[i];
+	return NULL;
+}
+
+static void list_applets()
+{
+	size_t i;
+	for (i = 0; i < NUM_APPLETS; i++)
+		printf("%s\n", applets[i].name + 3);
+}
+
+/* Reads commands on file descriptor 0 with read() rather than through stdin:
+ * a child's stdin must not hold commands that its parent has buffered. */
+
+struct command_reader {
+	char buffer[BATCH_BUFFER_SIZE];
+	size_t start;
+	size_t end;
+	int eof;
+	char *line;
+	size_t capacity;
+};
+
+/* Returns the next line, without its '\n', or NULL at the end of input. Exits
+ * in case of error (malloc(), I/O). */
+
+static char *read_command(struct command_reader *reader)
+{
+	size_t length = 0;
+
+	for (;;) {
+		char *newline;
+		size_t count;
+		ssize_t got;
+
+		if (reader->start == reader->end) {
+			if (reader->eof) break;
+			got = read(0, reader->buffer, BATCH_BUFFER_SIZE);
+			if (got < 0 && EINTR == errno) continue;
+			if (got < 0) { perror(NULL); exit(EXIT_FAILURE); }
+			reader->start = 0;
+			reader->end = got;
+			if (0 == got) reader->eof = TRUE;
+			continue;
+		}
+		newline = memchr(reader->buffer + reader->start, '\n',
+				reader->end - reader->start);
+		count = (NULL == newline ? reader->end :
+				(size_t) (newline - reader->buffer))
+			- reader->start;
+		if (length + count + 1 > reader->capacity) {
+			reader->capacity = 2 * (length + count + 1);
+			reader->line = realloc(reader->line, reader->capacity);
+			if (NULL == reader->line) {
+				perror(NULL);
+				exit(EXIT_FAILURE);
+			}
+		}
+		memcpy(reader->line + length, reader->buffer + reader->start,
+				count);
+		length += count;
+		reader->start += count;
+		if (NULL != newline) {
+			reader->start++;	/* the '\n' */
+			reader->line[length] = '\0';
+			return reader->line;
+		}
+	}
+
+	if (0 == length) return NULL;
+	reader->line[length] = '\0';	/* last line, without '\n' */
+	return reader->line;
+}
+
+/* Splits 'line' into words, in place, with the shell's quotes and escapes (see
+ * help()). 'words' must have room for strlen(line) / 2 + 2 words. Returns the
+ * number of words (words[count] is NULL), or -1 if a quote is not closed. */
+
+static int split_words(char *line, char **words)
+{
+	char *in = line, *out = line;
+	int count = 0;
+
+	for (;;) {
+		char quote = '\0';
+		while (' ' == *in || '\t' == *in || '\r' == *in) in++;
+		if ('\0' == *in) break;
+		words[count++] = out;
+		for (; '\0' != *in; in++) {
+			if ('\0' == quote && (' ' == *in || '\t' == *in
+						|| '\r' == *in))
+				break;
+			if ('\0' == quote && ('\'' == *in || '"' == *in)) {
+				quote = *in;
+			} else if (quote == *in) {
+				quote = '\0';
+			} else if ('\\' == *in && '\'' != quote
+					&& '\0' != in[1]) {
+				*out++ = *++in;
+			} else {
+				*out++ = *in;
+			}
+		}
+		if ('\0' != quote) return -1;
+		if ('\0' != *in) in++;
+		*out++ = '\0';
+	}
+	words[count] = NULL;
+	return count;
+}
+
+/* Runs 'argv' in a child process, and returns its exit status (or -1 if it
+ * could not be run). */
+
+static int run_command(struct applet *applet, int argc, char *argv[])
+{
+	pid_t pid;
+	int status;
+
+	/* nothing buffered may be output twice */
+	fflush(stdout);
+	fflush(stderr);
+	pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return -1;
+	}
+	if (0 == pid) {
+		int null = open("/dev/null", O_RDONLY);
+		if (null < 0 || dup2(null, 0) < 0) {
+			perror("/dev/null");
+			_exit(EXIT_FAILURE);
+		}
+		close(null);
+		optind = 1;
+		argv[0] = applet->name;
+		exit(applet->main(argc, argv));
+	}
+	while (waitpid(pid, &status, 0) < 0)
+		if (EINTR != errno) {
+			perror("waitpid");
+			return -1;
+		}
+	if (WIFEXITED(status)) return WEXITSTATUS(status);
+	return -1;
+}
+
+static int run_batch(char *nw)
+{
+	struct command_reader *reader = calloc(1, sizeof(struct command_reader));
+	char **words = NULL;
+	char *line;
+	int lineno = 0, failures = 0;
+
+	if (NULL == reader) { perror(NULL); exit(EXIT_FAILURE); }
+
+	while (NULL != (line = read_command(reader))) {
+		struct applet *applet;
+		int num_words, status;
+
+		lineno++;
+		words = realloc(words, (strlen(line) / 2 + 2) * sizeof(char *));
+		if (NULL == words) { perror(NULL); exit(EXIT_FAILURE); }
+		num_words = split_words(line, words);
+		if (num_words < 0) {
+			fprintf (stderr, "%s: line %d: unmatched quote\n", nw,
+					lineno);
+			failures++;
+			continue;
+		}
+		if (0 == num_words || '#' == words[0][0]) continue;
+		applet = find_applet(words[0]);
+		if (NULL == applet) {
+			fprintf (stderr, "%s: line %d: unknown program '%s'\n",
+					nw, lineno, words[0]);
+			failures++;
+			continue;
+		}
+		status = run_command(applet, num_words, words);
+		if (0 != status) {
+			fprintf (stderr, "%s: line %d: '%s' failed (status %d)\n",
+					nw, lineno, words[0], status);
+			failures++;
+		}
+	}
+
+	free(words);
+	free(reader->line);
+	free(reader);
+	return 0 == failures ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+	struct applet *applet = find_applet(argv[0]);
+
+	/* called as nw_<program> */
+	if (NULL != applet) return applet->main(argc, argv);
+
+	if (argc < 2) {
+		fprintf (stderr, "Usage: %s <program> [arguments] | --batch | "
+				"-h | -l\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	if (0 == strcmp("-h", argv[1]) || 0 == strcmp("--help", argv[1])) {
+		help(argv);
+		exit(EXIT_SUCCESS);
+	}
+	if (0 == strcmp("-l", argv[1])) {
+		list_applets();
+		exit(EXIT_SUCCESS);
+	}
+	if (0 == strcmp("--batch", argv[1])) return run_batch(argv[0]);
+
+	applet = find_applet(argv[1]);
+	if (NULL == applet) {
+		fprintf (stderr, "%s: unknown program '%s' (see %s -l)\n",
+				argv[0], argv[1], argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	/* the program's usage and help refer to it by its own name */
+	argv[1] = applet->name;
+	return applet->main(argc - 1, argv + 1);
+}
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,23 +31,43 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_NWS_NEWICK_PARSER_H_INCLUDED
+# define YY_NWS_NEWICK_PARSER_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int nwsdebug;
+#endif
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     TOK_EOF = 0,
-     O_PAREN = 258,
-     COLON = 259,
-     COMMA = 260,
-     C_PAREN = 261,
-     SEMICOLON = 262,
-     LABEL = 263
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    TOK_EOF = 0,                   /* TOK_EOF  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    O_PAREN = 258,                 /* O_PAREN  */
+    COLON = 259,                   /* COLON  */
+    COMMA = 260,                   /* COMMA  */
+    C_PAREN = 261,                 /* C_PAREN  */
+    SEMICOLON = 262,               /* SEMICOLON  */
+    LABEL = 263                    /* LABEL  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
 #define TOK_EOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define O_PAREN 258
 #define COLON 259
 #define COMMA 260
@@ -57,24 +75,28 @@
 #define SEMICOLON 262
 #define LABEL 263
 
-
-
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 70 "newick_parser.y"
+union YYSTYPE
 {
+#line 73 "newick_parser.y"
+
 	char *sval;
 	struct rnode *nodep;
 	struct llist *llistp;
-}
-/* Line 1529 of yacc.c.  */
-#line 73 "newick_parser.h"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+
+#line 89 "newick_parser.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE nwslval;
 
+
+
+int nwsparse (struct newick_parser *parser, void *scanner);
+
+
+#endif /* !YY_NWS_NEWICK_PARSER_H_INCLUDED  */
@@ -35,30 +35,29 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "to_newick.h" // TODO: needed?
 #include "parser.h"
 
-/* in the (admittedly artificial) case of trees with lots of nesting on the
- * left side, the stack can be exhausted. I set this to 100,000, which is
- * enough for a 100,000-leaf, completely unbalanced left-leaning tree. */
-
 /* NOTE: this grammar generates 2 shift/reduce and 1 reduce/reduce conflicts,
  * but they are all due to the error-reporting code. For a correct tree, the
  * grammar is unambiguous. According to the test suite, Bison resolves the
  * conflicts correctly anyway. */
 
-#define YYMAXDEPTH 100000
+/* Every level of nesting leaves a few symbols on the parser's stack, so the
+ * stack limit caps the tree's depth. Bison grows the stack on demand, so a
+ * high limit costs nothing for shallow trees; this one admits caterpillars
+ * with a few million leaves. */
+
+#define YYMAXDEPTH 10000000
 
-extern struct llist *nodes_in_order;
-extern struct rnode *root;
-extern enum parser_status_type newick_parser_status;
+/* The parser is pure (reentrant): all its state is in the struct
+ * newick_parser passed to nwsparse(), along with the scanner (see parser.h),
+ * so any number of parsers can run at the same time. */
 
-extern int lineno;
-char *nwsget_text();
-extern int nwslex (void);
+char *nwsget_text(void *scanner);
 
-void nwserror(char *s)
+void nwserror(struct newick_parser *parser, void *scanner, const char *s)
 {
 	s = s;	/* suppresses warning about unused s */
 	printf ("ERROR: Syntax error at line %d near '%s'\n",
-		lineno, nwsget_text());
+		parser->lineno, nwsget_text(scanner));
 }
 
 %}
@@ -66,6 +65,10 @@ void nwserror(char *s)
 /* %error-verbose */
 
 %name-prefix="nws"
+%pure-parser
+%parse-param {struct newick_parser *parser}
+%parse-param {void *scanner}
+%lex-param {void *scanner}
 
 %union {
 	char *sval;
@@ -82,18 +85,22 @@ void nwserror(char *s)
 %type <llistp> nodelist
 %type <nodep> inner_node
 
+%{
+int nwslex(YYSTYPE *lvalp, void *scanner);
+%}
+
 %%
 
 // TODO: check the parser's behaviour if create_rnode(), append_element(), etc
 // fail
 
 tree: /* empty */	{
-		root = NULL;
-		newick_parser_status = PARSER_STATUS_EMPTY;
+		parser->root = NULL;
+		parser->status = PARSER_STATUS_EMPTY;
 		YYACCEPT;
 	}
     | node SEMICOLON {
-    		root = $1;
+    		parser->root = $1;
 		YYACCEPT;
     }
 
@@ -102,24 +109,24 @@ tree: /* empty */	{
 
     | node { 	
 	fprintf (stderr, "ERROR: missing ';' at end of tree, line %d "
-		"near '%s'\n", lineno, nwsget_text());
-	root = NULL;
-	newick_parser_status = PARSER_STATUS_PARSE_ERROR;
+		"near '%s'\n", parser->lineno, nwsget_text(scanner));
+	parser->root = NULL;
+	parser->status = PARSER_STATUS_PARSE_ERROR;
 	YYACCEPT;
     }
     ;
 
 node: 	leaf {
-		if (! append_element(nodes_in_order, $1)) {
-			root = NULL;
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
+		if (! append_element(parser->nodes_in_order, $1)) {
+			parser->root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
 			YYACCEPT;
 		}
 	}
     	| inner_node {
-    		if (! append_element(nodes_in_order, $1)) {
-			root = NULL;
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
+    		if (! append_element(parser->nodes_in_order, $1)) {
+			parser->root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
 			YYACCEPT;
 		}
 	}
@@ -130,14 +137,14 @@ inner_node: O_PAREN nodelist C_PAREN {
 		struct rnode *np;
 		np = create_rnode("","");
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		for (lep = $2->head; NULL != lep; lep = lep->next) {
 			if (! add_child(np, (struct rnode*) lep->data)) {
-				root = NULL;
-				newick_parser_status =
+				parser->root = NULL;
+				parser->status =
 					PARSER_STATUS_MALLOC_ERROR;
 				YYACCEPT;
 			}
@@ -150,15 +157,15 @@ inner_node: O_PAREN nodelist C_PAREN {
 		struct rnode *np;
 		np = create_rnode($4,"");
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		free($4);
 		for (lep = $2->head; NULL != lep; lep = lep->next) {
 			if (! add_child(np, (struct rnode*) lep->data)) {
-				root = NULL;
-				newick_parser_status =
+				parser->root = NULL;
+				parser->status =
 					PARSER_STATUS_MALLOC_ERROR;
 				YYACCEPT;
 			}
@@ -171,15 +178,15 @@ inner_node: O_PAREN nodelist C_PAREN {
 		struct rnode *np;
 		np = create_rnode($4,$6);
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		free($4);
 		for (lep = $2->head; NULL != lep; lep = lep->next) {
 			if (! add_child(np, (struct rnode*) lep->data)) {
-				root = NULL;
-				newick_parser_status =
+				parser->root = NULL;
+				parser->status =
 					PARSER_STATUS_MALLOC_ERROR;
 				YYACCEPT;
 			}
@@ -193,14 +200,14 @@ inner_node: O_PAREN nodelist C_PAREN {
 		struct rnode *np;
 		np = create_rnode("",$5);
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		for (lep = $2->head; NULL != lep; lep = lep->next) {
 			if (! add_child(np, (struct rnode*) lep->data)) {
-				root = NULL;
-				newick_parser_status =
+				parser->root = NULL;
+				parser->status =
 					PARSER_STATUS_MALLOC_ERROR;
 				YYACCEPT;
 			}
@@ -211,8 +218,8 @@ inner_node: O_PAREN nodelist C_PAREN {
     }
     | O_PAREN nodelist { 
 	fprintf (stderr, "ERROR: missing ')' at line %d near '%s'\n",
-		lineno, nwsget_text());
-	root = NULL;
+		parser->lineno, nwsget_text(scanner));
+	parser->root = NULL;
 	YYACCEPT;	
     }
     ;
@@ -221,13 +228,13 @@ nodelist: node {
 		struct llist *listp;
 		listp = create_llist();
 		if (NULL == listp) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		if (! append_element(listp, $1)) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 			
@@ -236,8 +243,8 @@ nodelist: node {
 	| nodelist COMMA node {
 		struct llist *listp = $1;
 		if (! append_element(listp, $3)) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		$$ = listp;
@@ -248,8 +255,8 @@ leaf: LABEL {
 		struct rnode *np;
 		np = create_rnode($1,"");
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		free($1);
@@ -259,8 +266,8 @@ leaf: LABEL {
 		struct rnode *np;
 		np = create_rnode($1,$3);
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		free($1);
@@ -270,8 +277,8 @@ leaf: LABEL {
     | COLON LABEL {
 		struct rnode *np = create_rnode("",$2);
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		free($2);
@@ -280,8 +287,8 @@ leaf: LABEL {
     | /* empty */ {
 		struct rnode *np = create_rnode("","");
 		if (NULL == np) {
-			newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-			root = NULL;
+			parser->status = PARSER_STATUS_MALLOC_ERROR;
+			parser->root = NULL;
 			YYACCEPT;
 		}
 		$$ = np;
@@ -0,0 +1,76 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* The scanner of the Bison parser (see newick_parser.y). It is written by
+ * hand, and reentrant: all its state is in a scanner object, which belongs to
+ * a struct newick_parser. The functions keep the names of the flex scanner it
+ * replaces, which the parser calls (nwslex() and nwsget_text()). */
+
+/* Tokens are the same as before: labels (quoted or not; runs of label
+ * characters separated by single spaces make one label, with the spaces turned
+ * into underscores), '(', ')', ',', ':' and ';'. Whitespace and [comments] are
+ * skipped, and any other character is echoed to stdout. */
+
+#include <stdio.h>
+
+struct newick_parser;
+union YYSTYPE;
+
+/* Creates a scanner for 'parser' (whose line count it updates), and stores it
+ * in '*scanner'. It has no input yet. Returns 0, or 1 in case of error
+ * (malloc()). */
+
+int nwslex_init_extra(struct newick_parser *parser, void **scanner);
+
+/* Makes the scanner read 'input', from its current position */
+
+void nwsset_in(FILE *input, void *scanner);
+
+/* Like nwsset_in(), but first drops whatever was read ahead of the last
+ * token */
+
+void nwsrestart(FILE *input, void *scanner);
+
+/* Makes the scanner read a copy of 'string'. Returns FAILURE in case of
+ * error (malloc()). */
+
+int nws_scan_string(const char *string, void *scanner);
+
+/* Returns the next token, and its value (for LABEL) in '*lvalp'. Returns 0 at
+ * the end of the input. */
+
+int nwslex(union YYSTYPE *lvalp, void *scanner);
+
+/* Returns the text of the last token ("" at the end of the input) */
+
+char *nwsget_text(void *scanner);
+
+/* Frees the scanner (but not its input file). Returns 0. */
+
+int nwslex_destroy(void *scanner);
@@ -49,6 +49,9 @@ for dir in lib_dirs:
 if libnw == None:
 	raise IOError, 'libnw not found'
 
+# For freeing the buffers that libnw returns
+libc = CDLL(find_library('c'))
+
 ################################################################
 # C structures
 
@@ -82,6 +85,20 @@ class rooted_tree(Structure):
 	_fields_ = [('root', POINTER(rnode)),
 		    ('nodes_in_order', POINTER(llist))]
 
+class taxon_index(Structure):
+	_fields_ = [('id2num', POINTER(c_int)),
+		    ('size', c_int),
+		    ('count', c_int)]
+
+class tree_batch(Structure):
+	_fields_ = [('num_trees', c_int),
+		    ('newicks', POINTER(c_char_p)),
+		    ('flats', c_void_p),
+		    ('clusters', c_void_p),
+		    ('taxa', POINTER(taxon_index)),
+		    ('taxon_labels', POINTER(c_char_p)),
+		    ('max_clusters', c_int)]
+
 ################################################################
 # C enums mapped to Python constants
 
@@ -123,6 +140,27 @@ libnw.reroot_tree.argtypes = [POINTER(rooted_tree), POINTER(rnode)]
 libnw.create_label2node_map.argtypes = [POINTER(llist)]
 libnw.create_label2node_map.restype = POINTER(hash)
 
+# tree_batch.h
+BATCH_BAD_PATTERN = -1
+
+libnw.read_tree_batch_file.argtypes = [c_char_p]
+libnw.read_tree_batch_file.restype = POINTER(tree_batch)
+libnw.read_tree_batch_string.argtypes = [c_char_p]
+libnw.read_tree_batch_string.restype = POINTER(tree_batch)
+libnw.tree_batch_leaf_counts.argtypes = [POINTER(tree_batch), POINTER(c_int)]
+libnw.tree_batch_leaf_counts.restype = None
+libnw.tree_batch_match_all.argtypes = [POINTER(tree_batch),
+		POINTER(c_char_p), c_int, POINTER(c_char), POINTER(c_int)]
+# returns a buffer that must be freed, hence not c_char_p
+libnw.tree_batch_prune.argtypes = [POINTER(tree_batch), c_int, c_int,
+		POINTER(c_char_p), c_int, c_int]
+libnw.tree_batch_prune.restype = c_void_p
+libnw.destroy_tree_batch.argtypes = [POINTER(tree_batch)]
+libnw.destroy_tree_batch.restype = None
+
+libc.free.argtypes = [c_void_p]
+libc.free.restype = None
+
 ################################################################
 # User-land Python classes
 
@@ -346,3 +384,96 @@ class Tree(object):
 			if label not in self.label2nodes:
 				self.label2nodes[label] = []
 			self.label2nodes[label].append(node)
+
+class TreeBatch(object):
+
+	'''A collection of trees, read once and kept in libnw. Each method works
+	on all the trees in a single call to C, instead of one call per tree or
+	node, and returns a Python list with one result per tree. E.g.
+		batch = TreeBatch('bootstrap.nw')
+		counts = batch.leaf_counts()
+		hits = batch.match('((A,B),C);')	# [True, False, ...]
+		pruned = batch.prune(['A', 'B'])	# Newick strings '''
+
+	def __init__(self, source, type='filename'):
+		'''Reads all trees from file 'source' (any format the nw_*
+		programs read), or from Newick text if type is 'string'.'''
+		if type == 'filename':
+			self.batch = libnw.read_tree_batch_file(source)
+		elif type == 'string':
+			self.batch = libnw.read_tree_batch_string(source)
+		else:
+			raise RuntimeError("Unknown type '%s'" % type)
+		if not bool(self.batch):
+			raise IOError, "could not read trees from '%s'" % source
+		self.num_trees = self.batch.contents.num_trees
+
+	def __del__(self):
+		if hasattr(self, 'batch') and bool(self.batch):
+			libnw.destroy_tree_batch(self.batch)
+
+	def __len__(self):
+		return self.num_trees
+
+	def get_newicks(self):
+		'''Returns the trees, as Newick strings'''
+		return self.batch.contents.newicks[:self.num_trees]
+
+	def get_taxa(self):
+		'''Returns the leaf labels of all trees, each once'''
+		count = self.batch.contents.taxa.contents.count
+		return self.batch.contents.taxon_labels[:count]
+
+	def leaf_counts(self):
+		'''Returns the number of leaves of each tree'''
+		counts = (c_int * self.num_trees)()
+		libnw.tree_batch_leaf_counts(self.batch, counts)
+		return list(counts)
+
+	def __match(self, patterns):
+		c_patterns = (c_char_p * len(patterns))(*patterns)
+		matches = create_string_buffer(len(patterns) * self.num_trees)
+		counts = (c_int * len(patterns))()
+		if not libnw.tree_batch_match_all(self.batch, c_patterns,
+				len(patterns), matches, counts):
+			raise MemoryError
+		for pattern, count in zip(patterns, counts):
+			if count == BATCH_BAD_PATTERN:
+				raise ValueError, "bad pattern '%s'" % pattern
+		return matches.raw, list(counts)
+
+	def match(self, patterns):
+		'''Tells which trees match a pattern (a Newick tree), i.e. have its
+		leaves, and its topology once pruned to them. Returns a list of
+		booleans (one per tree) for a single pattern, or a list of such lists
+		for a list of patterns.'''
+		single = isinstance(patterns, str)
+		if single: patterns = [patterns]
+		raw, counts = self.__match(patterns)
+		n = self.num_trees
+		vectors = [[c != '\0' for c in raw[i * n:(i + 1) * n]]
+				for i in range(len(patterns))]
+		if single: return vectors[0]
+		return vectors
+
+	def count(self, patterns):
+		'''Returns the number of trees that match a pattern (see match()),
+		or a list of numbers for a list of patterns.'''
+		single = isinstance(patterns, str)
+		if single: patterns = [patterns]
+		raw, counts = self.__match(patterns)
+		if single: return counts[0]
+		return counts
+
+	def prune(self, labels, reverse=False):
+		'''Returns the trees (as Newick strings) without the nodes whose
+		labels are passed, like nw_prune, or if 'reverse' is true, without the
+		leaves whose labels are NOT passed. The batch is not changed.'''
+		c_labels = (c_char_p * len(labels))(*labels)
+		buffer = libnw.tree_batch_prune(self.batch, 0,
+				self.num_trees - 1, c_labels, len(labels),
+				int(bool(reverse)))
+		if buffer is None: raise MemoryError
+		trees = string_at(buffer)
+		libc.free(buffer)
+		return trees.splitlines()
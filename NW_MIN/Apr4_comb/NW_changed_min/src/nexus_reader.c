@@ -0,0 +1,386 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "parser.h"
+#include "nexus_reader.h"
+#include "mmap_parser.h"
+#include "tree.h"
+#include "list.h"
+#include "rnode.h"
+#include "label_table.h"
+#include "common.h"
+
+#define INIT_TEXT_SIZE 1024
+
+int is_nexus(FILE *input)
+{
+	int c = getc(input);
+	if (EOF == c) return FALSE;
+	ungetc(c, input);
+	return '#' == c;
+}
+
+struct nexus_reader *create_nexus_reader(FILE *input)
+{
+	struct nexus_reader *reader = malloc(sizeof(struct nexus_reader));
+	if (NULL == reader) return NULL;
+
+	reader->input = input;
+	reader->status = PARSER_STATUS_OK;
+	reader->lineno = 1;
+	reader->tree_lineno = 1;
+	reader->started = FALSE;
+	reader->in_trees_block = FALSE;
+	reader->length = 0;
+	reader->capacity = INIT_TEXT_SIZE;
+	reader->translation = NULL;
+	reader->translation_size = 0;
+	reader->text = malloc(reader->capacity);
+	reader->parser = create_mmap_text_parser("", 0);
+	if (NULL == reader->text || NULL == reader->parser) {
+		destroy_nexus_reader(reader);
+		return NULL;
+	}
+	reader->text[0] = '\0';
+
+	return reader;
+}
+
+void destroy_nexus_reader(struct nexus_reader *reader)
+{
+	if (NULL != reader->parser) destroy_mmap_parser(reader->parser);
+	free(reader->text);
+	free(reader->translation);
+	free(reader);
+}
+
+static int next_char(struct nexus_reader *reader)
+{
+	int c = getc(reader->input);
+	if ('\n' == c) reader->lineno++;
+	return c;
+}
+
+/* Appends 'c' to the reader's text. Returns FAILURE in case of error
+ * (malloc()). */
+
+static int append_char(struct nexus_reader *reader, char c)
+{
+	if (reader->length + 1 == reader->capacity) {
+		char *text = realloc(reader->text, 2 * reader->capacity);
+		if (NULL == text) {
+			reader->status = PARSER_STATUS_MALLOC_ERROR;
+			return FAILURE;
+		}
+		reader->text = text;
+		reader->capacity *= 2;
+	}
+	reader->text[reader->length++] = c;
+	reader->text[reader->length] = '\0';
+	return SUCCESS;
+}
+
+/* Skips a comment, whose '[' has been read. NEXUS comments can be nested. */
+
+static void skip_comment(struct nexus_reader *reader)
+{
+	int depth = 1, c;
+	while (depth > 0 && EOF != (c = next_char(reader))) {
+		if ('[' == c) depth++;
+		else if (']' == c) depth--;
+	}
+}
+
+/* Appends a quoted word, whose opening quote has been read, quotes included
+ * ('' stands for a quote within the word). Returns FAILURE in case of error
+ * (malloc()). */
+
+static int read_quoted(struct nexus_reader *reader)
+{
+	int c;
+	if (! append_char(reader, '\'')) return FAILURE;
+	while (EOF != (c = next_char(reader))) {
+		if (! append_char(reader, c)) return FAILURE;
+		if ('\'' != c) continue;
+		c = getc(reader->input);
+		if ('\'' != c) {
+			if (EOF != c) ungetc(c, reader->input);
+			break;
+		}
+		if (! append_char(reader, c)) return FAILURE;
+	}
+	return SUCCESS;
+}
+
+static int is_delimiter(int c)
+{
+	return ';' == c || '=' == c || ',' == c || '[' == c || '\'' == c
+		|| ' ' == c || '\t' == c || '\n' == c || '\r' == c;
+}
+
+/* Reads the next word (a token, or one of ";=,") into the reader's text,
+ * skipping spaces and comments. Returns FAILURE at the end of input, or in
+ * case of error (malloc(), see 'status'). */
+
+static int read_word(struct nexus_reader *reader)
+{
+	int c;
+
+	reader->length = 0;
+	reader->text[0] = '\0';
+	for (;;) {
+		c = next_char(reader);
+		if (EOF == c) return FAILURE;
+		if ('[' == c) skip_comment(reader);
+		else if (! is_delimiter(c) || '\'' == c) break;
+		else if (';' == c || '=' == c || ',' == c)
+			return append_char(reader, c);
+	}
+	if ('\'' == c) return read_quoted(reader);
+	for (;;) {
+		if (! append_char(reader, c)) return FAILURE;
+		c = getc(reader->input);
+		if (EOF == c) break;
+		if (is_delimiter(c)) {
+			ungetc(c, reader->input);
+			break;
+		}
+	}
+	return SUCCESS;
+}
+
+static int is_word(struct nexus_reader *reader, const char *keyword)
+{
+	return 0 == strcasecmp(keyword, reader->text);
+}
+
+/* Skips the rest of the current command, up to its ';' (which may be the
+ * current word). Returns FAILURE at the end of input. */
+
+static int skip_command(struct nexus_reader *reader)
+{
+	while (! is_word(reader, ";"))
+		if (! read_word(reader)) return FAILURE;
+	return SUCCESS;
+}
+
+/* Reports a syntax error. Returns FAILURE, for convenience. */
+
+static int syntax_error(struct nexus_reader *reader, const char *expected)
+{
+	if (PARSER_STATUS_MALLOC_ERROR == reader->status) return FAILURE;
+	fprintf (stderr, "ERROR: NEXUS syntax error at line %d: expected %s "
+		"near '%s'\n", reader->lineno, expected, reader->text);
+	reader->status = PARSER_STATUS_PARSE_ERROR;
+	return FAILURE;
+}
+
+/* Maps label id 'token' to label id 'label'. Returns FAILURE in case of error
+ * (malloc()). */
+
+static int set_translation(struct nexus_reader *reader, int token, int label)
+{
+	if (token >= reader->translation_size) {
+		int size = 2 * token + 16, i;
+		int *translation = realloc(reader->translation,
+				size * sizeof(int));
+		if (NULL == translation) {
+			reader->status = PARSER_STATUS_MALLOC_ERROR;
+			return FAILURE;
+		}
+		for (i = reader->translation_size; i < size; i++)
+			translation[i] = -1;
+		reader->translation = translation;
+		reader->translation_size = size;
+	}
+	reader->translation[token] = label;
+	return SUCCESS;
+}
+
+/* Reads a TRANSLATE command's pairs, up to its ';'. Returns FAILURE in case of
+ * error (see 'status'). */
+
+static int read_translate(struct nexus_reader *reader)
+{
+	int token, label;
+
+	for (;;) {
+		if (! read_word(reader)) return syntax_error(reader, "a token");
+		if (is_word(reader, ";")) return SUCCESS;	/* empty */
+		token = intern_label(reader->text);
+		if (! read_word(reader) || is_word(reader, ",")
+				|| is_word(reader, ";"))
+			return syntax_error(reader, "a label");
+		label = intern_label(reader->text);
+		if (-1 == token || -1 == label
+				|| ! set_translation(reader, token, label)) {
+			reader->status = PARSER_STATUS_MALLOC_ERROR;
+			return FAILURE;
+		}
+		if (! read_word(reader)) return syntax_error(reader, "',' or ';'");
+		if (is_word(reader, ";")) return SUCCESS;
+		if (! is_word(reader, ",")) return syntax_error(reader, "','");
+	}
+}
+
+/* Reads a tree's Newick text, after the '=' of its TREE command, into the
+ * reader's text (comments left out). Returns FAILURE in case of error (see
+ * 'status'). */
+
+static int read_tree_text(struct nexus_reader *reader)
+{
+	int c;
+
+	reader->length = 0;
+	reader->text[0] = '\0';
+	reader->tree_lineno = reader->lineno;
+	while (EOF != (c = next_char(reader))) {
+		if ('[' == c) {
+			skip_comment(reader);
+			continue;
+		}
+		if ('\'' == c) {
+			if (! read_quoted(reader)) return FAILURE;
+			continue;
+		}
+		if (! append_char(reader, c)) return FAILURE;
+		if (';' == c) return SUCCESS;
+	}
+	reader->length = 0;
+	reader->text[0] = '\0';
+	return syntax_error(reader, "';' at end of tree");
+}
+
+/* Reads up to the next TREE command, and its tree's text. Returns FAILURE at
+ * the end of input (status PARSER_STATUS_EMPTY), or in case of error. */
+
+static int next_tree_text(struct nexus_reader *reader)
+{
+	if (! reader->started) {
+		if (! read_word(reader) || ! is_word(reader, "#NEXUS"))
+			return syntax_error(reader, "'#NEXUS'");
+		reader->started = TRUE;
+	}
+	for (;;) {
+		if (! read_word(reader)) {
+			if (PARSER_STATUS_MALLOC_ERROR == reader->status)
+				return FAILURE;
+			reader->status = PARSER_STATUS_EMPTY;
+			return FAILURE;
+		}
+		if (! reader->in_trees_block) {
+			if (is_word(reader, "BEGIN")) {
+				if (! read_word(reader)) break;
+				reader->in_trees_block = is_word(reader, "TREES");
+			}
+		} else if (is_word(reader, "END") || is_word(reader, "ENDBLOCK")) {
+			/* translations are the block's */
+			reader->in_trees_block = FALSE;
+			free(reader->translation);
+			reader->translation = NULL;
+			reader->translation_size = 0;
+		} else if (is_word(reader, "TRANSLATE")) {
+			if (! read_translate(reader)) return FAILURE;
+			continue;
+		} else if (is_word(reader, "TREE") || is_word(reader, "UTREE")) {
+			/* TREE [*] name = tree; */
+			if (! read_word(reader)) break;
+			if (is_word(reader, "*") && ! read_word(reader)) break;
+			if (! read_word(reader) || ! is_word(reader, "="))
+				return syntax_error(reader, "'='");
+			return read_tree_text(reader);
+		}
+		if (! skip_command(reader)) break;
+	}
+	return syntax_error(reader, "';'");
+}
+
+/* Gives the tree's leaves the labels their tokens translate to. Returns
+ * FAILURE in case of error (malloc()). */
+
+static int translate_leaves(struct nexus_reader *reader,
+		struct rooted_tree *tree)
+{
+	struct list_elem *elem;
+
+	if (NULL == reader->translation) return SUCCESS;
+	for (elem = tree->nodes_in_order->head; NULL != elem;
+			elem = elem->next) {
+		struct rnode *node = elem->data;
+		int id = node->label_id;
+		if (! is_leaf(node) || id >= reader->translation_size
+				|| -1 == reader->translation[id])
+			continue;
+		if (! set_rnode_label(node,
+				label_string(reader->translation[id])))
+			return FAILURE;
+	}
+	return SUCCESS;
+}
+
+static struct rooted_tree *read_tree(struct nexus_reader *reader,
+		int in_arena)
+{
+	struct mmap_parser *parser = reader->parser;
+	struct rooted_tree *tree;
+
+	reader->status = PARSER_STATUS_OK;
+	if (! next_tree_text(reader)) return NULL;
+	reset_mmap_text_parser(parser, reader->text, reader->length,
+			reader->tree_lineno);
+	tree = in_arena ? mmap_parse_tree_in_arena(parser)
+		: mmap_parse_tree(parser);
+	if (NULL == tree) {
+		/* "TREE t = ;" has no tree, but it is not the end */
+		reader->status = PARSER_STATUS_EMPTY == parser->status ?
+			PARSER_STATUS_PARSE_ERROR : parser->status;
+		return NULL;
+	}
+	if (! translate_leaves(reader, tree)) {
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+		reader->status = PARSER_STATUS_MALLOC_ERROR;
+		return NULL;
+	}
+	return tree;
+}
+
+struct rooted_tree *nexus_read_tree(struct nexus_reader *reader)
+{
+	return read_tree(reader, FALSE);
+}
+
+struct rooted_tree *nexus_read_tree_in_arena(struct nexus_reader *reader)
+{
+	return read_tree(reader, TRUE);
+}
@@ -0,0 +1,84 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* A reader of the trees of NEXUS files: it finds the TREES blocks, skipping
+ * all other blocks, and returns each TREE of these as a struct rooted_tree,
+ * with the leaf labels given by the block's TRANSLATE command, if any. The
+ * input is read as a stream, one TREE command at a time, so it can be a pipe
+ * and need not fit in memory. Comments (which may be nested, and span lines)
+ * are skipped, as are NEXUS rooting comments like [&R]. */
+
+/* NOTE: as with Newick input, quoted labels keep their quotes. A TRANSLATE
+ * table maps tokens to labels through the label table (see label_table.h), and
+ * applies to the leaves of all later trees of the block. */
+
+/* NOTE: include parser.h first (for enum parser_status_type) */
+
+#include <stdio.h>
+#include <stddef.h>
+
+struct rooted_tree;
+struct mmap_parser;
+
+struct nexus_reader {
+	FILE *input;
+	enum parser_status_type status;
+	int lineno;
+	int tree_lineno;	/* where the last tree's text starts */
+	int started;		/* TRUE once "#NEXUS" has been read */
+	int in_trees_block;
+	char *text;		/* the last word or tree read, NUL-terminated */
+	size_t length;
+	size_t capacity;
+	/* by the label id of a TRANSLATE token: the id of its label, or -1 */
+	int *translation;
+	int translation_size;
+	struct mmap_parser *parser;	/* parses the trees' text */
+};
+
+/* Returns TRUE iff 'input' looks like a NEXUS file (it starts with '#'). It
+ * reads nothing from the input. */
+
+int is_nexus(FILE *input);
+
+/* Creates a reader of 'input', from its current position. The input is not
+ * closed by destroy_nexus_reader(). */
+/* Returns NULL in case of error (malloc()) */
+
+struct nexus_reader *create_nexus_reader(FILE *input);
+
+/* Reads the next tree, like parse_tree(). Sets the reader's 'status'. */
+
+struct rooted_tree *nexus_read_tree(struct nexus_reader *reader);
+
+/* Like nexus_read_tree(), but in an arena, like parse_tree_in_arena() */
+
+struct rooted_tree *nexus_read_tree_in_arena(struct nexus_reader *reader);
+
+void destroy_nexus_reader(struct nexus_reader *reader);
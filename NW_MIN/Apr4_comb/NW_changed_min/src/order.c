@@ -41,6 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "list.h"
 #include "rnode.h"
 #include "order_tree.h"
+#include "output.h"
 
 enum order_criterion { ORDER_ALNUM_LBL, ORDER_NUM_DESCENDANTS, ORDER_DELADDERIZE };
 
@@ -151,12 +152,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-h] <filename|->\n", argv[0]);
@@ -172,6 +172,8 @@ int main(int argc, char *argv[])
 	struct parameters params = get_params(argc, argv);
 	int (*order_function)(struct rooted_tree *);
 
+	buffer_stdout();
+
 	switch(params.criterion) {
 	case ORDER_ALNUM_LBL:
 		order_function =  order_tree_lbl;
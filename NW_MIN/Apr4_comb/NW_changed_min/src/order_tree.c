@@ -34,12 +34,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h> 	//TODO: rm when debugged
+#include <stdint.h>
 
 #include "rnode.h"
 #include "tree.h"
 #include "list.h"
 #include "common.h"
 #include "order_tree.h"
+#include "label_table.h"
 
 int lbl_comparator(const void *a, const void *b)
 {
@@ -55,43 +57,188 @@ int lbl_comparator(const void *a, const void *b)
 	return cmp;
 }
 
+/* order_tree_lbl() sorts on label ranks (see label_ranks()) rather than on
+ * the labels themselves, so that the sort keys are just integers, and can be
+ * kept in the nodes' data pointers. A tree that uses only a small part of the
+ * label table gets its own ranking, over its leaf labels only: otherwise
+ * ordering many small trees with distinct labels (as in nw_order) would cost
+ * the size of the whole table each time. */
+
+#define OWN_RANKING_FACTOR 4
+
+/* Children lists up to this long are sorted in place, by insertion */
+
+#define SMALL_SORT_MAX 16
+
+/* Scratch space, kept between calls so that ordering is allocation-free once
+ * it has grown large enough. Each thread has its own. */
+
+static THREAD_LOCAL int *own_ranks = NULL;	/* indexed by label id */
+static THREAD_LOCAL int own_ranks_size = 0;
+static THREAD_LOCAL int *leaf_ids = NULL;
+static THREAD_LOCAL int leaf_ids_size = 0;
+
+struct rank_sort_entry {
+	int rank;
+	int position;	/* original position, to keep the sort stable */
+	struct rnode *node;
+};
+
+static THREAD_LOCAL struct rank_sort_entry *sort_entries = NULL;
+static THREAD_LOCAL int sort_entries_size = 0;
+
+/* Grows an int array to at least 'size' elements. Returns FAILURE iff
+ * realloc() fails. */
+
+static int grow_int_array(int **array, int *array_size, int size)
+{
+	if (size <= *array_size) return SUCCESS;
+	int *bigger = realloc(*array, size * sizeof(int));
+	if (NULL == bigger) return FAILURE;
+	*array = bigger;
+	*array_size = size;
+	return SUCCESS;
+}
+
+static int label_id_comparator(const void *a, const void *b)
+{
+	return strcmp(label_string(*(const int *) a),
+			label_string(*(const int *) b));
+}
+
+/* Ranks the tree's leaf labels only (equal labels get equal ranks). Returns
+ * the ranks (indexed by label id), or NULL in case of error (malloc()) */
+
+static const int *rank_leaf_labels(struct llist *leaves)
+{
+	int num_leaves = leaves->count;
+	struct list_elem *elem;
+	int i, n = 0, rank = 0;
+
+	if (! grow_int_array(&leaf_ids, &leaf_ids_size, num_leaves))
+		return NULL;
+	if (! grow_int_array(&own_ranks, &own_ranks_size, label_table_size()))
+		return NULL;
+	for (elem = leaves->head; NULL != elem; elem = elem->next) {
+		struct rnode *current = elem->data;
+		leaf_ids[n++] = current->label_id;
+	}
+	qsort(leaf_ids, n, sizeof(int), label_id_comparator);
+	for (i = 0; i < n; i++) {
+		/* ids are unique per label, so equal labels are adjacent */
+		if (i > 0 && leaf_ids[i] != leaf_ids[i-1]) rank++;
+		own_ranks[leaf_ids[i]] = rank;
+	}
+
+	return own_ranks;
+}
+
+static int node_rank(struct rnode *node)
+{
+	return (int) (intptr_t) node->data;
+}
+
+static int rank_sort_entry_comparator(const void *a, const void *b)
+{
+	const struct rank_sort_entry *ea = a;
+	const struct rank_sort_entry *eb = b;
+
+	if (ea->rank != eb->rank) return ea->rank < eb->rank ? -1 : 1;
+	return ea->position < eb->position ? -1 : 1;
+}
+
+/* Sorts the children on their rank, in place and stably. Returns FAILURE iff
+ * the scratch array for long lists cannot be grown. */
+
+static int sort_kids_on_rank(struct llist *children)
+{
+	struct list_elem *el, *prev;
+	int i;
+
+	if (children->count <= SMALL_SORT_MAX) {
+		/* Insertion sort, moving the nodes along the list elements */
+		for (el = children->head; NULL != el; el = el->next) {
+			struct rnode *kid = el->data;
+			struct list_elem *last_ok = children->head;
+			if (el == last_ok) continue;
+			/* find the first element ranked higher than 'kid' */
+			for (; last_ok != el &&
+				node_rank(last_ok->data) <= node_rank(kid);
+				last_ok = last_ok->next)
+				;
+			/* shift nodes from there to 'el' one element right */
+			for (prev = last_ok; prev != el; prev = prev->next) {
+				struct rnode *tmp = prev->data;
+				prev->data = kid;
+				kid = tmp;
+			}
+			el->data = kid;
+		}
+		return SUCCESS;
+	}
+
+	if (children->count > sort_entries_size) {
+		struct rank_sort_entry *bigger = realloc(sort_entries,
+			children->count * sizeof(struct rank_sort_entry));
+		if (NULL == bigger) return FAILURE;
+		sort_entries = bigger;
+		sort_entries_size = children->count;
+	}
+	for (i = 0, el = children->head; NULL != el; i++, el = el->next) {
+		sort_entries[i].node = el->data;
+		sort_entries[i].rank = node_rank(el->data);
+		sort_entries[i].position = i;
+	}
+	qsort(sort_entries, children->count, sizeof(struct rank_sort_entry),
+			rank_sort_entry_comparator);
+	for (i = 0, el = children->head; NULL != el; i++, el = el->next)
+		el->data = sort_entries[i].node;
+
+	return SUCCESS;
+}
+
 int order_tree_lbl(struct rooted_tree *tree)
 {
 	struct list_elem *elem;
+	const int *ranks;
+	/* the tree as it is, which may differ from nodes_in_order */
+	struct llist *postorder = tree_postorder(tree);
+	struct llist *leaves = tree_leaves(tree);
 
-	/* the rnode->data member is used to store the sort field. For leaves,
-	 * this is just the label; for inner nodes it is the sort field of the
-	 * first child (after sorting). */
+	if (NULL == postorder || NULL == leaves) return FAILURE;
+	if (label_table_size() > OWN_RANKING_FACTOR * leaves->count)
+		ranks = rank_leaf_labels(leaves);
+	else
+		ranks = label_ranks();
+	if (NULL == ranks) return FAILURE;
 
-	for (elem=tree->nodes_in_order->head; NULL!=elem; elem=elem->next) {
+	/* the rnode->data member is used to store the sort key. For leaves,
+	 * this is the label's rank; for inner nodes it is the sort key of the
+	 * first child (after sorting), i.e. the lowest rank in the clade. */
+
+	for (elem = postorder->head; NULL != elem; elem = elem->next) {
 		struct rnode *current = elem->data;
 		if (is_leaf(current)) {
-			current->data = strdup(current->label);
+			current->data = (void *) (intptr_t)
+				ranks[current->label_id];
 		} else {
 			/* Since all children have been visited (because we're
 			 * traversing the tree in parse order), we can just
-			 * order the children on their sort field. */
-
-			struct rnode ** kids_array;
-			int count = current->children->count;
-			kids_array = (struct rnode **)
-				llist_to_array(current->children);
-			if (NULL == kids_array) return FAILURE;
-			destroy_llist(current->children);
-			qsort(kids_array, count, sizeof(struct rnode *),
-					lbl_comparator);
-			struct llist *ordered_kids_list;
-			ordered_kids_list = array_to_llist(
-				(void **) kids_array, count);
-			if (NULL == ordered_kids_list) return FAILURE;
-			current->children = ordered_kids_list;
-
-			// Get sort field from first child ("back-inherit") [?]
-			current->data = strdup(kids_array[0]->data);
-			free(kids_array);
+			 * order the children on their sort key. */
+			if (! sort_kids_on_rank(current->children))
+				return FAILURE;
+			struct rnode *first_kid = current->children->head->data;
+			current->data = first_kid->data;
 		}
 	}
 
+	/* The keys are not pointers: clear them, since destroying a node
+	 * free()s its data */
+	for (elem = postorder->head; NULL != elem; elem = elem->next)
+		((struct rnode *) elem->data)->data = NULL;
+	/* children were reordered (postorder goes too) */
+	forget_tree_orders(tree);
+
 	return SUCCESS;
 }
 
@@ -149,6 +296,7 @@ int order_tree_num_desc(struct rooted_tree *tree)
 			*((int *) current->data) = nb_descendants;
 		}
 	}
+	forget_tree_orders(tree);
 
 	return SUCCESS;
 }
@@ -214,6 +362,7 @@ int order_tree_deladderize(struct rooted_tree *tree)
 			*((int *) current->data) = nb_descendants;
 		}
 	}
+	forget_tree_orders(tree);
 
 	return SUCCESS;
 }
@@ -43,9 +43,12 @@ int num_desc_comparator(const void *a, const void *b);
 
 int reverse_num_desc_comparator(const void *a, const void *b);
 
-/* Orders all nodes in the tree, according to lbl_comparator() - this could be
- * parametered, if we can think of other interesting orders. NOTE: this
- * function uses (and modifies) the rnode's data attribute. */
+/* Orders all nodes in the tree by label: leaves by their own label, inner
+ * nodes by their clade's lowest label (in strcmp() order, like
+ * lbl_comparator()). The sort keys are label ranks, not strings, so the
+ * function allocates nothing once its scratch space has grown. NOTE: this
+ * function uses the rnode's data attribute for the keys, and leaves it NULL. */
+/* Returns FAILURE iff the scratch space cannot be grown (malloc()) */
 
 int order_tree_lbl(struct rooted_tree *tree);
 
@@ -0,0 +1,216 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "output.h"
+#include "common.h"
+
+/* Doubles are formatted by scaling them to an integer of the digits to write,
+ * and rounding that. This is exact unless the scaled value is (nearly) halfway
+ * between two integers, where the scaling's own rounding error could tip the
+ * result: such values, and those outside the ranges below, are left to
+ * sprintf(). */
+
+#define HALFWAY_MARGIN 1e-6
+
+/* "%g" writes numbers in [1e-4, 1e6) without an exponent, with 6 digits */
+
+#define G_DIGITS 6
+#define G_MIN 1e-4
+#define G_MAX 1e6
+
+/* "%.*f" is handled for up to this many decimals, and scaled values below
+ * FIXED_MAX (where a double still has plenty of fractional bits) */
+
+#define FIXED_MAX_DECIMALS 9
+#define FIXED_MAX 1e9
+
+static const double powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static char stdout_buffer[OUTPUT_BUFFER_SIZE];
+
+void buffer_stdout()
+{
+	if (isatty(fileno(stdout))) return;
+	setvbuf(stdout, stdout_buffer, _IOFBF, OUTPUT_BUFFER_SIZE);
+}
+
+/* Writes the digits of 'n' to 'dest', at least 'min_digits' of them (with
+ * leading zeros). Returns a pointer to the terminating '\0'. */
+
+static char *format_digits(char *dest, unsigned long long n, int min_digits)
+{
+	char digits[24];
+	int length = 0;
+
+	do {
+		digits[length++] = '0' + n % 10;
+		n /= 10;
+	} while (n > 0);
+	while (length < min_digits) digits[length++] = '0';
+	while (length > 0) *dest++ = digits[--length];
+	*dest = '\0';
+	return dest;
+}
+
+char *format_long(char *dest, long n)
+{
+	unsigned long magnitude = n;
+	if (n < 0) {
+		*dest++ = '-';
+		magnitude = - magnitude;
+	}
+	return format_digits(dest, magnitude, 1);
+}
+
+/* Rounds 'scaled' (>= 0) to the nearest integer. Returns FALSE if it is too
+ * close to halfway to tell. */
+
+static int round_scaled(double scaled, unsigned long long *rounded)
+{
+	double whole = floor(scaled);
+	double fraction = scaled - whole;
+
+	if (fabs(fraction - 0.5) < HALFWAY_MARGIN) return FALSE;
+	*rounded = (unsigned long long) whole + (fraction > 0.5);
+	return TRUE;
+}
+
+static char *format_with_printf(char *dest, const char *format, double x)
+{
+	return dest + sprintf(dest, format, x);
+}
+
+char *format_double(char *dest, double x)
+{
+	double magnitude = fabs(x);
+	unsigned long long digits;
+	char text[G_DIGITS + 1];
+	int exponent, point, end;
+
+	if (0 == x) {
+		strcpy(dest, signbit(x) ? "-0" : "0");
+		return dest + strlen(dest);
+	}
+	/* (false for NaN) */
+	if (! (magnitude >= G_MIN && magnitude < G_MAX))
+		return format_with_printf(dest, "%g", x);
+
+	/* 10^exponent <= magnitude < 10^(exponent + 1) */
+	for (exponent = G_DIGITS - 1; exponent >= 0; exponent--)
+		if (magnitude >= powers_of_ten[exponent]) break;
+	if (exponent < 0)
+		for (exponent = -1; magnitude * powers_of_ten[-exponent] < 1;
+				exponent--)
+			;
+	if (! round_scaled(magnitude *
+			powers_of_ten[G_DIGITS - 1 - exponent], &digits))
+		return format_with_printf(dest, "%g", x);
+	/* rounded up to the next power of ten, maybe out of range (or the
+	 * exponent is off by one, for values within an ulp of a power) */
+	if (digits >= powers_of_ten[G_DIGITS]
+		|| digits < powers_of_ten[G_DIGITS - 1])
+		return format_with_printf(dest, "%g", x);
+
+	format_digits(text, digits, G_DIGITS);
+	/* trailing zeros of the fraction are not written */
+	for (end = G_DIGITS; end > 1 && '0' == text[end - 1]; end--)
+		;
+	if (x < 0) *dest++ = '-';
+	if (exponent >= 0) {
+		point = exponent + 1;
+		memcpy(dest, text, point);
+		dest += point;
+		if (end > point) {
+			*dest++ = '.';
+			memcpy(dest, text + point, end - point);
+			dest += end - point;
+		}
+	} else {
+		*dest++ = '0';
+		*dest++ = '.';
+		memset(dest, '0', -exponent - 1);
+		dest += -exponent - 1;
+		memcpy(dest, text, end);
+		dest += end;
+	}
+	*dest = '\0';
+	return dest;
+}
+
+char *format_fixed(char *dest, double x, int decimals)
+{
+	unsigned long long scaled;
+	double unit;
+
+	if (decimals < 0 || decimals > FIXED_MAX_DECIMALS
+		|| ! (fabs(x) * powers_of_ten[decimals] < FIXED_MAX)
+		|| ! round_scaled(fabs(x) * powers_of_ten[decimals], &scaled))
+		return dest + sprintf(dest, "%.*f", decimals, x);
+	/* printf() keeps the sign of values that round to zero */
+	if (signbit(x)) *dest++ = '-';
+	unit = powers_of_ten[decimals];
+	dest = format_digits(dest, scaled / (unsigned long long) unit, 1);
+	if (decimals > 0) {
+		*dest++ = '.';
+		dest = format_digits(dest, scaled % (unsigned long long) unit,
+				decimals);
+	}
+	return dest;
+}
+
+void out_string(FILE *out, const char *string)
+{
+	fputs(string, out);
+}
+
+void out_long(FILE *out, long n)
+{
+	char text[NUMBER_STRING_SIZE];
+	fwrite(text, 1, format_long(text, n) - text, out);
+}
+
+void out_double(FILE *out, double x)
+{
+	char text[NUMBER_STRING_SIZE];
+	fwrite(text, 1, format_double(text, x) - text, out);
+}
+
+void out_fixed(FILE *out, double x, int decimals)
+{
+	char text[NUMBER_STRING_SIZE];
+	fwrite(text, 1, format_fixed(text, x, decimals) - text, out);
+}
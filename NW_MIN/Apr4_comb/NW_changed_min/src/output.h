@@ -0,0 +1,74 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Fast output, for tools that write a lot: a large buffer for the output
+ * stream, and numbers formatted without printf(). The functions below write to
+ * the stream through stdio, so they can be mixed freely with printf() and
+ * friends, but they skip the parsing of a format - and the formatting of
+ * doubles, which is printf()'s slowest part. Numbers come out exactly as
+ * printf() would write them. */
+
+#include <stdio.h>
+
+/* The size of the buffer buffer_stdout() gives stdout */
+
+#define OUTPUT_BUFFER_SIZE (256 * 1024)
+
+/* Large enough for any number written by the format_*() functions below */
+
+#define NUMBER_STRING_SIZE 512
+
+/* Gives stdout a buffer of OUTPUT_BUFFER_SIZE, unless it is a terminal
+ * (which stays line-buffered). Call it before anything is written to stdout,
+ * e.g. at the start of main(). */
+
+void buffer_stdout();
+
+/* Each of these writes a number to 'dest' (which must have room for
+ * NUMBER_STRING_SIZE characters), and returns a pointer to the terminating
+ * '\0'. */
+
+/* Like sprintf(dest, "%ld", n) */
+
+char *format_long(char *dest, long n);
+
+/* Like sprintf(dest, "%g", x) */
+
+char *format_double(char *dest, double x);
+
+/* Like sprintf(dest, "%.*f", decimals, x), for 0 <= decimals <= 9 */
+
+char *format_fixed(char *dest, double x, int decimals);
+
+/* These write a string or a number, formatted as above, to 'out' */
+
+void out_string(FILE *out, const char *string);
+void out_long(FILE *out, long n);
+void out_double(FILE *out, double x);
+void out_fixed(FILE *out, double x, int decimals);
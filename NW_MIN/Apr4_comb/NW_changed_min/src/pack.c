@@ -0,0 +1,148 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* nw_pack: store Newick trees as a tree pack (see tree_pack.h) */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <string.h>
+
+#include "parser.h"
+#include "tree.h"
+#include "flat_tree.h"
+#include "tree_pack.h"
+#include "common.h"
+
+void help(char *argv[])
+{
+	printf (
+"Stores Newick trees in a binary tree pack, which all programs read faster\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s [-h] <newick trees filename|->\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"First argument is the name of a file that contains Newick trees, or '-'\n"
+"(in which case trees are read from standard input).\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"Writes the trees, as a tree pack, to standard output. By convention, packs\n"
+"have suffix '.nwb'. If a tree can't be read, the output is not a valid pack\n"
+"and the exit status is nonzero.\n"
+"\n"
+"A pack holds each tree's nodes as arrays, with labels and branch lengths\n"
+"stored once for all trees. Every program that reads trees accepts a pack\n"
+"instead of a Newick file, and reads it in place, without parsing: this\n"
+"pays off when the same trees are read many times (e.g. bootstrap\n"
+"replicates, at each stage of a pipeline). Packs depend on the machine's\n"
+"byte order: use Newick to exchange trees. See also nw_unpack.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# pack bootstrap replicates, then use the pack\n"
+"$ %s data/HRV_20reps.nw > HRV_20reps.nwb\n"
+"$ nw_topology HRV_20reps.nwb\n",
+	argv[0],
+	argv[0]
+	);
+}
+
+void get_params(int argc, char *argv[])
+{
+	int opt_char;
+	while ((opt_char = getopt(argc, argv, "h")) != -1) {
+		switch (opt_char) {
+		case 'h':
+			help(argv);
+			exit(EXIT_SUCCESS);
+		default:
+			fprintf (stderr, "Unknown option '-%c'\n", opt_char);
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	/* check arguments */
+	if ((argc - optind) == 1)	{
+		if (0 != strcmp("-", argv[optind])) {
+			FILE *fin = fopen(argv[optind], "r");
+			if (NULL == fin) {
+				perror(NULL);
+				exit(EXIT_FAILURE);
+			}
+			set_parser_input(fin);
+		}
+	} else {
+		fprintf(stderr, "Usage: %s [-h] <filename|->\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct rooted_tree *tree;
+	struct tree_pack_writer *writer;
+
+	get_params(argc, argv);
+
+	writer = create_tree_pack_writer(stdout);
+	if (NULL == writer) { perror(NULL); exit(EXIT_FAILURE); }
+
+	while ((tree = parse_tree_in_arena()) != NULL) {
+		struct flat_tree *flat = create_flat_tree(tree);
+		if (NULL == flat || ! write_packed_tree(writer, flat)) {
+			perror(NULL);
+			exit(EXIT_FAILURE);
+		}
+		destroy_flat_tree(flat);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+	}
+	if (PARSER_STATUS_EMPTY != newick_parser_status()) {	/* EOF */
+		fprintf (stderr, "Error reading trees - pack not finished.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (! finish_tree_pack(writer) || 0 != fflush(stdout)) {
+		perror(NULL);
+		exit(EXIT_FAILURE);
+	}
+
+	return 0;
+}
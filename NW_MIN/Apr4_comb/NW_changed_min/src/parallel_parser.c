@@ -0,0 +1,337 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "parser.h"
+#include "mmap_parser.h"
+#include "parallel_parser.h"
+#include "tree_index.h"
+#include "tree.h"
+#include "label_table.h"
+#include "common.h"
+
+/* Chunks are cut at the first tree that starts this many bytes or more after
+ * the chunk's start, so a chunk may be larger (if its trees are) but never
+ * splits a tree. */
+
+#define CHUNK_SIZE 65536
+
+/* How many chunks each worker may parse ahead of the caller */
+
+#define CHUNKS_AHEAD_PER_WORKER 4
+
+#define INIT_CHUNK_TREES 16
+
+/* A chunk of text, and the trees parsed from it. A chunk is 'done' once all
+ * its trees have been parsed; the caller then takes them, in order. 'status'
+ * is PARSER_STATUS_EMPTY if the chunk's text was parsed to the end. */
+
+struct parsed_chunk {
+	size_t start;
+	size_t end;
+	struct rooted_tree **trees;
+	int num_trees;
+	int next;		/* the next tree to hand out */
+	int done;
+	enum parser_status_type status;
+};
+
+/* Workers take chunks in order ('next_chunk'), but may finish them in any
+ * order; the caller reads chunk 'current_chunk'. Both numbers, and the chunks'
+ * 'done' flags, are changed under 'lock'. */
+
+struct parallel_parser {
+	struct mmap_parser *map;	/* only owns the mapping */
+	struct parsed_chunk *chunks;
+	int num_chunks;
+	int next_chunk;
+	int current_chunk;
+	int max_ahead;
+	int in_arena;
+	int stop;
+	enum parser_status_type status;
+	pthread_mutex_t lock;
+	pthread_cond_t chunk_done;	/* signalled by workers */
+	pthread_cond_t chunk_taken;	/* signalled by the caller */
+	pthread_t *workers;
+	int num_workers;
+};
+
+int num_processors()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num > 0) return num;
+#endif
+	return 1;
+}
+
+/* Sets the chunks' limits: 'index' tells where the trees start. The first
+ * chunk starts at the parser's current position, and the last one ends at the
+ * end of the text (trailing text is then parsed, and reported, as it would be
+ * by a single parser). Returns FAILURE in case of error (malloc()) */
+
+static int cut_chunks(struct parallel_parser *parser, struct tree_index *index)
+{
+	size_t start = parser->map->pos, size = parser->map->size;
+	int capacity = 16;
+	long n;
+
+	parser->num_chunks = 0;
+	parser->chunks = malloc(capacity * sizeof(struct parsed_chunk));
+	if (NULL == parser->chunks) return FAILURE;
+	if (start == size) return SUCCESS;
+
+	for (n = 0; ; n++) {
+		struct parsed_chunk *chunk;
+		int last = n == index->num_trees;
+		size_t end = last ? size : (size_t) index->offset[n];
+		if (! last && end < start + CHUNK_SIZE) continue;
+		if (parser->num_chunks == capacity) {
+			struct parsed_chunk *bigger;
+			capacity *= 2;
+			bigger = realloc(parser->chunks,
+				capacity * sizeof(struct parsed_chunk));
+			if (NULL == bigger) return FAILURE;
+			parser->chunks = bigger;
+		}
+		chunk = parser->chunks + parser->num_chunks++;
+		chunk->start = start;
+		chunk->end = end;
+		chunk->trees = NULL;
+		chunk->num_trees = 0;
+		chunk->next = 0;
+		chunk->done = FALSE;
+		chunk->status = PARSER_STATUS_EMPTY;
+		start = chunk->end;
+		if (last) return SUCCESS;
+	}
+}
+
+/* Parses all trees of a chunk, stopping at the first error */
+
+static void parse_chunk(struct parallel_parser *parser,
+		struct parsed_chunk *chunk)
+{
+	struct mmap_parser *text_parser = create_mmap_text_parser(
+		parser->map->text + chunk->start, chunk->end - chunk->start);
+	struct rooted_tree *tree;
+	int capacity = 0;
+
+	if (NULL == text_parser) {
+		chunk->status = PARSER_STATUS_MALLOC_ERROR;
+		return;
+	}
+	for (;;) {
+		tree = parser->in_arena ? mmap_parse_tree_in_arena(text_parser)
+			: mmap_parse_tree(text_parser);
+		if (NULL == tree) break;
+		if (chunk->num_trees == capacity) {
+			struct rooted_tree **bigger;
+			capacity = 0 == capacity ? INIT_CHUNK_TREES
+				: 2 * capacity;
+			bigger = realloc(chunk->trees,
+				capacity * sizeof(struct rooted_tree *));
+			if (NULL == bigger) {
+				destroy_tree(tree, DONT_FREE_NODE_DATA);
+				text_parser->status =
+					PARSER_STATUS_MALLOC_ERROR;
+				break;
+			}
+			chunk->trees = bigger;
+		}
+		chunk->trees[chunk->num_trees++] = tree;
+	}
+	chunk->status = text_parser->status;
+	destroy_mmap_parser(text_parser);
+}
+
+static void *worker(void *arg)
+{
+	struct parallel_parser *parser = arg;
+	struct parsed_chunk *chunk;
+
+	/* parsing is mostly creating nodes, which intern their labels */
+	use_label_cache();
+	pthread_mutex_lock(&parser->lock);
+	for (;;) {
+		while (! parser->stop && parser->next_chunk < parser->num_chunks
+			&& parser->next_chunk >=
+				parser->current_chunk + parser->max_ahead)
+			pthread_cond_wait(&parser->chunk_taken, &parser->lock);
+		if (parser->stop || parser->next_chunk == parser->num_chunks)
+			break;
+		chunk = parser->chunks + parser->next_chunk++;
+		pthread_mutex_unlock(&parser->lock);
+
+		parse_chunk(parser, chunk);
+
+		pthread_mutex_lock(&parser->lock);
+		chunk->done = TRUE;
+		pthread_cond_broadcast(&parser->chunk_done);
+	}
+	pthread_mutex_unlock(&parser->lock);
+	free_label_cache();
+
+	return NULL;
+}
+
+/* Stops the workers and waits for them to exit */
+
+static void stop_workers(struct parallel_parser *parser)
+{
+	int i;
+
+	pthread_mutex_lock(&parser->lock);
+	parser->stop = TRUE;
+	pthread_cond_broadcast(&parser->chunk_taken);
+	pthread_mutex_unlock(&parser->lock);
+	for (i = 0; i < parser->num_workers; i++)
+		pthread_join(parser->workers[i], NULL);
+	parser->num_workers = 0;
+}
+
+struct parallel_parser *create_parallel_parser(FILE *input, int num_threads,
+		int in_arena)
+{
+	struct parallel_parser *parser;
+	struct tree_index *index;
+
+	if (num_threads < 1) num_threads = 1;
+	parser = malloc(sizeof(struct parallel_parser));
+	if (NULL == parser) return NULL;
+	parser->chunks = NULL;
+	parser->workers = NULL;
+	parser->num_workers = 0;
+	parser->next_chunk = parser->current_chunk = 0;
+	parser->max_ahead = CHUNKS_AHEAD_PER_WORKER * num_threads;
+	parser->in_arena = in_arena;
+	parser->stop = FALSE;
+	parser->status = PARSER_STATUS_OK;
+	pthread_mutex_init(&parser->lock, NULL);
+	pthread_cond_init(&parser->chunk_done, NULL);
+	pthread_cond_init(&parser->chunk_taken, NULL);
+
+	parser->map = create_mmap_parser(input);
+	if (NULL == parser->map) goto error;
+	index = index_tree_text(parser->map->text, parser->map->size);
+	if (NULL == index) goto error;
+	if (! cut_chunks(parser, index)) {
+		destroy_tree_index(index);
+		goto error;
+	}
+	destroy_tree_index(index);
+
+	parser->workers = malloc(num_threads * sizeof(pthread_t));
+	if (NULL == parser->workers) goto error;
+	for (; parser->num_workers < num_threads; parser->num_workers++)
+		if (0 != pthread_create(parser->workers + parser->num_workers,
+					NULL, worker, parser))
+			goto error;
+
+	return parser;
+
+error:
+	destroy_parallel_parser(parser);
+	return NULL;
+}
+
+struct rooted_tree *parallel_parse_tree(struct parallel_parser *parser)
+{
+	struct parsed_chunk *chunk;
+	struct rooted_tree *tree;
+
+	for (;;) {
+		if (parser->current_chunk == parser->num_chunks) {
+			if (PARSER_STATUS_OK == parser->status)
+				parser->status = PARSER_STATUS_EMPTY;
+			return NULL;
+		}
+		chunk = parser->chunks + parser->current_chunk;
+		pthread_mutex_lock(&parser->lock);
+		while (! chunk->done)
+			pthread_cond_wait(&parser->chunk_done, &parser->lock);
+		pthread_mutex_unlock(&parser->lock);
+		if (chunk->next < chunk->num_trees) {
+			tree = chunk->trees[chunk->next];
+			chunk->trees[chunk->next++] = NULL;
+			/* the tree's cached orders were stamped with the
+			 * worker's link_changes (see tree.h): restamp them with
+			 * ours */
+			use_nodes_in_order_as_postorder(tree);
+			parser->status = PARSER_STATUS_OK;
+			return tree;
+		}
+		free(chunk->trees);
+		chunk->trees = NULL;
+		if (PARSER_STATUS_EMPTY != chunk->status) {
+			/* an error: as a single parser, stop there */
+			parser->status = chunk->status;
+			stop_workers(parser);
+			parser->current_chunk = parser->num_chunks;
+			return NULL;
+		}
+		pthread_mutex_lock(&parser->lock);
+		parser->current_chunk++;
+		pthread_cond_broadcast(&parser->chunk_taken);
+		pthread_mutex_unlock(&parser->lock);
+	}
+}
+
+enum parser_status_type parallel_parser_status(struct parallel_parser *parser)
+{
+	return parser->status;
+}
+
+void destroy_parallel_parser(struct parallel_parser *parser)
+{
+	int c, n;
+
+	stop_workers(parser);
+	free(parser->workers);
+	if (NULL != parser->chunks) {
+		for (c = 0; c < parser->num_chunks; c++) {
+			struct parsed_chunk *chunk = parser->chunks + c;
+			for (n = chunk->next; n < chunk->num_trees; n++)
+				destroy_tree(chunk->trees[n],
+						DONT_FREE_NODE_DATA);
+			free(chunk->trees);
+		}
+		free(parser->chunks);
+	}
+	if (NULL != parser->map) destroy_mmap_parser(parser->map);
+	pthread_cond_destroy(&parser->chunk_taken);
+	pthread_cond_destroy(&parser->chunk_done);
+	pthread_mutex_destroy(&parser->lock);
+	free(parser);
+}
@@ -0,0 +1,74 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* A parallel front end to the mmap parser (see mmap_parser.h), for large
+ * multi-tree files. The file is mapped once and split into chunks of whole
+ * trees, using a tree index (see tree_index.h); worker threads parse the
+ * chunks, each with a parser of its own, and the trees are handed out in input
+ * order, as if read by a single parser. Workers only parse a few chunks ahead
+ * of the caller, so memory use does not grow with the file. */
+
+/* NOTE: like the mmap parser, this only reads regular files, and
+ * create_parallel_parser() returns NULL for other inputs. The trees are
+ * independent of the workers, and belong to the caller like those of
+ * parse_tree(). */
+
+/* NOTE: include parser.h first (for enum parser_status_type) */
+
+#include <stdio.h>
+
+struct parallel_parser;
+
+/* Creates a parser over the rest of 'input' (from its current position), and
+ * starts 'num_threads' workers (at least one). If 'in_arena' is TRUE, each
+ * tree is parsed into an arena, like parse_tree_in_arena() does. The file can
+ * be closed afterwards. */
+/* Returns NULL if the file cannot be mapped, or in case of error (malloc(),
+ * threads) */
+
+struct parallel_parser *create_parallel_parser(FILE *input, int num_threads,
+		int in_arena);
+
+/* Returns the next tree, like parse_tree(), or NULL at the end of input or in
+ * case of error. Must be called from one thread at a time. */
+
+struct rooted_tree *parallel_parse_tree(struct parallel_parser *parser);
+
+/* Status of the last parallel_parse_tree() */
+
+enum parser_status_type parallel_parser_status(struct parallel_parser *parser);
+
+/* Returns the number of processors, as a default number of workers */
+
+int num_processors();
+
+/* Stops the workers, frees the trees they parsed ahead (but not those already
+ * returned), and frees the parser. */
+
+void destroy_parallel_parser(struct parallel_parser *parser);
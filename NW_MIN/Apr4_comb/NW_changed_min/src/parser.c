@@ -29,64 +29,443 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "list.h"
-// #include "newick.tab.h"
 #include "tree.h"
 #include "parser.h"
+#include "newick_parser.h"
+#include "newick_scanner.h"
 #include "common.h"
+#include "arena.h"
+#include "mmap_parser.h"
+#include "parallel_parser.h"
+#include "compressed_io.h"
+#include "tree_pack.h"
+#include "nexus_reader.h"
 
-struct llist *nodes_in_order;
-struct rnode *root;
-enum parser_status_type newick_parser_status;
+/* State of the default parser, see parse_tree() */
 
-int nwsparse(); // TODO: rm this if fails
+static struct newick_parser *default_parser = NULL;
+static struct newick_parser *string_parser = NULL;
+static FILE *default_input = NULL;
+static FILE *decompressed_input = NULL;	/* see current_input() */
+static enum parser_status_type last_status = PARSER_STATUS_OK;
+static int engine = -1;		/* unset: see current_engine() */
+static struct mmap_parser *default_mmap_parser = NULL;
+static int mmap_unavailable = FALSE;	/* for the current input */
+static struct parallel_parser *default_parallel_parser = NULL;
+static int num_parser_threads = 0;	/* 0: see current_parallel_parser() */
+static int input_is_pack = -1;	/* unset: see current_tree_pack() */
+static struct tree_pack *default_pack = NULL;
+static long next_packed_tree = 0;
+static int input_is_nexus = -1;	/* unset: see current_nexus_reader() */
+static struct nexus_reader *default_nexus_reader = NULL;
 
-int set_parser_input_filename (char *filename)
+struct newick_parser *create_newick_parser(FILE *input)
 {
-	extern FILE *nwsin;
-	FILE *fin = fopen(filename, "r");
-	if (NULL == fin) return FAILURE;
-	nwsin = fin;
+	struct newick_parser *parser = malloc(sizeof(struct newick_parser));
+	if (NULL == parser) return NULL;
 
-	return SUCCESS;
+	parser->input = input;
+	parser->root = NULL;
+	parser->nodes_in_order = NULL;
+	parser->status = PARSER_STATUS_OK;
+	parser->lineno = 0;
+	if (0 != nwslex_init_extra(parser, &(parser->scanner))) {
+		free(parser);
+		return NULL;
+	}
+	if (NULL != input) nwsset_in(input, parser->scanner);
+
+	return parser;
 }
 
-// TODO: have caller check value
-struct rooted_tree *parse_tree()
+struct newick_parser *create_newick_string_parser(const char *newick)
+{
+	struct newick_parser *parser = create_newick_parser(NULL);
+	if (NULL == parser) return NULL;
+
+	/* the copy is the scanner's, and goes with it */
+	if (SUCCESS != nws_scan_string(newick, parser->scanner)) {
+		destroy_newick_parser(parser);
+		return NULL;
+	}
+
+	return parser;
+}
+
+void destroy_newick_parser(struct newick_parser *parser)
+{
+	nwslex_destroy(parser->scanner);
+	free(parser);
+}
+
+/* Parses a tree; if 'arena' is not NULL, the tree's nodes and lists are
+ * allocated from it. */
+
+static struct rooted_tree *parse_tree_with_arena(struct newick_parser *parser,
+		struct arena *arena)
 {
 	struct rooted_tree *tree;
+	struct arena *previous;
 
 	tree = malloc(sizeof(struct rooted_tree));
 	if(NULL == tree) {
-		newick_parser_status = PARSER_STATUS_MALLOC_ERROR; 
-		printf("\nError 1");
+		parser->status = PARSER_STATUS_MALLOC_ERROR; 
 		return NULL;
 	}
 
-	nodes_in_order = create_llist();
-	if (NULL == nodes_in_order) {
-		newick_parser_status = PARSER_STATUS_MALLOC_ERROR;
-		printf("\nError 2");
+	previous = set_current_arena(arena);
+	parser->nodes_in_order = create_llist();
+	if (NULL == parser->nodes_in_order) {
+		set_current_arena(previous);
+		free(tree);
+		parser->status = PARSER_STATUS_MALLOC_ERROR;
 		return NULL;
 	}
 
-	/* calls the YACC (Bison, in fact) parser. This sets 'root' and
-	 * 'newick_parser_status'. */
-	nwsparse();
+	/* calls the YACC (Bison, in fact) parser. This sets the parser's
+	 * 'root' and 'status'. */
+	parser->root = NULL;
+	parser->status = PARSER_STATUS_OK;
+	nwsparse(parser, parser->scanner);
+	set_current_arena(previous);
 	
-	if (NULL != root) {
-		tree->root = root;
-		tree->nodes_in_order = nodes_in_order;
+	if (NULL != parser->root) {
+		tree->root = parser->root;
+		tree->nodes_in_order = parser->nodes_in_order;
 		tree->type = TREE_TYPE_UNKNOWN; 
+		tree->arena = arena;
+		tree->orders = NULL;
+		use_nodes_in_order_as_postorder(tree);
+		parser->root = NULL;
+		parser->nodes_in_order = NULL;
 		return tree;
 	} else {
 		free(tree);
-		destroy_llist(nodes_in_order);
-		/* NOTE: 'newick_parser_status' has been set by nwsparse(), and
+		destroy_llist(parser->nodes_in_order);
+		parser->nodes_in_order = NULL;
+		/* NOTE: the parser's 'status' has been set by nwsparse(), and
 		 * can be read by caller (should, in fact). */
-		printf("\nError 3");
 		return NULL;
 	}
 }
 
+// TODO: have caller check value
+struct rooted_tree *parser_parse_tree(struct newick_parser *parser)
+{
+	return parse_tree_with_arena(parser, NULL);
+}
+
+struct rooted_tree *parser_parse_tree_in_arena(struct newick_parser *parser)
+{
+	struct rooted_tree *tree;
+	struct arena *arena = create_arena();
+
+	if (NULL == arena) {
+		parser->status = PARSER_STATUS_MALLOC_ERROR;
+		return NULL;
+	}
+	tree = parse_tree_with_arena(parser, arena);
+	/* no tree (or an error): nothing of the arena is in use */
+	if (NULL == tree) destroy_arena(arena);
+	return tree;
+}
+
+/* Returns the default parsers' input: the file set by set_parser_input() (or
+ * stdin), decompressed if need be (see compressed_io.h). */
+
+static FILE *current_input()
+{
+	FILE *input = NULL == default_input ? stdin : default_input;
+
+	if (NULL == decompressed_input) {
+		decompressed_input = open_decompressed(input, FALSE);
+		if (NULL == decompressed_input) {
+			fprintf(stderr, "WARNING: can't decompress input "
+				"(not supported by this build?)\n");
+			decompressed_input = input;
+		}
+	}
+	return decompressed_input;
+}
+
+/* Returns the parser that parse_tree() should use, creating the default one if
+ * needed. */
+
+static struct newick_parser *current_parser()
+{
+	if (NULL != string_parser) return string_parser;
+	if (NULL == default_parser)
+		default_parser = create_newick_parser(current_input());
+	return default_parser;
+}
+
+static enum parser_engine current_engine()
+{
+	if (-1 == engine) {
+		const char *name = getenv("NW_PARSER");
+		if (NULL != name && 0 == strcmp("mmap", name))
+			engine = PARSER_ENGINE_MMAP;
+		else if (NULL != name && 0 == strcmp("parallel", name))
+			engine = PARSER_ENGINE_PARALLEL;
+		else
+			engine = PARSER_ENGINE_BISON;
+	}
+	return engine;
+}
+
+/* Returns the mmap parser that parse_tree() should use, or NULL if it should
+ * use the Bison parser (which it always does for strings, and for inputs that
+ * can't be mapped). */
+
+static struct mmap_parser *current_mmap_parser()
+{
+	if (PARSER_ENGINE_MMAP != current_engine()) return NULL;
+	if (NULL != string_parser || mmap_unavailable) return NULL;
+	if (NULL == default_mmap_parser) {
+		default_mmap_parser = create_mmap_parser(current_input());
+		if (NULL == default_mmap_parser) mmap_unavailable = TRUE;
+	}
+	return default_mmap_parser;
+}
+
+/* Returns the parallel parser that parse_tree() should use, or NULL if it
+ * should use another one. The first call decides whether trees are parsed into
+ * arenas - mixing parse_tree() and parse_tree_in_arena() still works. */
+
+static struct parallel_parser *current_parallel_parser(int in_arena)
+{
+	if (PARSER_ENGINE_PARALLEL != current_engine()) return NULL;
+	if (NULL != string_parser || mmap_unavailable) return NULL;
+	if (NULL == default_parallel_parser) {
+		int num_threads = num_parser_threads;
+		if (0 == num_threads) {
+			const char *threads = getenv("NW_PARSER_THREADS");
+			num_threads = NULL == threads ? 0 : atoi(threads);
+		}
+		if (num_threads < 1) num_threads = num_processors();
+		default_parallel_parser = create_parallel_parser(
+			current_input(), num_threads, in_arena);
+		if (NULL == default_parallel_parser) mmap_unavailable = TRUE;
+	}
+	return default_parallel_parser;
+}
+
+/* Returns TRUE iff the default input is a tree pack, and opens the pack the
+ * first time (default_pack stays NULL if it is invalid). */
+
+static int current_tree_pack()
+{
+	if (NULL != string_parser) return FALSE;
+	if (-1 == input_is_pack) {
+		input_is_pack = is_tree_pack(current_input());
+		if (input_is_pack) {
+			default_pack = open_tree_pack(current_input());
+			next_packed_tree = 0;
+		}
+	}
+	return input_is_pack;
+}
+
+/* Returns the pack's next tree, like parse_tree() */
+
+static struct rooted_tree *parse_packed_tree(int in_arena)
+{
+	struct rooted_tree *tree;
+	struct arena *arena = NULL;
+
+	if (NULL == default_pack) {
+		last_status = PARSER_STATUS_PARSE_ERROR;
+		fprintf (stderr, "ERROR: invalid tree pack\n");
+		return NULL;
+	}
+	if (next_packed_tree == default_pack->num_trees) {
+		last_status = PARSER_STATUS_EMPTY;
+		return NULL;
+	}
+	last_status = PARSER_STATUS_OK;
+	if (in_arena) {
+		arena = create_arena();
+		if (NULL == arena) {
+			last_status = PARSER_STATUS_MALLOC_ERROR;
+			return NULL;
+		}
+	}
+	tree = packed_rooted_tree(default_pack, next_packed_tree++, arena);
+	if (NULL == tree) {
+		if (NULL != arena) destroy_arena(arena);
+		last_status = PARSER_STATUS_MALLOC_ERROR;
+	}
+	return tree;
+}
+
+/* Returns TRUE iff the default input is a NEXUS file, and creates its reader
+ * the first time (default_nexus_reader stays NULL if that fails). */
+
+static int current_nexus_reader()
+{
+	if (NULL != string_parser) return FALSE;
+	if (-1 == input_is_nexus) {
+		input_is_nexus = is_nexus(current_input());
+		if (input_is_nexus)
+			default_nexus_reader = create_nexus_reader(
+					current_input());
+	}
+	return input_is_nexus;
+}
+
+/* Returns the NEXUS file's next tree, like parse_tree() */
+
+static struct rooted_tree *read_nexus_tree(int in_arena)
+{
+	struct rooted_tree *tree;
+
+	if (NULL == default_nexus_reader) {
+		last_status = PARSER_STATUS_MALLOC_ERROR;
+		return NULL;
+	}
+	if (in_arena)
+		tree = nexus_read_tree_in_arena(default_nexus_reader);
+	else
+		tree = nexus_read_tree(default_nexus_reader);
+	last_status = default_nexus_reader->status;
+	return tree;
+}
+
+void set_parser_engine(enum parser_engine new_engine)
+{
+	engine = new_engine;
+}
+
+void set_parser_threads(int num_threads)
+{
+	num_parser_threads = num_threads;
+}
+
+enum parser_status_type newick_parser_status()
+{
+	return last_status;
+}
+
+void set_parser_input(FILE *input)
+{
+	/* the decompressing stream, if any, is ours (but not the file) */
+	if (NULL != decompressed_input && decompressed_input != default_input
+			&& decompressed_input != stdin)
+		fclose(decompressed_input);
+	decompressed_input = NULL;
+	default_input = input;
+	if (NULL != default_mmap_parser) {
+		destroy_mmap_parser(default_mmap_parser);
+		default_mmap_parser = NULL;
+	}
+	if (NULL != default_parallel_parser) {
+		destroy_parallel_parser(default_parallel_parser);
+		default_parallel_parser = NULL;
+	}
+	mmap_unavailable = FALSE;
+	if (NULL != default_pack) {
+		close_tree_pack(default_pack);
+		default_pack = NULL;
+	}
+	input_is_pack = -1;
+	if (NULL != default_nexus_reader) {
+		destroy_nexus_reader(default_nexus_reader);
+		default_nexus_reader = NULL;
+	}
+	input_is_nexus = -1;
+	/* drops whatever was read ahead from the previous input */
+	if (NULL != default_parser) {
+		nwsrestart(current_input(), default_parser->scanner);
+		default_parser->input = current_input();
+	}
+}
+
+int set_parser_input_filename (char *filename)
+{
+	FILE *fin = fopen(filename, "r");
+	if (NULL == fin) return FAILURE;
+	set_parser_input(fin);
+
+	return SUCCESS;
+}
+
+int set_parser_string_input(const char *newick)
+{
+	clear_parser_string_input();
+	string_parser = create_newick_string_parser(newick);
+	return NULL != string_parser;
+}
+
+void clear_parser_string_input()
+{
+	if (NULL == string_parser) return;
+	destroy_newick_parser(string_parser);
+	string_parser = NULL;
+}
+
+struct rooted_tree *parse_tree()
+{
+	struct parallel_parser *parallel_parser;
+	struct mmap_parser *mmap_parser;
+	struct newick_parser *parser;
+	struct rooted_tree *tree;
+
+	if (current_tree_pack()) return parse_packed_tree(FALSE);
+	if (current_nexus_reader()) return read_nexus_tree(FALSE);
+	parallel_parser = current_parallel_parser(FALSE);
+	mmap_parser = current_mmap_parser();
+
+	if (NULL != parallel_parser) {
+		tree = parallel_parse_tree(parallel_parser);
+		last_status = parallel_parser_status(parallel_parser);
+			return tree;
+	}
+	if (NULL != mmap_parser) {
+		tree = mmap_parse_tree(mmap_parser);
+		last_status = mmap_parser->status;
+		return tree;
+	}
+	parser = current_parser();
+	if (NULL == parser) {
+		last_status = PARSER_STATUS_MALLOC_ERROR;
+		return NULL;
+	}
+	tree = parser_parse_tree(parser);
+	last_status = parser->status;
+	return tree;
+}
+
+struct rooted_tree *parse_tree_in_arena()
+{
+	struct parallel_parser *parallel_parser;
+	struct mmap_parser *mmap_parser;
+	struct newick_parser *parser;
+	struct rooted_tree *tree;
+
+	if (current_tree_pack()) return parse_packed_tree(TRUE);
+	if (current_nexus_reader()) return read_nexus_tree(TRUE);
+	parallel_parser = current_parallel_parser(TRUE);
+	mmap_parser = current_mmap_parser();
+
+	if (NULL != parallel_parser) {
+		tree = parallel_parse_tree(parallel_parser);
+		last_status = parallel_parser_status(parallel_parser);
+			return tree;
+	}
+	if (NULL != mmap_parser) {
+		tree = mmap_parse_tree_in_arena(mmap_parser);
+		last_status = mmap_parser->status;
+			return tree;
+	}
+	parser = current_parser();
+	if (NULL == parser) {
+		last_status = PARSER_STATUS_MALLOC_ERROR;
+		return NULL;
+	}
+	tree = parser_parse_tree_in_arena(parser);
+	last_status = parser->status;
+	return tree;
+}
@@ -28,6 +28,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+#include <stdio.h>
+
 enum parser_status_type {
 	PARSER_STATUS_OK,	// TODO: is this ever used?
 	PARSER_STATUS_EMPTY,
@@ -35,8 +37,76 @@ enum parser_status_type {
 	PARSER_STATUS_MALLOC_ERROR
 };
 struct rooted_tree;
+struct rnode;
+struct llist;
+
+/* A Newick parser: a pure Bison parser, its reentrant scanner, and what they
+ * share while parsing. Parsers are independent of each other, so several can
+ * be used at once, e.g. one per thread. The members are read-only for callers,
+ * except 'status', which tells why a parse returned NULL. */
+
+struct newick_parser {
+	void *scanner;		/* see newick_scanner.h */
+	FILE *input;		/* NULL when reading from a string */
+	struct rnode *root;
+	struct llist *nodes_in_order;
+	enum parser_status_type status;
+	int lineno;
+};
+
+/* Creates a parser that reads trees from 'input'. Returns NULL in case of
+ * error (malloc()). */
+
+struct newick_parser *create_newick_parser(FILE *input);
+
+/* Creates a parser that reads trees from a string, which is copied. Returns
+ * NULL in case of error (malloc()). */
+
+struct newick_parser *create_newick_string_parser(const char *newick);
+
+/* Parses the next tree of the parser's input, like parse_tree() (see below) */
+
+struct rooted_tree *parser_parse_tree(struct newick_parser *parser);
+
+/* Parses the next tree of the parser's input, like parse_tree_in_arena() */
+
+struct rooted_tree *parser_parse_tree_in_arena(struct newick_parser *parser);
+
+/* Frees the parser (but not its input file, which the caller closes) */
+
+void destroy_newick_parser(struct newick_parser *parser);
+
+/* The functions below use a default parser, for programs that read one stream
+ * of trees at a time from a single thread. The default parser reads from
+ * stdin until told otherwise. */
 
-extern enum parser_status_type newick_parser_status;
+/* parse_tree() can use either the Bison parser or the one of mmap_parser.h,
+ * which is faster on large files. The latter is used if the environment
+ * variable NW_PARSER is "mmap", unless set_parser_engine() says otherwise. It
+ * only reads files (not pipes, etc.): for other inputs, and for strings,
+ * parse_tree() uses the Bison parser anyway. Both accept the same trees. */
+
+/* With NW_PARSER set to "parallel", the mmap parser runs on several threads
+ * (see parallel_parser.h): as many as there are processors, or as
+ * NW_PARSER_THREADS says. The trees still come in input order. */
+
+/* Whatever the engine, an input that is a tree pack (see tree_pack.h) is read
+ * as such: its trees are not parsed at all. Likewise, the trees of a NEXUS
+ * file (one that starts with '#') are read from its TREES blocks, see
+ * nexus_reader.h. */
+
+enum parser_engine { PARSER_ENGINE_BISON, PARSER_ENGINE_MMAP,
+	PARSER_ENGINE_PARALLEL };
+
+void set_parser_engine(enum parser_engine engine);
+
+/* Sets the number of threads of the parallel engine (0: the default) */
+
+void set_parser_threads(int num_threads);
+
+/* Status of the last parse_tree() or parse_tree_in_arena() */
+
+enum parser_status_type newick_parser_status();
 
 /* Sets the parser's input to the file whose name is passed as argument.
  * Returns FAILURE iff there was a problem (file not found, or error, etc).
@@ -44,8 +114,26 @@ extern enum parser_status_type newick_parser_status;
 
 int set_parser_input_filename (char *filename);
 
-/* Parses a tree from nwsin, returns a pointer to a tree structure, or NULL if
- * there is no input. It is the caller's responsibility to set nwsin (which by
- * default is stdin). Use one of the set_parser_input_*() functions.. */
+/* Sets the parser's input to an open file. */
+
+void set_parser_input(FILE *input);
+
+/* Makes the parser read from a string (which is copied) until
+ * clear_parser_string_input() is called, then from its file again. Returns
+ * FAILURE in case of error (malloc()). */
+
+int set_parser_string_input(const char *newick);
+void clear_parser_string_input();
+
+/* Parses a tree from the parser's input, returns a pointer to a tree
+ * structure, or NULL if there is no input (or an error, see
+ * newick_parser_status()). Use one of the set_parser_input*() functions to
+ * read from somewhere else than stdin. */
 
 struct rooted_tree *parse_tree();
+
+/* Like parse_tree(), but the tree's nodes, lists and edge lengths are allocated
+ * from an arena of its own (see arena.h), which is released by the
+ * destroy_tree*() functions in one go instead of node by node. */
+
+struct rooted_tree *parse_tree_in_arena();
@@ -37,13 +37,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdbool.h>
 
 #include "tree.h"
-#include "nodemap.h"
 #include "parser.h"
 #include "to_newick.h"
 #include "rnode.h"
 #include "link.h"
-#include "hash.h"
 #include "list.h"
+#include "label_table.h"
+#include "output.h"
 
 struct parameters {
 	struct llist 	*labels;
@@ -130,12 +130,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) >= 2)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 		struct llist *lbl_list = create_llist();
 		if (NULL == lbl_list) { perror(NULL); exit(EXIT_FAILURE); }
@@ -156,14 +155,34 @@ struct parameters get_params(int argc, char *argv[])
 	return params;
 }
 
+/* Returns an array, indexed by label id, of the tree's nodes (the last node
+ * wins if a label occurs more than once). */
+
+static struct rnode **label_id2node_map(struct rooted_tree *tree)
+{
+	struct rnode **map = calloc(label_table_size(), sizeof(struct rnode *));
+	if (NULL == map) {
+		fprintf (stderr, "Memory error - exiting.\n");
+		exit(EXIT_FAILURE);
+	}
+	struct list_elem *elem;
+	for (elem=tree->nodes_in_order->head; NULL!=elem; elem=elem->next) {
+		struct rnode *current = elem->data;
+		if (EMPTY_LABEL_ID == current->label_id) continue;
+		map[current->label_id] = current;
+	}
+	return map;
+}
+
 void process_tree(struct rooted_tree *tree, struct llist *labels)
 {
-	struct hash *lbl2node_map = create_label2node_map(tree->nodes_in_order);
+	struct rnode **lbl2node_map = label_id2node_map(tree);
 	struct list_elem *elem;
 
 	for (elem = labels->head; NULL != elem; elem = elem->next) {
 		char *label = elem->data;
-		struct rnode *goner = hash_get(lbl2node_map, label);
+		int id = find_label(label);
+		struct rnode *goner = id < 0 ? NULL : lbl2node_map[id];
 		if (NULL == goner) {
 			fprintf (stderr, "WARNING: label '%s' not found.\n",
 					label);
@@ -188,7 +207,7 @@ void process_tree(struct rooted_tree *tree, struct llist *labels)
 		}
 	}
 
-	destroy_hash(lbl2node_map);
+	free(lbl2node_map);
 }
 
 /* Produces a new list with all labels in the tree that are NOT in 'labels'. */
@@ -197,40 +216,35 @@ void process_tree(struct rooted_tree *tree, struct llist *labels)
 struct llist *reverse_labels(struct rooted_tree *tree, struct llist *labels)
 {
 	struct llist *rev_labels = create_llist();
-	/* We use a hash for looking up labels, instead of going over the list
-	 * of labels every time (see below) */
-	struct hash *labels_h = create_hash(labels->count);
-	if (NULL == labels_h) {
+	/* We flag the passed labels by label id, instead of going over the
+	 * list of labels every time (see below). Labels that were never
+	 * interned cannot occur in the tree. */
+	bool *passed = calloc(label_table_size(), sizeof(bool));
+	if (NULL == rev_labels || NULL == passed) {
 		fprintf(stderr, "Memory error -exiting.\n");
 		exit(EXIT_FAILURE);
 	}
 
 	struct list_elem *elem;
 
-	/* fill label hash with the labels */
-	char *PRESENT = "present";
 	for (elem = labels->head; NULL != elem; elem = elem->next) {
-		char *label = elem->data;
-		if (! hash_set(labels_h, label, PRESENT)) {
-			fprintf(stderr, "Memory error -exiting.\n");
-			exit(EXIT_FAILURE);
-		}
+		int id = find_label(elem->data);
+		if (id >= 0) passed[id] = true;
 	}
 
 	/* Now iterate over all nodes in the tree and see if their labels are
-	 * found in the labels hash. If not, add them to the 'rev_labels' list.
-	 * */
+	 * flagged. If not, add them to the 'rev_labels' list. */
 	for (elem=tree->nodes_in_order->head; NULL!=elem; elem=elem->next) {
-		char *label = ((struct rnode*) elem->data)->label;
-		if (0 == strcmp("", label)) continue;
-		if (NULL == hash_get(labels_h, label)) {
-			if (! append_element(rev_labels, label)) {
+		struct rnode *current = elem->data;
+		if (EMPTY_LABEL_ID == current->label_id) continue;
+		if (! passed[current->label_id]) {
+			if (! append_element(rev_labels, current->label)) {
 				fprintf(stderr, "Memory error -exiting.\n");
 				exit(EXIT_FAILURE);
 			}
 		}
 	}
-	destroy_hash(labels_h);
+	free(passed);
 
 	return rev_labels;
 }
@@ -241,6 +255,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	while (NULL != (tree = parse_tree())) {
 		if (params.reverse) {
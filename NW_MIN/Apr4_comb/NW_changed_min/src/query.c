@@ -0,0 +1,215 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* nw_query: send requests to nw_serve, and print the replies */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "output.h"
+#include "common.h"
+
+struct parameters {
+	char *socket_path;
+	char **words;		/* of the request, or NULL: read stdin */
+	int num_words;
+};
+
+void help(char *argv[])
+{
+	printf (
+"Sends requests to nw_serve, and prints the replies\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s [-h] <socket> [<request> [<argument>+]]\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"The first argument is the socket nw_serve listens on. The others form the\n"
+"request (see nw_serve -h). Without them, requests are read from standard\n"
+"input, one per line, over a single connection.\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"Prints the reply's lines (not the 'OK' line), so that e.g. 'match' prints\n"
+"trees like other programs do. Errors go to standard error, and make the\n"
+"exit status nonzero.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# trees with this clade, as nw_match would print them\n"
+"$ %s /tmp/nw.sock match reps '((HRV_A1,HRV_A2),HRV_B3);'\n"
+"\n"
+"# many requests, one connection\n"
+"$ sed 's/^/count reps /' patterns.nw | %s /tmp/nw.sock\n",
+	argv[0],
+	argv[0],
+	argv[0]
+	);
+}
+
+struct parameters get_params(int argc, char *argv[])
+{
+	struct parameters params;
+
+	int opt_char;
+	while ((opt_char = getopt(argc, argv, "h")) != -1) {
+		switch (opt_char) {
+		case 'h':
+			help(argv);
+			exit(EXIT_SUCCESS);
+		default:
+			fprintf (stderr, "Unknown option '-%c'\n", opt_char);
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	/* check arguments */
+	if ((argc - optind) >= 1)	{
+		params.socket_path = argv[optind];
+		params.num_words = argc - optind - 1;
+		params.words = params.num_words > 0 ? argv + optind + 1 : NULL;
+	} else {
+		fprintf(stderr, "Usage: %s [-h] <socket> [<request>]\n",
+				argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	return params;
+}
+
+static int connect_to(const char *path)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		fprintf (stderr, "Socket path too long: %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || 0 != connect(fd, (struct sockaddr *) &address,
+				sizeof(address))) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	return fd;
+}
+
+/* Reads one reply from 'server', and prints it. Returns SUCCESS IFF the reply
+ * was 'OK'. Exits if the server has gone. */
+
+static int print_reply(FILE *server, char **line, size_t *capacity)
+{
+	int num_lines, i;
+
+	if (getline(line, capacity, server) <= 0) {
+		fprintf (stderr, "Server closed the connection\n");
+		exit(EXIT_FAILURE);
+	}
+	if (0 == strncmp("ERROR ", *line, 6)) {
+		fputs(*line + 6, stderr);
+		return FAILURE;
+	}
+	if (1 != sscanf(*line, "OK %d", &num_lines)) {
+		fprintf (stderr, "Unexpected reply: %s", *line);
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < num_lines; i++) {
+		if (getline(line, capacity, server) <= 0) {
+			fprintf (stderr, "Server closed the connection\n");
+			exit(EXIT_FAILURE);
+		}
+		fputs(*line, stdout);
+	}
+	return SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+	struct parameters params = get_params(argc, argv);
+	int fd = connect_to(params.socket_path);
+	FILE *to_server = fdopen(dup(fd), "w");
+	FILE *from_server = fdopen(fd, "r");
+	char *line = NULL;
+	size_t capacity = 0;
+	int status = EXIT_SUCCESS;
+	int i;
+
+	if (NULL == to_server || NULL == from_server) {
+		perror(NULL);
+		exit(EXIT_FAILURE);
+	}
+	buffer_stdout();
+
+	if (NULL != params.words) {
+		for (i = 0; i < params.num_words; i++) {
+			if (i > 0) putc(' ', to_server);
+			fputs(params.words[i], to_server);
+		}
+		putc('\n', to_server);
+		fflush(to_server);
+		if (! print_reply(from_server, &line, &capacity))
+			status = EXIT_FAILURE;
+	} else {
+		/* one request at a time: replies are printed in order */
+		while (getline(&line, &capacity, stdin) > 0) {
+			fputs(line, to_server);
+			if ('\n' != line[strlen(line) - 1])
+				putc('\n', to_server);
+			fflush(to_server);
+			if (! print_reply(from_server, &line, &capacity))
+				status = EXIT_FAILURE;
+		}
+	}
+
+	free(line);
+	fclose(to_server);
+	fclose(from_server);
+	return status;
+}
@@ -42,6 +42,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "rnode.h"
 #include "readline.h"
 #include "common.h"
+#include "output.h"
 
 
 struct parameters {
@@ -185,12 +186,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 2)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 		params.map_filename = argv[optind+1];
 	} else {
@@ -212,10 +212,11 @@ void process_tree(struct rooted_tree *tree, struct hash *rename_map,
 		if (params.only_leaves && ! is_leaf(current)) { continue; }
 		char *label = current->label;
 		char *new_label = hash_get(rename_map, label);
-		if (NULL != new_label) {
-			current->label = strdup(new_label);
-			free(label);
-		}
+		if (NULL != new_label)
+			if (! set_rnode_label(current, new_label)) {
+				perror(NULL);
+				exit(EXIT_FAILURE);
+			}
 	}
 
 	dump_newick(tree->root);
@@ -228,6 +229,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	rename_map = read_map(params.map_filename);
 
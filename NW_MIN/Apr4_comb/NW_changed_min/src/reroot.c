@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "hash.h"
 #include "common.h"
 #include "link.h"
+#include "output.h"
 
 enum reroot_status { REROOT_OK, LCA_IS_TREE_ROOT };
 enum deroot_status { DEROOT_OK, BALANCED, NOT_BIFURCATING };
@@ -158,12 +159,11 @@ struct parameters get_params(int argc, char *argv[])
 	/* read arguments */
 	if (0 != strcmp("-", argv[optind])) {
 		FILE *fin = fopen(argv[optind], "r");
-		extern FILE *nwsin;
 		if (NULL == fin) {
 			perror(NULL);
 			exit(EXIT_FAILURE);
 		}
-		nwsin = fin;
+		set_parser_input(fin);
 	}
 	struct llist *lbl_list = create_llist();
 	if (NULL == lbl_list) { perror(NULL); exit(EXIT_FAILURE); }
@@ -378,6 +378,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	
 	params = get_params(argc, argv);
+	buffer_stdout();
 	while (NULL != (tree = parse_tree())) {
 		/* tree is free()d in process_tree(), as derooting is
 		 * compatible with ordinary free()ing (with destroy_tree()),
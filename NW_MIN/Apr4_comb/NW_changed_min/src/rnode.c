@@ -34,16 +34,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "rnode.h"
 #include "list.h"
-#include "rnode_iterator.h"
-#include "hash.h"
+#include "label_table.h"
+#include "arena.h"
 #include "common.h"
 
 struct rnode *create_rnode(char *label, char *length_as_string)
 {
 	struct rnode *node_p;
 
-	node_p = malloc(sizeof(struct rnode));
+	node_p = arena_malloc(sizeof(struct rnode));
 	if (NULL == node_p) return NULL;
+	node_p->in_arena = NULL != current_arena();
 
 	if (NULL == label) {
 		label = "";
@@ -51,8 +52,10 @@ struct rnode *create_rnode(char *label, char *length_as_string)
 	if (NULL == length_as_string) {
 		length_as_string = "";
 	}
-	node_p->label = strdup(label);
-	node_p->edge_length_as_string = strdup(length_as_string);
+	node_p->label_id = intern_label(label);
+	if (-1 == node_p->label_id) return NULL;
+	node_p->label = label_string(node_p->label_id);
+	node_p->edge_length_as_string = arena_strdup(length_as_string);
 	node_p->children = create_llist();	
 	if (NULL == node_p->children) return NULL;
 	node_p->parent = NULL;
@@ -73,14 +76,22 @@ struct rnode *create_rnode(char *label, char *length_as_string)
 	return node_p;
 }
 
+int set_rnode_label(struct rnode *node, const char *label)
+{
+	int id = intern_label(label);
+	if (-1 == id) return FAILURE;
+	node->label_id = id;
+	node->label = label_string(id);
+	return SUCCESS;
+}
+
 void destroy_rnode(struct rnode *node, void (*free_data)(void *))
 {
 #ifdef SHOW_RNODE_DESTROY
 	fprintf (stderr, " freeing rnode %p '%s'\n", node, node->label);
 #endif
 	destroy_llist(node->children);
-	free(node->label);
-	free(node->edge_length_as_string);
+	arena_free(node->edge_length_as_string);
 	/* if free_data is not NULL, we call it to free the node data (use this
 	 * when the data cannot just be free()d); otherwise we just free()
 	 * node->data  */
@@ -88,7 +99,7 @@ void destroy_rnode(struct rnode *node, void (*free_data)(void *))
 		free_data(node->data);
 	else if (NULL != node->data)
 		free(node->data);
-	free(node);
+	if (! node->in_arena) free(node);
 }
 
 int children_count(struct rnode *node)
@@ -123,41 +134,22 @@ void dump_rnode(void *arg)
 	printf ("  data    = %p\n", node->data);
 }
 
-/* If something fails, we just return. */
-// TODO: consider just computing the nodes_in_order list and free()ing as
-// usual; if not possible then add as an example (in rnode_iterator.[ch]) of
-// when this is not possible
+/* Frees the nodes bottom-up, following parent links: a node's children are
+ * shifted off its children list as they are descended into, so that when we
+ * climb back to it, it only has the remaining ones. This allocates nothing,
+ * and uses neither node->data nor the iterator fields. */
+
 void free_descendants(struct rnode *node)
 {
-	const int HASH_SIZE = 1000; 	/* pretty arbitrary */
-	struct hash *to_free = create_hash(HASH_SIZE);
-	if (NULL == to_free) return;	
-	struct rnode_iterator *it = create_rnode_iterator(node);
-	if (NULL == it) return;
-	struct rnode *current;
-
-	/* Iterates through the tree nodes, "remembering" nodes seen for the
-	 * first time */
-	while (NULL != (current = rnode_iterator_next(it))) {
-		char *node_hash_key = make_hash_key(current);
-		if (NULL == hash_get(to_free, node_hash_key))
-			if (! hash_set(to_free, node_hash_key, current))
-				return; 
-                free(node_hash_key);
-	}
-
-	// Frees all nodes "seen" above - which must be all the descendants of
-	// 'node'.
-	struct llist *keys = hash_keys(to_free);
-	if (NULL == keys) return;
-       	struct list_elem *el;
-	for (el = keys->head; NULL != el; el = el->next) {
-		char *key = el->data;
-		current = hash_get(to_free, key);
+	struct rnode *current = node;
+
+	while (NULL != current) {
+		if (! is_leaf(current)) {
+			current = shift(current->children);
+			continue;
+		}
+		struct rnode *parent = current->parent;
 		destroy_rnode(current, NULL);
-	}	
-
-        destroy_llist(keys);
-        destroy_hash(to_free);
-	destroy_rnode_iterator(it);
+		current = (current == node) ? NULL : parent;
+	}
 }
@@ -67,7 +67,11 @@ struct rnode {
 	char *edge_length_as_string;	/* Most of the time this is enough, but... */
 	double edge_length; 		/* ...use this when numerical value is needed */
 	struct llist *children;
+	/* Interned (see label_table.h): do not modify or free() it, use
+	 * set_rnode_label() instead. */
 	char *label;
+	int label_id;
+	int in_arena;	/* allocated from an arena (see arena.h): don't free() */
 	void *data;	/* app-dependent data for this node */
 
 	/* enables traversing by rnode_iterator_next() */
@@ -76,13 +80,18 @@ struct rnode {
 };
 
 /* allocates a rnode and returns a pointer to it, or exits. If 'label' is NULL
- * or empty, the node will have an empty string for a label. If
- * 'length_as_string' is NULL or empty, the node's branch will have no length
- * */
+ * or empty, the node will have an empty string for a label. The label is
+ * interned, not copied. If 'length_as_string' is NULL or empty, the node's
+ * branch will have no length */
 /* Returns NULL if structure cannot be created (malloc() problems). */
 
 struct rnode *create_rnode(char *label, char *length_as_string);
 
+/* Sets the node's label (and label id) */
+/* Returns FAILURE iff the label cannot be interned (malloc()) */
+
+int set_rnode_label(struct rnode *node, const char *label);
+
 /* Destroys the rnode, including the parent edge (if any). If free_data is not
  * NULL, it is called to free the node's data TODO: this should be used in
  destroy_tree_cb - check.*/
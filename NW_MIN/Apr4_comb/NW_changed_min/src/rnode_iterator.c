@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "list.h"
 #include "rnode.h"
 #include "tree.h"
+#include "common.h"
 
 /* The functions in this module provide an iterator interface on a node and its
  * descendents, allowing traversal. The low-level rnode_iterator and functions
@@ -140,63 +141,99 @@ struct rnode *rnode_iterator_next(struct rnode_iterator *iter)
 	return next;
 }
 
-/* Computes the list by doing a tree traversal, then reversing it, printing out
- * each node the first time it sees it. */
-/* see note above about the 'seen' member of struct rnode */
+/* A node on the path from the root, and its next child to visit */
 
-struct llist *get_nodes_in_order(struct rnode *root)
-{
-	struct rnode_iterator *it = create_rnode_iterator(root);
-	if (NULL == it) return NULL;
-	struct rnode *current;
-	struct llist *traversal = create_llist();
-	if (NULL == traversal) return NULL;
-	struct llist *reverse_traversal;
-	struct llist *nodes_in_reverse_order = create_llist();
-	if (NULL == nodes_in_reverse_order) return NULL;
-	struct llist *nodes_in_order;
-
-	/* Iterates over the whole tree - note that a node is visited more than
-	 * once, except leaves. */
-	while ((current = rnode_iterator_next(it)) != NULL) {
-		current->seen = 0;
-		if (! append_element (traversal, current)) return NULL;
-	}
+struct traversal_frame {
+	struct rnode *node;
+	struct list_elem *next;
+};
 
-	destroy_rnode_iterator(it);
+#define INIT_TRAVERSAL_STACK_SIZE 64
 
-	reverse_traversal = llist_reverse(traversal);
-	if (NULL == reverse_traversal) return NULL;
-	destroy_llist(traversal);
+/* Visits the clade of 'root' depth-first, with a stack of its own rather than
+ * the iterator (so the nodes' 'seen' and 'current_child_elem' members are left
+ * alone) and without recursion (trees may be very deep). Each node is
+ * appended to 'preorder' before its descendants and to 'postorder' after
+ * them; either list may be NULL. Returns FAILURE in case of error (malloc()) */
 
-	/* This keeps only the first 'visit' through any node */
-	struct list_elem *el;
-	for (el = reverse_traversal->head; NULL != el; el = el->next) {
-		current = el->data;
-		/* Nodes will have been seen by the iterator above, hence they
-		 * start with a 'seen' value of 1. */
-		if (current->seen == 0) {
-			/* Not seen yet? add to list, and mark as seen (hash) */
-			if (! append_element
-					(nodes_in_reverse_order, current))
-				return NULL;
-			current->seen = 1;
+static int traverse(struct rnode *root, struct llist *preorder,
+		struct llist *postorder)
+{
+	int size = INIT_TRAVERSAL_STACK_SIZE;
+	int top = 0;
+	struct traversal_frame *stack = malloc(size *
+			sizeof(struct traversal_frame));
+	if (NULL == stack) return FAILURE;
+
+	if (NULL != preorder && ! append_element(preorder, root)) {
+		free(stack);
+		return FAILURE;
+	}
+	stack[top].node = root;
+	stack[top].next = root->children->head;
+	top++;
+	while (top > 0) {
+		struct traversal_frame *frame = stack + top - 1;
+		struct rnode *kid;
+		if (NULL == frame->next) {
+			/* all children done */
+			if (NULL != postorder &&
+				! append_element(postorder, frame->node)) {
+				free(stack);
+				return FAILURE;
+			}
+			top--;
+			continue;
 		}
+		kid = frame->next->data;
+		frame->next = frame->next->next;
+		if (NULL != preorder && ! append_element(preorder, kid)) {
+			free(stack);
+			return FAILURE;
+		}
+		if (top == size) {
+			size *= 2;
+			struct traversal_frame *new_stack = realloc(stack,
+				size * sizeof(struct traversal_frame));
+			if (NULL == new_stack) {
+				free(stack);
+				return FAILURE;
+			}
+			stack = new_stack;
+		}
+		stack[top].node = kid;
+		stack[top].next = kid->children->head;
+		top++;
 	}
 
-	destroy_llist(reverse_traversal);
-	nodes_in_order = llist_reverse(nodes_in_reverse_order);
+	free(stack);
+	return SUCCESS;
+}
+
+struct llist *get_nodes_in_order(struct rnode *root)
+{
+	struct llist *nodes_in_order = create_llist();
 	if (NULL == nodes_in_order) return NULL;
-	destroy_llist(nodes_in_reverse_order);
 
-	/* remove the 'seen' marks */
-	for (el = nodes_in_order->head; NULL != el; el = el->next) {
-		current = el->data;
-		current->seen = 0;
+	if (! traverse(root, NULL, nodes_in_order)) {
+		destroy_llist(nodes_in_order);
+		return NULL;
 	}
 	return nodes_in_order;
 }
 
+struct llist *get_nodes_in_preorder(struct rnode *root)
+{
+	struct llist *preorder = create_llist();
+	if (NULL == preorder) return NULL;
+
+	if (! traverse(root, preorder, NULL)) {
+		destroy_llist(preorder);
+		return NULL;
+	}
+	return preorder;
+}
+
 /* Returns a label->node map of (labeled) leaves */
 /* Nodes' 'seen' member must be zero - see note above about the 'seen' member of struct rnode */
 // TODO: this function should use the tree's nodes_in_order list. If invalid or
@@ -41,8 +41,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * be faster than iterating on a subtree. But there are exceptions:
 
  o the 'nodes_in_order' list may be outdated (e.g. because nodes were inserted,
-   deleted, etc) - in that case, the list should be reconstructed with
-   get_nodes_in_order(), which uses the rnode iterator.
+   deleted, etc) - in that case, use tree_postorder() (see tree.h), or
+   get_nodes_in_order().
  
  o the 'nodes_in_order' list may not contain all the needed information (this
    is the case when outputting Newick).
@@ -84,12 +84,18 @@ bool more_children_to_visit (struct rnode_iterator *);
 /* TODO: these are client functions, they may belong elsewhere */
 
 /* Returns the list of nodes that descend from the argument node, in parse
- * order. Together with the argument node, this can be used to create a struct
- * rooted_tree. */
+ * order (i.e., postorder). Together with the argument node, this can be used
+ * to create a struct rooted_tree. Unlike the iterator, this does not change
+ * the nodes. See also tree_postorder() (tree.h), which keeps the list. */
 /* Returns NULL in case of malloc() problems. */
 
 struct llist *get_nodes_in_order(struct rnode *);
 
+/* Like get_nodes_in_order(), but in preorder (parents before children) */
+/* Returns NULL in case of malloc() problems. */
+
+struct llist *get_nodes_in_preorder(struct rnode *);
+
 /* Returns a label->rnode map of all leaves that descend from 'root' */
 /* Returns NULL in case of malloc() problems. */
 
@@ -0,0 +1,503 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* nw_serve: keep tree collections loaded, and answer queries over a socket */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "parser.h"
+#include "flat_tree.h"
+#include "cluster_set.h"
+#include "tree_batch.h"
+#include "common.h"
+
+#define DEFAULT_THREADS 4
+#define LISTEN_BACKLOG 64
+
+/* A named batch of trees (see tree_batch.h), loaded once. It does not change
+ * afterwards, so all workers read it without locking. */
+
+struct collection {
+	char *name;
+	struct tree_batch *batch;
+};
+
+struct parameters {
+	char *socket_path;
+	int num_threads;
+	int num_collections;
+	char **specs;		/* "name=file" */
+};
+
+static struct collection *collections = NULL;
+static int num_collections = 0;
+
+void help(char *argv[])
+{
+	printf (
+"Keeps tree collections in memory, and answers queries about them\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s [-h] [-t threads] <socket> <name>=<trees filename> [<name>=<filename>+]\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"The first argument is the path of the (Unix-domain) socket to listen on. The\n"
+"others each name a collection of trees, and the file it is read from (in any\n"
+"format the other programs read, including tree packs and NEXUS).\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"Reads all the collections, then answers requests until interrupted. Each\n"
+"request is one line, and each reply starts with a line 'OK <n>', followed by\n"
+"n lines, or with a line 'ERROR <message>'. A connection may send any number\n"
+"of requests. Trees are numbered from 1; <tree> is a number or 'all'.\n"
+"\n"
+"    list                            collections: name, trees, taxa\n"
+"    match <collection> <pattern>    the trees that match the pattern\n"
+"    count <collection> <pattern>    the number of trees that match it\n"
+"    labels <collection>             all leaf labels of the collection\n"
+"    labels <collection> <tree>      the labels of a tree\n"
+"    prune <collection> <tree> <label>+\n"
+"                                    the tree(s), without these nodes\n"
+"    restrict <collection> <tree> <label>+\n"
+"                                    the tree(s), with only these leaves\n"
+"\n"
+"The pattern is a Newick tree; a tree matches it if it has all the pattern's\n"
+"leaves, and has the same topology as the pattern once pruned to them.\n"
+"Pruning works like nw_prune; restricting removes the leaves that are not\n"
+"passed, splicing out nodes left with only one child.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"    -t <number>: answer this many connections at once (default: %d)\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# serve the bootstrap replicates, then count trees that have a clade\n"
+"$ %s /tmp/nw.sock reps=data/HRV_20reps.nw &\n"
+"$ nw_query /tmp/nw.sock count reps '((HRV_A1,HRV_A2),HRV_B3);'\n",
+	argv[0],
+	DEFAULT_THREADS,
+	argv[0]
+	);
+}
+
+struct parameters get_params(int argc, char *argv[])
+{
+	struct parameters params;
+	params.num_threads = DEFAULT_THREADS;
+
+	int opt_char;
+	while ((opt_char = getopt(argc, argv, "ht:")) != -1) {
+		switch (opt_char) {
+		case 'h':
+			help(argv);
+			exit(EXIT_SUCCESS);
+		case 't':
+			params.num_threads = atoi(optarg);
+			if (params.num_threads < 1) {
+				fprintf (stderr, "Bad number of threads '%s'\n",
+						optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			fprintf (stderr, "Unknown option '-%c'\n", opt_char);
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	/* check arguments */
+	if ((argc - optind) >= 2)	{
+		params.socket_path = argv[optind];
+		params.specs = argv + optind + 1;
+		params.num_collections = argc - optind - 1;
+	} else {
+		fprintf(stderr, "Usage: %s [-h] [-t threads] <socket> "
+				"<name>=<filename> [<name>=<filename>+]\n",
+				argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	return params;
+}
+
+/* Reads the trees of a "name=file" spec into 'coll'. Exits in case of
+ * error. */
+
+static void load_collection(struct collection *coll, char *spec)
+{
+	char *filename = strchr(spec, '=');
+
+	if (NULL == filename || filename == spec) {
+		fprintf (stderr, "Expected <name>=<filename>, got '%s'\n", spec);
+		exit(EXIT_FAILURE);
+	}
+	*filename++ = '\0';
+	coll->name = spec;
+	coll->batch = read_tree_batch_file(filename);
+	if (NULL == coll->batch) {
+		if (PARSER_STATUS_MALLOC_ERROR == newick_parser_status())
+			perror(NULL);
+		else
+			fprintf (stderr, "Error reading trees from %s\n",
+					filename);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static struct collection *find_collection(const char *name)
+{
+	int i;
+	for (i = 0; i < num_collections; i++)
+		if (0 == strcmp(name, collections[i].name))
+			return &collections[i];
+	return NULL;
+}
+
+static void reply_error(FILE *out, const char *fmt, ...)
+{
+	va_list args;
+	fputs("ERROR ", out);
+	va_start(args, fmt);
+	vfprintf(out, fmt, args);
+	va_end(args);
+	putc('\n', out);
+}
+
+static void serve_match(struct tree_batch *batch, const char *pattern,
+		int count_only, FILE *out)
+{
+	char *matches = malloc(batch->num_trees + 1);
+	int n, count;
+
+	if (NULL == matches) {
+		reply_error(out, "%s", strerror(errno));
+		return;
+	}
+	count = tree_batch_match(batch, pattern, matches);
+	if (BATCH_BAD_PATTERN == count) {
+		reply_error(out, "bad pattern");
+	} else if (BATCH_MEM_ERROR == count) {
+		reply_error(out, "%s", strerror(errno));
+	} else if (count_only) {
+		fprintf(out, "OK 1\n%d\n", count);
+	} else {
+		fprintf(out, "OK %d\n", count);
+		for (n = 0; n < batch->num_trees; n++)
+			if (matches[n]) {
+				fputs(batch->newicks[n], out);
+				putc('\n', out);
+			}
+	}
+	free(matches);
+}
+
+/* Parses a tree number (see help()) into 'first' and 'last' (0-based). Returns
+ * FAILURE, after replying an error, if 'arg' is not a valid tree number. */
+
+static int tree_range(struct collection *coll, const char *arg, int *first,
+		int *last, FILE *out)
+{
+	int num_trees = coll->batch->num_trees;
+	char *end;
+	long n;
+
+	if (NULL == arg) {
+		reply_error(out, "missing tree number");
+		return FAILURE;
+	}
+	if (0 == strcmp("all", arg)) {
+		*first = 0;
+		*last = num_trees - 1;
+		return SUCCESS;
+	}
+	n = strtol(arg, &end, 10);
+	if ('\0' != *end || n < 1 || n > num_trees) {
+		reply_error(out, "no tree '%s' in %s (%d trees)", arg,
+				coll->name, num_trees);
+		return FAILURE;
+	}
+	*first = *last = n - 1;
+	return SUCCESS;
+}
+
+static void serve_labels(struct collection *coll, const char *arg, FILE *out)
+{
+	struct tree_batch *batch = coll->batch;
+	int first, last, n, i, count;
+
+	if (NULL == arg) {
+		fprintf(out, "OK %d\n", batch->taxa->count);
+		for (i = 0; i < batch->taxa->count; i++) {
+			fputs(batch->taxon_labels[i], out);
+			putc('\n', out);
+		}
+		return;
+	}
+	if (! tree_range(coll, arg, &first, &last, out)) return;
+	for (count = 0, n = first; n <= last; n++)
+		for (i = 0; i < batch->flats[n]->num_nodes; i++)
+			if ('\0' != *flat_tree_label(batch->flats[n], i))
+				count++;
+	fprintf(out, "OK %d\n", count);
+	for (n = first; n <= last; n++)
+		for (i = 0; i < batch->flats[n]->num_nodes; i++)
+			if ('\0' != *flat_tree_label(batch->flats[n], i)) {
+				fputs(flat_tree_label(batch->flats[n], i), out);
+				putc('\n', out);
+			}
+}
+
+/* Replies the pruned or restricted tree(s); 'args' is the rest of the request
+ * line, after the collection's name. */
+
+static void serve_prune(struct collection *coll, char *args, int restrict_to,
+		FILE *out)
+{
+	char *save;
+	char *tree_arg = strtok_r(args, " \t", &save);
+	const char **labels;
+	char *label, *trees;
+	int first, last, num_labels = 0;
+
+	if (! tree_range(coll, tree_arg, &first, &last, out)) return;
+	/* there are fewer labels than characters */
+	labels = malloc((strlen(save) + 1) * sizeof(char *));
+	if (NULL == labels) {
+		reply_error(out, "%s", strerror(errno));
+		return;
+	}
+	while (NULL != (label = strtok_r(NULL, " \t", &save)))
+		labels[num_labels++] = label;
+
+	trees = tree_batch_prune(coll->batch, first, last, labels, num_labels,
+			restrict_to);
+	if (NULL == trees)
+		reply_error(out, "%s", strerror(errno));
+	else
+		fprintf(out, "OK %d\n%s", last - first + 1, trees);
+	free(trees);
+	free(labels);
+}
+
+static void serve_list(FILE *out)
+{
+	int i;
+	fprintf(out, "OK %d\n", num_collections);
+	for (i = 0; i < num_collections; i++)
+		fprintf(out, "%s %d %d\n", collections[i].name,
+				collections[i].batch->num_trees,
+				collections[i].batch->taxa->count);
+}
+
+/* Answers the request on 'line' (which is modified) */
+
+static void serve_request(char *line, FILE *out)
+{
+	char *save, *rest;
+	char *command = strtok_r(line, " \t", &save);
+	char *name;
+	struct collection *coll;
+
+	if (NULL == command) {
+		reply_error(out, "empty request");
+		return;
+	}
+	if (0 == strcmp("list", command)) {
+		serve_list(out);
+		return;
+	}
+	name = strtok_r(NULL, " \t", &save);
+	if (NULL == name) {
+		reply_error(out, "missing collection name");
+		return;
+	}
+	coll = find_collection(name);
+	if (NULL == coll) {
+		reply_error(out, "no collection '%s'", name);
+		return;
+	}
+	rest = save + strspn(save, " \t");
+
+	if (0 == strcmp("match", command))
+		serve_match(coll->batch, rest, FALSE, out);
+	else if (0 == strcmp("count", command))
+		serve_match(coll->batch, rest, TRUE, out);
+	else if (0 == strcmp("labels", command))
+		serve_labels(coll, strtok_r(NULL, " \t", &save), out);
+	else if (0 == strcmp("prune", command))
+		serve_prune(coll, rest, FALSE, out);
+	else if (0 == strcmp("restrict", command))
+		serve_prune(coll, rest, TRUE, out);
+	else
+		reply_error(out, "unknown request '%s'", command);
+}
+
+/* Answers the requests of one connection, until the client closes it */
+
+static void serve_connection(int fd)
+{
+	FILE *in = fdopen(fd, "r");
+	FILE *out = NULL;
+	char *line = NULL;
+	size_t capacity = 0;
+	ssize_t length;
+	int out_fd = dup(fd);
+
+	if (out_fd >= 0) out = fdopen(out_fd, "w");
+	if (NULL == in || NULL == out) {
+		perror(NULL);
+		if (NULL != in) fclose(in); else close(fd);
+		if (NULL != out) fclose(out); else if (out_fd >= 0) close(out_fd);
+		return;
+	}
+
+	while ((length = getline(&line, &capacity, in)) > 0) {
+		while (length > 0 && ('\n' == line[length-1]
+					|| '\r' == line[length-1]))
+			line[--length] = '\0';
+		serve_request(line, out);
+		if (EOF == fflush(out)) break;	/* client is gone */
+	}
+
+	free(line);
+	fclose(out);
+	fclose(in);
+}
+
+/* Each worker answers one connection at a time */
+
+static void *worker_main(void *arg)
+{
+	int listener = *(int *) arg;
+	for (;;) {
+		int fd = accept(listener, NULL, NULL);
+		if (fd < 0) {
+			if (EINTR == errno || ECONNABORTED == errno) continue;
+			perror("accept");
+			exit(EXIT_FAILURE);
+		}
+		serve_connection(fd);
+	}
+	return NULL;
+}
+
+/* Returns a socket listening on 'path'. A stale socket at 'path' (e.g. from a
+ * server that was killed) is replaced, but no other kind of file. */
+
+static int listen_on(const char *path)
+{
+	struct sockaddr_un address;
+	struct stat st;
+	int fd;
+
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		fprintf (stderr, "Socket path too long: %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+
+	if (0 == stat(path, &st) && S_ISSOCK(st.st_mode)) unlink(path);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || 0 != bind(fd, (struct sockaddr *) &address,
+				sizeof(address))
+		|| 0 != listen(fd, LISTEN_BACKLOG)) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	return fd;
+}
+
+int main(int argc, char *argv[])
+{
+	struct parameters params = get_params(argc, argv);
+	static int listener;
+	pthread_t thread;
+	sigset_t signals;
+	int i, signal_number;
+
+	collections = malloc(params.num_collections * sizeof(struct collection));
+	if (NULL == collections) { perror(NULL); exit(EXIT_FAILURE); }
+	for (i = 0; i < params.num_collections; i++) {
+		load_collection(&collections[i], params.specs[i]);
+		if (NULL != find_collection(collections[i].name)) {
+			fprintf (stderr, "Collection '%s' given twice\n",
+					collections[i].name);
+			exit(EXIT_FAILURE);
+		}
+		num_collections++;
+	}
+
+	/* Workers inherit this mask: only the main thread takes the signals
+	 * that stop the server, so that it can remove the socket. A client
+	 * that leaves early must not kill the server. */
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	listener = listen_on(params.socket_path);
+	for (i = 0; i < params.num_threads; i++)
+		if (0 != pthread_create(&thread, NULL, worker_main, &listener)) {
+			perror(NULL);
+			exit(EXIT_FAILURE);
+		}
+	fprintf (stderr, "Serving %d collection(s) on %s\n", num_collections,
+			params.socket_path);
+
+	sigwait(&signals, &signal_number);
+	unlink(params.socket_path);
+
+	return 0;
+}
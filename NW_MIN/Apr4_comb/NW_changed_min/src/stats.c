@@ -40,6 +40,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "tree.h"
 #include "rnode.h"
 #include "common.h"
+#include "output.h"
 
 enum stats_output_format {STATS_OUTPUT_LINE, STATS_OUTPUT_COLUMN};
 
@@ -181,12 +182,11 @@ static struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-fHh] <filename|->\n", argv[0]);
@@ -257,6 +257,7 @@ int main (int argc, char* argv[])
 {
 
 	struct parameters params = get_params(argc, argv);
+	buffer_stdout();
 
 	struct rooted_tree *tree;
 	while ((tree = parse_tree()) != NULL) {
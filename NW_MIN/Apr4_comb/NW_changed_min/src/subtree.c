@@ -46,6 +46,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "rnode.h"
 #include "common.h"
 #include "link.h"
+#include "output.h"
 
 enum {EXACT, REGEXP};
 
@@ -343,6 +344,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	while ((tree = parse_tree()) != NULL) {
 		process_tree(tree, params);
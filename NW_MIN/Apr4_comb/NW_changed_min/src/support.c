@@ -45,12 +45,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "node_set.h"
 #include "to_newick.h"
 #include "common.h"
-
-extern FILE *nwsin;
-
-static struct hash *lbl2num = NULL;
-static struct hash *bipart_counts = NULL;
-static int num_leaves;
+#include "label_table.h"
+#include "output.h"
+
+/* What is known of the replicates: the leaf numbers and the bipartition
+ * counts. */
+
+struct support_context {
+	/* Leaf numbers, indexed by label id; -1 for labels not in the first
+	 * tree */
+	int *lbl2num;
+	int lbl2num_size;
+	struct hash *bipart_counts;
+	int num_leaves;
+};
 
 struct parameters {
 	FILE * target_tree_file;
@@ -154,29 +162,37 @@ struct parameters get_params(int argc, char *argv[])
 	return params;
 }
 
-int init_lbl2num(struct rooted_tree *tree)
+int init_lbl2num(struct support_context *ctx, struct rooted_tree *tree)
 {
 	struct list_elem *el;
-	lbl2num = create_hash(num_leaves);
-	if (NULL == lbl2num) return FAILURE;
+	int i;
+	ctx->lbl2num_size = label_table_size();
+	ctx->lbl2num = malloc(ctx->lbl2num_size * sizeof(int));
+	if (NULL == ctx->lbl2num) return FAILURE;
+	for (i = 0; i < ctx->lbl2num_size; i++) ctx->lbl2num[i] = -1;
 	int n = 0;
 
 	for (el = tree->nodes_in_order->head; NULL != el; el = el->next) {
 		struct rnode *current = (struct rnode *) el->data;
 		if (! is_leaf(current)) { continue; }
-		int *num = malloc(sizeof(int));
-		if (NULL == num) return FAILURE;
-		*num = n;
-		if (! hash_set(lbl2num, current->label, num))
-			return FAILURE;
+		ctx->lbl2num[current->label_id] = n;
 		n++;
 	}	
 
 	return SUCCESS;
 }
 
+/* Returns the number of a leaf, or -1 if its label was not in the first
+ * tree */
+
+static int leaf_number(struct support_context *ctx, struct rnode *leaf)
+{
+	if (leaf->label_id >= ctx->lbl2num_size) return -1;
+	return ctx->lbl2num[leaf->label_id];
+}
+
 // TODO: shouldn't this call node_set_union() ?
-node_set union_of_child_node_sets(struct rnode *node)
+node_set union_of_child_node_sets(int num_leaves, struct rnode *node)
 {
 	node_set result = create_node_set(num_leaves);
 	if (NULL == result) { perror(NULL); exit(EXIT_FAILURE); }
@@ -191,9 +207,9 @@ node_set union_of_child_node_sets(struct rnode *node)
 	return result;
 }
 
-int add_bipart_count(const char *node_set_string)
+int add_bipart_count(struct support_context *ctx, const char *node_set_string)
 {
-	int *count = hash_get(bipart_counts, node_set_string);
+	int *count = hash_get(ctx->bipart_counts, node_set_string);
 	if (NULL == count) {
 		int *num = malloc(sizeof(int));
 		if (NULL == num) {
@@ -201,7 +217,7 @@ int add_bipart_count(const char *node_set_string)
 			exit(EXIT_FAILURE);
 		}
 		*num = 1;
-		if (! hash_set(bipart_counts, node_set_string, num))
+		if (! hash_set(ctx->bipart_counts, node_set_string, num))
 			return FAILURE;
 	} else {
 		(*count)++;
@@ -210,16 +226,18 @@ int add_bipart_count(const char *node_set_string)
 	return SUCCESS;
 }
 
-void compute_bipartitions(struct rooted_tree *tree)
+void compute_bipartitions(struct support_context *ctx,
+		struct rooted_tree *tree)
 {
+	int num_leaves = ctx->num_leaves;
 	struct list_elem *el;
 	
 	for (el = tree->nodes_in_order->head; NULL != el; el = el->next) {
 		struct rnode *current = (struct rnode *) el->data;
 		node_set set;
 		if (is_leaf(current)) {
-			int *num = hash_get(lbl2num, current->label);
-			if (NULL == num) {
+			int num = leaf_number(ctx, current);
+			if (-1 == num) {
 				fprintf(stderr,
 					"Label '%s' not found - aborting\n",
 					current->label);
@@ -227,15 +245,15 @@ void compute_bipartitions(struct rooted_tree *tree)
 			}
 			set = create_node_set(num_leaves);
 			if (NULL == set) {perror(NULL); exit(EXIT_FAILURE);}
-			node_set_add(set, *num, num_leaves);
+			node_set_add(set, num, num_leaves);
 		} else {
-			set = union_of_child_node_sets(current);
+			set = union_of_child_node_sets(num_leaves, current);
 			char *node_set_string = node_set_to_s(set, num_leaves);
 			if (NULL == node_set_string) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			if (! add_bipart_count(node_set_string)) {
+			if (! add_bipart_count(ctx, node_set_string)) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
@@ -255,31 +273,36 @@ void empty_data(struct rooted_tree *tree)
 	}
 }
 
-int process_tree(struct rooted_tree *tree)
+int process_tree(struct support_context *ctx, struct rooted_tree *tree)
 {
-	if (NULL == lbl2num) { /* first tree */
-		num_leaves = leaf_count(tree);
-		if (! init_lbl2num(tree)) return FAILURE;
-		bipart_counts = create_hash(num_leaves);
-		if (NULL == bipart_counts) return FAILURE;
+	if (NULL == ctx->lbl2num) { /* first tree */
+		ctx->num_leaves = leaf_count(tree);
+		if (! init_lbl2num(ctx, tree)) return FAILURE;
+		ctx->bipart_counts = create_hash(ctx->num_leaves);
+		if (NULL == ctx->bipart_counts) return FAILURE;
 	}
-	compute_bipartitions(tree);
+	compute_bipartitions(ctx, tree);
 	empty_data(tree);
 	destroy_tree(tree, DONT_FREE_NODE_DATA);
 
 	return SUCCESS;
 }
 
-void show_bipartition_counts()
+void show_bipartition_counts(struct support_context *ctx)
 {
-	struct llist *keys = hash_keys(bipart_counts);
+	struct llist *keys = hash_keys(ctx->bipart_counts);
 	struct list_elem *el;
 	assert(NULL != keys);
 
 	for (el = keys->head; NULL != el; el = el->next) {
 		char * key = (char *) el->data;
-		int * value = (int *) hash_get(bipart_counts, key);
-		printf ("%2d\t%s\n", *value, key);
+		int * value = (int *) hash_get(ctx->bipart_counts, key);
+		/* as printf("%2d\t%s\n"), there can be many of them */
+		if (*value >= 0 && *value < 10) putchar(' ');
+		out_long(stdout, *value);
+		putchar('\t');
+		out_string(stdout, key);
+		putchar('\n');
 	}
 
 	destroy_llist(keys);
@@ -292,28 +315,24 @@ int qsort_strcmp(const void *s1, const void *s2)
 	return strcmp(* (char **) s1, * (char **) s2);
 }
 
-void show_label_numbers()
+void show_label_numbers(struct support_context *ctx)
 {
-	struct llist *keys = hash_keys(lbl2num);
-	struct list_elem *el;
-	int i = 0;
-	assert(NULL != keys);
-	assert(0 != keys->count);
+	int id, i;
+	int count = 0;
 
-	char **labels = malloc(keys->count * sizeof(char *));
+	char **labels = malloc(ctx->lbl2num_size * sizeof(char *));
 	if (NULL == labels) {
 		perror(NULL);
 		exit(EXIT_FAILURE);
 	}
-	for (el = keys->head; NULL != el; el = el->next) {
-		char * key = (char *) el->data;
-		labels[i++] = key;
-	}
-	qsort(labels, keys->count, sizeof(char *), qsort_strcmp);
-	for (i = 0; i < keys->count; i++) {
+	for (id = 0; id < ctx->lbl2num_size; id++)
+		if (-1 != ctx->lbl2num[id])
+			labels[count++] = label_string(id);
+	assert(0 != count);
+	qsort(labels, count, sizeof(char *), qsort_strcmp);
+	for (i = 0; i < count; i++) {
 		printf ("%d: %s\n", i, labels[i]);
 	}
-	destroy_llist(keys);
 	free(labels);
 }
 
@@ -321,34 +340,37 @@ void show_label_numbers()
  * number of replicates. If this number is > 0, the counts will be expressed as
  * percentages of it. Otherwise, the counts will be absolute. */
 
-void attribute_support_to_target_tree(struct rooted_tree *tree, int rep_count)
+void attribute_support_to_target_tree(struct support_context *ctx,
+		struct rooted_tree *tree, int rep_count)
 {
+	int num_leaves = ctx->num_leaves;
 	/* # of digits for bipart count - need this to know string length */
 	/* e.g. if count = 143, need 3 characters */
 	int max_count_length;
        	if (0 == rep_count)	/* percent: 3 chars or less */
 		max_count_length = 3;
 	else
-		max_count_length = log10(bipart_counts->count) + 1;	
+		max_count_length = log10(ctx->bipart_counts->count) + 1;	
 	struct list_elem *el;
 	
 	for (el = tree->nodes_in_order->head; NULL != el; el = el->next) {
 		struct rnode *current = (struct rnode *) el->data;
 		node_set set;
 		if (is_leaf(current)) {
-			int *num = (int *) hash_get(lbl2num, current->label);
-			assert (NULL != num);
+			int num = leaf_number(ctx, current);
+			assert (-1 != num);
 			set = create_node_set(num_leaves);
 			if (NULL == set) {perror(NULL); exit(EXIT_FAILURE);}
-			node_set_add(set, *num, num_leaves);
+			node_set_add(set, num, num_leaves);
 		} else {
-			set = union_of_child_node_sets(current);
+			set = union_of_child_node_sets(num_leaves, current);
 			char *node_set_string = node_set_to_s(set, num_leaves);
 			if (NULL == node_set_string) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			int * count_p = hash_get(bipart_counts, node_set_string);
+			int * count_p = hash_get(ctx->bipart_counts,
+					node_set_string);
 			int count;
 			if (NULL == count_p) {
 				fprintf(stderr, "WARNING: zero bipart count for %s\n",
@@ -364,13 +386,16 @@ void attribute_support_to_target_tree(struct rooted_tree *tree, int rep_count)
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			free(current->label);
 			if (rep_count > 0) {	/* percent */
 				sprintf (lbl, "%d", 100 * count / rep_count);
 			} else {
 				sprintf (lbl, "%d", count);
 			}
-			current->label = lbl;
+			if (! set_rnode_label(current, lbl)) {
+				perror(NULL);
+				exit(EXIT_FAILURE);
+			}
+			free(lbl);
 			free(node_set_string);
 		}
 		current->data = set;
@@ -381,13 +406,17 @@ int main(int argc, char *argv[])
 {
 	struct rooted_tree *tree;	
 	struct parameters params = get_params(argc, argv);
+	struct support_context ctx = { NULL, 0, NULL, 0 };
+
+	buffer_stdout();
 	
 	/* Build the bipartition counts hash, and counts the number of
-	 * replicates. */
-	nwsin = params.rep_trees_file;
+	 * replicates. The default parser reads both files in turn, so that
+	 * replicates can be a tree pack, compressed, etc. */
+	set_parser_input(params.rep_trees_file);
 	int rep_count = 0;
 	while (NULL != (tree = parse_tree())) {
-		if (! process_tree(tree)) {
+		if (! process_tree(&ctx, tree)) {
 			fprintf(stderr, "Could not process tree "
 				"(memory error) - exiting.\n");
 			exit(EXIT_FAILURE);
@@ -398,13 +427,13 @@ int main(int argc, char *argv[])
 	if (! params.use_percent) { rep_count = 0; }
 
 	/* Attribute counts to the target trees */
-	nwsin = params.target_tree_file;
+	set_parser_input(params.target_tree_file);
 	while ((tree = parse_tree()) != NULL) {
-		attribute_support_to_target_tree(tree, rep_count);
+		attribute_support_to_target_tree(&ctx, tree, rep_count);
 		char *newick = to_newick(tree->root);
 		printf ("%s\n", newick);
 		free(newick);
-		if (params.show_label_numbers) show_label_numbers();
+		if (params.show_label_numbers) show_label_numbers(&ctx);
 		destroy_tree(tree, FREE_NODE_DATA);
 	}
 
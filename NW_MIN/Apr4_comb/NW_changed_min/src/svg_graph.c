@@ -54,6 +54,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "tree.h"
 #include "xml_utils.h"
 #include "error.h"
+#include "output.h"
 
 enum { INDIVIDUAL, CLADE, UNKNOWN };
 
@@ -798,6 +799,21 @@ enum display_status display_svg_tree(
 	return DISPLAY_OK;
 }
 
+void svg_line(int group_nb, double x1, double y1, double x2, double y2)
+{
+	out_string(stdout, "<line class='clade_");
+	out_long(stdout, group_nb);
+	out_string(stdout, "' x1='");
+	out_fixed(stdout, x1, 4);
+	out_string(stdout, "' y1='");
+	out_fixed(stdout, y1, 4);
+	out_string(stdout, "' x2='");
+	out_fixed(stdout, x2, 4);
+	out_string(stdout, "' y2='");
+	out_fixed(stdout, y2, 4);
+	out_string(stdout, "'/>");
+}
+
 void svg_footer() { printf ("</svg>\n"); }
 
 void destroy_svg_node_data (struct rnode *node)
@@ -74,6 +74,12 @@ void set_svg_plain_node_style(char *);
 void set_svg_root_length(int);
 void set_svg_label_char_width(double);
 
+/* Prints a <line> of class clade_<group_nb>, like printf("<line class='clade_%d'
+ * x1='%.4f' ...") would - but faster, as there are one or two per node (see
+ * output.h). */
+
+void svg_line(int group_nb, double x1, double y1, double x2, double y2);
+
 /* Returns the largest power of ten not greater than argument */
 
 double largest_PoT_lte(double);
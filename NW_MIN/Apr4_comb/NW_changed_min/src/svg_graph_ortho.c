@@ -39,6 +39,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "node_pos_alloc.h"
 #include "graph_common.h"
 #include "svg_graph_common.h"
+#include "output.h"
 
 extern enum inner_lbl_pos inner_label_pos;
 
@@ -89,10 +90,8 @@ void draw_branches_ortho (struct rooted_tree *tree, const double h_scale,
 
 		/* draw node (vertical line), except for leaves */
 		if (! is_leaf(node)) {
-		printf("<line class='clade_%d' "
-			"x1='%.4f' y1='%.4f' x2='%.4f' y2='%.4f'/>",
-			node_data->group_nb, svg_h_pos, svg_top_pos, svg_h_pos,
-			svg_bottom_pos);
+		svg_line(node_data->group_nb, svg_h_pos, svg_top_pos,
+			svg_h_pos, svg_bottom_pos);
 		}
 		/* draw horizontal line */
 		if (is_root(node)) {
@@ -103,10 +102,8 @@ void draw_branches_ortho (struct rooted_tree *tree, const double h_scale,
 			struct svg_data *parent_data = node->parent->data;
 			double svg_parent_h_pos = ROOT_SPACE + (
 				h_scale * parent_data->depth);
-			printf ("<line class='clade_%d' "
-				"x1='%.4f' y1='%.4f' x2='%.4f' y2='%.4f'/>",
-				node_data->group_nb, svg_parent_h_pos,
-				 svg_mid_pos, svg_h_pos, svg_mid_pos);
+			svg_line(node_data->group_nb, svg_parent_h_pos,
+				svg_mid_pos, svg_h_pos, svg_mid_pos);
 		}
 		/* draw ornament, if any */
 		if (NULL != node_data->ornament)
@@ -166,9 +163,15 @@ void draw_label(const double svg_h_pos, const double svg_mid_pos,
 	if (v_nudge)
 		v_pos -= KNEE_NODE_V_NUDGE;
 
-	printf("<text class='%s' "
-	       "x='%.4f' y='%.4f'>%s</text>",
-		class, h_pos, v_pos, node->label);
+	out_string(stdout, "<text class='");
+	out_string(stdout, class);
+	out_string(stdout, "' x='");
+	out_fixed(stdout, h_pos, 4);
+	out_string(stdout, "' y='");
+	out_fixed(stdout, v_pos, 4);
+	out_string(stdout, "'>");
+	out_string(stdout, node->label);
+	out_string(stdout, "</text>");
 
 	if (url) printf ("</a>");
 }
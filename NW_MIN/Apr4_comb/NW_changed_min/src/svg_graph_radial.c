@@ -40,6 +40,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "graph_common.h"
 #include "svg_graph_common.h"
 #include "math.h"
+#include "output.h"
 
 extern enum inner_lbl_pos inner_label_pos;
 
@@ -132,10 +133,7 @@ void draw_branches_radial (struct rooted_tree *tree, const double r_scale,
 				r_scale * parent_data->depth);
 			double svg_par_x_pos = svg_parent_radius * cos(svg_mid_angle);
 			double svg_par_y_pos = svg_parent_radius * sin(svg_mid_angle);
-			printf ("<line class='clade_%d' "
-				"x1='%.4f' y1='%.4f' x2='%.4f' y2='%.4f'/>",
-				group_nb,
-				svg_mid_x_pos, svg_mid_y_pos,
+			svg_line(group_nb, svg_mid_x_pos, svg_mid_y_pos,
 				svg_par_x_pos, svg_par_y_pos);
 		}
 		/* draw ornament, if any */
@@ -148,6 +146,43 @@ void draw_branches_radial (struct rooted_tree *tree, const double r_scale,
 	printf("</g>");
 }
 
+/* These print a label's <text> element, in pieces: its start up to the
+ * transform's value, the transform's rotations, and the rest. Labels are
+ * printed with output.h rather than printf(), as there is one per node. */
+
+static void print_text_start(const char *class, const char *style)
+{
+	out_string(stdout, "<text class='");
+	out_string(stdout, class);
+	out_string(stdout, "' ");
+	out_string(stdout, style);
+	out_string(stdout, "transform='");
+}
+
+/* Like printf("rotate(%g,%g,%g)", angle, x, y) */
+
+static void print_rotation(double angle, double x, double y)
+{
+	out_string(stdout, "rotate(");
+	out_double(stdout, angle);
+	putchar(',');
+	out_double(stdout, x);
+	putchar(',');
+	out_double(stdout, y);
+	putchar(')');
+}
+
+static void print_text_end(double x, double y, const char *label)
+{
+	out_string(stdout, "' x='");
+	out_fixed(stdout, x, 4);
+	out_string(stdout, "' y='");
+	out_fixed(stdout, y, 4);
+	out_string(stdout, "'>");
+	out_string(stdout, label);
+	out_string(stdout, "</text>");
+}
+
 /* Draws a node label */
 
 static void draw_label(struct rnode *node, double radius,
@@ -194,13 +229,9 @@ static void draw_label(struct rnode *node, double radius,
 			x_pos -= (NUDGE_DISTANCE * cos(mid_angle + PI / 2));
 			y_pos -= (NUDGE_DISTANCE * sin(mid_angle + PI / 2));
 		}
-		printf("<text class='%s' "
-		       "transform='rotate(%g,%g,%g)' "
-		       "x='%.4f' y='%.4f'>%s</text>",
-			class,
-			mid_angle / (2*PI) * 360,
-			x_pos, y_pos,
-			x_pos, y_pos, node->label);
+		print_text_start(class, "");
+		print_rotation(mid_angle / (2*PI) * 360, x_pos, y_pos);
+		print_text_end(x_pos, y_pos, node->label);
 	}
 	else {
 		mid_angle += svg_left_label_angle_correction;
@@ -210,15 +241,11 @@ static void draw_label(struct rnode *node, double radius,
 			x_pos += (NUDGE_DISTANCE * cos(mid_angle + PI / 2));
 			y_pos += (NUDGE_DISTANCE * sin(mid_angle + PI / 2));
 		}
-		printf(	"<text class='%s' "
-			"style='text-anchor:end;' "
-			"transform='rotate(%g,%g,%g) rotate(180,%g,%g)' "
-		       "x='%.4f' y='%.4f'>%s</text>",
-			class,
-			mid_angle / (2*PI) * 360,
-			x_pos, y_pos,
-			x_pos, y_pos,
-			x_pos, y_pos, node->label);
+		print_text_start(class, "style='text-anchor:end;' ");
+		print_rotation(mid_angle / (2*PI) * 360, x_pos, y_pos);
+		out_string(stdout, " ");
+		print_rotation(180, x_pos, y_pos);
+		print_text_end(x_pos, y_pos, node->label);
 	}
 
 	if (url) printf("</a>");
@@ -32,132 +32,166 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 #include <assert.h>
 
+#include "to_newick.h"
 #include "rnode.h"
 #include "list.h"
-#include "concat.h"
 #include "common.h"
-#include "rnode_iterator.h"
-#include "hash.h"
 
-/* returns the length part of a node, e.g. ":12.345" */
+/* Both functions below write the tree in a single preorder pass: no string is
+ * built per subtree, so the cost is linear in the output's length. Output goes
+ * to a growable buffer, which dump_newick() keeps from one tree to the next
+ * and writes out in one go. */
 
-char *length(struct rnode *node)
+#define INIT_BUFFER_SIZE 256
+#define INIT_STACK_SIZE 64
+
+struct newick_writer {
+	char *buf;
+	size_t len;	/* not counting the '\0' */
+	size_t size;
+};
+
+static int put(struct newick_writer *w, const char *s)
 {
-	char * result = malloc(sizeof(char));
-	if (NULL == result) return NULL;
-	*result = '\0';
-
-	if (NULL != node->parent) {
-		if (strlen(node->edge_length_as_string) > 0) {
-			result = append_to(result, ":");
-			result = append_to(result,
-				       node->edge_length_as_string);	
-		}
+	size_t n = strlen(s);
+
+	if (w->len + n + 1 > w->size) {
+		size_t new_size = 2 * w->size;
+		char *new_buf;
+		while (w->len + n + 1 > new_size) new_size *= 2;
+		new_buf = realloc(w->buf, new_size);
+		if (NULL == new_buf) return FAILURE;
+		w->buf = new_buf;
+		w->size = new_size;
 	}
+	memcpy(w->buf + w->len, s, n + 1);
+	w->len += n;
+	return SUCCESS;
+}
+
+/* Writes the node's label and, if it has one, its length (to_newick() only
+ * writes lengths of nodes that have a parent, dump_newick() always does). */
 
-	return result;
+static int put_node(struct newick_writer *w, struct rnode *node,
+		int length_needs_parent)
+{
+	if (! put(w, node->label)) return FAILURE;
+	if ('\0' == node->edge_length_as_string[0]) return SUCCESS;
+	if (length_needs_parent && NULL == node->parent) return SUCCESS;
+	if (! put(w, ":")) return FAILURE;
+	return put(w, node->edge_length_as_string);
 }
 
-char *subtree(struct rnode *node)
+/* A node whose subtree is being written, and the child being written. */
+
+struct open_node {
+	struct rnode *node;
+	struct list_elem *child;
+};
+
+/* Writes the subtree rooted at 'root' (without the ';'). Iterative, so that
+ * deep trees do not exhaust the call stack. */
+
+static int put_subtree(struct newick_writer *w, struct rnode *root,
+		int length_needs_parent)
 {
-	char * result = malloc(sizeof(char));
-	if (NULL == result) return NULL;
-	*result = '\0';
-
-	if (is_leaf(node)) {
-		result = append_to(result, node->label);
-		char *length_s = length(node);
-		if (NULL == length_s) return NULL;
-		result = append_to(result, length_s);
-		free(length_s);
-	} else {
-		struct rnode *child;
-		struct list_elem *elem;
-		char * child_node_s;
-
-		result = append_to(result, "(");
-
-		/* first child */
-		elem = node->children->head;
-		child = elem->data;
-		child_node_s = subtree(child);
-		if (NULL == child_node_s) return NULL;
-		result = append_to(result, child_node_s);
-		free(child_node_s);
-		/* other children, comma-separated */
-		for (elem = elem->next; elem != NULL; elem = elem->next) {
-			result = append_to(result, ",");
-			child = elem->data;
-			child_node_s = subtree(child);
-			if (NULL == child_node_s) return NULL;
-			result = append_to(result, child_node_s);
-			free(child_node_s);
+	struct open_node *stack = malloc(INIT_STACK_SIZE *
+			sizeof(struct open_node));
+	int depth = 0;
+	int capacity = INIT_STACK_SIZE;
+	struct rnode *node = root;
+
+	if (NULL == stack) return FAILURE;
+
+	for (;;) {
+		/* go down to the first leaf, opening subtrees */
+		while (! is_leaf(node)) {
+			if (depth == capacity) {
+				struct open_node *bigger = realloc(stack,
+					2 * capacity * sizeof(struct open_node));
+				if (NULL == bigger) goto error;
+				stack = bigger;
+				capacity *= 2;
+			}
+			stack[depth].node = node;
+			stack[depth].child = node->children->head;
+			depth++;
+			if (! put(w, "(")) goto error;
+			node = node->children->head->data;
 		}
-		result = append_to(result, ")");
-		if (NULL != node->label) {
-			result = append_to(result, node->label);
+		if (! put_node(w, node, length_needs_parent)) goto error;
+
+		/* go up to the next sibling, closing finished subtrees */
+		for (;;) {
+			struct open_node *top;
+			if (0 == depth) {
+				free(stack);
+				return SUCCESS;
+			}
+			top = stack + depth - 1;
+			if (NULL != top->child->next) {
+				top->child = top->child->next;
+				node = top->child->data;
+				if (! put(w, ",")) goto error;
+				break;
+			}
+			if (! put(w, ")")) goto error;
+			if (! put_node(w, top->node, length_needs_parent))
+				goto error;
+			depth--;
 		}
-		char *length_s = length(node);
-		if (NULL == length_s) return NULL;
-		result = append_to(result, length_s);
-		free(length_s);
 	}
-	return result;
+
+error:
+	free(stack);
+	return FAILURE;
 }
 
 char *to_newick(struct rnode *node)
 {
-	char *result;
-	result = subtree(node);
-	if (NULL == result) return NULL;
-	result = append_to(result, ";");
-	return result;
+	struct newick_writer w;
+
+	w.len = 0;
+	w.size = INIT_BUFFER_SIZE;
+	w.buf = malloc(w.size);
+	if (NULL == w.buf) return NULL;
+	w.buf[0] = '\0';
+
+	if (! put_subtree(&w, node, TRUE) || ! put(&w, ";")) {
+		free(w.buf);
+		return NULL;
+	}
+	return w.buf;
 }
 
+/* dump_newick()'s buffer, grown to fit the largest tree so far */
+
+static struct newick_writer dump_writer = { NULL, 0, 0 };
+
 int dump_newick(struct rnode *node)
 {
-	struct rnode_iterator *it;
-	struct rnode *current;
+	struct newick_writer *w = &dump_writer;
 
-	it = create_rnode_iterator(node);
-	if (NULL == it) {
-		perror(NULL);
-		return FAILURE;
+	/* A lone node has always come out as "(;" */
+	if (is_leaf(node) && is_root(node)) {
+		printf("(;\n");
+		return SUCCESS;
 	}
-	
-	it->root->seen = 1;
-
-	printf("(");
-	while ((current = rnode_iterator_next(it)) != NULL) {
-		 //fprintf (stderr, "%s: seen: %d\n", current->label, current->seen);
-		if (is_leaf(current)) {
-			/* leaf: just print label */
-			printf("%s", current->label);
-			if (strcmp("", current->edge_length_as_string) != 0)
-					printf(":%s", current->edge_length_as_string);
-		}
-		else {
-			/* inner node: behaviour depends on whether we've
-			 * already 'seen' this node or not. */
-			if (0 == current->seen) {
-				/* not seen: print '(' */
-				current->seen = 1;
-				printf("(");
-			} else {
-				if (more_children_to_visit(it)) {
-					printf(",");
-				}
-				else {
-					printf(")%s", current->label);
-					if (strcmp("",
-					current->edge_length_as_string) != 0)
-						printf(":%s", current->edge_length_as_string);
-				}
-			}
+	if (NULL == w->buf) {
+		w->buf = malloc(INIT_BUFFER_SIZE);
+		if (NULL == w->buf) {
+			perror(NULL);
+			return FAILURE;
 		}
+		w->size = INIT_BUFFER_SIZE;
+	}
+	w->len = 0;
+	w->buf[0] = '\0';
+	if (! put_subtree(w, node, FALSE) || ! put(w, ";\n")) {
+		perror(NULL);
+		return FAILURE;
 	}
-	printf(";\n");
+	fwrite(w->buf, 1, w->len, stdout);
 
-	destroy_rnode_iterator(it);
 	return SUCCESS;
 }
@@ -33,11 +33,11 @@ struct rnode;
 
 /* Returns a Newick representation of the tree. Memory is allocated, don't
  * forget to free() it. Returns NULL in case of failure (which will be a memory
- * allocation problem). WARNING: the current implementation is recursive, and
- * hence is slow for big trees.  */
+ * allocation problem). Takes time linear in the length of the output. */
 
 char *to_newick(struct rnode* root);
 
 /* Dumps the newick rooted at 'root' to stdout. */
+/* Returns FAILURE in case of error (malloc()) */
 
-void dump_newick(struct rnode* root);
+int dump_newick(struct rnode* root);
@@ -40,6 +40,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "rnode.h"
 #include "list.h"
 #include "common.h"
+#include "output.h"
 
 struct parameters {
 	int show_inner_labels;
@@ -129,12 +130,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 1)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 	} else {
 		fprintf(stderr, "Usage: %s [-bhIL] <filename|->\n", argv[0]);
@@ -155,17 +155,14 @@ void process_tree(struct rooted_tree *tree, struct parameters params)
 			char *length = current->edge_length_as_string;
 			length[0] = '\0';
 		}
+		/* labels are shared, so we can't just truncate them */
 		if (! params.show_inner_labels) {
-			if (! is_leaf(current)) {
-				char *label = current->label;
-				label[0] = '\0';
-			}
+			if (! is_leaf(current))
+				set_rnode_label(current, "");
 		}
 		if (! params.show_leaf_labels) {
-			if (is_leaf(current)) {
-				char *label = current->label;
-				label[0] = '\0';
-			}
+			if (is_leaf(current))
+				set_rnode_label(current, "");
 		}
 	}
 }
@@ -176,6 +173,7 @@ int main (int argc, char* argv[])
 	struct parameters params;
 
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	while ((tree = parse_tree()) != NULL) {
 		process_tree(tree, params);
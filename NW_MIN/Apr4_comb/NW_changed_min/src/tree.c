@@ -40,11 +40,126 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "nodemap.h"
 #include "hash.h"
 #include "rnode_iterator.h"
+#include "arena.h"
 #include "common.h"
 
 const int FREE_NODE_DATA = 1;
 const int DONT_FREE_NODE_DATA = 0;
 
+/* A tree's cached traversals. Each list is built when first asked for, and
+ * all are dropped when the tree has changed (see tree.h). */
+
+struct tree_orders {
+	unsigned long link_changes;	/* value of link_changes when valid */
+	struct rnode *root;		/* the tree's root when valid */
+	struct llist *postorder;
+	int postorder_is_nodes_in_order;	/* then it isn't ours to free */
+	struct llist *preorder;
+	struct llist *leaves;
+};
+
+static void clear_tree_orders(struct tree_orders *orders)
+{
+	if (NULL != orders->postorder && ! orders->postorder_is_nodes_in_order)
+		destroy_llist(orders->postorder);
+	if (NULL != orders->preorder) destroy_llist(orders->preorder);
+	if (NULL != orders->leaves) destroy_llist(orders->leaves);
+	orders->postorder = orders->preorder = orders->leaves = NULL;
+	orders->postorder_is_nodes_in_order = FALSE;
+}
+
+/* Returns the tree's cached traversals, emptied if the tree has changed since
+ * they were computed. Returns NULL in case of error (malloc()) */
+
+static struct tree_orders *current_orders(struct rooted_tree *tree)
+{
+	struct tree_orders *orders = tree->orders;
+
+	if (NULL == orders) {
+		orders = malloc(sizeof(struct tree_orders));
+		if (NULL == orders) return NULL;
+		orders->postorder = orders->preorder = orders->leaves = NULL;
+		orders->postorder_is_nodes_in_order = FALSE;
+		tree->orders = orders;
+	} else if (orders->link_changes != link_changes ||
+			orders->root != tree->root) {
+		clear_tree_orders(orders);
+	}
+	orders->link_changes = link_changes;
+	orders->root = tree->root;
+
+	return orders;
+}
+
+struct llist *tree_postorder(struct rooted_tree *tree)
+{
+	struct tree_orders *orders = current_orders(tree);
+	if (NULL == orders) return NULL;
+
+	if (NULL == orders->postorder)
+		orders->postorder = get_nodes_in_order(tree->root);
+
+	return orders->postorder;
+}
+
+struct llist *tree_preorder(struct rooted_tree *tree)
+{
+	struct tree_orders *orders = current_orders(tree);
+	if (NULL == orders) return NULL;
+
+	if (NULL == orders->preorder)
+		orders->preorder = get_nodes_in_preorder(tree->root);
+
+	return orders->preorder;
+}
+
+struct llist *tree_leaves(struct rooted_tree *tree)
+{
+	struct llist *postorder = tree_postorder(tree);
+	struct list_elem *el;
+	if (NULL == postorder) return NULL;
+
+	/* tree_postorder() made the orders current */
+	if (NULL == tree->orders->leaves) {
+		struct llist *leaves = create_llist();
+		if (NULL == leaves) return NULL;
+		for (el = postorder->head; NULL != el; el = el->next) {
+			if (! is_leaf((struct rnode *) el->data)) continue;
+			if (! append_element(leaves, el->data)) {
+				destroy_llist(leaves);
+				return NULL;
+			}
+		}
+		tree->orders->leaves = leaves;
+	}
+
+	return tree->orders->leaves;
+}
+
+void use_nodes_in_order_as_postorder(struct rooted_tree *tree)
+{
+	struct tree_orders *orders;
+
+	tree->built = link_changes;
+	tree->changed = FALSE;
+	orders = current_orders(tree);
+	/* if NULL, tree_postorder() will build a list */
+	if (NULL == orders) return;
+
+	clear_tree_orders(orders);
+	orders->postorder = tree->nodes_in_order;
+	orders->postorder_is_nodes_in_order = TRUE;
+}
+
+void forget_tree_orders(struct rooted_tree *tree)
+{
+	tree->changed = TRUE;
+	if (NULL == tree->orders) return;
+	clear_tree_orders(tree->orders);
+	free(tree->orders);
+	tree->orders = NULL;
+}
+
 
 /* 'outgroup' is the node which will be the outgroup after rerooting. */
 
@@ -91,7 +206,9 @@ int reroot_tree(struct rooted_tree *tree, struct rnode *outgroup)
 	tree->root = new_root;
         destroy_llist(tree->nodes_in_order);
 	tree->nodes_in_order = get_nodes_in_order(tree->root);
-	reset_current_child_elem(tree);
+	use_nodes_in_order_as_postorder(tree);
+	/* but it has nodes that were not built with it */
+	tree->changed = TRUE;
 
 	return SUCCESS;
 }
@@ -120,12 +237,13 @@ int all_children_have_same_label(struct rnode *n, char **label)
 	struct list_elem *el = n->children->head;
 	struct rnode *child = el->data;
 	char *ref_label = child->label;
+	int ref_label_id = child->label_id;
 
 	/* iterate over other children, and compare their label to the first's */
 
 	for (el = el->next; NULL != el; el = el->next) {
 		child = el->data;
-		if (0 != strcmp(ref_label, child->label))
+		if (ref_label_id != child->label_id)
 			return 0; /* found a different label */
 	}
 
@@ -145,35 +263,55 @@ void collapse_pure_clades(struct rooted_tree *tree)
 		if (! all_children_are_leaves(current)) continue;
 		char *label;
 		if (all_children_have_same_label(current, &label)) {
-			/* set own label to children's label  - we copy it
-			 * because it will be later passed to free() */
-			free(current->label);
-			current->label = strdup(label);
+			/* set own label to children's label */
+			set_rnode_label(current, label);
 			/* remove children */
 			clear_llist(current->children);
 		}
 	}
 }
 
+/* True IFF the tree's nodes, lists and edge lengths all come from its arena,
+ * i.e. it was built in one and has not changed since. */
+
+static int all_in_arena(struct rooted_tree *tree)
+{
+	return NULL != tree->arena && ! tree->changed &&
+		link_changes == tree->built;
+}
+
 void destroy_tree(struct rooted_tree *tree, int free_node_data)
 {
 	struct list_elem *e;
 
+	if (all_in_arena(tree)) {
+		/* the arena takes the rest */
+		if (free_node_data)
+			for (e = tree->nodes_in_order->head; NULL != e;
+					e = e->next)
+				free(((struct rnode *) e->data)->data);
+		forget_tree_orders(tree);
+		destroy_arena(tree->arena);
+		free(tree);
+		return;
+	}
+
 	/* Traversing in post-order ensures that children list's data are
 	 * already empty when we destroy the list */
 	for (e = tree->nodes_in_order->head; NULL != e; e = e->next) {
 		struct rnode *current = e->data;
 		destroy_llist(current->children);
-		free(current->label);
-		free(current->edge_length_as_string);
+		arena_free(current->edge_length_as_string);
 		/* only works if data can be free()d, i.e. has no pointer to
 		 * allocated storage. Otherwise free the data "manually". */
 		if (free_node_data)
 			free(current->data);
-		free(current);
+		if (! current->in_arena) free(current);
 	}
 
 	destroy_llist(tree->nodes_in_order);
+	forget_tree_orders(tree);
+	if (NULL != tree->arena) destroy_arena(tree->arena);
 	free(tree);
 }
 
@@ -191,22 +329,37 @@ void destroy_tree_cb(struct rooted_tree *tree,
 {
 	struct list_elem *e;
 
+	if (all_in_arena(tree)) {
+		for (e = tree->nodes_in_order->head; NULL != e; e = e->next) {
+			struct rnode *current = e->data;
+			if (NULL != node_data_destroyer)
+				node_data_destroyer(current);
+			else
+				free(current->data);
+		}
+		forget_tree_orders(tree);
+		destroy_arena(tree->arena);
+		free(tree);
+		return;
+	}
+
 	/* Traversing in post-order ensures that children list's data are
 	 * already empty when we destroy the list (since the lists contain
 	 * children edges) */
 	for (e = tree->nodes_in_order->head; NULL != e; e = e->next) {
 		struct rnode *current = e->data;
 		destroy_llist(current->children);
-		free(current->label);
-		free(current->edge_length_as_string);
+		arena_free(current->edge_length_as_string);
 		if (NULL != node_data_destroyer)
 			node_data_destroyer(current);
 		else if (NULL != current->data) 
 			free(current->data);
-		free(current);
+		if (! current->in_arena) free(current);
 	}
 
 	destroy_llist(tree->nodes_in_order);
+	forget_tree_orders(tree);
+	if (NULL != tree->arena) destroy_arena(tree->arena);
 	free(tree);
 }
 
@@ -215,6 +368,20 @@ void destroy_tree_cb_2(struct rooted_tree *tree,
 {
 	struct list_elem *e;
 
+	if (all_in_arena(tree)) {
+		for (e = tree->nodes_in_order->head; NULL != e; e = e->next) {
+			struct rnode *current = e->data;
+			if (NULL != node_data_destroyer)
+				node_data_destroyer(current->data);
+			else
+				free(current->data);
+		}
+		forget_tree_orders(tree);
+		destroy_arena(tree->arena);
+		free(tree);
+		return;
+	}
+
 	/* Traversing in post-order ensures that children list's data are
 	 * already empty when we destroy the list */
 	for (e = tree->nodes_in_order->head; NULL != e; e = e->next) {
@@ -223,6 +390,8 @@ void destroy_tree_cb_2(struct rooted_tree *tree,
 	}
 
 	destroy_llist(tree->nodes_in_order);
+	forget_tree_orders(tree);
+	if (NULL != tree->arena) destroy_arena(tree->arena);
 	free(tree);
 }
 
@@ -406,21 +575,57 @@ struct llist *nodes_from_regexp(struct rooted_tree *tree, regex_t *preg)
 	return result;
 }
 
-/* Clones a clade (recursively) */
-// TODO: try an iterative version using a rnode_iterator
+/* Clones a clade. Uses an explicit stack of (original, clone) pairs rather
+ * than recursion, so that the depth of the clade does not matter. */
+
+struct clone_pair {
+	struct rnode *orig;
+	struct rnode *clone;
+};
+
 static struct rnode *clone_clade(struct rnode *root)
 {
 	struct rnode *root_clone = create_rnode(root->label,
 			root->edge_length_as_string);
 	if (NULL == root_clone) return NULL;
-	struct list_elem *el;
-	for (el = root->children->head; NULL != el; el = el->next) {
-		struct rnode *kid = el->data;
-		struct rnode *kid_clone = clone_clade(kid);
-		if (NULL == kid_clone) return NULL;
-		if (! add_child(root_clone, kid_clone)) return NULL;
+
+	size_t size = 64, top = 0;
+	struct clone_pair *stack = malloc(size * sizeof(struct clone_pair));
+	if (NULL == stack) return NULL;
+	stack[top].orig = root;
+	stack[top].clone = root_clone;
+	top++;
+
+	while (top > 0) {
+		struct clone_pair pair = stack[--top];
+		struct list_elem *el;
+		for (el = pair.orig->children->head; NULL != el; el = el->next) {
+			struct rnode *kid = el->data;
+			struct rnode *kid_clone = create_rnode(kid->label,
+					kid->edge_length_as_string);
+			if (NULL == kid_clone) { free(stack); return NULL; }
+			if (! add_child(pair.clone, kid_clone)) {
+				free(stack);
+				return NULL;
+			}
+			if (is_leaf(kid)) continue;
+			if (top == size) {
+				size *= 2;
+				struct clone_pair *new_stack = realloc(stack,
+					size * sizeof(struct clone_pair));
+				if (NULL == new_stack) {
+					free(stack);
+					return NULL;
+				}
+				stack = new_stack;
+			}
+			stack[top].orig = kid;
+			stack[top].clone = kid_clone;
+			top++;
+		}
 	}
 
+	free(stack);
 	return root_clone;
 }
 
@@ -437,6 +642,9 @@ struct rooted_tree* clone_subtree(struct rnode *root)
 
 	clone->root = root_clone;
 	clone->nodes_in_order = nodes_in_order_clone;
+	clone->arena = NULL;
+	clone->orders = NULL;
+	use_nodes_in_order_as_postorder(clone);
 
 	return clone;
 }
@@ -31,6 +31,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 struct rnode;
 struct llist;
+struct arena;
+struct tree_orders;
 
 extern const int FREE_NODE_DATA;
 extern const int DONT_FREE_NODE_DATA;
@@ -41,8 +43,48 @@ struct rooted_tree {
 	struct rnode *root;
 	struct llist *nodes_in_order;
 	enum tree_type type;
+	struct arena *arena;	/* NULL unless parsed in an arena */
+	struct tree_orders *orders;	/* see tree_postorder(); may be NULL */
+	/* link_changes when built, and whether the tree has changed by other
+	 * means since (see destroy_tree()) */
+	unsigned long built;
+	int changed;
 };
 
+/* NOTE: 'nodes_in_order' lists all the tree's nodes in parse order. It is not
+ * updated when the tree is modified (it still has any removed nodes, so that
+ * they are freed with the tree). Functions that need the nodes of the tree as
+ * it is should use the traversals below. These are computed when first asked
+ * for, and kept until the tree's structure changes, i.e. until a function of
+ * link.h is called (on the same thread), or the tree gets a new root. */
+
+/* Returns the tree's nodes in postorder (children in order, then their
+ * parent). The list belongs to the tree and must not be modified. */
+/* Returns NULL in case of error (malloc()) */
+
+struct llist *tree_postorder(struct rooted_tree *tree);
+
+/* Returns the tree's nodes in preorder (a parent, then its children in order),
+ * like tree_postorder() */
+
+struct llist *tree_preorder(struct rooted_tree *tree);
+
+/* Returns the tree's leaves in order, like tree_postorder() */
+
+struct llist *tree_leaves(struct rooted_tree *tree);
+
+/* Makes tree_postorder() return 'nodes_in_order' until the tree changes. This
+ * saves building a list for freshly built trees, and marks the tree as built
+ * (see destroy_tree()). */
+
+void use_nodes_in_order_as_postorder(struct rooted_tree *tree);
+
+/* Drops the tree's cached traversals, and marks the tree as changed. Call this
+ * after changing the tree by other means than link.h (e.g. reordering
+ * children), and before freeing a tree by hand. */
+
+void forget_tree_orders(struct rooted_tree *tree);
+
 /* Reroots the tree in such a way that 'outgroup' and descendants are one of
  * the root's children, and the rest of the tree is the other child. The old
  * root node gets spliced out if it has only one child. */
@@ -58,7 +100,10 @@ void collapse_pure_clades(struct rooted_tree *tree);
 /* Destroys a tree, releasing memory. Node data is freed if 'free_node_data' is
  * true (but any dynamically allocated memory pointed to by node data is NOT
  * freed), so 'free_node_data' should be set to true IFF the data can be
- * free()d directly. Otherwise, it will need to be free()d manually. */
+ * free()d directly. Otherwise, it will need to be free()d manually. If the tree
+ * was parsed in an arena, the arena goes too (as do all three functions), and
+ * if the tree has not changed since (on the same thread), so do all its nodes:
+ * then only node data is visited. */
 
 void destroy_tree(struct rooted_tree *, int free_node_data);
 
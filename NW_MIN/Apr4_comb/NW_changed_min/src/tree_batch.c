@@ -0,0 +1,388 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_batch.h"
+#include "parser.h"
+#include "mmap_parser.h"
+#include "tree.h"
+#include "rnode.h"
+#include "link.h"
+#include "list.h"
+#include "flat_tree.h"
+#include "cluster_set.h"
+#include "to_newick.h"
+#include "label_table.h"
+#include "common.h"
+
+#define INIT_BATCH_CAPACITY 64
+
+static struct tree_batch *create_tree_batch()
+{
+	struct tree_batch *batch = malloc(sizeof(struct tree_batch));
+	if (NULL == batch) return NULL;
+	batch->num_trees = 0;
+	batch->newicks = NULL;
+	batch->flats = NULL;
+	batch->clusters = NULL;
+	batch->taxon_labels = NULL;
+	batch->max_clusters = 0;
+	batch->taxa = create_taxon_index(0);
+	if (NULL == batch->taxa) {
+		free(batch);
+		return NULL;
+	}
+	return batch;
+}
+
+/* Adds 'tree' to the batch (the tree itself is not kept). Returns FAILURE in
+ * case of error (malloc()). */
+
+static int add_tree(struct tree_batch *batch, struct rooted_tree *tree,
+		int *capacity)
+{
+	int n = batch->num_trees;
+
+	if (n == *capacity) {
+		int new_capacity = *capacity ? 2 * *capacity
+			: INIT_BATCH_CAPACITY;
+		char **newicks = realloc(batch->newicks,
+				new_capacity * sizeof(char *));
+		if (NULL == newicks) return FAILURE;
+		batch->newicks = newicks;
+		struct flat_tree **flats = realloc(batch->flats,
+				new_capacity * sizeof(struct flat_tree *));
+		if (NULL == flats) return FAILURE;
+		batch->flats = flats;
+		*capacity = new_capacity;
+	}
+	batch->newicks[n] = to_newick(tree->root);
+	if (NULL == batch->newicks[n]) return FAILURE;
+	batch->flats[n] = create_flat_tree(tree);
+	if (NULL == batch->flats[n]) {
+		free(batch->newicks[n]);
+		return FAILURE;
+	}
+	batch->num_trees++;
+	return taxon_index_add_tree(batch->taxa, tree);
+}
+
+/* Computes the clusters, once all taxa are numbered */
+
+static int compute_clusters(struct tree_batch *batch)
+{
+	int n, id;
+
+	batch->clusters = calloc(batch->num_trees,
+			sizeof(struct tree_clusters *));
+	batch->taxon_labels = malloc(batch->taxa->count * sizeof(char *));
+	if (NULL == batch->clusters || NULL == batch->taxon_labels)
+		return FAILURE;
+	for (n = 0; n < batch->num_trees; n++) {
+		batch->clusters[n] = create_flat_tree_clusters(batch->flats[n],
+				batch->taxa);
+		if (NULL == batch->clusters[n]) return FAILURE;
+		if (batch->clusters[n]->num_clusters > batch->max_clusters)
+			batch->max_clusters = batch->clusters[n]->num_clusters;
+	}
+	for (id = 0; id < batch->taxa->size; id++)
+		if (batch->taxa->id2num[id] >= 0)
+			batch->taxon_labels[batch->taxa->id2num[id]] =
+				label_string(id);
+	return SUCCESS;
+}
+
+struct tree_batch *read_tree_batch()
+{
+	struct tree_batch *batch = create_tree_batch();
+	struct rooted_tree *tree;
+	int capacity = 0;
+
+	if (NULL == batch) return NULL;
+	/* we only keep the (smaller) flat trees while taxa are numbered */
+	while (NULL != (tree = parse_tree())) {
+		int added = add_tree(batch, tree, &capacity);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+		if (! added) goto error;
+	}
+	if (PARSER_STATUS_EMPTY != newick_parser_status()) goto error;
+	if (! compute_clusters(batch)) goto error;
+	return batch;
+
+error:
+	destroy_tree_batch(batch);
+	return NULL;
+}
+
+struct tree_batch *read_tree_batch_file(const char *filename)
+{
+	if (! set_parser_input_filename((char *) filename)) return NULL;
+	return read_tree_batch();
+}
+
+struct tree_batch *read_tree_batch_string(const char *newick)
+{
+	struct tree_batch *batch;
+	if (! set_parser_string_input(newick)) return NULL;
+	batch = read_tree_batch();
+	clear_parser_string_input();
+	return batch;
+}
+
+void tree_batch_leaf_counts(struct tree_batch *batch, int *counts)
+{
+	int n, i;
+	for (n = 0; n < batch->num_trees; n++) {
+		struct flat_tree *flat = batch->flats[n];
+		counts[n] = 0;
+		for (i = 0; i < flat->num_nodes; i++)
+			if (flat_tree_is_leaf(flat, i)) counts[n]++;
+	}
+}
+
+/* Matches the pattern parsed by 'parser' (see tree_batch_match()). The pattern
+ * is parsed as a flat tree, whose labels are its own: unlike parse_tree(), this
+ * interns none of them, so that a server's label table does not grow with each
+ * request. */
+
+static int match_pattern(struct tree_batch *batch, struct mmap_parser *parser,
+		char *matches)
+{
+	struct flat_tree *flat;
+	struct tree_clusters *pattern_clusters = NULL;
+	struct cluster_restriction *pattern_restriction = NULL;
+	struct cluster_restriction *restriction = NULL;
+	int n, count = 0, capacity;
+
+	memset(matches, FALSE, batch->num_trees);
+	flat = mmap_parse_flat_tree(parser);
+	if (NULL == flat)
+		return PARSER_STATUS_MALLOC_ERROR == parser->status ?
+			BATCH_MEM_ERROR : BATCH_BAD_PATTERN;
+	/* a label that no tree has: no tree can match */
+	for (n = 0; n < flat->num_nodes; n++) {
+		const char *label = flat_tree_label(flat, n);
+		if (flat_tree_is_leaf(flat, n) && '\0' != *label
+			&& taxon_number(batch->taxa, label) < 0) {
+			destroy_flat_tree(flat);
+			return 0;
+		}
+	}
+
+	pattern_clusters = create_flat_tree_clusters(flat, batch->taxa);
+	capacity = flat->num_nodes > batch->max_clusters ?
+		flat->num_nodes : batch->max_clusters;
+	destroy_flat_tree(flat);
+	if (NULL == pattern_clusters) goto error;
+	pattern_restriction = create_cluster_restriction(capacity,
+			pattern_clusters->num_words);
+	restriction = create_cluster_restriction(capacity,
+			pattern_clusters->num_words);
+	if (NULL == pattern_restriction || NULL == restriction) goto error;
+
+	restrict_clusters(pattern_clusters, pattern_clusters->leaves,
+			pattern_restriction);
+	for (n = 0; n < batch->num_trees; n++) {
+		restrict_clusters(batch->clusters[n], pattern_clusters->leaves,
+				restriction);
+		if (cluster_restrictions_equal(pattern_restriction,
+					restriction)) {
+			matches[n] = TRUE;
+			count++;
+		}
+	}
+
+	destroy_cluster_restriction(restriction);
+	destroy_cluster_restriction(pattern_restriction);
+	destroy_tree_clusters(pattern_clusters);
+	return count;
+
+error:
+	if (NULL != restriction) destroy_cluster_restriction(restriction);
+	if (NULL != pattern_restriction)
+		destroy_cluster_restriction(pattern_restriction);
+	if (NULL != pattern_clusters) destroy_tree_clusters(pattern_clusters);
+	return BATCH_MEM_ERROR;
+}
+
+int tree_batch_match(struct tree_batch *batch, const char *pattern,
+		char *matches)
+{
+	struct mmap_parser *parser = create_mmap_text_parser(pattern,
+			strlen(pattern));
+	int count;
+
+	if (NULL == parser) return BATCH_MEM_ERROR;
+	count = match_pattern(batch, parser, matches);
+	destroy_mmap_parser(parser);
+	return count;
+}
+
+int tree_batch_match_all(struct tree_batch *batch, const char **patterns,
+		int num_patterns, char *matches, int *counts)
+{
+	struct mmap_parser *parser = create_mmap_text_parser("", 0);
+	int p;
+
+	if (NULL == parser) return FAILURE;
+	for (p = 0; p < num_patterns; p++) {
+		reset_mmap_text_parser(parser, patterns[p],
+				strlen(patterns[p]), 1);
+		counts[p] = match_pattern(batch, parser,
+				matches + (size_t) p * batch->num_trees);
+		if (BATCH_MEM_ERROR == counts[p]) {
+			destroy_mmap_parser(parser);
+			return FAILURE;
+		}
+	}
+	destroy_mmap_parser(parser);
+	return SUCCESS;
+}
+
+/* Returns the tree of 'flat', pruned of the nodes whose labels are flagged in
+ * 'passed' (indexed by label id, 'size' entries), or restricted to the leaves
+ * whose labels are flagged. */
+/* Returns NULL in case of error (malloc()) */
+
+static struct rooted_tree *pruned_tree(struct flat_tree *flat,
+		const char *passed, int size, int restrict_to)
+{
+	struct rooted_tree *tree = flat_tree_to_rooted_tree(flat);
+	struct rnode **goners;
+	struct list_elem *elem;
+	int num_goners = 0, i;
+
+	if (NULL == tree) return NULL;
+	goners = malloc(tree->nodes_in_order->count * sizeof(struct rnode *));
+	if (NULL == goners) goto error;
+	for (elem = tree->nodes_in_order->head; NULL != elem; elem = elem->next) {
+		struct rnode *node = elem->data;
+		int id = node->label_id;
+		int flagged = EMPTY_LABEL_ID != id && id < size && passed[id];
+		if (restrict_to ? is_leaf(node) && ! flagged : flagged)
+			goners[num_goners++] = node;
+	}
+
+	for (i = 0; i < num_goners; i++) {
+		/* parent may have been unlinked already, so let's check */
+		if (NULL == goners[i]->parent)
+			continue;
+		switch (unlink_rnode(goners[i])) {
+		case UNLINK_RNODE_DONE:
+			break;
+		case UNLINK_RNODE_ROOT_CHILD:
+			unlink_rnode_root_child->parent = NULL;
+			tree->root = unlink_rnode_root_child;
+			break;
+		default:
+			goto error;
+		}
+	}
+
+	free(goners);
+	return tree;
+
+error:
+	free(goners);
+	destroy_tree(tree, DONT_FREE_NODE_DATA);
+	return NULL;
+}
+
+char *tree_batch_prune(struct tree_batch *batch, int first, int last,
+		const char **labels, int num_labels, int restrict_to)
+{
+	int size = label_table_size();
+	char *passed = calloc(size, 1);
+	char *result = NULL;
+	size_t length = 0, capacity = 0;
+	int n, i;
+
+	if (NULL == passed) return NULL;
+	/* labels that were never interned cannot occur in the trees */
+	for (i = 0; i < num_labels; i++) {
+		int id = find_label(labels[i]);
+		if (id >= 0 && id < size) passed[id] = TRUE;
+	}
+
+	for (n = first; n <= last; n++) {
+		struct rooted_tree *tree = pruned_tree(batch->flats[n], passed,
+				size, restrict_to);
+		char *newick = NULL;
+		size_t newick_length;
+		if (NULL != tree) {
+			newick = to_newick(tree->root);
+			destroy_tree(tree, DONT_FREE_NODE_DATA);
+		}
+		if (NULL == newick) goto error;
+		newick_length = strlen(newick);
+		if (length + newick_length + 2 > capacity) {
+			char *bigger;
+			capacity = 2 * (length + newick_length + 2);
+			bigger = realloc(result, capacity);
+			if (NULL == bigger) {
+				free(newick);
+				goto error;
+			}
+			result = bigger;
+		}
+		memcpy(result + length, newick, newick_length);
+		length += newick_length;
+		result[length++] = '\n';
+		free(newick);
+	}
+	if (NULL == result) result = malloc(1);		/* no trees */
+	if (NULL != result) result[length] = '\0';
+	free(passed);
+	return result;
+
+error:
+	free(result);
+	free(passed);
+	return NULL;
+}
+
+void destroy_tree_batch(struct tree_batch *batch)
+{
+	int n;
+
+	for (n = 0; n < batch->num_trees; n++) {
+		free(batch->newicks[n]);
+		destroy_flat_tree(batch->flats[n]);
+		if (NULL != batch->clusters && NULL != batch->clusters[n])
+			destroy_tree_clusters(batch->clusters[n]);
+	}
+	free(batch->newicks);
+	free(batch->flats);
+	free(batch->clusters);
+	free(batch->taxon_labels);
+	destroy_taxon_index(batch->taxa);
+	free(batch);
+}
@@ -0,0 +1,99 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Tree batches: a whole collection of trees, read once and kept in memory,
+ * with entry points that work on all its trees in a single call and return
+ * arrays or buffers of results. They spare bindings (see newick_utils.py)
+ * a crossing into C per tree or per node, and serve nw_serve's requests.
+ * Trees are kept as Newick, as flat trees (see flat_tree.h) and as clusters
+ * (see cluster_set.h); none of this changes once the batch is read, so any
+ * number of threads may query a batch at once. Trees are numbered from 0. */
+
+struct flat_tree;
+struct tree_clusters;
+struct taxon_index;
+
+/* tree_batch_match() results other than a number of trees */
+
+#define BATCH_BAD_PATTERN (-1)
+#define BATCH_MEM_ERROR (-2)
+
+struct tree_batch {
+	int num_trees;
+	char **newicks;
+	struct flat_tree **flats;
+	struct tree_clusters **clusters;
+	struct taxon_index *taxa;	/* the leaf labels of all trees */
+	char **taxon_labels;		/* by taxon number */
+	int max_clusters;
+};
+
+/* Reads all the trees of the parser's input (see parser.h), in any format it
+ * reads. */
+/* Returns NULL if a tree can't be read (see newick_parser_status()), or in
+ * case of error (malloc()) */
+
+struct tree_batch *read_tree_batch();
+
+/* Like read_tree_batch(), but from file 'filename', or from Newick text */
+
+struct tree_batch *read_tree_batch_file(const char *filename);
+struct tree_batch *read_tree_batch_string(const char *newick);
+
+/* Sets 'counts[n]' to the number of leaves of tree n, for all trees */
+
+void tree_batch_leaf_counts(struct tree_batch *batch, int *counts);
+
+/* Sets 'matches[n]' to true IFF tree n matches 'pattern', a Newick tree: that
+ * is, IFF the tree has all the pattern's leaves, and has the same topology as
+ * the pattern once pruned to them. Returns the number of matching trees, or
+ * one of the BATCH_* errors above. */
+
+int tree_batch_match(struct tree_batch *batch, const char *pattern,
+		char *matches);
+
+/* Matches each of 'num_patterns' patterns, like tree_batch_match(). The
+ * matches of pattern p go to 'matches' + p * batch->num_trees, its number of
+ * matches to 'counts[p]' (BATCH_BAD_PATTERN if it can't be parsed). Returns
+ * FAILURE in case of error (malloc()). */
+
+int tree_batch_match_all(struct tree_batch *batch, const char **patterns,
+		int num_patterns, char *matches, int *counts);
+
+/* Returns trees 'first' to 'last', as Newick (one tree per line), without the
+ * nodes whose labels are among the 'num_labels' 'labels' (like nw_prune), or,
+ * if 'restrict_to' is true, without the leaves whose labels are NOT among
+ * them. Nodes left with a single child are spliced out. The trees in the
+ * batch are not changed. The result must be free()d. */
+/* Returns NULL in case of error (malloc()) */
+
+char *tree_batch_prune(struct tree_batch *batch, int first, int last,
+		const char **labels, int num_labels, int restrict_to);
+
+void destroy_tree_batch(struct tree_batch *batch);
@@ -43,6 +43,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "address_parser.h"
 #include "tree_editor_rnode_data.h"
 #include "common.h"
+#include "output.h"
 
 void address_scanner_set_input(char *);
 void address_scanner_clear_input();
@@ -245,12 +246,11 @@ struct parameters get_params(int argc, char *argv[])
 	if (3 == (argc - optind))	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 		params.address = argv[optind+1];
 		char action = argv[optind+2][0];
@@ -465,6 +465,8 @@ int main(int argc, char* argv[])
 	struct parameters params = get_params(argc, argv);
 	struct rooted_tree *tree;
 
+	buffer_stdout();
+
 	address_scanner_set_input(params.address);
 	// TODO: have adsparse() set an error code to distinguish the various
 	// causes of NULL (e.g., syntax error and memory error)
@@ -0,0 +1,378 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "tree_index.h"
+#include "masprintf.h"
+#include "common.h"
+
+#define SCAN_BUFFER_SIZE 65536
+#define INIT_NUM_TREES 64
+
+/* The saved index: the magic string, then the indexed file's size and
+ * modification time (in nanoseconds), the number of trees, and each tree's
+ * offset and length, all as 64-bit little-endian integers. */
+
+#define INDEX_MAGIC "NWI2"
+#define INDEX_MAGIC_LENGTH 4
+#define INDEX_HEADER_SIZE (INDEX_MAGIC_LENGTH + 3 * 8)
+
+enum scan_state { IN_TREE, IN_QUOTES, IN_COMMENT };
+
+static struct tree_index *alloc_tree_index(long capacity)
+{
+	struct tree_index *index = malloc(sizeof(struct tree_index));
+	if (NULL == index) return NULL;
+	index->num_trees = 0;
+	index->offset = malloc(capacity * sizeof(long long));
+	index->length = malloc(capacity * sizeof(long long));
+	if (NULL == index->offset || NULL == index->length) {
+		destroy_tree_index(index);
+		return NULL;
+	}
+	return index;
+}
+
+/* Adds a tree, growing the arrays as needed. Returns FAILURE in case of error
+ * (malloc()). */
+
+static int add_tree(struct tree_index *index, long *capacity,
+		long long offset, long long length)
+{
+	if (index->num_trees == *capacity) {
+		long long *offsets, *lengths;
+		*capacity *= 2;
+		offsets = realloc(index->offset, *capacity * sizeof(long long));
+		if (NULL == offsets) return FAILURE;
+		index->offset = offsets;
+		lengths = realloc(index->length, *capacity * sizeof(long long));
+		if (NULL == lengths) return FAILURE;
+		index->length = lengths;
+	}
+	index->offset[index->num_trees] = offset;
+	index->length[index->num_trees] = length;
+	index->num_trees++;
+	return SUCCESS;
+}
+
+/* A file's modification time, in nanoseconds: whole seconds would miss a
+ * change that keeps the size, made within the second the file was indexed. */
+
+static long long mtime_ns(const struct stat *st)
+{
+	return (long long) st->st_mtim.tv_sec * 1000000000LL
+		+ st->st_mtim.tv_nsec;
+}
+
+/* Sets the index's file size and time from 'input'. Returns FAILURE if it is
+ * not a regular file (or can't be stat()ed). */
+
+static int stamp_index(struct tree_index *index, FILE *input)
+{
+	struct stat st;
+	if (0 != fstat(fileno(input), &st) || ! S_ISREG(st.st_mode))
+		return FAILURE;
+	index->file_size = st.st_size;
+	index->file_mtime = mtime_ns(&st);
+	return SUCCESS;
+}
+
+/* Where a scan is, from one block of text to the next */
+
+struct scan {
+	enum scan_state state;
+	long long pos;		/* of the next character */
+	long long start;	/* of the current tree, -1 if none */
+	long capacity;		/* of the index's arrays */
+};
+
+/* Adds the trees that end in 'text' to the index. Returns FAILURE in case of
+ * error (malloc()). */
+
+static int scan_text(struct tree_index *index, struct scan *scan,
+		const char *text, size_t length)
+{
+	size_t i;
+
+	for (i = 0; i < length; i++, scan->pos++) {
+		char c = text[i];
+		switch (scan->state) {
+		case IN_QUOTES:
+			if ('\'' == c) scan->state = IN_TREE;
+			continue;
+		case IN_COMMENT:
+			if (']' == c) scan->state = IN_TREE;
+			continue;
+		case IN_TREE:
+			break;
+		}
+		switch (c) {
+		case ' ': case '\t': case '\n': case '\r':
+			continue;
+		case '\'':
+			scan->state = IN_QUOTES;
+			break;
+		case '[':
+			scan->state = IN_COMMENT;
+			break;
+		case ';':
+			if (-1 == scan->start) scan->start = scan->pos;
+			if (! add_tree(index, &(scan->capacity), scan->start,
+						scan->pos + 1 - scan->start))
+				return FAILURE;
+			scan->start = -1;
+			continue;
+		}
+		if (-1 == scan->start) scan->start = scan->pos;
+	}
+	return SUCCESS;
+}
+
+static void init_scan(struct scan *scan)
+{
+	scan->state = IN_TREE;
+	scan->pos = 0;
+	scan->start = -1;
+	scan->capacity = INIT_NUM_TREES;
+}
+
+struct tree_index *create_tree_index(FILE *input)
+{
+	struct tree_index *index = alloc_tree_index(INIT_NUM_TREES);
+	char *buffer = malloc(SCAN_BUFFER_SIZE);
+	struct scan scan;
+	size_t num_read;
+
+	init_scan(&scan);
+	if (NULL == index || NULL == buffer) goto error;
+	if (! stamp_index(index, input)) goto error;
+	if (0 != fseeko(input, 0, SEEK_SET)) goto error;
+
+	while (0 < (num_read = fread(buffer, 1, SCAN_BUFFER_SIZE, input)))
+		if (! scan_text(index, &scan, buffer, num_read)) goto error;
+	if (ferror(input)) goto error;
+
+	free(buffer);
+	return index;
+
+error:
+	free(buffer);
+	if (NULL != index) destroy_tree_index(index);
+	return NULL;
+}
+
+struct tree_index *index_tree_text(const char *text, size_t length)
+{
+	struct tree_index *index = alloc_tree_index(INIT_NUM_TREES);
+	struct scan scan;
+
+	if (NULL == index) return NULL;
+	init_scan(&scan);
+	index->file_size = length;
+	index->file_mtime = 0;
+	if (! scan_text(index, &scan, text, length)) {
+		destroy_tree_index(index);
+		return NULL;
+	}
+	return index;
+}
+
+static void put_int64(unsigned char *dest, long long value)
+{
+	int i;
+	unsigned long long v = value;
+	for (i = 0; i < 8; i++) {
+		dest[i] = v & 0xff;
+		v >>= 8;
+	}
+}
+
+static long long get_int64(const unsigned char *src)
+{
+	int i;
+	unsigned long long v = 0;
+	for (i = 7; i >= 0; i--)
+		v = (v << 8) | src[i];
+	return v;
+}
+
+int write_tree_index(struct tree_index *index, const char *filename)
+{
+	char *index_filename = masprintf("%s%s", filename, TREE_INDEX_SUFFIX);
+	unsigned char record[16];
+	FILE *out;
+	long n;
+	int ok;
+
+	if (NULL == index_filename) return FAILURE;
+	out = fopen(index_filename, "wb");
+	if (NULL == out) {
+		free(index_filename);
+		return FAILURE;
+	}
+	ok = INDEX_MAGIC_LENGTH == fwrite(INDEX_MAGIC, 1, INDEX_MAGIC_LENGTH,
+			out);
+	put_int64(record, index->file_size);
+	put_int64(record + 8, index->file_mtime);
+	ok = ok && 16 == fwrite(record, 1, 16, out);
+	put_int64(record, index->num_trees);
+	ok = ok && 8 == fwrite(record, 1, 8, out);
+	for (n = 0; ok && n < index->num_trees; n++) {
+		put_int64(record, index->offset[n]);
+		put_int64(record + 8, index->length[n]);
+		ok = 16 == fwrite(record, 1, 16, out);
+	}
+	if (0 != fclose(out)) ok = FALSE;
+	/* don't leave a truncated index around */
+	if (! ok) remove(index_filename);
+	free(index_filename);
+	return ok;
+}
+
+struct tree_index *read_tree_index(const char *filename)
+{
+	char *index_filename = masprintf("%s%s", filename, TREE_INDEX_SUFFIX);
+	struct tree_index *index = NULL;
+	unsigned char header[INDEX_HEADER_SIZE], record[16];
+	struct stat st;
+	FILE *in = NULL;
+	long long num_trees;
+	long n;
+
+	if (NULL == index_filename) return NULL;
+	if (0 != stat(filename, &st)) goto error;
+	in = fopen(index_filename, "rb");
+	if (NULL == in) goto error;
+	if (INDEX_HEADER_SIZE != fread(header, 1, INDEX_HEADER_SIZE, in))
+		goto error;
+	if (0 != memcmp(INDEX_MAGIC, header, INDEX_MAGIC_LENGTH)) goto error;
+	/* stale? */
+	if (get_int64(header + INDEX_MAGIC_LENGTH) != st.st_size
+		|| get_int64(header + INDEX_MAGIC_LENGTH + 8) != mtime_ns(&st))
+		goto error;
+	num_trees = get_int64(header + INDEX_MAGIC_LENGTH + 16);
+	if (num_trees < 0 || num_trees > st.st_size) goto error;
+
+	index = alloc_tree_index(num_trees > 0 ? num_trees : 1);
+	if (NULL == index) goto error;
+	index->file_size = st.st_size;
+	index->file_mtime = mtime_ns(&st);
+	for (n = 0; n < num_trees; n++) {
+		if (16 != fread(record, 1, 16, in)) goto error;
+		index->offset[n] = get_int64(record);
+		index->length[n] = get_int64(record + 8);
+		if (index->offset[n] < 0 || index->length[n] <= 0
+			|| index->offset[n] + index->length[n] > st.st_size)
+			goto error;
+	}
+	index->num_trees = num_trees;
+
+	fclose(in);
+	free(index_filename);
+	return index;
+
+error:
+	if (NULL != in) fclose(in);
+	if (NULL != index) destroy_tree_index(index);
+	free(index_filename);
+	return NULL;
+}
+
+struct tree_index *get_tree_index(const char *filename)
+{
+	struct tree_index *index = read_tree_index(filename);
+	FILE *input;
+
+	if (NULL != index) return index;
+	input = fopen(filename, "r");
+	if (NULL == input) return NULL;
+	index = create_tree_index(input);
+	fclose(input);
+	if (NULL != index) write_tree_index(index, filename);
+	return index;
+}
+
+int seek_tree(FILE *file, struct tree_index *index, long n)
+{
+	if (n < 0 || n >= index->num_trees) return FAILURE;
+	return 0 == fseeko(file, index->offset[n], SEEK_SET);
+}
+
+char *read_tree_text(FILE *file, struct tree_index *index, long n)
+{
+	char *text;
+	size_t length;
+
+	if (! seek_tree(file, index, n)) return NULL;
+	length = index->length[n];
+	text = malloc(length + 1);
+	if (NULL == text) return NULL;
+	if (length != fread(text, 1, length, file)) {
+		free(text);
+		return NULL;
+	}
+	text[length] = '\0';
+	return text;
+}
+
+/* Returns the number of the first tree that starts at or after 'offset' */
+
+static long first_tree_from(struct tree_index *index, long long offset)
+{
+	long low = 0, high = index->num_trees;
+	while (low < high) {
+		long mid = low + (high - low) / 2;
+		if (index->offset[mid] < offset)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+void tree_index_part(struct tree_index *index, int part, int num_parts,
+		long *first, long *end)
+{
+	long long size = index->file_size;
+	*first = first_tree_from(index, size * part / num_parts);
+	*end = part == num_parts - 1 ? index->num_trees :
+		first_tree_from(index, size * (part + 1) / num_parts);
+}
+
+void destroy_tree_index(struct tree_index *index)
+{
+	free(index->offset);
+	free(index->length);
+	free(index);
+}
@@ -0,0 +1,101 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Tree indexes: where each tree of a multi-tree Newick file starts, and how
+ * long it is, so that trees can be read in any order (or a file shared among
+ * workers) without parsing the trees before them. An index is built in a
+ * single scan of the file, which only looks for the ';' ending each tree
+ * (skipping quoted labels and [comments]), and can be saved next to the file,
+ * with suffix ".nwi", to be reused as long as the file is unchanged. */
+
+#include <stdio.h>
+
+#define TREE_INDEX_SUFFIX ".nwi"
+
+struct tree_index {
+	long num_trees;
+	long long *offset;	/* of each tree's first (non-blank) character */
+	long long *length;	/* of each tree, up to and including its ';' */
+	long long file_size;	/* size and modification time (ns) of the */
+	long long file_mtime;	/* indexed file, to tell whether the index is
+				 * stale */
+};
+
+/* Indexes the trees of 'input', which must be a regular file, from its
+ * beginning. Text after the last ';' is not a tree. */
+/* Returns NULL in case of error (malloc(), I/O) */
+
+struct tree_index *create_tree_index(FILE *input);
+
+/* Indexes the trees of 'length' bytes of text at 'text' (e.g. a mapped or
+ * decompressed file). Such an index can't be saved. */
+/* Returns NULL in case of error (malloc()) */
+
+struct tree_index *index_tree_text(const char *text, size_t length);
+
+/* Reads the index of file 'filename' from 'filename'.nwi. */
+/* Returns NULL if there is no such index, or if it is stale or corrupt. */
+
+struct tree_index *read_tree_index(const char *filename);
+
+/* Saves the index of file 'filename' to 'filename'.nwi. Returns FAILURE in
+ * case of error (I/O, typically a read-only directory). */
+
+int write_tree_index(struct tree_index *index, const char *filename);
+
+/* Returns the index of file 'filename': the saved one if it is up to date,
+ * otherwise a new one, which is then saved (if possible - failing to save it
+ * is not an error). */
+/* Returns NULL in case of error (malloc(), I/O) */
+
+struct tree_index *get_tree_index(const char *filename);
+
+/* Positions 'file' at the start of tree 'n' (counting from 0), so that the
+ * parser reads it next (see set_parser_input()). Returns FAILURE if 'n' is
+ * out of range or if the file can't be positioned. */
+
+int seek_tree(FILE *file, struct tree_index *index, long n);
+
+/* Returns the Newick text of tree 'n', as a NUL-terminated, malloc()ed string
+ * (which the caller must free()). */
+/* Returns NULL if 'n' is out of range, or in case of error (malloc(), I/O) */
+
+char *read_tree_text(FILE *file, struct tree_index *index, long n);
+
+/* Divides the trees into 'num_parts' parts of about the same size (in bytes),
+ * for sharing them among workers, and sets 'first' and 'end' so that part
+ * 'part' (from 0) consists of trees first to end - 1 (none if they are
+ * equal). */
+
+void tree_index_part(struct tree_index *index, int part, int num_parts,
+		long *first, long *end);
+
+/* Frees the index */
+
+void destroy_tree_index(struct tree_index *index);
@@ -43,6 +43,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "to_newick.h"
 #include "tree_models.h"
 #include "masprintf.h"
+#include "arena.h"
 
 #define UNUSED -1
 
@@ -176,7 +177,7 @@ double tlt_grow_node(struct rnode *leaf, double branch_termination_rate,
 		length += remaining_time;
 
 	char *length_s = masprintf("%g", length);
-	free(leaf->edge_length_as_string);
+	arena_free(leaf->edge_length_as_string);
 	leaf->edge_length_as_string = length_s;	/* NULL if masprintf() fails - check in caller */
 
 	/* Return the remaining time so caller f() can take action based on
@@ -215,11 +216,7 @@ void free_data(struct llist *leaves_queue,
 	struct list_elem *elem;
 	for (elem = all_children->head; NULL != elem; elem = elem->next) {
 		kid = elem->data;
-		free(kid->edge_length_as_string);
-		free(kid->label);
-	       	free(kid->data);
-		destroy_llist(kid->children);
-		free(kid);
+		destroy_rnode(kid, NULL);
 	}
 	destroy_llist(all_children);
 }
@@ -287,3 +284,53 @@ int time_limited_tree(double branch_termination_rate, double duration)
 
 	return SUCCESS;
 }
+
+/******************************************************************/
+/* Caterpillar model */
+
+/* Draws an exponentially distributed edge length for a new node */
+
+static struct rnode *create_caterpillar_node(char *label,
+		double branch_termination_rate)
+{
+	double length = reciprocal_exponential_CDF(random_lt_1(),
+			branch_termination_rate);
+	char *length_s = masprintf("%g", length);
+	if (NULL == length_s) return NULL;
+	struct rnode *node = create_rnode(label, length_s);
+	free(length_s);
+	return node;
+}
+
+int caterpillar_tree(int num_leaves, double branch_termination_rate)
+{
+	struct rnode *root = create_rnode("", "");
+	if (NULL == root) return FAILURE;
+
+	/* Each inner node gets one leaf and one inner node, except the last
+	 * one, which gets two leaves. The tree is built top-down, so there is
+	 * no recursion however deep it gets. */
+	struct rnode *current = root;
+	int i;
+	for (i = 1; i <= num_leaves; i++) {
+		char *label = masprintf("l%d", i);
+		if (NULL == label) return FAILURE;
+		struct rnode *leaf = create_caterpillar_node(label,
+				branch_termination_rate);
+		free(label);
+		if (NULL == leaf) return FAILURE;
+		if (! add_child(current, leaf)) return FAILURE;
+		if (i < num_leaves - 1) {
+			struct rnode *inner = create_caterpillar_node("",
+					branch_termination_rate);
+			if (NULL == inner) return FAILURE;
+			if (! add_child(current, inner)) return FAILURE;
+			current = inner;
+		}
+	}
+
+	dump_newick(root);
+	free_descendants(root);
+
+	return SUCCESS;
+}
@@ -58,3 +58,11 @@ double tlt_grow_node(struct rnode *, double branch_termination_rate,
  * value from an exponential PDF using a random number 0 <= x < 1. */
 
 double reciprocal_exponential_CDF(double x, double k);
+
+/* A caterpillar (or ladder): every inner node has one leaf child and one inner
+ * child, except the deepest, which has two leaves. The tree is as deep as it
+ * has leaves, which makes it a good stress test for anything recursive. Edge
+ * lengths are exponentially distributed as in time_limited_tree(). Returns
+ * FAILURE IFF there is a problem (malloc()). 'num_leaves' must be >= 2. */
+
+int caterpillar_tree(int num_leaves, double branch_termination_rate);
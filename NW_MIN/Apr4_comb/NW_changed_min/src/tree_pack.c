@@ -0,0 +1,555 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif
+
+#include "tree_pack.h"
+#include "flat_tree.h"
+#include "tree.h"
+#include "arena.h"
+#include "hash.h"
+#include "common.h"
+
+/* A pack is laid out as follows, every part starting at a multiple of 8:
+ *
+ * header: the magic bytes, then the format's version, a byte order mark and
+ * 	the sizes of int, long long and double, as ints;
+ * trees: for each tree, its number of nodes and flags (ints), then its
+ * 	parent, label_id and length_id arrays (see struct flat_tree), and the
+ * 	edge_length array if the tree has lengths;
+ * dictionary: the strings, NUL-terminated, string 0 being "";
+ * the offsets of the strings, and those of the trees (long longs);
+ * trailer: the number of trees and strings, the offsets of both offset
+ * 	tables, and the largest number of nodes of a tree (long longs), then
+ * 	the magic bytes again. */
+
+#define PACK_MAGIC "\x89NWB"
+#define PACK_MAGIC_LENGTH 4
+#define PACK_VERSION 1
+#define BYTE_ORDER_MARK 0x01020304
+#define TYPE_SIZES (sizeof(int) | sizeof(long long) << 8 \
+		| sizeof(double) << 16)
+#define HEADER_SIZE 16
+#define TRAILER_SIZE (5 * sizeof(long long) + 8)
+#define NUM_NODE_ARRAYS 3
+#define HAS_LENGTHS 1
+#define INIT_CAPACITY 64
+#define READ_SIZE 65536
+
+/* Rounds 'size' up to a multiple of 8 */
+
+static long long align(long long size)
+{
+	return (size + 7) & ~7LL;
+}
+
+/* Returns the size of a tree's record */
+
+static long long record_size(int num_nodes, int flags)
+{
+	long long size = align((2 + NUM_NODE_ARRAYS * (long long) num_nodes)
+			* sizeof(int));
+	if (flags & HAS_LENGTHS) size += num_nodes * sizeof(double);
+	return size;
+}
+
+int is_tree_pack(FILE *input)
+{
+	int c = getc(input);
+	if (EOF == c) return FALSE;
+	ungetc(c, input);
+	return (unsigned char) PACK_MAGIC[0] == c;
+}
+
+/* Reads the rest of 'input' into memory. Returns NULL in case of error
+ * (malloc(), I/O) */
+
+static char *read_all(FILE *input, size_t *size)
+{
+	size_t capacity = READ_SIZE, num_read;
+	char *data = malloc(capacity);
+
+	*size = 0;
+	if (NULL == data) return NULL;
+	while (0 < (num_read = fread(data + *size, 1, capacity - *size,
+					input))) {
+		*size += num_read;
+		if (*size == capacity) {
+			char *bigger = realloc(data, 2 * capacity);
+			if (NULL == bigger) { free(data); return NULL; }
+			data = bigger;
+			capacity *= 2;
+		}
+	}
+	if (ferror(input)) { free(data); return NULL; }
+	return data;
+}
+
+/* Maps or reads the input. Returns FAILURE in case of error. */
+
+static int load_pack(struct tree_pack *pack, FILE *input)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	struct stat st;
+	int fd = fileno(input);
+
+	if (-1 != fd && 0 == fstat(fd, &st) && S_ISREG(st.st_mode)
+		&& 0 == ftello(input) && st.st_size > 0) {
+		void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd,
+				0);
+		if (MAP_FAILED != map) {
+			pack->data = map;
+			pack->size = st.st_size;
+			pack->mapped = TRUE;
+			return SUCCESS;
+		}
+	}
+#endif
+	pack->data = read_all(input, &(pack->size));
+	pack->mapped = FALSE;
+	return NULL != pack->data;
+}
+
+/* Checks the header and trailer, and sets up the dictionary. Returns FAILURE
+ * if they are invalid, or in case of error (malloc()). */
+
+static int read_pack_tables(struct tree_pack *pack)
+{
+	const char *data = pack->data;
+	const int *header = (const int *) (data + PACK_MAGIC_LENGTH);
+	const long long *trailer;
+	const long long *string_offset;
+	long long num_trees, num_strings, strings_table, trees_table;
+	long long max_num_nodes, n, last_nul;
+
+	if (pack->size < HEADER_SIZE + TRAILER_SIZE || pack->size % 8 != 0)
+		return FAILURE;
+	if (0 != memcmp(PACK_MAGIC, data, PACK_MAGIC_LENGTH)
+		|| 0 != memcmp(PACK_MAGIC, data + pack->size - 8,
+			PACK_MAGIC_LENGTH))
+		return FAILURE;
+	if (PACK_VERSION != header[0] || BYTE_ORDER_MARK != header[1]
+		|| TYPE_SIZES != header[2])
+		return FAILURE;
+
+	trailer = (const long long *) (data + pack->size - TRAILER_SIZE);
+	num_trees = trailer[0];
+	num_strings = trailer[1];
+	strings_table = trailer[2];
+	trees_table = trailer[3];
+	max_num_nodes = trailer[4];
+	if (num_trees < 0 || num_strings < 1 || max_num_nodes < 0
+		|| max_num_nodes > (long long) pack->size
+		|| strings_table < HEADER_SIZE || strings_table % 8 != 0
+		|| trees_table % 8 != 0
+		|| trees_table != strings_table
+			+ num_strings * (long long) sizeof(long long)
+		|| trees_table + num_trees * (long long) sizeof(long long)
+			!= (long long) (pack->size - TRAILER_SIZE))
+		return FAILURE;
+
+	/* every string must end before the offset tables */
+	for (last_nul = strings_table - 1; last_nul >= HEADER_SIZE; last_nul--)
+		if ('\0' == data[last_nul]) break;
+	string_offset = (const long long *) (data + strings_table);
+	pack->strings = malloc(num_strings * sizeof(char *));
+	if (NULL == pack->strings) return FAILURE;
+	for (n = 0; n < num_strings; n++) {
+		if (string_offset[n] < HEADER_SIZE
+			|| string_offset[n] > last_nul)
+			return FAILURE;
+		pack->strings[n] = (char *) data + string_offset[n];
+	}
+	if ('\0' != pack->strings[0][0]) return FAILURE;
+
+	pack->no_lengths = malloc((max_num_nodes > 0 ? max_num_nodes : 1)
+			* sizeof(double));
+	pack->links = malloc((max_num_nodes > 0 ? 3 * max_num_nodes : 1)
+			* sizeof(int));
+	if (NULL == pack->no_lengths || NULL == pack->links) return FAILURE;
+	for (n = 0; n < max_num_nodes; n++) pack->no_lengths[n] = -1;
+
+	pack->num_trees = num_trees;
+	pack->num_strings = num_strings;
+	pack->max_num_nodes = max_num_nodes;
+	pack->tree_offset = (const long long *) (data + trees_table);
+	return SUCCESS;
+}
+
+struct tree_pack *open_tree_pack(FILE *input)
+{
+	struct tree_pack *pack = malloc(sizeof(struct tree_pack));
+
+	if (NULL == pack) return NULL;
+	pack->strings = NULL;
+	pack->no_lengths = NULL;
+	pack->links = NULL;
+	if (! load_pack(pack, input)) {
+		free(pack);
+		return NULL;
+	}
+	if (! read_pack_tables(pack)) {
+		close_tree_pack(pack);
+		return NULL;
+	}
+	return pack;
+}
+
+/* Sets the flat tree's child links and subtree sizes from its parents.
+ * Returns FAILURE unless the parents describe a tree in preorder. */
+
+static int derive_links(struct flat_tree *flat)
+{
+	int num_nodes = flat->num_nodes;
+	int *last_child = flat->subtree_size;	/* until the sizes are set */
+	int i, node;
+
+	if (FLAT_NONE != flat->parent[0]) return FAILURE;
+	for (i = 0; i < num_nodes; i++) {
+		flat->first_child[i] = FLAT_NONE;
+		flat->next_sibling[i] = FLAT_NONE;
+	}
+	for (i = 1; i < num_nodes; i++) {
+		int parent = flat->parent[i];
+		if (parent < 0 || parent >= i) return FAILURE;
+		/* in preorder, the parent is node i - 1 or one of its
+		 * ancestors; the nodes passed on the way are complete, so
+		 * this is linear overall */
+		for (node = i - 1; node != parent; node = flat->parent[node])
+			if (FLAT_NONE == node) return FAILURE;
+		if (FLAT_NONE == flat->first_child[parent])
+			flat->first_child[parent] = i;
+		else
+			flat->next_sibling[last_child[parent]] = i;
+		last_child[parent] = i;
+	}
+	for (i = 0; i < num_nodes; i++) flat->subtree_size[i] = 1;
+	for (i = num_nodes - 1; i > 0; i--)
+		flat->subtree_size[flat->parent[i]] += flat->subtree_size[i];
+	return SUCCESS;
+}
+
+int packed_flat_tree(struct tree_pack *pack, long n, struct flat_tree *flat)
+{
+	long long offset, end;
+	const int *record;
+	int num_nodes, flags, i;
+
+	if (n < 0 || n >= pack->num_trees) return FAILURE;
+	offset = pack->tree_offset[n];
+	end = (const char *) pack->tree_offset - pack->data;
+	if (offset < HEADER_SIZE || offset % 8 != 0 || offset + 8 > end)
+		return FAILURE;
+	record = (const int *) (pack->data + offset);
+	num_nodes = record[0];
+	flags = record[1];
+	if (num_nodes < 1 || num_nodes > pack->max_num_nodes
+		|| offset + record_size(num_nodes, flags) > end)
+		return FAILURE;
+
+	flat->num_nodes = num_nodes;
+	flat->parent = (int *) record + 2;
+	flat->label_id = flat->parent + num_nodes;
+	flat->length_id = flat->label_id + num_nodes;
+	if (flags & HAS_LENGTHS)
+		flat->edge_length = (double *) (pack->data + offset
+				+ record_size(num_nodes, 0));
+	else
+		flat->edge_length = pack->no_lengths;
+	flat->first_child = pack->links;
+	flat->next_sibling = pack->links + num_nodes;
+	flat->subtree_size = pack->links + 2 * num_nodes;
+	flat->strings = pack->strings;
+	flat->num_strings = pack->num_strings;
+
+	for (i = 0; i < num_nodes; i++)
+		if (flat->label_id[i] < 0
+			|| flat->label_id[i] >= pack->num_strings
+			|| flat->length_id[i] < 0
+			|| flat->length_id[i] >= pack->num_strings)
+			return FAILURE;
+	return derive_links(flat);
+}
+
+struct rooted_tree *packed_rooted_tree(struct tree_pack *pack, long n,
+		struct arena *arena)
+{
+	struct flat_tree flat;
+	struct rooted_tree *tree;
+	struct arena *previous;
+
+	if (! packed_flat_tree(pack, n, &flat)) return NULL;
+	previous = set_current_arena(arena);
+	tree = flat_tree_to_rooted_tree(&flat);
+	set_current_arena(previous);
+	if (NULL != tree) tree->arena = arena;
+	return tree;
+}
+
+void close_tree_pack(struct tree_pack *pack)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	if (pack->mapped)
+		munmap((void *) pack->data, pack->size);
+	else
+		free((void *) pack->data);
+#else
+	free((void *) pack->data);
+#endif
+	free(pack->strings);
+	free(pack->no_lengths);
+	free(pack->links);
+	free(pack);
+}
+
+struct tree_pack_writer {
+	FILE *output;
+	long long pos;		/* the number of bytes written so far */
+	struct hash *string_ids;	/* values are ids + 1, as pointers */
+	char **strings;		/* the dictionary, in id order */
+	int num_strings;
+	int strings_capacity;
+	long long *tree_offset;
+	long num_trees;
+	long trees_capacity;
+	int max_num_nodes;
+	int *ids;		/* a tree's strings' ids in the dictionary */
+	int *node_ids;		/* a tree's label or length ids, remapped */
+	int ids_capacity;
+	int nodes_capacity;
+};
+
+/* Writes 'size' bytes, or zeroes if 'data' is NULL. Returns FAILURE in case
+ * of error (I/O). */
+
+static int write_bytes(struct tree_pack_writer *writer, const void *data,
+		size_t size)
+{
+	static const char zeroes[8];
+	if (0 == size) return SUCCESS;
+	if (NULL == data) data = zeroes;	/* (padding is < 8 bytes) */
+	if (size != fwrite(data, 1, size, writer->output)) return FAILURE;
+	writer->pos += size;
+	return SUCCESS;
+}
+
+static int pad(struct tree_pack_writer *writer)
+{
+	return write_bytes(writer, NULL, align(writer->pos) - writer->pos);
+}
+
+/* Returns the dictionary id of 'string', adding it if needed. Returns -1 in
+ * case of error (malloc()). */
+
+static int pack_string_id(struct tree_pack_writer *writer, const char *string)
+{
+	intptr_t id = (intptr_t) hash_get(writer->string_ids, string);
+	if (0 != id) return id - 1;
+
+	if (writer->num_strings == writer->strings_capacity) {
+		char **bigger = realloc(writer->strings,
+			2 * writer->strings_capacity * sizeof(char *));
+		if (NULL == bigger) return -1;
+		writer->strings = bigger;
+		writer->strings_capacity *= 2;
+	}
+	char *copy = strdup(string);
+	if (NULL == copy) return -1;
+	id = writer->num_strings;
+	if (! hash_set(writer->string_ids, string, (void *) (id + 1))) {
+		free(copy);
+		return -1;
+	}
+	writer->strings[writer->num_strings++] = copy;
+	return id;
+}
+
+static void destroy_tree_pack_writer(struct tree_pack_writer *writer)
+{
+	int i;
+	if (NULL != writer->string_ids) destroy_hash(writer->string_ids);
+	if (NULL != writer->strings)
+		for (i = 0; i < writer->num_strings; i++)
+			free(writer->strings[i]);
+	free(writer->strings);
+	free(writer->tree_offset);
+	free(writer->ids);
+	free(writer->node_ids);
+	free(writer);
+}
+
+struct tree_pack_writer *create_tree_pack_writer(FILE *output)
+{
+	struct tree_pack_writer *writer;
+	int header[3] = { PACK_VERSION, BYTE_ORDER_MARK, TYPE_SIZES };
+
+	writer = malloc(sizeof(struct tree_pack_writer));
+	if (NULL == writer) return NULL;
+	writer->output = output;
+	writer->pos = 0;
+	writer->string_ids = create_hash(INIT_CAPACITY);
+	writer->strings = malloc(INIT_CAPACITY * sizeof(char *));
+	writer->num_strings = 0;
+	writer->strings_capacity = INIT_CAPACITY;
+	writer->tree_offset = malloc(INIT_CAPACITY * sizeof(long long));
+	writer->num_trees = 0;
+	writer->trees_capacity = INIT_CAPACITY;
+	writer->max_num_nodes = 0;
+	writer->ids = NULL;
+	writer->node_ids = NULL;
+	writer->ids_capacity = 0;
+	writer->nodes_capacity = 0;
+	if (NULL == writer->string_ids || NULL == writer->strings
+		|| NULL == writer->tree_offset
+		|| -1 == pack_string_id(writer, "")
+		|| ! write_bytes(writer, PACK_MAGIC, PACK_MAGIC_LENGTH)
+		|| ! write_bytes(writer, header, sizeof(header))) {
+		destroy_tree_pack_writer(writer);
+		return NULL;
+	}
+	return writer;
+}
+
+/* Makes room for a tree's ids. Returns FAILURE in case of error (malloc()). */
+
+static int reserve_ids(struct tree_pack_writer *writer, struct flat_tree *flat)
+{
+	if (flat->num_strings > writer->ids_capacity) {
+		free(writer->ids);
+		writer->ids = malloc(flat->num_strings * sizeof(int));
+		if (NULL == writer->ids) return FAILURE;
+		writer->ids_capacity = flat->num_strings;
+	}
+	if (flat->num_nodes > writer->nodes_capacity) {
+		free(writer->node_ids);
+		writer->node_ids = malloc(flat->num_nodes * sizeof(double));
+		if (NULL == writer->node_ids) return FAILURE;
+		writer->nodes_capacity = flat->num_nodes;
+	}
+	return SUCCESS;
+}
+
+/* Writes a tree's label or length ids, in the dictionary */
+
+static int write_string_ids(struct tree_pack_writer *writer,
+		struct flat_tree *flat, const int *ids)
+{
+	int i;
+	for (i = 0; i < flat->num_nodes; i++)
+		writer->node_ids[i] = writer->ids[ids[i]];
+	return write_bytes(writer, writer->node_ids,
+			flat->num_nodes * sizeof(int));
+}
+
+int write_packed_tree(struct tree_pack_writer *writer, struct flat_tree *flat)
+{
+	int header[2] = { flat->num_nodes, 0 };
+	double *lengths;
+	int i;
+
+	if (writer->num_trees == writer->trees_capacity) {
+		long long *bigger = realloc(writer->tree_offset,
+			2 * writer->trees_capacity * sizeof(long long));
+		if (NULL == bigger) return FAILURE;
+		writer->tree_offset = bigger;
+		writer->trees_capacity *= 2;
+	}
+	if (! reserve_ids(writer, flat)) return FAILURE;
+	/* each of the tree's strings is looked up once */
+	for (i = 0; i < flat->num_strings; i++) {
+		writer->ids[i] = pack_string_id(writer, flat->strings[i]);
+		if (-1 == writer->ids[i]) return FAILURE;
+	}
+	for (i = 0; i < flat->num_nodes; i++)
+		if (0 != writer->ids[flat->length_id[i]])
+			header[1] = HAS_LENGTHS;
+
+	writer->tree_offset[writer->num_trees++] = writer->pos;
+	if (flat->num_nodes > writer->max_num_nodes)
+		writer->max_num_nodes = flat->num_nodes;
+	if (! write_bytes(writer, header, sizeof(header))
+		|| ! write_bytes(writer, flat->parent,
+			flat->num_nodes * sizeof(int))
+		|| ! write_string_ids(writer, flat, flat->label_id)
+		|| ! write_string_ids(writer, flat, flat->length_id)
+		|| ! pad(writer))
+		return FAILURE;
+	if (! (header[1] & HAS_LENGTHS)) return SUCCESS;
+
+	/* the lengths' values, which parsers leave to the tools (-1) */
+	lengths = (double *) writer->node_ids;
+	for (i = 0; i < flat->num_nodes; i++) {
+		const char *length = flat->strings[flat->length_id[i]];
+		lengths[i] = '\0' == length[0] ? -1 : atof(length);
+	}
+	return write_bytes(writer, lengths, flat->num_nodes * sizeof(double));
+}
+
+int finish_tree_pack(struct tree_pack_writer *writer)
+{
+	long long trailer[5];
+	long long *string_offset = malloc(writer->num_strings
+			* sizeof(long long));
+	int i, ok = NULL != string_offset;
+
+	for (i = 0; ok && i < writer->num_strings; i++) {
+		string_offset[i] = writer->pos;
+		ok = write_bytes(writer, writer->strings[i],
+				strlen(writer->strings[i]) + 1);
+	}
+	ok = ok && pad(writer);
+	trailer[2] = writer->pos;
+	ok = ok && write_bytes(writer, string_offset,
+			writer->num_strings * sizeof(long long));
+	trailer[3] = writer->pos;
+	ok = ok && write_bytes(writer, writer->tree_offset,
+			writer->num_trees * sizeof(long long));
+	trailer[0] = writer->num_trees;
+	trailer[1] = writer->num_strings;
+	trailer[4] = writer->max_num_nodes;
+	ok = ok && write_bytes(writer, trailer, sizeof(trailer))
+		&& write_bytes(writer, PACK_MAGIC, PACK_MAGIC_LENGTH)
+		&& write_bytes(writer, NULL, 8 - PACK_MAGIC_LENGTH);
+
+	free(string_offset);
+	destroy_tree_pack_writer(writer);
+	return ok;
+}
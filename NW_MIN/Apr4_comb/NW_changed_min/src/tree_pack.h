@@ -0,0 +1,118 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* Tree packs: a binary format for collections of trees (suffix ".nwb"), so
+ * that a collection which is read many times is parsed only once. A pack holds
+ * each tree as arrays indexed by node, in preorder: the parents, and labels
+ * and edge lengths as ids into a dictionary shared by all trees (plus the
+ * lengths' values, if any), with a table of where each tree starts. Packs are
+ * mapped and read in place: getting a tree as a flat tree (see flat_tree.h)
+ * only derives the child links from the parents, and making a struct
+ * rooted_tree of it needs no parsing. */
+
+/* NOTE: numbers are stored as the packing host has them (byte order and
+ * sizes), which is checked when a pack is opened: a pack can be read wherever
+ * it can be mapped, but it is not meant for exchange between different
+ * machines - Newick is. */
+
+#include <stdio.h>
+
+#define TREE_PACK_SUFFIX ".nwb"
+
+struct flat_tree;
+struct rooted_tree;
+struct arena;
+
+struct tree_pack {
+	const char *data;	/* the whole pack, mapped or read */
+	size_t size;
+	int mapped;		/* FALSE if 'data' was read into memory */
+	long num_trees;
+	const long long *tree_offset;	/* of each tree's record, in 'data' */
+	char **strings;		/* the dictionary, pointing into 'data' */
+	int num_strings;
+	int max_num_nodes;
+	double *no_lengths;	/* -1 for each node of a tree without lengths */
+	int *links;		/* the last flat tree's derived arrays */
+};
+
+/* Returns TRUE iff 'input' is a tree pack, judging by its next byte (which is
+ * put back). */
+
+int is_tree_pack(FILE *input);
+
+/* Opens the pack that makes up the rest of 'input' (from its current
+ * position). A regular file read from its start is mapped, any other input is
+ * read into memory. The file can be closed afterwards. */
+/* Returns NULL if the input is not a valid pack, or in case of error
+ * (malloc(), I/O) */
+
+struct tree_pack *open_tree_pack(FILE *input);
+
+/* Sets 'flat' to tree number 'n' (from 0) of the pack, in place: the arrays
+ * and strings are the pack's, so 'flat' must not be modified nor passed to
+ * destroy_flat_tree(). It is valid until the next call on the same pack. Its
+ * string ids are those of the whole pack. */
+/* Returns FAILURE if there is no such tree, or if its record is corrupt */
+
+int packed_flat_tree(struct tree_pack *pack, long n, struct flat_tree *flat);
+
+/* Returns tree number 'n' of the pack, allocated from 'arena' if it is not
+ * NULL (see arena.h). Children keep their order, and nodes_in_order is a
+ * postorder, as with the parser. */
+/* Returns NULL if there is no such tree, or in case of error (malloc()) */
+
+struct rooted_tree *packed_rooted_tree(struct tree_pack *pack, long n,
+		struct arena *arena);
+
+/* Unmaps or frees the pack */
+
+void close_tree_pack(struct tree_pack *pack);
+
+/* Writing a pack: trees are added one by one, and the dictionary and tree
+ * table are written after the last one, so the output need not be seekable
+ * (e.g. a pipe). */
+
+struct tree_pack_writer;
+
+/* Starts a pack on 'output', and writes its header. */
+/* Returns NULL in case of error (malloc(), I/O) */
+
+struct tree_pack_writer *create_tree_pack_writer(FILE *output);
+
+/* Adds a tree to the pack. Lengths are only stored for trees that have some. */
+/* Returns FAILURE in case of error (malloc(), I/O) */
+
+int write_packed_tree(struct tree_pack_writer *writer, struct flat_tree *flat);
+
+/* Writes the dictionary and tree table, and frees the writer (the output is
+ * neither flushed nor closed). */
+/* Returns FAILURE in case of error (I/O) */
+
+int finish_tree_pack(struct tree_pack_writer *writer);
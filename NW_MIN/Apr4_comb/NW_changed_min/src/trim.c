@@ -42,6 +42,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "masprintf.h"
 #include "rnode.h"
 #include "list.h"
+#include "output.h"
+#include "arena.h"
 
 enum {DEPTH_DISTANCE, DEPTH_ANCESTORS};
 
@@ -126,12 +128,11 @@ struct parameters get_params(int argc, char *argv[])
 	if ((argc - optind) == 2)	{
 		if (0 != strcmp("-", argv[optind])) {
 			FILE *fin = fopen(argv[optind], "r");
-			extern FILE *nwsin;
 			if (NULL == fin) {
 				perror(NULL);
 				exit(EXIT_FAILURE);
 			}
-			nwsin = fin;
+			set_parser_input(fin);
 		}
 		optind++;	/* optind is now index of 2nd arg - depth */
 		params.threshold = atof(argv[optind]);
@@ -155,7 +156,7 @@ void trim(struct rnode *node, struct parameters params)
 		/* Shrink parent edge length */
 		double excess = ndata->distance_depth - params.threshold;
 		double trimmed_edge_length = node->edge_length - excess;
-		free(node->edge_length_as_string);
+		arena_free(node->edge_length_as_string);
 		char *new_length = masprintf("%g", trimmed_edge_length);
 		if (NULL == new_length) { perror(NULL); exit(EXIT_FAILURE); }
 		node->edge_length_as_string = new_length;
@@ -237,6 +238,7 @@ int main(int argc, char *argv[])
 	struct parameters params;
 	
 	params = get_params(argc, argv);
+	buffer_stdout();
 
 	while (NULL != (tree = parse_tree())) {
 		process_tree(tree, params);
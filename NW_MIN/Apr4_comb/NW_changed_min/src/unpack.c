@@ -0,0 +1,175 @@
+/* 
+
+Copyright (c) 2009 Thomas Junier and Evgeny Zdobnov, University of Geneva
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+* Neither the name of the University of Geneva nor the names of its
+    contributors may be used to endorse or promote products derived from this
+    software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+/* nw_unpack: print the trees of a tree pack (see tree_pack.h) as Newick */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <string.h>
+
+#include "tree.h"
+#include "to_newick.h"
+#include "tree_pack.h"
+#include "compressed_io.h"
+#include "common.h"
+#include "output.h"
+
+struct parameters {
+	FILE *input;
+	long first;		/* -t, counting from 1; 0 for all trees */
+	long last;
+};
+
+void help(char *argv[])
+{
+	printf (
+"Prints the trees of a tree pack as Newick\n"
+"\n"
+"Synopsis\n"
+"--------\n"
+"\n"
+"%s [-h] [-t <range>] <pack filename|->\n"
+"\n"
+"Input\n"
+"-----\n"
+"\n"
+"Argument is the name of a tree pack made by nw_pack, or '-' (in which case\n"
+"the pack is read from standard input).\n"
+"\n"
+"Output\n"
+"------\n"
+"\n"
+"Prints the pack's trees, one per line. Other programs read packs directly:\n"
+"this is for exchanging trees, or for programs outside this package.\n"
+"\n"
+"Options\n"
+"-------\n"
+"\n"
+"    -h: print this message and exit\n"
+"    -t <int>[-<int>]: print tree number <int> (from 1), or a range of trees\n"
+"       (this does not read the trees before them)\n"
+"\n"
+"Examples\n"
+"--------\n"
+"\n"
+"# print all trees\n"
+"$ %s HRV_20reps.nwb\n"
+"\n"
+"# print the 10th tree\n"
+"$ %s -t 10 HRV_20reps.nwb\n",
+	argv[0],
+	argv[0],
+	argv[0]
+	);
+}
+
+struct parameters get_params(int argc, char *argv[])
+{
+	struct parameters params;
+	char *dash;
+
+	params.first = params.last = 0;
+
+	int opt_char;
+	while ((opt_char = getopt(argc, argv, "ht:")) != -1) {
+		switch (opt_char) {
+		case 'h':
+			help(argv);
+			exit(EXIT_SUCCESS);
+		case 't':
+			params.first = atol(optarg);
+			dash = strchr(optarg, '-');
+			params.last = NULL == dash ? params.first :
+				atol(dash + 1);
+			if (params.first < 1 || params.last < params.first) {
+				fprintf (stderr, "Invalid range '%s'.\n",
+						optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			fprintf (stderr, "Unknown option '-%c'\n", opt_char);
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	/* check arguments */
+	if ((argc - optind) == 1)	{
+		if (0 != strcmp("-", argv[optind]))
+			params.input = open_input_file(argv[optind]);
+		else
+			params.input = open_decompressed(stdin, FALSE);
+		if (NULL == params.input) {
+			perror(NULL);
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		fprintf(stderr, "Usage: %s [-ht] <filename|->\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	return params;
+}
+
+int main(int argc, char *argv[])
+{
+	struct parameters params = get_params(argc, argv);
+	struct tree_pack *pack;
+	long n, end;
+
+	buffer_stdout();
+
+	if (! is_tree_pack(params.input)
+		|| NULL == (pack = open_tree_pack(params.input))) {
+		fprintf (stderr, "Not a valid tree pack.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (params.last > pack->num_trees) {
+		fprintf (stderr, "There are only %ld trees.\n",
+				pack->num_trees);
+		exit(EXIT_FAILURE);
+	}
+	n = 0 == params.first ? 0 : params.first - 1;
+	end = 0 == params.first ? pack->num_trees : params.last;
+
+	for (; n < end; n++) {
+		struct rooted_tree *tree = packed_rooted_tree(pack, n, NULL);
+		if (NULL == tree) {
+			fprintf (stderr, "Can't read tree %ld.\n", n + 1);
+			exit(EXIT_FAILURE);
+		}
+		dump_newick(tree->root);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+	}
+
+	close_tree_pack(pack);
+	if (stdin != params.input) fclose(params.input);
+	return 0;
+}
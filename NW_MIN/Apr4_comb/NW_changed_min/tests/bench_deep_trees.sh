@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# bench_deep_trees.sh - times a few programs on caterpillar trees of increasing
+# depth (generated by nw_gen -c). Each tree is as deep as it has leaves, so any
+# recursion over the tree's structure would exhaust the stack well before the
+# largest size; the times should grow linearly with the number of leaves. Like
+# valgrind_nw_prog.sh, this is not part of the test suite, as it takes a while
+# (and some memory) to run. Pass the sizes as arguments to override the
+# defaults.
+
+sizes=${@:-10000 100000 1000000}
+tree=deep_tree.nw
+
+# <program name>:<arguments, with the tree on stdin>
+cases='nw_topology:-
+nw_order:-
+nw_labels:-
+nw_prune:- l1 l2
+nw_reroot:- l2
+nw_clade:- l3 l4
+nw_distance:-
+nw_stats:-
+nw_condense:-
+nw_ed:- "b > 1e9" d'
+
+TIMEFORMAT='%R s'
+
+for size in $sizes; do
+	echo "Caterpillar with $size leaves:"
+	../src/nw_gen -s 1 -c $size > $tree || exit 1
+	echo "$cases" | while IFS=':' read prog args ; do
+		echo -n "  $prog: "
+		IFS='' cmd="../src/$prog $args < $tree > /dev/null"
+		time eval $cmd || echo "  $prog FAILED"
+	done
+done
+
+rm -f $tree
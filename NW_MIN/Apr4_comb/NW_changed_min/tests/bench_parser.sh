@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# bench_parser.sh - compares the throughput of the Newick parsers (see
+# parser.h): the Bison one, the hand-written one over mmap'd input (used when
+# NW_PARSER=mmap), and the latter on 1, 2, 4, ... threads, up to the number of
+# processors (NW_PARSER=parallel). nw_topology -I reads each tree and prints it
+# without inner labels, so its time is mostly parsing. The input is a file of
+# 40 random trees from nw_gen (or the files passed as arguments) - the parallel
+# parser only helps with many trees, e.g. bootstrap replicates. Like
+# bench_deep_trees.sh, this is not part of the test suite.
+
+trees=bench_trees.nw
+
+if (( $# > 0 )); then
+	files="$@"
+else
+	for seed in $(seq 1 40); do
+		../src/nw_gen -s $seed -d 9 || exit 1
+	done > $trees
+	files=$trees
+fi
+
+TIMEFORMAT='%R'
+
+engines="bison mmap"
+procs=$(getconf _NPROCESSORS_ONLN 2> /dev/null || echo 1)
+for (( threads = 1; threads <= procs; threads *= 2 )); do
+	engines="$engines parallel:$threads"
+done
+
+for file in $files; do
+	bytes=$(wc -c < $file)
+	echo "$file ($bytes bytes):"
+	for engine in $engines; do
+		parser=${engine%:*}
+		threads=${engine#*:}
+		secs=$( { time NW_PARSER=$parser NW_PARSER_THREADS=$threads \
+			../src/nw_topology -I $file > /dev/null ; } 2>&1 )
+		awk -v p=$engine -v s=$secs -v b=$bytes 'BEGIN {
+			printf "  %-11s %6.2f s  %7.1f MB/s\n", p, s,
+				(s > 0 ? b / s / 1e6 : 0) }'
+	done
+done
+
+rm -f $trees
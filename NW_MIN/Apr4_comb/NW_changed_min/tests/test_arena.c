@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "rnode.h"
+#include "list.h"
+
+int test_alloc()
+{
+	const char *test_name = "test_alloc";
+	struct arena *arena = create_arena();
+	char *small, *big;
+	int i;
+
+	if (NULL == arena) {
+		printf ("%s: could not create arena.\n", test_name);
+		return 1;
+	}
+	for (i = 0; i < 10000; i++) {
+		small = arena_alloc(arena, 1 + i % 40);
+		if (NULL == small || 0 != (uintptr_t) small % sizeof(double)) {
+			printf ("%s: bad allocation #%d.\n", test_name, i);
+			return 1;
+		}
+		memset(small, 'x', 1 + i % 40);
+	}
+	/* larger than a chunk */
+	big = arena_alloc(arena, 100000);
+	if (NULL == big) {
+		printf ("%s: could not allocate a large block.\n", test_name);
+		return 1;
+	}
+	memset(big, 'y', 100000);
+	/* a no-op for arena memory */
+	arena_free(small);
+	arena_free(big + 99999);
+	destroy_arena(arena);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Nodes made while an arena is current come from it, and can still be
+ * destroyed one by one (as do nodes made without an arena). */
+
+int test_current_arena()
+{
+	const char *test_name = "test_current_arena";
+	struct arena *arena = create_arena();
+	struct rnode *in_arena, *on_heap;
+	char *length;
+
+	if (NULL != set_current_arena(arena)) {
+		printf ("%s: expected no current arena.\n", test_name);
+		return 1;
+	}
+	in_arena = create_rnode("Homo", "0.5");
+	length = arena_strdup("1.25");
+	set_current_arena(NULL);
+	on_heap = create_rnode("Pan", "0.25");
+	if (NULL == in_arena || NULL == on_heap || NULL == length) {
+		printf ("%s: could not create nodes.\n", test_name);
+		return 1;
+	}
+	if (! append_element(in_arena->children, on_heap)) {
+		printf ("%s: could not add child.\n", test_name);
+		return 1;
+	}
+	if (0 != strcmp("0.5", in_arena->edge_length_as_string) ||
+		0 != strcmp("1.25", length)) {
+		printf ("%s: expected lengths '0.5' and '1.25', got '%s' and "
+			"'%s'.\n", test_name, in_arena->edge_length_as_string,
+			length);
+		return 1;
+	}
+	destroy_rnode(on_heap, NULL);
+	destroy_rnode(in_arena, NULL);
+	destroy_arena(arena);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting arena test...\n");
+	failures += test_alloc();
+	failures += test_current_arena();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tree_stubs.h"
+#include "../src/tree.h"
+#include "../src/cluster_set.h"
+#include "../src/flat_tree.h"
+
+/* Returns a set of the given taxa, which must be in 'index'. The list ends
+ * with NULL. */
+
+cluster_word *make_taxon_set(struct taxon_index *index, const char **labels)
+{
+	cluster_word *set = create_taxon_set(taxon_set_words(index));
+	for (; NULL != *labels; labels++)
+		taxon_set_add(set, taxon_number(index, *labels));
+	return set;
+}
+
+int test_taxon_index()
+{
+	const char *test_name = "test_taxon_index";
+	struct rooted_tree tree = tree_2();
+	struct taxon_index *index = create_taxon_index(10);
+
+	if (! taxon_index_add_tree(index, &tree)) {
+		printf ("%s: memory error.\n", test_name);
+		return 1;
+	}
+	if (5 != index->count) {
+		printf ("%s: expected 5 taxa, got %d.\n", test_name,
+				index->count);
+		return 1;
+	}
+	if (0 != taxon_number(index, "A")) {
+		printf ("%s: 'A' should be taxon 0.\n", test_name);
+		return 1;
+	}
+	if (4 != taxon_number(index, "E")) {
+		printf ("%s: 'E' should be taxon 4.\n", test_name);
+		return 1;
+	}
+	/* inner labels are not taxa */
+	if (-1 != taxon_number(index, "f")) {
+		printf ("%s: 'f' should not be a taxon.\n", test_name);
+		return 1;
+	}
+	/* adding the same tree again changes nothing */
+	taxon_index_add_tree(index, &tree);
+	if (5 != index->count) {
+		printf ("%s: expected 5 taxa, got %d.\n", test_name,
+				index->count);
+		return 1;
+	}
+
+	destroy_taxon_index(index);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_tree_clusters()
+{
+	const char *test_name = "test_tree_clusters";
+	struct rooted_tree tree = tree_2();
+	struct taxon_index *index = create_taxon_index(10);
+	struct tree_clusters *tc;
+	int words;
+
+	taxon_index_add_tree(index, &tree);
+	tc = create_tree_clusters(&tree, index);
+	if (NULL == tc) {
+		printf ("%s: could not compute clusters.\n", test_name);
+		return 1;
+	}
+	words = tc->num_words;
+	if (9 != tc->num_clusters) {
+		printf ("%s: expected 9 clusters, got %d.\n", test_name,
+				tc->num_clusters);
+		return 1;
+	}
+	if (5 != taxon_set_count(tc->leaves, words)) {
+		printf ("%s: expected 5 leaves.\n", test_name);
+		return 1;
+	}
+	/* clusters follow nodes_in_order: A B f C D E g h i */
+	if (2 != taxon_set_count(tc->sets + 2 * words, words)) {
+		printf ("%s: cluster of 'f' should have 2 taxa.\n", test_name);
+		return 1;
+	}
+	if (3 != taxon_set_count(tc->sets + 7 * words, words)) {
+		printf ("%s: cluster of 'h' should have 3 taxa.\n", test_name);
+		return 1;
+	}
+	if (5 != taxon_set_count(tc->sets + 8 * words, words)) {
+		printf ("%s: cluster of root should have 5 taxa.\n", test_name);
+		return 1;
+	}
+
+	destroy_tree_clusters(tc);
+	destroy_taxon_index(index);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* ((A,B)f,(C,(D,E)g)h)i; vs (A,B,(C,(D,E)f)g)h; */
+
+int test_restriction()
+{
+	const char *test_name = "test_restriction";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree5 = tree_5();
+	struct taxon_index *index = create_taxon_index(10);
+	struct tree_clusters *tc2, *tc5;
+	struct cluster_restriction *r2, *r5;
+	const char *all[] = { "A", "B", "C", "D", "E", NULL };
+	const char *cde[] = { "C", "D", "E", NULL };
+	const char *acd[] = { "A", "C", "D", NULL };
+	const char *abc[] = { "A", "B", "C", NULL };
+	cluster_word *taxa;
+
+	taxon_index_add_tree(index, &tree2);
+	taxon_index_add_tree(index, &tree5);
+	tc2 = create_tree_clusters(&tree2, index);
+	tc5 = create_tree_clusters(&tree5, index);
+	r2 = create_cluster_restriction(9, tc2->num_words);
+	r5 = create_cluster_restriction(9, tc5->num_words);
+
+	taxa = make_taxon_set(index, all);
+	restrict_clusters(tc2, taxa, r2);
+	restrict_clusters(tc5, taxa, r5);
+	/* {A,B}, {C,D,E}, {D,E} */
+	if (3 != r2->count) {
+		printf ("%s: expected 3 clusters, got %d.\n", test_name,
+				r2->count);
+		return 1;
+	}
+	if (cluster_restrictions_equal(r2, r5)) {
+		printf ("%s: trees should differ on all taxa.\n", test_name);
+		return 1;
+	}
+	free(taxa);
+
+	taxa = make_taxon_set(index, cde);
+	restrict_clusters(tc2, taxa, r2);
+	restrict_clusters(tc5, taxa, r5);
+	if (! cluster_restrictions_equal(r2, r5)) {
+		printf ("%s: trees should agree on C,D,E.\n", test_name);
+		return 1;
+	}
+	free(taxa);
+
+	/* (A,(C,D)) in both trees - in tree 2, h's and g's clusters become
+	 * the same, and must be counted once. */
+	taxa = make_taxon_set(index, acd);
+	restrict_clusters(tc2, taxa, r2);
+	restrict_clusters(tc5, taxa, r5);
+	if (1 != r2->count) {
+		printf ("%s: expected 1 cluster, got %d.\n", test_name,
+				r2->count);
+		return 1;
+	}
+	if (! cluster_restrictions_equal(r2, r5)) {
+		printf ("%s: trees should agree on A,C,D.\n", test_name);
+		return 1;
+	}
+	free(taxa);
+
+	/* ((A,B),C) vs (A,B,C) */
+	taxa = make_taxon_set(index, abc);
+	restrict_clusters(tc2, taxa, r2);
+	restrict_clusters(tc5, taxa, r5);
+	if (cluster_restrictions_equal(r2, r5)) {
+		printf ("%s: trees should differ on A,B,C.\n", test_name);
+		return 1;
+	}
+	free(taxa);
+
+	destroy_cluster_restriction(r2);
+	destroy_cluster_restriction(r5);
+	destroy_tree_clusters(tc2);
+	destroy_tree_clusters(tc5);
+	destroy_taxon_index(index);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Two isomorphic ladders agree on their taxa, but not on taxa that one of them
+ * lacks. */
+
+int test_cover()
+{
+	const char *test_name = "test_cover";
+	struct rooted_tree tree14 = tree_14();
+	struct rooted_tree tree15 = tree_15();
+	struct rooted_tree tree2 = tree_2();
+	struct taxon_index *index = create_taxon_index(20);
+	struct tree_clusters *tc14, *tc15;
+	struct cluster_restriction *r14, *r15;
+	const char *homo_a[] = { "Homo", "Equus", "Xenopus", "A", NULL };
+	cluster_word *taxa;
+
+	taxon_index_add_tree(index, &tree14);
+	taxon_index_add_tree(index, &tree2);
+	tc14 = create_tree_clusters(&tree14, index);
+	tc15 = create_tree_clusters(&tree15, index);
+	r14 = create_cluster_restriction(11, tc14->num_words);
+	r15 = create_cluster_restriction(11, tc15->num_words);
+
+	restrict_clusters(tc14, tc14->leaves, r14);
+	restrict_clusters(tc15, tc14->leaves, r15);
+	if (! cluster_restrictions_equal(r14, r15)) {
+		printf ("%s: ladders should be equal.\n", test_name);
+		return 1;
+	}
+
+	taxa = make_taxon_set(index, homo_a);
+	restrict_clusters(tc14, taxa, r14);
+	restrict_clusters(tc15, taxa, r15);
+	if (r14->covers) {
+		printf ("%s: tree should not cover 'A'.\n", test_name);
+		return 1;
+	}
+	if (cluster_restrictions_equal(r14, r15)) {
+		printf ("%s: should not be equal on 'A'.\n", test_name);
+		return 1;
+	}
+	free(taxa);
+
+	destroy_cluster_restriction(r14);
+	destroy_cluster_restriction(r15);
+	destroy_tree_clusters(tc14);
+	destroy_tree_clusters(tc15);
+	destroy_taxon_index(index);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* The clusters of a flat tree are those of the tree, in preorder */
+
+int test_flat_tree_clusters()
+{
+	const char *test_name = "test_flat_tree_clusters";
+	struct rooted_tree tree = tree_2();
+	struct taxon_index *index = create_taxon_index(10);
+	struct flat_tree *flat = create_flat_tree(&tree);
+	struct tree_clusters *tc, *ftc;
+	struct cluster_restriction *r, *fr;
+	int words;
+
+	taxon_index_add_tree(index, &tree);
+	tc = create_tree_clusters(&tree, index);
+	ftc = create_flat_tree_clusters(flat, index);
+	if (NULL == tc || NULL == ftc) {
+		printf ("%s: could not compute clusters.\n", test_name);
+		return 1;
+	}
+	words = ftc->num_words;
+	if (9 != ftc->num_clusters || 5 != taxon_set_count(ftc->leaves, words)) {
+		printf ("%s: expected 9 clusters and 5 leaves.\n", test_name);
+		return 1;
+	}
+	/* preorder: i f A B h C g D E */
+	if (5 != taxon_set_count(ftc->sets, words)
+		|| 2 != taxon_set_count(ftc->sets + 1 * words, words)
+		|| 3 != taxon_set_count(ftc->sets + 4 * words, words)) {
+		printf ("%s: wrong cluster sizes.\n", test_name);
+		return 1;
+	}
+	r = create_cluster_restriction(9, words);
+	fr = create_cluster_restriction(9, words);
+	restrict_clusters(tc, tc->leaves, r);
+	restrict_clusters(ftc, tc->leaves, fr);
+	if (! cluster_restrictions_equal(r, fr)) {
+		printf ("%s: expected the same clusters as the tree.\n",
+				test_name);
+		return 1;
+	}
+
+	destroy_cluster_restriction(r);
+	destroy_cluster_restriction(fr);
+	destroy_tree_clusters(tc);
+	destroy_tree_clusters(ftc);
+	destroy_flat_tree(flat);
+	destroy_taxon_index(index);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting cluster set test...\n");
+	failures += test_taxon_index();
+	failures += test_tree_clusters();
+	failures += test_restriction();
+	failures += test_cover();
+	failures += test_flat_tree_clusters();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
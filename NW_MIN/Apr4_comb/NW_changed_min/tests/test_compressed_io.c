@@ -0,0 +1,221 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/compressed_io.h"
+
+static const char *trees =
+	"((A,B),C);\n"
+	"(D,(E,F));\n";
+
+#define TMP_FILE "test_compressed_io.tmp.gz"
+
+/* Reads all of 'input' (at most 'size' - 1 bytes) into 'dest', and closes it.
+ * Returns 0 in case of error. */
+
+static int read_all(FILE *input, char *dest, size_t size)
+{
+	size_t length = fread(dest, 1, size - 1, input);
+	int ok = ! ferror(input);
+	dest[length] = '\0';
+	if (0 != fclose(input)) ok = 0;
+	return ok;
+}
+
+int test_compression_of()
+{
+	const char *test_name = "test_compression_of";
+	const unsigned char gzip[] = { 0x1f, 0x8b, 0x08, 0x00 };
+	const unsigned char zstd[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+	if (COMPRESSION_GZIP != compression_of_data(gzip, 4)
+		|| COMPRESSION_ZSTD != compression_of_data(zstd, 4)
+		|| COMPRESSION_NONE != compression_of_data(zstd, 3)
+		|| COMPRESSION_NONE != compression_of_data(
+			(const unsigned char *) trees, 4)) {
+		printf ("%s: wrong compression of data.\n", test_name);
+		return 1;
+	}
+	if (COMPRESSION_GZIP != compression_of_filename("trees.nw.gz")
+		|| COMPRESSION_ZSTD != compression_of_filename("trees.zst")
+		|| COMPRESSION_NONE != compression_of_filename("gz")
+		|| COMPRESSION_NONE != compression_of_filename("trees.nw")) {
+		printf ("%s: wrong compression of filename.\n", test_name);
+		return 1;
+	}
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Uncompressed input is passed as is. */
+
+int test_plain()
+{
+	const char *test_name = "test_plain";
+	FILE *file = tmpfile();
+	FILE *input;
+	char text[100];
+
+	if (NULL == file) {
+		printf ("%s: could not create file.\n", test_name);
+		return 1;
+	}
+	fputs(trees, file);
+	rewind(file);
+	input = open_decompressed(file, 1);
+	if (file != input) {
+		printf ("%s: expected the input itself.\n", test_name);
+		return 1;
+	}
+	if (! read_all(input, text, sizeof(text))
+		|| 0 != strcmp(trees, text)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name, trees,
+				text);
+		return 1;
+	}
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+#ifdef HAVE_LIBZ
+
+/* Writes 'text' to 'file', gzipped, 'times' times as separate gzip members.
+ * Returns 0 in case of error. */
+
+static int write_gzip(FILE *file, const char *text, int times)
+{
+	int i;
+	for (i = 0; i < times; i++) {
+		FILE *output = open_compressed(file, COMPRESSION_GZIP, 0);
+		if (NULL == output) return 0;
+		fputs(text, output);
+		if (0 != fclose(output)) return 0;
+	}
+	return 1;
+}
+
+int test_gzip()
+{
+	const char *test_name = "test_gzip";
+	FILE *output = open_output_file(TMP_FILE);
+	FILE *input;
+	unsigned char head[2];
+	char text[100];
+
+	if (NULL == output) {
+		printf ("%s: could not create file.\n", test_name);
+		return 1;
+	}
+	fputs(trees, output);
+	if (0 != fclose(output)) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	/* it's really gzipped */
+	input = fopen(TMP_FILE, "r");
+	if (NULL == input || 2 != fread(head, 1, 2, input)
+		|| COMPRESSION_GZIP != compression_of_data(head, 2)) {
+		printf ("%s: output is not gzipped.\n", test_name);
+		return 1;
+	}
+	fclose(input);
+	input = open_input_file(TMP_FILE);
+	if (NULL == input || ! read_all(input, text, sizeof(text))
+		|| 0 != strcmp(trees, text)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name, trees,
+				text);
+		return 1;
+	}
+	remove(TMP_FILE);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Concatenated gzip files (e.g. cat a.gz b.gz) are read as one. */
+
+int test_gzip_members()
+{
+	const char *test_name = "test_gzip_members";
+	FILE *file = tmpfile();
+	FILE *input;
+	char text[100];
+	char exp[100];
+
+	if (NULL == file || ! write_gzip(file, trees, 3)) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	rewind(file);
+	sprintf(exp, "%s%s%s", trees, trees, trees);
+	input = open_decompressed(file, 1);
+	if (NULL == input || ! read_all(input, text, sizeof(text))
+		|| 0 != strcmp(exp, text)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name, exp,
+				text);
+		return 1;
+	}
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Truncated input is an error, not a short read. */
+
+int test_gzip_truncated()
+{
+	const char *test_name = "test_gzip_truncated";
+	FILE *file = tmpfile();
+	FILE *truncated = tmpfile();
+	FILE *input;
+	char text[100];
+	long length;
+	int c;
+
+	if (NULL == file || NULL == truncated || ! write_gzip(file, trees, 1)) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	length = ftell(file);
+	rewind(file);
+	while (EOF != (c = getc(file)) && ftell(file) < length - 4)
+		putc(c, truncated);
+	fclose(file);
+	rewind(truncated);
+	input = open_decompressed(truncated, 1);
+	if (NULL == input) {
+		printf ("%s: got NULL stream.\n", test_name);
+		return 1;
+	}
+	if (read_all(input, text, sizeof(text))) {
+		printf ("%s: expected an error, got '%s'.\n", test_name, text);
+		return 1;
+	}
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+#endif
+
+int main()
+{
+	int failures = 0;
+	printf("Starting compressed I/O test...\n");
+	failures += test_compression_of();
+	failures += test_plain();
+#ifdef HAVE_LIBZ
+	failures += test_gzip();
+	failures += test_gzip_members();
+	failures += test_gzip_truncated();
+#endif
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
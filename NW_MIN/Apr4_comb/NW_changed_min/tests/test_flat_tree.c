@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_stubs.h"
+#include "../src/tree.h"
+#include "../src/list.h"
+#include "../src/to_newick.h"
+#include "../src/flat_tree.h"
+
+/* ((A,B)f,(C,(D,E)g)h)i; - in preorder: i f A B h C g D E */
+
+int test_create()
+{
+	const char *test_name = "test_create";
+	struct rooted_tree tree = tree_2();
+	struct flat_tree *flat = create_flat_tree(&tree);
+	const char *exp_labels[] = { "i", "f", "A", "B", "h", "C", "g", "D",
+		"E" };
+	int exp_parent[] = { FLAT_NONE, 0, 1, 1, 0, 4, 4, 6, 6 };
+	int exp_first_child[] = { 1, 2, FLAT_NONE, FLAT_NONE, 5, FLAT_NONE,
+		7, FLAT_NONE, FLAT_NONE };
+	int exp_next_sibling[] = { FLAT_NONE, 4, 3, FLAT_NONE, FLAT_NONE, 6,
+		FLAT_NONE, 8, FLAT_NONE };
+	int exp_size[] = { 9, 3, 1, 1, 5, 1, 3, 1, 1 };
+	int n;
+
+	if (NULL == flat) {
+		printf ("%s: could not create flat tree.\n", test_name);
+		return 1;
+	}
+	if (9 != flat->num_nodes) {
+		printf ("%s: expected 9 nodes, got %d.\n", test_name,
+				flat->num_nodes);
+		return 1;
+	}
+	for (n = 0; n < 9; n++) {
+		if (0 != strcmp(exp_labels[n], flat_tree_label(flat, n))) {
+			printf ("%s: node %d: expected label '%s', got '%s'.\n",
+				test_name, n, exp_labels[n],
+				flat_tree_label(flat, n));
+			return 1;
+		}
+		if (exp_parent[n] != flat->parent[n]
+			|| exp_first_child[n] != flat->first_child[n]
+			|| exp_next_sibling[n] != flat->next_sibling[n]) {
+			printf ("%s: node %d: wrong links.\n", test_name, n);
+			return 1;
+		}
+		if (exp_size[n] != flat->subtree_size[n]) {
+			printf ("%s: node %d: expected subtree size %d, got %d.\n",
+				test_name, n, exp_size[n],
+				flat->subtree_size[n]);
+			return 1;
+		}
+	}
+	if (! flat_tree_is_leaf(flat, 7) || flat_tree_is_leaf(flat, 6)) {
+		printf ("%s: wrong leaves.\n", test_name);
+		return 1;
+	}
+
+	destroy_flat_tree(flat);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* (((D,D)e,D)f,((C,B)g,(B,A)h)i)j; - each string is stored once */
+
+int test_strings()
+{
+	const char *test_name = "test_strings";
+	struct rooted_tree tree = tree_9();
+	struct flat_tree *flat = create_flat_tree(&tree);
+
+	/* "", D, e, f, C, B, g, A, h, i, j */
+	if (11 != flat->num_strings) {
+		printf ("%s: expected 11 strings, got %d.\n", test_name,
+				flat->num_strings);
+		return 1;
+	}
+	if (flat->label_id[3] != flat->label_id[5]) {
+		printf ("%s: 'D' leaves should share a label id.\n", test_name);
+		return 1;
+	}
+	if (0 != flat->length_id[3]) {
+		printf ("%s: missing length should be \"\".\n", test_name);
+		return 1;
+	}
+
+	destroy_flat_tree(flat);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Converting back should yield the same Newick */
+
+int test_round_trip_tree(const char *test_name, struct rooted_tree tree)
+{
+	struct flat_tree *flat = create_flat_tree(&tree);
+	struct rooted_tree *back;
+	char *exp_newick = to_newick(tree.root);
+	char *obt_newick;
+
+	if (NULL == flat) {
+		printf ("%s: could not create flat tree.\n", test_name);
+		return 1;
+	}
+	back = flat_tree_to_rooted_tree(flat);
+	if (NULL == back) {
+		printf ("%s: could not convert back.\n", test_name);
+		return 1;
+	}
+	obt_newick = to_newick(back->root);
+	if (0 != strcmp(exp_newick, obt_newick)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name,
+				exp_newick, obt_newick);
+		return 1;
+	}
+	if (tree.nodes_in_order->count != back->nodes_in_order->count) {
+		printf ("%s: expected %d nodes, got %d.\n", test_name,
+			tree.nodes_in_order->count,
+			back->nodes_in_order->count);
+		return 1;
+	}
+
+	free(exp_newick);
+	free(obt_newick);
+	destroy_tree(back, DONT_FREE_NODE_DATA);
+	destroy_flat_tree(flat);
+	return 0;
+}
+
+int test_round_trip()
+{
+	const char *test_name = "test_round_trip";
+
+	/* lengths, polytomies, empty labels, linear tree, quoted labels */
+	if (test_round_trip_tree(test_name, tree_3())) return 1;
+	if (test_round_trip_tree(test_name, tree_5())) return 1;
+	if (test_round_trip_tree(test_name, tree_7())) return 1;
+	if (test_round_trip_tree(test_name, tree_10())) return 1;
+	if (test_round_trip_tree(test_name, tree_12())) return 1;
+	if (test_round_trip_tree(test_name, tree_16())) return 1;
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting flat tree test...\n");
+	failures += test_create();
+	failures += test_strings();
+	failures += test_round_trip();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
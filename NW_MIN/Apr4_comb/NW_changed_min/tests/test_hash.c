@@ -1,4 +1,5 @@
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 
 #include "hash.h"
@@ -122,6 +123,55 @@ int test_destroy()
 	return 0;
 }
 
+int test_grow()
+{
+	char *test_name = "test_grow";
+	struct hash *h = create_hash(4);
+	static int values[1000];
+	int i;
+
+	/* many more elements than the hint; keys of both sides of
+	 * HASH_INLINE_KEY */
+	for (i = 0; i < 1000; i++) {
+		char *key = masprintf(i % 2 ? "k%d" : "a rather long key %d", i);
+		values[i] = i;
+		if (! hash_set(h, key, values + i)) {
+			printf ("%s: could not set '%s'.\n", test_name, key);
+			return 1;
+		}
+		free(key);
+	}
+	if (1000 != h->count) {
+		printf ("%s: expected hash count to be 1000, got %d.\n",
+				test_name, h->count);
+		return 1;
+	}
+	for (i = 0; i < 1000; i++) {
+		char *key = masprintf(i % 2 ? "k%d" : "a rather long key %d", i);
+		int *value = hash_get(h, key);
+		if (NULL == value || i != *value) {
+			printf ("%s: wrong value for '%s'.\n", test_name, key);
+			return 1;
+		}
+		free(key);
+	}
+	if (NULL != hash_get(h, "k1000")) {
+		printf ("%s: 'k1000' should not be found.\n", test_name);
+		return 1;
+	}
+	/* replacing a value does not add an element */
+	hash_set(h, "k1", values);
+	if (1000 != h->count || values != hash_get(h, "k1")) {
+		printf ("%s: value of 'k1' should have been replaced.\n",
+				test_name);
+		return 1;
+	}
+
+	destroy_hash(h);
+	printf ("%s ok.\n", test_name);
+	return 0;
+}
+
 int test_make_hash_key()
 {
 	char *test_name = "test_make_hash_key";
@@ -145,6 +195,7 @@ int main()
 	failures += test_simple();
 	failures += test_keys();
 	failures += test_destroy();
+	failures += test_grow();
 	failures += test_make_hash_key();
 	if (0 == failures) {
 		printf("All tests ok.\n");
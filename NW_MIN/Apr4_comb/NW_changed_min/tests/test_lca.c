@@ -73,6 +73,14 @@ int test_lca2()
 				test_name, lca->label);
 		return 1;
 	}
+	/* a node of another tree */
+	struct rooted_tree other = tree_3();
+	lca = lca2(&tree, desc_A, other.root);
+	if (NULL != lca) {
+		printf ("%s: expected no LCA for nodes of different trees.\n",
+				test_name);
+		return 1;
+	}
 	
 	printf("%s ok.\n", test_name);
 	return 0;
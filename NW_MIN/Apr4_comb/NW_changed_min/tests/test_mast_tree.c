@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "tree.h"
+#include "order_tree.h"
+#include "tree_stubs.h"
+#include "to_newick.h"
+#include "mast_tree.h"
+
+/* Returns the MAST's Newick, ordered by label */
+
+char *mast_newick(struct rooted_tree *mast)
+{
+	order_tree_lbl(mast);
+	return to_newick(mast->root);
+}
+
+int test_two_trees_same()
+{
+	const char *test_name = "test_two_trees_same";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree3 = tree_3();
+	struct rooted_tree *mast;
+	char *exp_newick = "((A,B),(C,(D,E)));";
+	char *obt_newick;
+
+	if (MAST_OK != mast_two_trees(&tree2, &tree3, &mast)) {
+		printf ("%s: MAST failed.\n", test_name);
+		return 1;
+	}
+	obt_newick = mast_newick(mast);
+	if (0 != strcmp(exp_newick, obt_newick)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name,
+				exp_newick, obt_newick);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* ((A,B)f,(C,(D,E)g)h)i; vs (A,B,(C,(D,E)f)g)h; - A or B must go */
+
+int test_two_trees_polytomy()
+{
+	const char *test_name = "test_two_trees_polytomy";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree5 = tree_5();
+	struct rooted_tree *mast;
+
+	if (MAST_OK != mast_two_trees(&tree2, &tree5, &mast)) {
+		printf ("%s: MAST failed.\n", test_name);
+		return 1;
+	}
+	if (4 != leaf_count(mast)) {
+		printf ("%s: expected 4 leaves, got %d.\n", test_name,
+				leaf_count(mast));
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_two_trees_disjoint()
+{
+	const char *test_name = "test_two_trees_disjoint";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree13 = tree_13();
+	struct rooted_tree *mast;
+
+	if (MAST_OK != mast_two_trees(&tree2, &tree13, &mast)) {
+		printf ("%s: MAST failed.\n", test_name);
+		return 1;
+	}
+	if (NULL != mast) {
+		printf ("%s: expected no MAST.\n", test_name);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_dup_label()
+{
+	const char *test_name = "test_dup_label";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree9 = tree_9();
+	struct rooted_tree *mast;
+
+	if (MAST_DUP_LABEL != mast_two_trees(&tree9, &tree2, &mast)) {
+		printf ("%s: expected MAST_DUP_LABEL.\n", test_name);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* The isomorphic ladders agree on all their leaves; #2 and #17 only on three
+ * (e.g., (A,(D,E))). Both algorithms should agree. */
+
+int test_k_trees()
+{
+	const char *test_name = "test_k_trees";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree3 = tree_3();
+	struct rooted_tree tree14 = tree_14();
+	struct rooted_tree tree15 = tree_15();
+	struct rooted_tree tree17 = tree_17();
+	struct rooted_tree *ladders[] = { &tree14, &tree15, &tree14 };
+	struct rooted_tree *trees[] = { &tree2, &tree3, &tree17 };
+	struct rooted_tree *mast;
+
+	if (MAST_OK != mast_trees(ladders, 3, &mast)) {
+		printf ("%s: MAST failed.\n", test_name);
+		return 1;
+	}
+	if (6 != leaf_count(mast)) {
+		printf ("%s: expected 6 leaves, got %d.\n", test_name,
+				leaf_count(mast));
+		return 1;
+	}
+	if (MAST_OK != mast_trees(trees, 3, &mast)) {
+		printf ("%s: MAST failed.\n", test_name);
+		return 1;
+	}
+	if (3 != leaf_count(mast)) {
+		printf ("%s: expected 3 leaves, got %d.\n", test_name,
+				leaf_count(mast));
+		return 1;
+	}
+	if (MAST_OK != mast_two_trees(&tree2, &tree17, &mast)) {
+		printf ("%s: MAST failed.\n", test_name);
+		return 1;
+	}
+	if (3 != leaf_count(mast)) {
+		printf ("%s: expected 3 leaves (2 trees), got %d.\n",
+				test_name, leaf_count(mast));
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_k_trees_not_binary()
+{
+	const char *test_name = "test_k_trees_not_binary";
+	struct rooted_tree tree2 = tree_2();
+	struct rooted_tree tree3 = tree_3();
+	struct rooted_tree tree5 = tree_5();
+	struct rooted_tree *trees[] = { &tree2, &tree3, &tree5 };
+	struct rooted_tree *mast;
+
+	if (MAST_NOT_BINARY != mast_trees(trees, 3, &mast)) {
+		printf ("%s: expected MAST_NOT_BINARY.\n", test_name);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting MAST test...\n");
+	failures += test_two_trees_same();
+	failures += test_two_trees_polytomy();
+	failures += test_two_trees_disjoint();
+	failures += test_dup_label();
+	failures += test_k_trees();
+	failures += test_k_trees_not_binary();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
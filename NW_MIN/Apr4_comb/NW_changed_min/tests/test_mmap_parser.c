@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/tree.h"
+#include "../src/list.h"
+#include "../src/parser.h"
+#include "../src/mmap_parser.h"
+#include "../src/parallel_parser.h"
+#include "../src/flat_tree.h"
+#include "../src/to_newick.h"
+
+/* Trees that exercise the scanner: lengths, quoted labels, comments, labels
+ * with spaces, empty leaves, and trees spanning lines. */
+
+static const char *trees =
+	"((A:1,B:1.0)f:2.0,(C:1,(D:1,E:1)g:2)h:3)i;\n"
+	"('Homo sapiens',[a comment]Pan)'Homininae';\n"
+	"(Gorilla gorilla,(,)):0.5;(\n"
+	"  Pongo,\n"
+	"  Hylobates\n"
+	")Hominoidea;\n";
+
+/* Returns a temporary file holding 'contents', rewound */
+
+static FILE *file_with(const char *contents)
+{
+	FILE *file = tmpfile();
+	if (NULL == file) return NULL;
+	fputs(contents, file);
+	rewind(file);
+	return file;
+}
+
+/* The mmap parser yields the same trees as the Bison parser */
+
+int test_same_trees()
+{
+	const char *test_name = "test_same_trees";
+	FILE *file = file_with(trees);
+	struct mmap_parser *parser = NULL;
+	struct newick_parser *bison = create_newick_string_parser(trees);
+	struct rooted_tree *exp, *obt;
+	int num_trees = 0;
+
+	if (NULL != file) parser = create_mmap_parser(file);
+	if (NULL == parser || NULL == bison) {
+		printf ("%s: could not create parsers.\n", test_name);
+		return 1;
+	}
+	while (NULL != (exp = parser_parse_tree(bison))) {
+		obt = mmap_parse_tree(parser);
+		if (NULL == obt) {
+			printf ("%s: tree %d: got NULL.\n", test_name,
+					num_trees);
+			return 1;
+		}
+		char *exp_newick = to_newick(exp->root);
+		char *obt_newick = to_newick(obt->root);
+		if (0 != strcmp(exp_newick, obt_newick)) {
+			printf ("%s: expected '%s', got '%s'.\n", test_name,
+					exp_newick, obt_newick);
+			return 1;
+		}
+		if (exp->nodes_in_order->count != obt->nodes_in_order->count
+			|| exp->nodes_in_order->tail->data !=
+				exp->root
+			|| obt->nodes_in_order->tail->data != obt->root) {
+			printf ("%s: wrong node list.\n", test_name);
+			return 1;
+		}
+		free(exp_newick);
+		free(obt_newick);
+		destroy_tree(exp, DONT_FREE_NODE_DATA);
+		destroy_tree(obt, DONT_FREE_NODE_DATA);
+		num_trees++;
+	}
+	if (4 != num_trees) {
+		printf ("%s: expected 4 trees, got %d.\n", test_name,
+				num_trees);
+		return 1;
+	}
+	if (NULL != mmap_parse_tree(parser)
+			|| PARSER_STATUS_EMPTY != parser->status) {
+		printf ("%s: expected end of input.\n", test_name);
+		return 1;
+	}
+	if (6 != parser->lineno) {
+		printf ("%s: expected line 6, got %d.\n", test_name,
+				parser->lineno);
+		return 1;
+	}
+	destroy_mmap_parser(parser);
+	destroy_newick_parser(bison);
+	fclose(file);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Flat trees are the same as those made from parsed trees */
+
+int test_flat_tree()
+{
+	const char *test_name = "test_flat_tree";
+	FILE *file = file_with(trees);
+	struct mmap_parser *parser = NULL;
+	struct newick_parser *bison = create_newick_string_parser(trees);
+	struct rooted_tree *tree;
+	struct flat_tree *exp, *obt;
+	int n;
+
+	if (NULL != file) parser = create_mmap_parser(file);
+	if (NULL == parser || NULL == bison) {
+		printf ("%s: could not create parsers.\n", test_name);
+		return 1;
+	}
+	while (NULL != (tree = parser_parse_tree(bison))) {
+		exp = create_flat_tree(tree);
+		obt = mmap_parse_flat_tree(parser);
+		if (NULL == exp || NULL == obt) {
+			printf ("%s: could not create flat trees.\n",
+					test_name);
+			return 1;
+		}
+		if (exp->num_nodes != obt->num_nodes
+			|| exp->num_strings != obt->num_strings) {
+			printf ("%s: expected %d nodes and %d strings, got %d "
+				"and %d.\n", test_name, exp->num_nodes,
+				exp->num_strings, obt->num_nodes,
+				obt->num_strings);
+			return 1;
+		}
+		for (n = 0; n < exp->num_nodes; n++) {
+			if (exp->parent[n] != obt->parent[n]
+				|| exp->first_child[n] != obt->first_child[n]
+				|| exp->next_sibling[n] != obt->next_sibling[n]
+				|| exp->subtree_size[n] != obt->subtree_size[n]
+				|| exp->edge_length[n] != obt->edge_length[n]) {
+				printf ("%s: node %d differs.\n", test_name, n);
+				return 1;
+			}
+			if (0 != strcmp(flat_tree_label(exp, n),
+					flat_tree_label(obt, n))
+				|| 0 != strcmp(exp->strings[exp->length_id[n]],
+					obt->strings[obt->length_id[n]])) {
+				printf ("%s: node %d: expected label '%s', "
+					"got '%s'.\n", test_name, n,
+					flat_tree_label(exp, n),
+					flat_tree_label(obt, n));
+				return 1;
+			}
+		}
+		destroy_flat_tree(exp);
+		destroy_flat_tree(obt);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+	}
+	destroy_mmap_parser(parser);
+	destroy_newick_parser(bison);
+	fclose(file);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Checks that parsing 'newick' gives NULL and status 'exp' */
+
+static int check_error(const char *test_name, const char *newick,
+		enum parser_status_type exp)
+{
+	FILE *file = file_with(newick);
+	struct mmap_parser *parser = NULL;
+
+	if (NULL != file) parser = create_mmap_parser(file);
+	if (NULL == parser) {
+		printf ("%s: could not create parser.\n", test_name);
+		return 1;
+	}
+	if (NULL != mmap_parse_tree(parser) || exp != parser->status) {
+		printf ("%s: '%s': expected status %d, got %d.\n", test_name,
+				newick, exp, parser->status);
+		return 1;
+	}
+	destroy_mmap_parser(parser);
+	fclose(file);
+	return 0;
+}
+
+int test_errors()
+{
+	const char *test_name = "test_errors";
+
+	if (check_error(test_name, "", PARSER_STATUS_EMPTY)) return 1;
+	if (check_error(test_name, "  [nothing]\n", PARSER_STATUS_EMPTY))
+		return 1;
+	if (check_error(test_name, "(A,B)", PARSER_STATUS_PARSE_ERROR))
+		return 1;
+	if (check_error(test_name, "(A,(B,C);", PARSER_STATUS_PARSE_ERROR))
+		return 1;
+	if (check_error(test_name, "(A,(B,C)));", PARSER_STATUS_PARSE_ERROR))
+		return 1;
+	if (check_error(test_name, "(A:,B);", PARSER_STATUS_PARSE_ERROR))
+		return 1;
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* The parser starts at the file's current position */
+
+int test_offset()
+{
+	const char *test_name = "test_offset";
+	FILE *file = file_with("(A,B);\n(C,D);\n");
+	struct mmap_parser *parser;
+	struct rooted_tree *tree;
+	char *obt;
+
+	fseek(file, 7, SEEK_SET);
+	parser = create_mmap_parser(file);
+	if (NULL == parser) {
+		printf ("%s: could not create parser.\n", test_name);
+		return 1;
+	}
+	tree = mmap_parse_tree_in_arena(parser);
+	if (NULL == tree) {
+		printf ("%s: got NULL.\n", test_name);
+		return 1;
+	}
+	obt = to_newick(tree->root);
+	if (0 != strcmp("(C,D);", obt)) {
+		printf ("%s: expected '(C,D);', got '%s'.\n", test_name, obt);
+		return 1;
+	}
+	free(obt);
+	destroy_tree(tree, DONT_FREE_NODE_DATA);
+	destroy_mmap_parser(parser);
+	fclose(file);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Returns a temporary file holding 'num_trees' different trees, spanning
+ * several of the parallel parser's chunks, then 'tail'; rewound. */
+
+static FILE *file_with_many_trees(int num_trees, const char *tail)
+{
+	FILE *file = tmpfile();
+	int i;
+	if (NULL == file) return NULL;
+	for (i = 0; i < num_trees; i++)
+		fprintf(file, "((A%d:1,'B;%d')[%d;],(C,D)%d);\n", i, i, i, i);
+	fputs(tail, file);
+	rewind(file);
+	return file;
+}
+
+/* The parallel parser yields the same trees as the mmap parser, in order,
+ * and stops at the same error */
+
+int test_parallel()
+{
+	const char *test_name = "test_parallel";
+	const char *tails[] = { "", "(E,F", NULL };
+	enum parser_status_type exp_status[] = {
+		PARSER_STATUS_EMPTY, PARSER_STATUS_PARSE_ERROR };
+	int num_trees = 5000, t;
+
+	for (t = 0; NULL != tails[t]; t++) {
+		FILE *file = file_with_many_trees(num_trees, tails[t]);
+		struct mmap_parser *serial = NULL;
+		struct parallel_parser *parallel = NULL;
+		struct rooted_tree *exp, *obt;
+		int n = 0;
+
+		if (NULL != file) {
+			serial = create_mmap_parser(file);
+			parallel = create_parallel_parser(file, 3, t);
+		}
+		if (NULL == serial || NULL == parallel) {
+			printf ("%s: could not create parsers.\n", test_name);
+			return 1;
+		}
+		while (NULL != (exp = mmap_parse_tree(serial))) {
+			obt = parallel_parse_tree(parallel);
+			if (NULL == obt) {
+				printf ("%s: tree %d: got NULL.\n", test_name,
+						n);
+				return 1;
+			}
+			char *exp_newick = to_newick(exp->root);
+			char *obt_newick = to_newick(obt->root);
+			if (0 != strcmp(exp_newick, obt_newick)) {
+				printf ("%s: tree %d: expected '%s', got "
+					"'%s'.\n", test_name, n, exp_newick,
+					obt_newick);
+				return 1;
+			}
+			if (obt->nodes_in_order != tree_postorder(obt)) {
+				printf ("%s: wrong postorder.\n", test_name);
+				return 1;
+			}
+			free(exp_newick);
+			free(obt_newick);
+			destroy_tree(exp, DONT_FREE_NODE_DATA);
+			destroy_tree(obt, DONT_FREE_NODE_DATA);
+			n++;
+		}
+		if (num_trees != n) {
+			printf ("%s: expected %d trees, got %d.\n", test_name,
+					num_trees, n);
+			return 1;
+		}
+		if (NULL != parallel_parse_tree(parallel)
+			|| exp_status[t] != serial->status
+			|| exp_status[t] != parallel_parser_status(parallel)) {
+			printf ("%s: expected status %d, got %d (serial: "
+				"%d).\n", test_name, exp_status[t],
+				parallel_parser_status(parallel),
+				serial->status);
+			return 1;
+		}
+		destroy_mmap_parser(serial);
+		destroy_parallel_parser(parallel);
+		fclose(file);
+	}
+
+	/* stopping early frees the trees parsed ahead */
+	FILE *file = file_with_many_trees(num_trees, "");
+	struct parallel_parser *parallel = create_parallel_parser(file, 2, 0);
+	struct rooted_tree *tree;
+	if (NULL == parallel || NULL == (tree = parallel_parse_tree(parallel))) {
+		printf ("%s: could not parse.\n", test_name);
+		return 1;
+	}
+	destroy_tree(tree, DONT_FREE_NODE_DATA);
+	destroy_parallel_parser(parallel);
+	fclose(file);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting mmap parser test...\n");
+	failures += test_same_trees();
+	failures += test_flat_tree();
+	failures += test_errors();
+	failures += test_offset();
+	failures += test_parallel();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/parser.h"
+#include "../src/nexus_reader.h"
+#include "../src/tree.h"
+#include "../src/to_newick.h"
+
+/* A TAXA block (skipped), and two TREES blocks, the first with a TRANSLATE
+ * table. Comments, quotes and line breaks are where they may trip a
+ * line-oriented converter. */
+
+static const char *nexus =
+	"#NEXUS\n"
+	"[ written by hand; not by a program ]\n"
+	"BEGIN TAXA;\n"
+	"\tDIMENSIONS NTAX=3;\n"
+	"\tTAXLABELS Mus 'Homo sapiens' 'it''s; odd';\n"
+	"END;\n"
+	"Begin trees; [ mixed case ]\n"
+	"\tTranslate\n"
+	"\t\t1 Mus,\n"
+	"\t\t2 'Homo sapiens',\n"
+	"\t\t3 'it''s; odd'\n"
+	"\t\t;\n"
+	"\ttree one = [&R] ((1:0.1,2:0.2)90:0.3,3:1e-05);\n"
+	"\tTREE * two = [&U] (3,\n"
+	"\t\t(2 [a [nested] comment; with a semicolon],\n"
+	"\t\t1));\n"
+	"End;\n"
+	"BEGIN TREES;\n"
+	"\tUTREE three = (1,(2,3));\n"
+	"ENDBLOCK;\n";
+
+static const char *exp_newicks[] = {
+	"((Mus:0.1,'Homo sapiens':0.2)90:0.3,'it''s; odd':1e-05);",
+	"('it''s; odd',('Homo sapiens',Mus));",
+	"(1,(2,3));"
+};
+
+#define NUM_TREES 3
+
+/* Returns a reader of 'text', from a temporary file */
+
+static struct nexus_reader *make_reader(const char *text)
+{
+	FILE *file = tmpfile();
+	if (NULL == file) return NULL;
+	fputs(text, file);
+	rewind(file);
+	if (! is_nexus(file)) return NULL;
+	return create_nexus_reader(file);
+}
+
+int test_read()
+{
+	const char *test_name = "test_read";
+	struct nexus_reader *reader = make_reader(nexus);
+	struct rooted_tree *tree;
+	int n;
+
+	if (NULL == reader) {
+		printf ("%s: could not make reader.\n", test_name);
+		return 1;
+	}
+	for (n = 0; n < NUM_TREES; n++) {
+		char *newick;
+		tree = n % 2 ? nexus_read_tree_in_arena(reader)
+			: nexus_read_tree(reader);
+		if (NULL == tree) {
+			printf ("%s: got NULL tree %d.\n", test_name, n);
+			return 1;
+		}
+		newick = to_newick(tree->root);
+		if (0 != strcmp(exp_newicks[n], newick)) {
+			printf ("%s: expected '%s', got '%s'.\n", test_name,
+					exp_newicks[n], newick);
+			return 1;
+		}
+		free(newick);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+	}
+	if (NULL != nexus_read_tree(reader)
+		|| PARSER_STATUS_EMPTY != reader->status) {
+		printf ("%s: expected the end of input.\n", test_name);
+		return 1;
+	}
+
+	fclose(reader->input);
+	destroy_nexus_reader(reader);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Bad input is an error, not the end of input */
+
+int test_errors()
+{
+	const char *test_name = "test_errors";
+	const char *bad[] = {
+		"#NEXUSX\nBEGIN TREES;\nTREE t = (A,B);\nEND;\n",
+		"#NEXUS\nBEGIN TREES;\nTREE t (A,B);\nEND;\n",
+		"#NEXUS\nBEGIN TREES;\nTREE t = (A,B)\n",
+		"#NEXUS\nBEGIN TREES;\nTRANSLATE 1 A, 2;\nTREE t = (1,2);\n",
+		"#NEXUS\nBEGIN TREES;\nTREE t = (A,B));\nEND;\n"
+	};
+	int i;
+
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+		struct nexus_reader *reader = make_reader(bad[i]);
+		if (NULL == reader) {
+			printf ("%s: could not make reader.\n", test_name);
+			return 1;
+		}
+		if (NULL != nexus_read_tree(reader)
+			|| PARSER_STATUS_PARSE_ERROR != reader->status) {
+			printf ("%s: expected a parse error for '%s'.\n",
+					test_name, bad[i]);
+			return 1;
+		}
+		fclose(reader->input);
+		destroy_nexus_reader(reader);
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting NEXUS reader test...\n");
+	failures += test_read();
+	failures += test_errors();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+#!/bin/sh
+
+# Tests nw_match's MAST search on a small seed and tree set. Unlike the other
+# app tests, nw_match writes its results to files named after its input files
+# (<seed file><tree file>_OP, and <that>_best with -t), so this one has a
+# script of its own.
+
+seeds=test_nw_match_seeds
+trees=test_nw_match_trees
+op=${seeds}${trees}_OP
+
+echo "Testing program: nw_match"
+
+if [ ! -x ../src/nw_match ] ; then
+	echo "nw_match not found or not executable."
+	exit 1
+fi
+
+# the inputs, gzipped
+zseeds=$seeds.gz
+ztrees=$trees.gz
+zop=${zseeds}${ztrees}_OP.gz
+# more trees than nw_match used to have room for: the trees, 41 times over
+many=test_nw_match_many
+mop=${seeds}${many}_OP
+
+cleanup()
+{
+	rm -f $op ${op}_best $trees.nwi
+	rm -f $zseeds ${zseeds}_frequencies $ztrees $zop
+	rm -f $many $many.nwi $mop
+}
+
+pass=TRUE
+check()
+{
+	if [ $1 = TRUE ] ; then
+		echo "pass"
+	else
+		echo "FAIL"
+		pass=FALSE
+	fi
+}
+
+cleanup
+
+# The MASTs of the default run, one per seed, are fixed.
+echo -n "test 'default': "
+ok=FALSE
+if ../src/nw_match $seeds $trees 70 > /dev/null &&
+		diff $op test_nw_match_mast.exp ; then
+	ok=TRUE
+fi
+check $ok
+
+# With a deadline, the best MAST goes to _best: a header of progress counters,
+# then the MAST itself, which must be a tree with as many leaves as stated.
+echo -n "test 'best': "
+ok=FALSE
+if ../src/nw_match -t 60 $seeds $trees 70 > /dev/null &&
+		[ `wc -l < ${op}_best` -eq 4 ] &&
+		grep -q '^# outer seeds covered: 12 of 12$' ${op}_best ; then
+	stated=`sed -n 's/^# best MAST: \([0-9]*\) leaves.*/\1/p' ${op}_best`
+	found=`tail -n 1 ${op}_best | ../src/nw_stats -f l - |
+		awk -F'\t' '/^(Cladogram|Phylogram)/ { print $3 }'`
+	if [ -n "$stated" ] && [ "$stated" = "$found" ] ; then
+		ok=TRUE
+	fi
+fi
+check $ok
+
+# Ordering candidates by co-occurrence may find other MASTs: just check that
+# there is one per seed.
+echo -n "test 'order': "
+ok=FALSE
+if ../src/nw_match -o $seeds $trees 70 > /dev/null &&
+		[ `wc -l < $op` -eq `wc -l < test_nw_match_mast.exp` ] ; then
+	ok=TRUE
+fi
+check $ok
+
+# Compressed inputs are read as they are, and -z gzips the output: once
+# decompressed, it is the same as the default run's.
+echo -n "test 'compressed': "
+ok=FALSE
+gzip -c $seeds > $zseeds
+cp ${seeds}_frequencies ${zseeds}_frequencies
+gzip -c $trees > $ztrees
+if ../src/nw_match -z $zseeds $ztrees 70 > /dev/null &&
+		gzip -dc $zop | diff - test_nw_match_mast.exp ; then
+	ok=TRUE
+fi
+check $ok
+
+# Each tree occurring as often as the others, the MASTs are the same as with
+# the trees once.
+echo -n "test 'many_trees': "
+ok=FALSE
+i=0
+while [ $i -lt 41 ] ; do
+	cat $trees
+	i=$((i + 1))
+done > $many
+if ../src/nw_match $seeds $many 70 > /dev/null &&
+		diff $mop test_nw_match_mast.exp ; then
+	ok=TRUE
+fi
+check $ok
+
+cleanup
+
+if test $pass = FALSE ; then
+	exit 1
+else
+	exit 0
+fi
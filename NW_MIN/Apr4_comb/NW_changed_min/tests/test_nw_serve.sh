@@ -0,0 +1,149 @@
+#!/bin/sh
+
+# Tests nw_serve, through nw_query, and the batch mode of the multi-call binary
+# nw. Where a separate program computes the same thing (labels, pruning, and
+# every command of a batch), the outputs are compared with that program's
+# (test_nw_serve_<case>.ref); the other replies are compared with
+# test_nw_serve_<case>.exp .
+
+sock=${TMPDIR:-/tmp}/test_nw_serve.$$
+trees=HRV_20reps.nw
+pattern='((POLIO1A_1,POLIO2_1),POLIO3_1);'
+
+echo "Testing programs: nw_serve, nw_query, nw"
+
+for prog in nw_serve nw_query nw ; do
+	if [ ! -x ../src/$prog ] ; then
+		echo "$prog not found or not executable."
+		exit 1
+	fi
+done
+
+query()
+{
+	../src/nw_query $sock "$@"
+}
+
+pass=TRUE
+check()
+{
+	if [ $1 = TRUE ] ; then
+		echo "pass"
+	else
+		echo "FAIL"
+		pass=FALSE
+	fi
+}
+
+# Compares a test's output (test_nw_serve_<case>.out) with the expected one,
+# test_nw_serve_<case>.<suffix>
+check_out()
+{
+	if diff test_nw_serve_$1.out test_nw_serve_$1.$2 ; then
+		check TRUE
+	else
+		check FALSE
+	fi
+}
+
+rm -f $sock
+../src/nw_serve $sock reps=$trees > /dev/null 2>&1 &
+server=$!
+trap 'kill $server 2> /dev/null; rm -f $sock' EXIT
+
+# The socket appears once the trees are read.
+tries=0
+until query list > test_nw_serve_list.out 2> /dev/null ; do
+	tries=$((tries + 1))
+	if [ $tries -gt 50 ] ; then
+		echo "nw_serve did not start."
+		exit 1
+	fi
+	sleep 0.1
+done
+
+echo -n "test 'list': "
+ok=FALSE
+if [ "$(cat test_nw_serve_list.out)" = "reps 20 30" ] ; then
+	ok=TRUE
+fi
+check $ok
+
+echo -n "test 'count': "
+ok=FALSE
+if [ "$(query count reps "$pattern")" = 14 ] ; then
+	ok=TRUE
+fi
+check $ok
+
+echo -n "test 'match': "
+query match reps "$pattern" > test_nw_serve_match.out
+check_out match exp
+
+echo -n "test 'labels': "
+query labels reps 1 > test_nw_serve_labels.out
+head -n 1 $trees | ../src/nw_labels - > test_nw_serve_labels.ref
+check_out labels ref
+
+echo -n "test 'all_labels': "
+query labels reps > test_nw_serve_all_labels.out
+../src/nw_labels -I $trees | awk '! seen[$0]++' \
+	> test_nw_serve_all_labels.ref
+check_out all_labels ref
+
+echo -n "test 'prune': "
+query prune reps all HRV3_1 POLIO2_1 > test_nw_serve_prune.out
+../src/nw_prune $trees HRV3_1 POLIO2_1 > test_nw_serve_prune.ref
+check_out prune ref
+
+echo -n "test 'restrict': "
+query restrict reps all POLIO1A_1 POLIO2_1 POLIO3_1 HRV3_1 \
+	> test_nw_serve_restrict.out
+check_out restrict exp
+
+# Errors make nw_query fail, with the server's message on stderr.
+echo -n "test 'error': "
+ok=FALSE
+if ! query count nosuch "$pattern" > /dev/null 2> test_nw_serve_error.out &&
+		[ "$(cat test_nw_serve_error.out)" = "no collection 'nosuch'" ]
+then
+	ok=TRUE
+fi
+check $ok
+
+echo -n "test 'bad_pattern': "
+ok=FALSE
+if ! query count reps '((POLIO1A_1,POLIO2_1);' > /dev/null 2>&1 &&
+		[ "$(query count reps "$pattern")" = 14 ] ; then
+	ok=TRUE
+fi
+check $ok
+
+# A batch outputs the same as its commands, run one after the other.
+echo -n "test 'batch': "
+cat > test_nw_serve_batch.in <<'END'
+# comments and blank lines are skipped
+
+labels -I catarrhini.nw
+prune catarrhini.nw 'Homo' Pan
+topology -I catarrhini.nw
+reroot catarrhini.nw Cercopithecidae
+order fagales.nw
+END
+../src/nw --batch < test_nw_serve_batch.in > test_nw_serve_batch.out
+ok=$?
+grep -v -e '^#' -e '^$' test_nw_serve_batch.in |
+	while read prog args ; do
+		eval ../src/nw_$prog $args < /dev/null
+	done > test_nw_serve_batch.ref
+if [ $ok -eq 0 ] ; then
+	check_out batch ref
+else
+	check FALSE
+fi
+
+if test $pass = FALSE ; then
+	exit 1
+else
+	exit 0
+fi
@@ -5,6 +5,10 @@
 #include "order_tree.h"
 #include "tree_stubs.h"
 #include "to_newick.h"
+#include "rnode.h"
+#include "link.h"
+#include "list.h"
+#include "label_table.h"
 
 int test_order_lbl()
 {
@@ -25,6 +29,81 @@ int test_order_lbl()
 	return 0;
 }
 
+/* A polytomy too large for the in-place insertion sort, with duplicate labels
+ * (whose order must be kept) */
+
+int test_order_lbl_polytomy()
+{
+	const char *test_name = "test_order_lbl_polytomy";
+	struct rnode *root = create_rnode("", "");
+	struct llist *nodes_in_order = create_llist();
+	struct rooted_tree tree;
+	char *labels = "tsrqponmlkjihgfedcbaa";
+	char label[2] = "x";
+	int i;
+
+	for (i = 0; '\0' != labels[i]; i++) {
+		label[0] = labels[i];
+		/* lengths tell the two 'a' leaves apart */
+		struct rnode *kid = create_rnode(label, i % 2 ? "1" : "2");
+		add_child(root, kid);
+		append_element(nodes_in_order, kid);
+	}
+	append_element(nodes_in_order, root);
+	tree.root = root;
+	tree.nodes_in_order = nodes_in_order;
+	tree.arena = NULL;
+	tree.orders = NULL;
+
+	order_tree_lbl(&tree);
+	char *obt_newick = to_newick(tree.root);
+	char *exp_newick = "(a:1,a:2,b:2,c:1,d:2,e:1,f:2,g:1,h:2,i:1,j:2,k:1,"
+		"l:2,m:1,n:2,o:1,p:2,q:1,r:2,s:1,t:2);";
+
+	if (0 != strcmp(obt_newick, exp_newick)) {
+		printf ("%s: expected '%s', got '%s'.\n",
+			test_name, exp_newick,
+			obt_newick);
+		return 1;
+	}
+	if (NULL != root->data) {
+		printf ("%s: node data should be NULL.\n", test_name);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* With many more labels in the table than in the tree, only the tree's own
+ * labels are ranked - the result must be the same. */
+
+int test_order_lbl_few_labels()
+{
+	const char *test_name = "test_order_lbl_few_labels";
+	struct rooted_tree tree = tree_13();
+	char label[16];
+	int i;
+
+	for (i = 0; i < 1000; i++) {
+		sprintf(label, "Z%d", i);
+		intern_label(label);
+	}
+	order_tree_lbl(&tree);
+	char *obt_newick = to_newick(tree.root);
+	char *exp_newick = "((Ant,Bee),((Cat,Dog),Eel));";
+
+	if (0 != strcmp(obt_newick, exp_newick)) {
+		printf ("%s: expected '%s', got '%s'.\n",
+			test_name, exp_newick,
+			obt_newick);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
 int test_order_num_desc()
 {
 	const char *test_name = "test_order_num_desc";
@@ -72,6 +151,8 @@ int main()
 	int failures = 0;
 	printf("Starting reordering test...\n");
 	failures += test_order_lbl();
+	failures += test_order_lbl_polytomy();
+	failures += test_order_lbl_few_labels();
 	failures += test_order_num_desc();
 	failures += test_order_deladderize();
 	if (0 == failures) {
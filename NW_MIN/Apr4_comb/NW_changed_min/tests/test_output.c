@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include "../src/output.h"
+
+/* Numbers must come out exactly as printf() writes them: this compares both
+ * on chosen values, and on many random ones of all magnitudes. */
+
+static const double chosen[] = {
+	0.0, -0.0, 1.0, -1.0, 0.5, 1.5, 2.5, 0.1, 0.15, 0.125, 1e-4, 1e-5,
+	0.00012345678, 999999.0, 999999.5, 1e6, 123456.5, 99999.95, 0.3,
+	1.0/3, 2.0/3, -1e-300, 1e300, 12345678.9, 0.000099999995, 1e-10
+};
+
+#define NUM_RANDOM 200000
+
+/* Returns a random double with a random exponent */
+
+static double random_double()
+{
+	double mantissa = (double) rand() / RAND_MAX;
+	int exponent = rand() % 30 - 12;
+	double x = mantissa * pow(10, exponent);
+	/* short decimals, like edge lengths, also hit halfway cases */
+	if (0 == rand() % 4) x = floor(x * 1000) / 1000;
+	return rand() % 2 ? x : -x;
+}
+
+static int check_double(const char *test_name, double x)
+{
+	char exp[NUMBER_STRING_SIZE], obs[NUMBER_STRING_SIZE];
+	int decimals;
+
+	sprintf(exp, "%g", x);
+	format_double(obs, x);
+	if (0 != strcmp(exp, obs)) {
+		printf ("%s: %%g of %.17g: expected '%s', got '%s'.\n",
+				test_name, x, exp, obs);
+		return 1;
+	}
+	for (decimals = 0; decimals <= 9; decimals += 2) {
+		sprintf(exp, "%.*f", decimals, x);
+		format_fixed(obs, x, decimals);
+		if (0 != strcmp(exp, obs)) {
+			printf ("%s: %%.%df of %.17g: expected '%s', got "
+				"'%s'.\n", test_name, decimals, x, exp, obs);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int test_format_double()
+{
+	const char *test_name = "test_format_double";
+	int i;
+
+	for (i = 0; i < sizeof(chosen) / sizeof(chosen[0]); i++)
+		if (check_double(test_name, chosen[i])) return 1;
+	if (check_double(test_name, NAN) || check_double(test_name, INFINITY))
+		return 1;
+	srand(1);
+	for (i = 0; i < NUM_RANDOM; i++)
+		if (check_double(test_name, random_double())) return 1;
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_format_long()
+{
+	const char *test_name = "test_format_long";
+	const long values[] = { 0, 1, -1, 9, 10, 1234567, LONG_MAX, LONG_MIN };
+	char exp[NUMBER_STRING_SIZE], obs[NUMBER_STRING_SIZE];
+	char *end;
+	int i;
+
+	for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		sprintf(exp, "%ld", values[i]);
+		end = format_long(obs, values[i]);
+		if (0 != strcmp(exp, obs) || obs + strlen(obs) != end) {
+			printf ("%s: expected '%s', got '%s'.\n", test_name,
+					exp, obs);
+			return 1;
+		}
+	}
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* out_*() go through the stream, in order with other output */
+
+int test_out()
+{
+	const char *test_name = "test_out";
+	const char *exp = "d = 0.25, n = -12, x = 3.1416;";
+	FILE *file = tmpfile();
+	char obs[100];
+	size_t length;
+
+	if (NULL == file) {
+		printf ("%s: could not create file.\n", test_name);
+		return 1;
+	}
+	out_string(file, "d = ");
+	out_double(file, 0.25);
+	fprintf(file, ", n = ");
+	out_long(file, -12);
+	out_string(file, ", x = ");
+	out_fixed(file, 3.14159265, 4);
+	putc(';', file);
+	rewind(file);
+	length = fread(obs, 1, sizeof(obs) - 1, file);
+	obs[length] = '\0';
+	if (0 != strcmp(exp, obs)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name, exp, obs);
+		return 1;
+	}
+	fclose(file);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	buffer_stdout();
+	printf("Starting output test...\n");
+	failures += test_format_long();
+	failures += test_format_double();
+	failures += test_out();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "tree.h"
+#include "parser.h"
+#include "to_newick.h"
+
+#define NUM_THREADS 4
+#define TREES_PER_THREAD 200
+
+/* Parses the next tree and checks its Newick. Returns 0 iff ok. */
+
+static int check_next_tree(const char *test_name,
+		struct newick_parser *parser, const char *exp)
+{
+	struct rooted_tree *tree = parser_parse_tree(parser);
+	char *obt;
+
+	if (NULL == tree) {
+		printf ("%s: expected tree '%s', got NULL.\n", test_name, exp);
+		return 1;
+	}
+	obt = to_newick(tree->root);
+	if (0 != strcmp(exp, obt)) {
+		printf ("%s: expected '%s', got '%s'.\n", test_name, exp, obt);
+		return 1;
+	}
+	free(obt);
+	destroy_tree(tree, DONT_FREE_NODE_DATA);
+	return 0;
+}
+
+int test_string_parser()
+{
+	const char *test_name = "test_string_parser";
+	struct newick_parser *parser =
+		create_newick_string_parser("((A,B)f,C)g;\n(D:1,E:2);");
+
+	if (NULL == parser) {
+		printf ("%s: could not create parser.\n", test_name);
+		return 1;
+	}
+	if (check_next_tree(test_name, parser, "((A,B)f,C)g;")) return 1;
+	if (check_next_tree(test_name, parser, "(D:1,E:2);")) return 1;
+	if (1 != parser->lineno) {
+		printf ("%s: expected line 1, got %d.\n", test_name,
+				parser->lineno);
+		return 1;
+	}
+	if (NULL != parser_parse_tree(parser)) {
+		printf ("%s: expected no more trees.\n", test_name);
+		return 1;
+	}
+	if (PARSER_STATUS_EMPTY != parser->status) {
+		printf ("%s: expected PARSER_STATUS_EMPTY.\n", test_name);
+		return 1;
+	}
+	destroy_newick_parser(parser);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Two parsers don't interfere */
+
+int test_interleaved_parsers()
+{
+	const char *test_name = "test_interleaved_parsers";
+	struct newick_parser *p1 = create_newick_string_parser(
+			"(A,B);(C,D);");
+	struct newick_parser *p2 = create_newick_string_parser(
+			"(E,(F,G));(H,I,J);");
+
+	if (NULL == p1 || NULL == p2) {
+		printf ("%s: could not create parsers.\n", test_name);
+		return 1;
+	}
+	if (check_next_tree(test_name, p1, "(A,B);")) return 1;
+	if (check_next_tree(test_name, p2, "(E,(F,G));")) return 1;
+	if (check_next_tree(test_name, p1, "(C,D);")) return 1;
+	if (check_next_tree(test_name, p2, "(H,I,J);")) return 1;
+	destroy_newick_parser(p1);
+	destroy_newick_parser(p2);
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Each thread parses its own trees, in arenas, and checks them. */
+
+struct thread_arg {
+	int num;
+	int failures;
+};
+
+static void *parse_trees(void *varg)
+{
+	struct thread_arg *arg = varg;
+	char exp[100];
+	char *input = malloc(TREES_PER_THREAD * sizeof(exp));
+	struct newick_parser *parser;
+	struct rooted_tree *tree;
+	int i;
+
+	if (NULL == input) { arg->failures++; return NULL; }
+	input[0] = '\0';
+	for (i = 0; i < TREES_PER_THREAD; i++) {
+		sprintf(exp, "((T%d_%d,B%d)x,(C,D%d)y)z;\n",
+				arg->num, i, i % 7, arg->num);
+		strcat(input, exp);
+	}
+	parser = create_newick_string_parser(input);
+	if (NULL == parser) { arg->failures++; return NULL; }
+	for (i = 0; i < TREES_PER_THREAD; i++) {
+		char *obt;
+		tree = parser_parse_tree_in_arena(parser);
+		if (NULL == tree) { arg->failures++; break; }
+		sprintf(exp, "((T%d_%d,B%d)x,(C,D%d)y)z;",
+				arg->num, i, i % 7, arg->num);
+		obt = to_newick(tree->root);
+		if (0 != strcmp(exp, obt)) arg->failures++;
+		free(obt);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+	}
+	destroy_newick_parser(parser);
+	free(input);
+	return NULL;
+}
+
+int test_threads()
+{
+	const char *test_name = "test_threads";
+	pthread_t threads[NUM_THREADS];
+	struct thread_arg args[NUM_THREADS];
+	int i, failures = 0;
+
+	for (i = 0; i < NUM_THREADS; i++) {
+		args[i].num = i;
+		args[i].failures = 0;
+		if (0 != pthread_create(threads + i, NULL, parse_trees,
+					args + i)) {
+			printf ("%s: could not create thread.\n", test_name);
+			return 1;
+		}
+	}
+	for (i = 0; i < NUM_THREADS; i++) {
+		pthread_join(threads[i], NULL);
+		failures += args[i].failures;
+	}
+	if (0 != failures) {
+		printf ("%s: %d bad trees.\n", test_name, failures);
+		return 1;
+	}
+
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting parser test...\n");
+	failures += test_string_parser();
+	failures += test_interleaved_parsers();
+	failures += test_threads();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
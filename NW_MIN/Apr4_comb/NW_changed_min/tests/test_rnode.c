@@ -2,6 +2,8 @@
 #include <string.h>
 
 #include "rnode.h"
+#include "label_table.h"
+#include "common.h"
 
 int test_create_rnode()
 {
@@ -152,6 +154,40 @@ int test_create_rnode_emptylength()
 	return 0;
 }
 
+int test_interned_labels()
+{
+	const char *test_name = "test_interned_labels";
+	struct rnode *n1 = create_rnode("Homo", NULL);
+	struct rnode *n2 = create_rnode("Homo", "");
+	struct rnode *n3 = create_rnode("Pan", NULL);
+
+	if (n1->label_id != n2->label_id || n1->label != n2->label) {
+		printf("%s: identical labels should share id and string.\n",
+				test_name);
+		return 1;
+	}
+	if (n1->label_id == n3->label_id) {
+		printf("%s: distinct labels should have distinct ids.\n",
+				test_name);
+		return 1;
+	}
+	if (SUCCESS != set_rnode_label(n3, "Homo")) {
+		printf("%s: set_rnode_label() failed.\n", test_name);
+		return 1;
+	}
+	if (n3->label_id != n1->label_id || 0 != strcmp("Homo", n3->label)) {
+		printf("%s: expected relabeled node to be 'Homo' (got '%s').\n",
+				test_name, n3->label);
+		return 1;
+	}
+	if (0 != strcmp("Pan", label_string(find_label("Pan")))) {
+		printf("%s: expected 'Pan' in label table.\n", test_name);
+		return 1;
+	}
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
 int test_create_many()
 {
 	int i;
@@ -173,6 +209,7 @@ int main()
 	failures += test_create_rnode_emptylabel();
 	failures += test_create_rnode_nulllength();
 	failures += test_create_rnode_emptylength();
+	failures += test_interned_labels();
 	failures += test_create_many();
 	if (0 == failures) {
 		printf("All tests ok.\n");
@@ -432,6 +432,114 @@ int test_clone_subtree()
 	return 0;
 }
 
+/* A caterpillar deep enough to overflow the C stack if cloning recursed */
+
+int test_clone_deep_subtree()
+{
+	const char *test_name = "test_clone_deep_subtree";
+	const int depth = 200000;
+	struct rnode *root = create_rnode("", "");
+	struct rnode *current = root;
+	int i;
+	for (i = 0; i < depth; i++) {
+		struct rnode *leaf = create_rnode("A", "1");
+		struct rnode *inner = create_rnode("", "1");
+		add_child(current, leaf);
+		add_child(current, inner);
+		current = inner;
+	}
+
+	struct rooted_tree *clone = clone_subtree(root);
+	if (NULL == clone) {
+		printf ("%s: clone_subtree() failed.\n", test_name);
+		return 1;
+	}
+	char *orig_newick = to_newick(root);
+	char *clone_newick = to_newick(clone->root);
+	if (strcmp(orig_newick, clone_newick) != 0) {
+		printf ("%s: Newick strings are different.\n", test_name);
+		return 1;
+	}
+	if (2 * depth + 1 != clone->nodes_in_order->count) {
+		printf ("%s: expected %d nodes, got %d.\n", test_name,
+				2 * depth + 1, clone->nodes_in_order->count);
+		return 1;
+	}
+
+	free(orig_newick);
+	free(clone_newick);
+	destroy_tree(clone, DONT_FREE_NODE_DATA);
+	free_descendants(root);
+
+	printf ("%s: ok.\n", test_name);
+	return 0;
+}
+
+/* Concatenates the labels of the nodes in 'list' into 'buf' */
+
+static char *list_labels(struct llist *list, char *buf)
+{
+	struct list_elem *el;
+	buf[0] = '\0';
+	for (el = list->head; NULL != el; el = el->next)
+		strcat(buf, ((struct rnode *) el->data)->label);
+	return buf;
+}
+
+int test_tree_orders()
+{
+	const char *test_name = "test_tree_orders";
+	struct rooted_tree tree = tree_2();	/* ((A,B)f,(C,(D,E)g)h)i; */
+	struct hash *map = create_label2node_map(tree.nodes_in_order);
+	struct rnode *node_C = hash_get(map, "C");
+	struct llist *postorder;
+	char buf[32];
+
+	postorder = tree_postorder(&tree);
+	if (strcmp("ABfCDEghi", list_labels(postorder, buf)) != 0) {
+		printf ("%s: wrong postorder '%s'.\n", test_name, buf);
+		return 1;
+	}
+	if (strcmp("ifABhCgDE", list_labels(tree_preorder(&tree), buf)) != 0) {
+		printf ("%s: wrong preorder '%s'.\n", test_name, buf);
+		return 1;
+	}
+	if (strcmp("ABCDE", list_labels(tree_leaves(&tree), buf)) != 0) {
+		printf ("%s: wrong leaves '%s'.\n", test_name, buf);
+		return 1;
+	}
+	if (tree_postorder(&tree) != postorder) {
+		printf ("%s: postorder was not cached.\n", test_name);
+		return 1;
+	}
+
+	/* changing the tree invalidates the cached orders */
+	if (UNLINK_RNODE_DONE != unlink_rnode(node_C)) {
+		printf ("%s: could not unlink C.\n", test_name);
+		return 1;
+	}
+	if (strcmp("ABfDEgi", list_labels(tree_postorder(&tree), buf)) != 0) {
+		printf ("%s: wrong postorder after unlink: '%s'.\n",
+				test_name, buf);
+		return 1;
+	}
+	if (strcmp("ABDE", list_labels(tree_leaves(&tree), buf)) != 0) {
+		printf ("%s: wrong leaves after unlink: '%s'.\n",
+				test_name, buf);
+		return 1;
+	}
+	/* nodes_in_order is left alone */
+	if (9 != tree.nodes_in_order->count) {
+		printf ("%s: expected 9 nodes in nodes_in_order, got %d.\n",
+				test_name, tree.nodes_in_order->count);
+		return 1;
+	}
+	forget_tree_orders(&tree);
+
+	printf ("%s: ok.\n", test_name);
+	return 0;
+}
+
 int main()
 {
 	int failures = 0;
@@ -447,6 +555,8 @@ int main()
 	failures += test_nodes_from_labels();
 	failures += test_nodes_from_regexp();
 	failures += test_clone_subtree();
+	failures += test_clone_deep_subtree();
+	failures += test_tree_orders();
 	if (0 == failures) {
 		printf("All tests ok.\n");
 	} else {
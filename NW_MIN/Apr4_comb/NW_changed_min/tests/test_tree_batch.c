@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/tree_batch.h"
+#include "../src/cluster_set.h"
+#include "../src/label_table.h"
+
+static const char *newicks = "((A,B),C);\n((A,C),B);\n(A,(B,C),D);\n";
+
+int test_read()
+{
+	const char *test_name = "test_read";
+	struct tree_batch *batch = read_tree_batch_string(newicks);
+	int counts[3];
+
+	if (NULL == batch) {
+		printf ("%s: got NULL batch.\n", test_name);
+		return 1;
+	}
+	if (3 != batch->num_trees || 4 != batch->taxa->count) {
+		printf ("%s: expected 3 trees on 4 taxa, got %d on %d.\n",
+				test_name, batch->num_trees,
+				batch->taxa->count);
+		return 1;
+	}
+	if (0 != strcmp("((A,C),B);", batch->newicks[1])) {
+		printf ("%s: expected '((A,C),B);', got '%s'.\n", test_name,
+				batch->newicks[1]);
+		return 1;
+	}
+	tree_batch_leaf_counts(batch, counts);
+	if (3 != counts[0] || 3 != counts[1] || 4 != counts[2]) {
+		printf ("%s: expected leaf counts 3, 3, 4.\n", test_name);
+		return 1;
+	}
+
+	destroy_tree_batch(batch);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_match()
+{
+	const char *test_name = "test_match";
+	struct tree_batch *batch = read_tree_batch_string(newicks);
+	const char *patterns[] = { "((A,B),C);", "(C,B);", "(A,D);",
+		"((A,X),B);", "((A,B);" };
+	int exp_counts[] = { 1, 3, 1, 0, BATCH_BAD_PATTERN };
+	const char *exp_matches = "100" "111" "001" "000";
+	char matches[5 * 3];
+	int counts[5];
+	int i;
+
+	if (NULL == batch) {
+		printf ("%s: got NULL batch.\n", test_name);
+		return 1;
+	}
+	if (1 != tree_batch_match(batch, patterns[0], matches)
+		|| ! matches[0] || matches[1] || matches[2]) {
+		printf ("%s: expected only tree 0 to match '%s'.\n",
+				test_name, patterns[0]);
+		return 1;
+	}
+	if (! tree_batch_match_all(batch, patterns, 5, matches, counts)) {
+		printf ("%s: could not match patterns.\n", test_name);
+		return 1;
+	}
+	for (i = 0; i < 5; i++)
+		if (exp_counts[i] != counts[i]) {
+			printf ("%s: expected %d matches of '%s', got %d.\n",
+					test_name, exp_counts[i], patterns[i],
+					counts[i]);
+			return 1;
+		}
+	for (i = 0; i < 4 * 3; i++)
+		if ((exp_matches[i] == '1') != matches[i]) {
+			printf ("%s: wrong match %d of '%s'.\n", test_name,
+					i % 3, patterns[i / 3]);
+			return 1;
+		}
+	/* patterns' labels are not interned */
+	int num_labels = label_table_size();
+	if (0 != tree_batch_match(batch, "((A,Y),(B,Z));", matches)
+		|| num_labels != label_table_size()) {
+		printf ("%s: a pattern with new labels changed the label "
+				"table.\n", test_name);
+		return 1;
+	}
+
+	destroy_tree_batch(batch);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_prune()
+{
+	const char *test_name = "test_prune";
+	struct tree_batch *batch = read_tree_batch_string(newicks);
+	const char *goners[] = { "A" };
+	const char *keepers[] = { "B", "C", "X" };
+	char *pruned, *restricted;
+
+	if (NULL == batch) {
+		printf ("%s: got NULL batch.\n", test_name);
+		return 1;
+	}
+	pruned = tree_batch_prune(batch, 0, 2, goners, 1, 0);
+	if (NULL == pruned
+		|| 0 != strcmp("(B,C);\n(C,B);\n((B,C),D);\n", pruned)) {
+		printf ("%s: wrong pruned trees '%s'.\n", test_name, pruned);
+		return 1;
+	}
+	/* pruning does not change the batch */
+	restricted = tree_batch_prune(batch, 1, 2, keepers, 3, 1);
+	if (NULL == restricted
+		|| 0 != strcmp("(C,B);\n(B,C);\n", restricted)) {
+		printf ("%s: wrong restricted trees '%s'.\n", test_name,
+				restricted);
+		return 1;
+	}
+
+	free(pruned);
+	free(restricted);
+	destroy_tree_batch(batch);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting tree batch test...\n");
+	failures += test_read();
+	failures += test_match();
+	failures += test_prune();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "../src/tree_index.h"
+#include "../src/masprintf.h"
+
+/* Semicolons in quoted labels and in comments do not end trees; blanks
+ * between trees are not part of them. */
+
+static const char *trees =
+	"((A,B),C);\n"
+	"  ('a;b',[;]D);\n"
+	"(E,\n"
+	" F);"
+	"(G,H);\n"
+	"trailing text";
+
+static const char *exp_trees[] = {
+	"((A,B),C);",
+	"('a;b',[;]D);",
+	"(E,\n F);",
+	"(G,H);"
+};
+
+#define NUM_EXP_TREES 4
+#define TMP_FILE "test_tree_index.tmp"
+
+/* Writes 'contents' to file 'filename'. Returns 0 in case of error. */
+
+static int write_file(const char *filename, const char *contents)
+{
+	FILE *file = fopen(filename, "w");
+	if (NULL == file) return 0;
+	fputs(contents, file);
+	fclose(file);
+	return 1;
+}
+
+int test_create()
+{
+	const char *test_name = "test_create";
+	FILE *file = tmpfile();
+	struct tree_index *index;
+	long n;
+
+	if (NULL == file) {
+		printf ("%s: could not create file.\n", test_name);
+		return 1;
+	}
+	fputs(trees, file);
+	rewind(file);
+	index = create_tree_index(file);
+	if (NULL == index) {
+		printf ("%s: got NULL index.\n", test_name);
+		return 1;
+	}
+	if (NUM_EXP_TREES != index->num_trees) {
+		printf ("%s: expected %d trees, got %ld.\n", test_name,
+				NUM_EXP_TREES, index->num_trees);
+		return 1;
+	}
+	if (13 != index->offset[1] || 13 != index->length[1]) {
+		printf ("%s: expected tree 1 at 13 (length 13), got %lld "
+				"(length %lld).\n", test_name,
+				index->offset[1], index->length[1]);
+		return 1;
+	}
+	/* backwards, to check that trees are read independently */
+	for (n = NUM_EXP_TREES - 1; n >= 0; n--) {
+		char *text = read_tree_text(file, index, n);
+		if (NULL == text || 0 != strcmp(exp_trees[n], text)) {
+			printf ("%s: expected tree %ld '%s', got '%s'.\n",
+				test_name, n, exp_trees[n], text);
+			return 1;
+		}
+		free(text);
+	}
+	if (NULL != read_tree_text(file, index, NUM_EXP_TREES)) {
+		printf ("%s: expected NULL past the last tree.\n", test_name);
+		return 1;
+	}
+
+	destroy_tree_index(index);
+	fclose(file);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int test_save()
+{
+	const char *test_name = "test_save";
+	char *index_file = masprintf("%s%s", TMP_FILE, TREE_INDEX_SUFFIX);
+	struct tree_index *index, *saved;
+	long n;
+	int failures = 0;
+
+	if (! write_file(TMP_FILE, trees)) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	remove(index_file);
+	if (NULL != read_tree_index(TMP_FILE)) {
+		printf ("%s: expected no index yet.\n", test_name);
+		return 1;
+	}
+	index = get_tree_index(TMP_FILE);	/* also saves it */
+	saved = read_tree_index(TMP_FILE);
+	if (NULL == index || NULL == saved) {
+		printf ("%s: got NULL index.\n", test_name);
+		return 1;
+	}
+	if (index->num_trees != saved->num_trees) {
+		printf ("%s: expected %ld trees, got %ld.\n", test_name,
+				index->num_trees, saved->num_trees);
+		return 1;
+	}
+	for (n = 0; n < index->num_trees; n++)
+		if (index->offset[n] != saved->offset[n]
+			|| index->length[n] != saved->length[n]) {
+			printf ("%s: tree %ld differs.\n", test_name, n);
+			return 1;
+		}
+	destroy_tree_index(saved);
+
+	/* a changed file makes the saved index stale */
+	if (! write_file(TMP_FILE, "(A,B);\n")) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	if (NULL != read_tree_index(TMP_FILE)) {
+		printf ("%s: expected stale index to be rejected.\n",
+				test_name);
+		failures = 1;
+	}
+	saved = get_tree_index(TMP_FILE);
+	if (NULL == saved || 1 != saved->num_trees) {
+		printf ("%s: expected 1 tree after change.\n", test_name);
+		failures = 1;
+	}
+
+	if (NULL != saved) destroy_tree_index(saved);
+	destroy_tree_index(index);
+	remove(TMP_FILE);
+	remove(index_file);
+	free(index_file);
+	if (0 == failures) printf("%s ok.\n", test_name);
+	return failures;
+}
+
+/* Sets the file's modification time to 'sec' seconds and 'nsec' nanoseconds.
+ * Returns 0 in case of error. */
+
+static int set_mtime(const char *filename, time_t sec, long nsec)
+{
+	struct timespec times[2];
+	times[0].tv_sec = times[1].tv_sec = sec;
+	times[0].tv_nsec = times[1].tv_nsec = nsec;
+	return 0 == utimensat(AT_FDCWD, filename, times, 0);
+}
+
+int test_same_second()
+{
+	const char *test_name = "test_same_second";
+	char *index_file = masprintf("%s%s", TMP_FILE, TREE_INDEX_SUFFIX);
+	struct tree_index *index, *saved;
+	int failures = 0;
+
+	if (! write_file(TMP_FILE, "(A,B);\n")
+		|| ! set_mtime(TMP_FILE, 1000, 100)) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	remove(index_file);
+	index = get_tree_index(TMP_FILE);	/* also saves it */
+	saved = read_tree_index(TMP_FILE);
+	if (NULL == index || NULL == saved) {
+		printf ("%s: got NULL index.\n", test_name);
+		return 1;
+	}
+	destroy_tree_index(saved);
+	/* same size, same second */
+	if (! write_file(TMP_FILE, "A;B;C;\n")
+		|| ! set_mtime(TMP_FILE, 1000, 200)) {
+		printf ("%s: could not write file.\n", test_name);
+		return 1;
+	}
+	saved = read_tree_index(TMP_FILE);
+	if (NULL != saved) {
+		printf ("%s: expected stale index to be rejected.\n",
+				test_name);
+		destroy_tree_index(saved);
+		failures = 1;
+	}
+
+	destroy_tree_index(index);
+	remove(TMP_FILE);
+	remove(index_file);
+	free(index_file);
+	if (0 == failures) printf("%s ok.\n", test_name);
+	return failures;
+}
+
+int test_part()
+{
+	const char *test_name = "test_part";
+	struct tree_index *index;
+	long first, end, next = 0;
+	int part, num_parts = 3;
+	FILE *file = tmpfile();
+
+	if (NULL == file) {
+		printf ("%s: could not create file.\n", test_name);
+		return 1;
+	}
+	fputs(trees, file);
+	rewind(file);
+	index = create_tree_index(file);
+	if (NULL == index) {
+		printf ("%s: got NULL index.\n", test_name);
+		return 1;
+	}
+	/* parts are contiguous and cover all trees */
+	for (part = 0; part < num_parts; part++) {
+		tree_index_part(index, part, num_parts, &first, &end);
+		if (first != next || end < first) {
+			printf ("%s: part %d is %ld-%ld, expected to start at "
+					"%ld.\n", test_name, part, first, end,
+					next);
+			return 1;
+		}
+		next = end;
+	}
+	if (NUM_EXP_TREES != next) {
+		printf ("%s: parts end at %ld, expected %d.\n", test_name,
+				next, NUM_EXP_TREES);
+		return 1;
+	}
+	/* more parts than trees: some are empty */
+	tree_index_part(index, 9, 10, &first, &end);
+	if (end != NUM_EXP_TREES) {
+		printf ("%s: last part ends at %ld, expected %d.\n",
+				test_name, end, NUM_EXP_TREES);
+		return 1;
+	}
+
+	destroy_tree_index(index);
+	fclose(file);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting tree index test...\n");
+	failures += test_create();
+	failures += test_save();
+	failures += test_same_second();
+	failures += test_part();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_stubs.h"
+#include "../src/tree.h"
+#include "../src/to_newick.h"
+#include "../src/flat_tree.h"
+#include "../src/tree_pack.h"
+#include "../src/arena.h"
+
+/* tree_3() has lengths, tree_2() has none, tree_12() has some: trees with and
+ * without lengths alternate in the pack. */
+
+static const char *exp_newicks[] = {
+	"((A:1,B:1.0)f:2.0,(C:1,(D:1,E:1)g:2)h:3)i;",
+	"((A,B)f,(C,(D,E)g)h)i;",
+	"((A,B:1),C);"
+};
+
+#define NUM_TREES 3
+
+/* Writes a pack of the trees above to 'file'. Returns 0 in case of error. */
+
+static int write_pack(FILE *file)
+{
+	struct rooted_tree trees[NUM_TREES];
+	struct tree_pack_writer *writer = create_tree_pack_writer(file);
+	int i;
+
+	trees[0] = tree_3();
+	trees[1] = tree_2();
+	trees[2] = tree_12();
+	if (NULL == writer) return 0;
+	for (i = 0; i < NUM_TREES; i++) {
+		struct flat_tree *flat = create_flat_tree(&trees[i]);
+		if (NULL == flat || ! write_packed_tree(writer, flat))
+			return 0;
+		destroy_flat_tree(flat);
+	}
+	return finish_tree_pack(writer);
+}
+
+/* Returns a pack of the trees above, read from a temporary file */
+
+static struct tree_pack *make_pack()
+{
+	FILE *file = tmpfile();
+	struct tree_pack *pack;
+
+	if (NULL == file || ! write_pack(file)) return NULL;
+	rewind(file);
+	if (! is_tree_pack(file)) return NULL;
+	pack = open_tree_pack(file);
+	fclose(file);
+	return pack;
+}
+
+int test_round_trip()
+{
+	const char *test_name = "test_round_trip";
+	struct tree_pack *pack = make_pack();
+	struct rooted_tree *tree;
+	struct arena *arena;
+	long n;
+
+	if (NULL == pack) {
+		printf ("%s: could not make pack.\n", test_name);
+		return 1;
+	}
+	if (NUM_TREES != pack->num_trees) {
+		printf ("%s: expected %d trees, got %ld.\n", test_name,
+				NUM_TREES, pack->num_trees);
+		return 1;
+	}
+	/* backwards, to check that trees are read independently */
+	for (n = NUM_TREES - 1; n >= 0; n--) {
+		char *newick;
+		arena = n % 2 ? create_arena() : NULL;
+		tree = packed_rooted_tree(pack, n, arena);
+		if (NULL == tree) {
+			printf ("%s: got NULL tree %ld.\n", test_name, n);
+			return 1;
+		}
+		newick = to_newick(tree->root);
+		if (0 != strcmp(exp_newicks[n], newick)) {
+			printf ("%s: expected '%s', got '%s'.\n", test_name,
+					exp_newicks[n], newick);
+			return 1;
+		}
+		free(newick);
+		destroy_tree(tree, DONT_FREE_NODE_DATA);
+	}
+	if (NULL != packed_rooted_tree(pack, NUM_TREES, NULL)) {
+		printf ("%s: expected NULL past the last tree.\n", test_name);
+		return 1;
+	}
+
+	close_tree_pack(pack);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Flat trees are read in place, with the pack's dictionary and lengths */
+
+int test_flat()
+{
+	const char *test_name = "test_flat";
+	struct tree_pack *pack = make_pack();
+	struct flat_tree flat;
+	int a_id;
+
+	if (NULL == pack) {
+		printf ("%s: could not make pack.\n", test_name);
+		return 1;
+	}
+	if (! packed_flat_tree(pack, 0, &flat) || 9 != flat.num_nodes) {
+		printf ("%s: expected a flat tree of 9 nodes.\n", test_name);
+		return 1;
+	}
+	/* preorder: i f A B h C g D E */
+	if (0 != strcmp("g", flat_tree_label(&flat, 6))
+		|| 2.0 != flat.edge_length[6] || 4 != flat.parent[6]) {
+		printf ("%s: wrong node 6.\n", test_name);
+		return 1;
+	}
+	if (! packed_flat_tree(pack, 1, &flat)
+		|| -1 != flat.edge_length[2]
+		|| 0 != strcmp("", flat.strings[flat.length_id[2]])) {
+		printf ("%s: expected no lengths in tree 1.\n", test_name);
+		return 1;
+	}
+	/* "A" is stored once for all trees */
+	a_id = flat.label_id[2];
+	if (0 != strcmp("A", pack->strings[a_id])
+		|| ! packed_flat_tree(pack, 2, &flat)
+		|| a_id != flat.label_id[2]) {
+		printf ("%s: expected the same id for 'A'.\n", test_name);
+		return 1;
+	}
+
+	close_tree_pack(pack);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+/* Truncated or corrupt packs are rejected, not read */
+
+int test_corrupt()
+{
+	const char *test_name = "test_corrupt";
+	FILE *file = tmpfile();
+	FILE *truncated = tmpfile();
+	struct tree_pack *pack;
+	struct flat_tree flat;
+	long length;
+	int c;
+
+	if (NULL == file || NULL == truncated || ! write_pack(file)) {
+		printf ("%s: could not write pack.\n", test_name);
+		return 1;
+	}
+	length = ftell(file);
+	rewind(file);
+	while (EOF != (c = getc(file)) && ftell(file) < length - 8)
+		putc(c, truncated);
+	rewind(truncated);
+	if (NULL != open_tree_pack(truncated)) {
+		printf ("%s: expected truncated pack to be rejected.\n",
+				test_name);
+		return 1;
+	}
+
+	/* the first node's parent (in the first tree, after the header) */
+	fseek(file, 16 + 2 * sizeof(int), SEEK_SET);
+	putc(5, file);
+	rewind(file);
+	pack = open_tree_pack(file);
+	if (NULL == pack) {
+		printf ("%s: got NULL pack.\n", test_name);
+		return 1;
+	}
+	if (packed_flat_tree(pack, 0, &flat)
+		|| ! packed_flat_tree(pack, 1, &flat)) {
+		printf ("%s: expected (only) tree 0 to be rejected.\n",
+				test_name);
+		return 1;
+	}
+
+	close_tree_pack(pack);
+	fclose(file);
+	fclose(truncated);
+	printf("%s ok.\n", test_name);
+	return 0;
+}
+
+int main()
+{
+	int failures = 0;
+	printf("Starting tree pack test...\n");
+	failures += test_round_trip();
+	failures += test_flat();
+	failures += test_corrupt();
+	if (0 == failures) {
+		printf("All tests ok.\n");
+	} else {
+		printf("%d test(s) FAILED.\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -33,6 +33,8 @@ struct rooted_tree tree_1()
 	result.root = node_e;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -78,6 +80,8 @@ struct rooted_tree tree_2()
 	result.root = node_i;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -123,6 +127,8 @@ struct rooted_tree tree_3()
 	result.root = node_i;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -170,6 +176,8 @@ struct rooted_tree tree_4()
 	result.root = node_i;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -212,6 +220,8 @@ struct rooted_tree tree_5()
 	result.root = node_h;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -249,6 +259,8 @@ struct rooted_tree tree_6()
 	result.root = node_f;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -295,6 +307,8 @@ struct rooted_tree tree_7()
 	result.root = node_i;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -336,6 +350,8 @@ struct rooted_tree tree_8()
 	result.root = root;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -387,6 +403,8 @@ struct rooted_tree tree_9()
 	tree.root = nj;
 	tree.nodes_in_order = nodes_in_order;
 	tree.type = TREE_TYPE_UNKNOWN;
+	tree.arena = NULL;
+	tree.orders = NULL;
 
 	return tree;
 }
@@ -420,6 +438,8 @@ struct rooted_tree tree_10()
 	tree.root = hominoidea;
 	tree.nodes_in_order = nodes_in_order;
 	tree.type = TREE_TYPE_UNKNOWN;
+	tree.arena = NULL;
+	tree.orders = NULL;
 
 	return tree;
 }
@@ -456,6 +476,8 @@ struct rooted_tree tree_11()
 	tree.root = hominoidea;
 	tree.nodes_in_order = nodes_in_order;
 	tree.type = TREE_TYPE_UNKNOWN;
+	tree.arena = NULL;
+	tree.orders = NULL;
 
 	return tree;
 }
@@ -489,6 +511,8 @@ struct rooted_tree tree_12()
 	result.root = node_e;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -535,6 +559,8 @@ struct rooted_tree tree_13()
 	result.root = node_i;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -586,6 +612,8 @@ struct rooted_tree tree_14()
 	result.root = Vertebrata;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_CLADOGRAM; 	/* should make no difference */
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -636,6 +664,8 @@ struct rooted_tree tree_15()
 	result.root = Vertebrata;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_CLADOGRAM; 	/* should make no difference */
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
@@ -668,7 +698,56 @@ struct rooted_tree tree_16()
 	result.root = root;
 	result.nodes_in_order = nodes_in_order;
 	result.type = TREE_TYPE_CLADOGRAM; 	/* should make no difference */
+	result.arena = NULL;
+	result.orders = NULL;
 
 	return result;
 }
 
+
+/* Same labels as #2, but A and B swapped with C: ((A,C)f,(B,(D,E)g)h)i; */
+struct rooted_tree tree_17()
+{
+	struct rnode *node_A, *node_B, *node_C, *node_D, *node_E;
+	struct rnode *node_f, *node_g, *node_h, *node_i;
+	struct llist *nodes_in_order;
+	struct rooted_tree result;
+	
+	node_A = create_rnode("A", "");
+	node_B = create_rnode("B", "");
+	node_C = create_rnode("C", "");
+	node_D = create_rnode("D", "");
+	node_E = create_rnode("E", "");
+	node_f = create_rnode("f", "");
+	node_g = create_rnode("g", "");
+	node_h = create_rnode("h", "");
+	node_i = create_rnode("i", "");
+
+	add_child(node_f, node_A);
+	add_child(node_f, node_C);
+	add_child(node_g, node_D);
+	add_child(node_g, node_E);
+	add_child(node_h, node_B);
+	add_child(node_h, node_g);
+	add_child(node_i, node_f);
+	add_child(node_i, node_h);
+
+	nodes_in_order = create_llist();
+	append_element(nodes_in_order, node_A);
+	append_element(nodes_in_order, node_C);
+	append_element(nodes_in_order, node_f);
+	append_element(nodes_in_order, node_B);
+	append_element(nodes_in_order, node_D);
+	append_element(nodes_in_order, node_E);
+	append_element(nodes_in_order, node_g);
+	append_element(nodes_in_order, node_h);
+	append_element(nodes_in_order, node_i);
+
+	result.root = node_i;
+	result.nodes_in_order = nodes_in_order;
+	result.type = TREE_TYPE_UNKNOWN;
+	result.arena = NULL;
+	result.orders = NULL;
+
+	return result;
+}
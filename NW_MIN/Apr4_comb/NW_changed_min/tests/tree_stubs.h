@@ -66,3 +66,7 @@ struct rooted_tree tree_15();
 /* A tree with labels that have spaces, or quotes */
 /* (('Falco peregrinus', Falco_eleonorae),'Falco_rusticolus'); */
 struct rooted_tree tree_16();
+
+/* Same labels as #2, different topology */
+/* ((A,C)f,(B,(D,E)g)h)i; */
+struct rooted_tree tree_17();